@@ -0,0 +1,516 @@
+/*
+* Implementation of BenchMain.
+* The benchmark tool, timing the data classes on generated content
+* and writing the results as CSV.
+*/
+
+#include "BenchMain.h"
+#include <math.h>
+#include <wx/dir.h>
+#include <wx/filename.h>
+#include <wx/stdpaths.h>
+#include <wx/wfstream.h>
+#include <wx/mstream.h>
+#include <wx/stopwatch.h>
+#include "data/Pk3Stats.h"
+#include "data/UdmfMapStats.h"
+
+//A wxWidgets macro creates the application, defining the main-function and
+//the accessor function wxGetApp().
+wxIMPLEMENT_APP_CONSOLE(BenchMain);
+
+const int BENCH_RUNS = 3; //Fastest of these is reported
+const uint32_t BENCH_SEED = 20200101;
+const int BENCH_MAP_LINES = 4000; //Linedefs per map, times scale
+const int BENCH_UDMF_LINES = 8000;
+
+BenchMain::BenchMain()
+: scale(1), thingDefs(NULL), failedChecks(0), totalWads(0), totalMaps(0)
+{
+}
+
+bool BenchMain::OnInit()
+{
+	//Not calling wxAppConsole::OnInit, which would parse the arguments
+	if (argc < 2) {
+		printUsage();
+		return false;
+	}
+	workFolder = argv[1];
+	if (argc > 2) {
+		long sc = 0;
+		if (!argv[2].ToLong(&sc) || sc<1) {
+			printUsage();
+			return false;
+		}
+		scale = sc;
+	}
+	if (argc > 3)
+		selection = argv[3];
+	wxLog::SetComponentLevel("dmdb", wxLOG_Warning);
+	return true;
+}
+
+int BenchMain::OnRun()
+{
+	fileFolder = workFolder+wxFILE_SEP_PATH+"files";
+	if (!makeFolder(fileFolder, false) || !makeFolder(workFolder+wxFILE_SEP_PATH+"temp", false)) {
+		wxFprintf(stderr, "Can't make folders in %s\n", workFolder);
+		return 2;
+	}
+	//The ThingDef file is in the folder of the executable
+	wxString appDir = wxFileName(wxStandardPaths::Get().GetExecutablePath()).GetPath();
+	wxString thingFile = appDir+wxFILE_SEP_PATH+"doom.thg";
+	if (wxFileExists(thingFile)) {
+		thingDefs = new ThingDefList();
+		thingDefs->loadDefs(thingFile);
+	} else {
+		wxFprintf(stderr, "%s not found, things are not recognized\n", thingFile);
+	}
+
+	if (isSelected("wadstats"))
+		benchWadStats();
+	if (isSelected("mapstats"))
+		benchMapStats();
+	if (isSelected("nodearea"))
+		benchNodeArea();
+	if (isSelected("udmf"))
+		benchUdmf();
+	if (isSelected("pk3stats"))
+		benchPk3();
+	if (isSelected("db"))
+		benchDatabase();
+
+	printResults();
+	return (failedChecks==0)? 0: 1;
+}
+
+int BenchMain::OnExit()
+{
+	if (thingDefs != NULL)
+		delete thingDefs;
+	return 0;
+}
+
+void BenchMain::onTotalCounts(long wads, long maps, long auths)
+{
+	totalWads = wads;
+	totalMaps = maps;
+}
+
+void BenchMain::printUsage()
+{
+	wxPrintf("Usage:\n");
+	wxPrintf("  dmdbbench <work folder> [scale] [benchmark]\n");
+	wxPrintf("Generates content in the work folder and times the data classes on it,\n");
+	wxPrintf("writing CSV to standard output. scale multiplies the content sizes (default 1),\n");
+	wxPrintf("and only benchmarks starting with the benchmark name are run, if given.\n");
+}
+
+bool BenchMain::isSelected(const wxString& group)
+{
+	return selection.IsEmpty() || group.StartsWith(selection) || selection.StartsWith(group);
+}
+
+void BenchMain::report(const wxString& name, double items, double bytes, double seconds)
+{
+	if (!selection.IsEmpty() && !name.StartsWith(selection))
+		return;
+	for (size_t i=0; i<results.size(); i++) {
+		if (results[i].name == name) {
+			if (seconds < results[i].seconds)
+				results[i].seconds = seconds;
+			return;
+		}
+	}
+	results.push_back(BenchResult(name, items, bytes, seconds));
+	wxFprintf(stderr, "%s\n", name);
+}
+
+void BenchMain::printResults()
+{
+	wxPrintf("benchmark,scale,items,bytes,seconds,items_per_sec,bytes_per_sec\n");
+	for (size_t i=0; i<results.size(); i++) {
+		BenchResult& res = results[i];
+		double sec = (res.seconds>0.0)? res.seconds: 1e-9;
+		wxPrintf("%s,%i,%.0f,%.0f,%.6f,%.1f,%.1f\n", res.name, scale, res.items, res.bytes,
+			res.seconds, res.items/sec, res.bytes/sec);
+	}
+}
+
+void BenchMain::checkFailed(const wxString& message)
+{
+	wxFprintf(stderr, "Check failed: %s\n", message);
+	failedChecks++;
+}
+
+bool BenchMain::makeFolder(const wxString& path, bool clear)
+{
+	if (clear && wxFileName::DirExists(path))
+		wxFileName::Rmdir(path, wxPATH_RMDIR_RECURSIVE);
+	wxFileName dirname(path, "");
+	return dirname.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+}
+
+
+//************************ File analysis ************************
+
+void BenchMain::benchWadStats()
+{
+	WadGenerator gen(BENCH_SEED);
+	gen.setMapSize(BENCH_MAP_LINES);
+	wxString fileName = fileFolder+wxFILE_SEP_PATH+"wadstats.wad";
+	size_t size = gen.writeWad(fileName, 16*scale, GEN_NODES_DOOM);
+	if (size == 0) {
+		checkFailed("Couldn't write "+fileName);
+		return;
+	}
+	wxStopWatch watch;
+	for (int run=0; run<BENCH_RUNS; run++) {
+		TaskProgress progress("wadstats", NULL);
+		watch.Start();
+		WadStats* wadStats = new WadStats(fileName);
+		wadStats->readFile(&progress);
+		double seconds = watch.TimeInMicro().ToDouble()/1e6;
+		if (progress.hasFailed())
+			checkFailed("WadStats failed reading "+fileName);
+		report("wadstats_read", wadStats->numberOfLumps, size, seconds);
+		delete wadStats;
+	}
+
+	//A large resource wad, timing the lump categorization
+	if (!isSelected("wadstats_lumps"))
+		return;
+	fileName = fileFolder+wxFILE_SEP_PATH+"wadstats_lumps.wad";
+	size = gen.writeResourceWad(fileName, 200000*scale);
+	if (size == 0) {
+		checkFailed("Couldn't write "+fileName);
+		return;
+	}
+	WadContentType checked[] = {WSPRITE, WPATCH, WFLAT, WSFX, WMUS};
+	for (int run=0; run<BENCH_RUNS; run++) {
+		TaskProgress progress("wadstats_lumps", NULL);
+		watch.Start();
+		WadStats* wadStats = new WadStats(fileName);
+		wadStats->readFile(&progress, false);
+		double seconds = watch.TimeInMicro().ToDouble()/1e6;
+		if (progress.hasFailed())
+			checkFailed("WadStats failed reading "+fileName);
+		for (int i=0; i<5; i++) {
+			int count = (wadStats->content[checked[i]]==NULL)? 0: wadStats->content[checked[i]]->count;
+			if (count != gen.getResourceCount(checked[i]))
+				checkFailed(wxString::Format("Lump type %i: %i lumps, generated %i", checked[i], count, gen.getResourceCount(checked[i])));
+		}
+		report("wadstats_lumps", wadStats->numberOfLumps, size, seconds);
+		delete wadStats;
+	}
+}
+
+void BenchMain::benchMapStats()
+{
+	for (int f=0; f<GEN_NODES_END; f++) {
+		GenNodeFormat format = (GenNodeFormat)f;
+		wxString name = "mapstats_"+getGenNodeName(format);
+		if (!isSelected(name))
+			continue;
+		WadGenerator gen(BENCH_SEED+f);
+		gen.setMapSize(BENCH_MAP_LINES*scale);
+		wxString fileName = fileFolder+wxFILE_SEP_PATH+name+".wad";
+		if (gen.writeWad(fileName, 8, format) == 0) {
+			checkFailed("Couldn't write "+fileName);
+			continue;
+		}
+		readMaps(name, fileName, false, gen.getMapArea());
+	}
+}
+
+void BenchMain::benchNodeArea()
+{
+	for (int f=0; f<GEN_NODES_END; f++) {
+		GenNodeFormat format = (GenNodeFormat)f;
+		wxString name = "nodearea_"+getGenNodeName(format);
+		if (!isSelected(name))
+			continue;
+		WadGenerator gen(BENCH_SEED+f);
+		gen.setMapSize(BENCH_MAP_LINES*scale);
+		vector<GenLump*> lumps;
+		gen.makeMap("MAP01", format, lumps);
+		wxMemoryBuffer data;
+		vector<DirEntry*> dir;
+		WadGenerator::packLumps(lumps, data, dir, 0);
+		Vector2D minXY(0.0, 0.0), maxXY(0.0, 0.0);
+		gen.getBounds(minXY, maxXY);
+
+		wxStopWatch watch;
+		for (int run=0; run<BENCH_RUNS; run++) {
+			//Fresh objects, as computeArea adds to the area and GL
+			//formats add vertices
+			TaskProgress progress(name, NULL);
+			vector<Vertex>* vertices = gen.makeVertices();
+			vector<MapLine>* lines = gen.makeLines();
+			NodeStats* nodeStats = createNodeStats(format, vertices, lines);
+			nodeStats->progress = &progress;
+			wxMemoryInputStream in(data.GetData(), data.GetDataLen());
+			nodeStats->readFile(&in, &dir);
+			if (nodeStats->checkNodes()) {
+				watch.Start();
+				double area = nodeStats->computeArea(minXY, maxXY);
+				double seconds = watch.TimeInMicro().ToDouble()/1e6;
+				if (fabs(area-gen.getMapArea()) > 0.5)
+					checkFailed(wxString::Format("%s area %.0f, expected %.0f", name, area, gen.getMapArea()));
+				report(name, gen.getSubsectors(), 0, seconds);
+			} else {
+				checkFailed(name+" nodes not valid");
+			}
+			delete nodeStats;
+			delete vertices;
+			delete lines;
+		}
+		for (size_t i=0; i<dir.size(); i++)
+			delete dir[i];
+	}
+}
+
+void BenchMain::benchUdmf()
+{
+	WadGenerator gen(BENCH_SEED);
+	gen.setMapSize(BENCH_UDMF_LINES*scale, true);
+	wxString fileName = fileFolder+wxFILE_SEP_PATH+"udmf.wad";
+	if (gen.writeWad(fileName, 4, GEN_NODES_XGLN, true) == 0) {
+		checkFailed("Couldn't write "+fileName);
+		return;
+	}
+	readMaps("udmf_textmap", fileName, true, gen.getMapArea());
+}
+
+void BenchMain::benchPk3()
+{
+	WadGenerator gen(BENCH_SEED);
+	gen.setMapSize(BENCH_MAP_LINES/2);
+	wxString fileName = fileFolder+wxFILE_SEP_PATH+"pk3stats.pk3";
+	int maps = (16*scale > 99)? 99: 16*scale;
+	size_t size = gen.writePk3(fileName, maps, GEN_NODES_XNOD);
+	if (size == 0) {
+		checkFailed("Couldn't write "+fileName);
+		return;
+	}
+	wxString tempFolder = workFolder+wxFILE_SEP_PATH+"temp";
+	wxStopWatch watch;
+	for (int run=0; run<BENCH_RUNS; run++) {
+		TaskProgress progress("pk3stats", NULL);
+		watch.Start();
+		Pk3Stats* pk3Stats = new Pk3Stats(fileName, tempFolder);
+		pk3Stats->readFile(&progress);
+		double seconds = watch.TimeInMicro().ToDouble()/1e6;
+		if (progress.hasFailed())
+			checkFailed("Pk3Stats failed reading "+fileName);
+		int found = 0;
+		for (WadContentX* wcx=pk3Stats->getMapContent(); wcx!=NULL; wcx=wcx->next)
+			found++;
+		if (found != maps)
+			checkFailed(wxString::Format("Pk3Stats found %i of %i maps", found, maps));
+		report("pk3stats_read", maps, size, seconds);
+		pk3Stats->cleanup();
+		delete pk3Stats;
+	}
+}
+
+void BenchMain::readMaps(const wxString& name, const wxString& fileName, bool udmf, double expectedArea)
+{
+	TaskProgress progress(name, NULL);
+	WadStats wadStats(fileName);
+	wadStats.readFile(&progress, false);
+	if (wadStats.getMapContent() == NULL) {
+		checkFailed("No maps found in "+fileName);
+		return;
+	}
+	map<int, ThingDef*>* tm = (thingDefs==NULL)? NULL: thingDefs->getMapPointer();
+	wxStopWatch watch;
+	for (int run=0; run<BENCH_RUNS; run++) {
+		double seconds = 0.0;
+		double lines = 0.0;
+		double bytes = 0.0;
+		for (WadContentX* wcx=wadStats.getMapContent(); wcx!=NULL; wcx=wcx->next) {
+			string mapName = wcx->lumps->at(0)->name;
+			TaskProgress* sub = new TaskProgress("", &progress);
+			MapStats* mapStats;
+			if (udmf)
+				mapStats = new UdmfMapStats(mapName, DENG_ZDOOM, sub);
+			else
+				mapStats = new MapStats(mapName, DENG_BOOM, sub);
+			//Read like WadReader::loadMap does
+			wxFileInputStream file(wcx->name);
+			wxBufferedInputStream buf(file, 2048);
+			watch.Start();
+			mapStats->readFile(&buf, wcx->lumps, tm);
+			seconds += watch.TimeInMicro().ToDouble()/1e6;
+
+			lines += mapStats->getLineCount();
+			for (size_t i=0; i<wcx->lumps->size(); i++)
+				bytes += wcx->lumps->at(i)->size;
+			if (run==0 && fabs(mapStats->getMapArea()-expectedArea)>0.5)
+				checkFailed(wxString::Format("%s %s area %.0f, expected %.0f", name, mapName,
+					mapStats->getMapArea(), expectedArea));
+			delete mapStats;
+			delete sub;
+		}
+		report(name, lines, bytes, seconds);
+	}
+}
+
+NodeStats* BenchMain::createNodeStats(GenNodeFormat format, vector<Vertex>* vert, vector<MapLine>* lin)
+{
+	switch (format) {
+		case GEN_NODES_DEEP: return new DeepNodeStats(vert, lin);
+		case GEN_NODES_XNOD: return new ZDoomNodeStats(vert, lin);
+		case GEN_NODES_XGLN: return new ZDoomGLNodeStats(vert);
+		case GEN_NODES_XGL2: return new ZDoomGL2NodeStats(vert);
+		case GEN_NODES_XGL3: return new ZDoomGL3NodeStats(vert);
+		case GEN_NODES_GLV2: return new GLv2NodeStats(vert);
+		case GEN_NODES_GLV5: return new GLv5NodeStats(vert);
+		default: return new NodeStats(vert, lin);
+	}
+}
+
+
+//************************ Database ************************
+
+void BenchMain::benchDatabase()
+{
+	int wadCount = 1000*scale;
+	int mapCount = 10000*scale;
+	wxString dbFolder = workFolder+wxFILE_SEP_PATH+"db";
+	if (!makeFolder(dbFolder, true)) {
+		checkFailed("Couldn't make "+dbFolder);
+		return;
+	}
+
+	//Generate the database, through an empty DataManager
+	DataFilter* wadFilter = new DataFilter(FILTER_WAD);
+	wadFilter->name = "All wads";
+	wadFilter->sortField = WAD_DBID;
+	DataFilter* mapFilter = new DataFilter(FILTER_MAP);
+	mapFilter->name = "All maps";
+	mapFilter->sortField = MAP_DBID;
+	DataManager* dataBase = new DataManager(this);
+	dataBase->setFolder(dbFolder);
+	try {
+		dataBase->load();
+		dataBase->initDataFilters(wadFilter, mapFilter);
+		DbGenerator gen(BENCH_SEED);
+		gen.generate(dataBase, wadCount, mapCount, 500*scale);
+		dataBase->addDataFilter(makeBenchList(wadCount));
+		dataBase->saveDataFilters();
+	} catch (GuiError& err) {
+		checkFailed("Generating database: "+err.text1+" "+err.text2);
+		delete dataBase;
+		delete wadFilter;
+		delete mapFilter;
+		return;
+	}
+	delete dataBase;
+
+	//Size of the files read by load
+	double bytes = 0.0;
+	wxArrayString files;
+	wxDir::GetAllFiles(dbFolder, &files, wxEmptyString, wxDIR_FILES);
+	for (size_t i=0; i<files.GetCount(); i++)
+		bytes += wxFileName::GetSize(files[i]).ToDouble();
+
+	//Each run loads the database, so filters and sorts start without
+	//cached range indexes and sort keys
+	wxStopWatch watch;
+	for (int run=0; run<BENCH_RUNS; run++) {
+		dataBase = new DataManager(this);
+		dataBase->setFolder(dbFolder);
+		watch.Start();
+		dataBase->load();
+		double seconds = watch.TimeInMicro().ToDouble()/1e6;
+		if (dataBase->getLoadError().Length() > 0)
+			checkFailed("Loading database: "+dataBase->getLoadError());
+		if (totalMaps != mapCount)
+			checkFailed(wxString::Format("Loaded %li of %i maps", totalMaps, mapCount));
+		if (run == 0)
+			checkBenchList(dataBase, wadCount);
+		report("db_load", totalMaps, bytes, seconds);
+		dataBase->initDataFilters(wadFilter, mapFilter);
+
+		YearFilter yearFilter(FILTER_WAD, DFOP_MORE, 2010);
+		timeFilter(dataBase, "db_filter_wad_year", &yearFilter, totalWads);
+		AreaFilter areaFilter(FILTER_MAP, DFOP_MORE, 50000000.0f);
+		timeFilter(dataBase, "db_filter_map_area", &areaFilter, totalMaps);
+		TextSearchFilter textFilter(FILTER_MAP, "tower");
+		timeFilter(dataBase, "db_filter_map_text", &textFilter, totalMaps);
+		timeFilter(dataBase, "db_filter_map_all", mapFilter, totalMaps);
+
+		watch.Start();
+		dataBase->setWadSort(WAD_YEAR);
+		report("db_sort_wad_year", totalWads, 0, watch.TimeInMicro().ToDouble()/1e6);
+		timeMapSort(dataBase, "db_sort_map_linedefs", MAP_LINEDEFS);
+		timeMapSort(dataBase, "db_sort_map_title", MAP_TITLE);
+		//Same sort again, from the cache
+		timeMapSort(dataBase, "db_sort_map_linedefs_cached", MAP_LINEDEFS);
+
+		//Back to the original filters, as the others go out of scope
+		dataBase->changeDataFilter(wadFilter);
+		delete dataBase;
+	}
+	delete wadFilter;
+	delete mapFilter;
+}
+
+DataListFilter* BenchMain::makeBenchList(int wadCount)
+{
+	DataListFilter* dlv = new DataListFilter(FILTER_WAD_LIST);
+	dlv->name = "Bench list";
+	dlv->sortField = WAD_YEAR;
+	dlv->sortReverse = true;
+	SortKey key;
+	key.field = WAD_TITLE;
+	key.reverse = false;
+	dlv->thenSort.push_back(key);
+	key.field = WAD_MAPS;
+	key.reverse = true;
+	dlv->thenSort.push_back(key);
+	for (int i=1; i<=wadCount; i+=7)
+		dlv->addEntry(i);
+	return dlv;
+}
+
+void BenchMain::checkBenchList(DataManager* dataBase, int wadCount)
+{
+	DataListFilter* expected = makeBenchList(wadCount);
+	DataListFilter* loaded = NULL;
+	list<DataListFilter*>* lists = dataBase->getWadLists();
+	for (list<DataListFilter*>::iterator it=lists->begin(); it!=lists->end(); ++it) {
+		if ((*it)->name == expected->name)
+			loaded = *it;
+	}
+	bool same = (loaded!=NULL && loaded->sortField==expected->sortField
+		&& loaded->sortReverse==expected->sortReverse
+		&& loaded->thenSort.size()==expected->thenSort.size()
+		&& loaded->entries->count()==expected->entries->count());
+	for (size_t i=0; same && i<expected->thenSort.size(); i++) {
+		same = (loaded->thenSort[i].field==expected->thenSort[i].field
+			&& loaded->thenSort[i].reverse==expected->thenSort[i].reverse);
+	}
+	for (uint32_t id=expected->entries->next(0); same && id!=0; id=expected->entries->next(id))
+		same = loaded->entries->contains(id);
+	if (!same)
+		checkFailed("List "+expected->name+" not read back as written");
+	delete expected;
+}
+
+void BenchMain::timeFilter(DataManager* dataBase, const wxString& name, DataFilter* filter, double items)
+{
+	wxStopWatch watch;
+	dataBase->changeDataFilter(filter);
+	report(name, items, 0, watch.TimeInMicro().ToDouble()/1e6);
+}
+
+void BenchMain::timeMapSort(DataManager* dataBase, const wxString& name, WadMapFields field)
+{
+	wxStopWatch watch;
+	dataBase->setMapSort(field);
+	report(name, totalMaps, 0, watch.TimeInMicro().ToDouble()/1e6);
+}
@@ -0,0 +1,151 @@
+/*!
+* \file BenchMain.h
+* \author Lars Thomas Boye 2020
+*
+* BenchMain is the benchmark tool, timing the hot paths of the data
+* classes on synthetic content. It generates wads, pk3s and a database
+* in a work folder with WadGenerator and DbGenerator, then runs each
+* benchmark a few times and keeps the fastest run. The results are
+* written to standard output as CSV, one line per benchmark, so they
+* can be collected and compared between builds:
+*
+*   benchmark,scale,items,bytes,seconds,items_per_sec,bytes_per_sec
+*
+* Usage:
+* - dmdbbench <work folder> [scale] [benchmark]
+*
+* scale multiplies the content sizes (default 1). With a benchmark name,
+* only benchmarks starting with it are run, such as "mapstats_xgl3" or
+* "db". The generated content is the same for the same scale, and the
+* map benchmarks check that the computed map area is the exact area of
+* the generated geometry. The exit code is 1 if any check failed.
+*/
+
+#ifndef BENCHMAIN_H
+#define BENCHMAIN_H
+
+#include "data/CoreBase.h"
+#include <vector>
+#include <wx/app.h>
+#include "data/DataManager.h"
+#include "data/ThingDef.h"
+#include "bench/WadGenerator.h"
+#include "bench/DbGenerator.h"
+
+/*!
+* Timing of one benchmark: the size of one run and the fastest time.
+*/
+struct BenchResult
+{
+	wxString name;
+	double items; //!< Items processed in one run (maps, linedefs, entries...)
+	double bytes; //!< Bytes processed in one run, 0 if not meaningful
+	double seconds; //!< Fastest run
+
+	BenchResult(wxString nam, double it, double by, double sec)
+	: name(nam), items(it), bytes(by), seconds(sec) {}
+};
+
+/*!
+* The benchmark application, a wxAppConsole. Each benchmark group has
+* a method, generating its content and calling report for each run.
+*
+* - wadstats_read: WadStats::readFile of a wad with many maps (with MD5).
+* - wadstats_lumps: WadStats::readFile of a resource wad of 200k lumps
+*   without MD5, timing the lump categorization (lumps/s).
+* - mapstats_<nodes>: MapStats::readFile of Doom format maps, for each
+*   node format WadGenerator writes.
+* - nodearea_<nodes>: NodeStats::computeArea alone, for each node format.
+* - udmf_textmap: UdmfMapStats::readFile, parsing TEXTMAP.
+* - pk3stats_read: Pk3Stats::readFile with nested map wads.
+* - db_*: DataManager load, then filtering and sorting the lists. A wad
+*   list with several sort keys is saved with the database, and the load
+*   checks that it reads back as written.
+*
+* BenchMain is the DataStatusListener of the DataManager, counting the
+* entries as they are loaded.
+*/
+class BenchMain : public wxAppConsole, public DataStatusListener
+{
+	public:
+		BenchMain();
+
+		/*! Checks the arguments, printing the usage if they are wrong. */
+		virtual bool OnInit();
+
+		/*! Generates the content and runs the benchmarks. */
+		virtual int OnRun();
+
+		/*! Deletes the thing definitions. */
+		virtual int OnExit();
+
+		//DataStatusListener:
+		virtual void onWadFilter(const wxString& name, unsigned int wadCount) {}
+		virtual void onMapFilter(const wxString& name, unsigned int mapCount) {}
+		virtual void onTotalCounts(long wads, long maps, long auths);
+		virtual void onEntryModified(int type, uint32_t dbid) {}
+		virtual void onListChanged(int type) {}
+
+	private:
+		/*! Prints the usage of the tool. */
+		void printUsage();
+
+		/*! true if benchmarks starting with group may be selected. */
+		bool isSelected(const wxString& group);
+
+		/*! Records the time of one run, keeping the fastest. */
+		void report(const wxString& name, double items, double bytes, double seconds);
+
+		/*! Writes the results as CSV. */
+		void printResults();
+
+		/*! Logs a failed check, which gives exit code 1. */
+		void checkFailed(const wxString& message);
+
+		/*! Makes the folder, deleting its old content if clear. */
+		bool makeFolder(const wxString& path, bool clear);
+
+		//Benchmark groups:
+		void benchWadStats();
+		void benchMapStats();
+		void benchNodeArea();
+		void benchUdmf();
+		void benchPk3();
+		void benchDatabase();
+
+		/*!
+		* Reads each map of a wad with MapStats (or UdmfMapStats), checking
+		* the map area, and reports the runs with the given name.
+		*/
+		void readMaps(const wxString& name, const wxString& fileName, bool udmf, double expectedArea);
+
+		/*! The NodeStats class for a node format. */
+		NodeStats* createNodeStats(GenNodeFormat format, vector<Vertex>* vert, vector<MapLine>* lin);
+
+		/*! Changes to filter on dataBase, reporting the time with the given name. */
+		void timeFilter(DataManager* dataBase, const wxString& name, DataFilter* filter, double items);
+
+		/*! Sorts the map list of dataBase, reporting the time with the given name. */
+		void timeMapSort(DataManager* dataBase, const wxString& name, WadMapFields field);
+
+		/*! Wad list with reversed and further sort keys, for the list file check. */
+		DataListFilter* makeBenchList(int wadCount);
+
+		/*! Checks that the list from makeBenchList was loaded as it was saved. */
+		void checkBenchList(DataManager* dataBase, int wadCount);
+
+		wxString workFolder;
+		wxString fileFolder; //Generated wads and pk3s
+		int scale;
+		wxString selection; //Benchmark name prefix, or empty for all
+		ThingDefList* thingDefs;
+		vector<BenchResult> results;
+		int failedChecks;
+		long totalWads; //Counts from the DataManager
+		long totalMaps;
+};
+
+//! A wxWidgets macro for the declaration of wxGetApp implemented by IMPLEMENT_APP
+wxDECLARE_APP(BenchMain);
+
+#endif // BENCHMAIN_H
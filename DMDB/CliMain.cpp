@@ -0,0 +1,369 @@
+/*
+* Implementation of CliMain.
+* The command-line tool, carrying out one command on a database folder
+* with the data classes and no windows.
+*/
+
+#include "CliMain.h"
+#include <wx/dir.h>
+#include <wx/filename.h>
+#include <wx/stdpaths.h>
+
+
+//A wxWidgets macro creates the application, defining the main-function and
+//the accessor function wxGetApp().
+wxIMPLEMENT_APP_CONSOLE(CliMain);
+
+//********************** ConsoleReport **********************
+
+ConsoleReport::ConsoleReport()
+: column(0)
+{
+}
+
+void ConsoleReport::writeHeading(wxString text)
+{
+	if (column > 0)
+		wxPrintf("\n");
+	wxPrintf("\n%s\n%s\n", text, wxString('=', text.Length()));
+	column = 0;
+}
+
+void ConsoleReport::writeSubHeading(wxString text)
+{
+	if (column > 0)
+		wxPrintf("\n");
+	wxPrintf("\n%s\n%s\n", text, wxString('-', text.Length()));
+	column = 0;
+}
+
+void ConsoleReport::writeText(wxString text)
+{
+	write(text);
+}
+
+void ConsoleReport::writeLine(wxString text)
+{
+	write(text);
+	wxPrintf("\n");
+	column = 0;
+}
+
+void ConsoleReport::setTabs(const wxArrayInt &tabs)
+{
+	//About 2 mm per character
+	tabStops.Clear();
+	for (size_t i=0; i<tabs.GetCount(); i++)
+		tabStops.Add(tabs[i]/20);
+}
+
+void ConsoleReport::write(const wxString& text)
+{
+	wxString out;
+	for (wxString::const_iterator it=text.begin(); it!=text.end(); ++it) {
+		if (*it == '\n') {
+			out.Append('\n');
+			column = 0;
+		} else if (*it == '\t') {
+			size_t stop = column+1;
+			for (size_t i=0; i<tabStops.GetCount(); i++) {
+				if (tabStops[i] > column) {
+					stop = tabStops[i];
+					break;
+				}
+			}
+			out.Append(' ', stop-column);
+			column = stop;
+		} else {
+			out.Append(*it);
+			column++;
+		}
+	}
+	wxPrintf("%s", out);
+}
+
+
+//************************ CliMain ************************
+
+BEGIN_EVENT_TABLE(CliMain, wxAppConsole)
+    EVT_THREAD(THREAD_TASKLOG, CliMain::onTaskLog)
+    EVT_THREAD(THREAD_WADENTRY, CliMain::onImportEntry)
+    EVT_THREAD(THREAD_WADDONE, CliMain::onImportDone)
+END_EVENT_TABLE()
+
+CliMain::CliMain()
+: jobCount(0), dataBase(NULL), wadFilter(NULL), mapFilter(NULL), jobsRunning(0),
+importAdded(0), importMaps(0), importUpdated(0)
+{
+}
+
+bool CliMain::OnInit()
+{
+	//Not calling wxAppConsole::OnInit, which would parse the arguments
+	if (argc < 3) {
+		printUsage();
+		return false;
+	}
+	command = argv[1];
+	dbFolder = argv[2];
+	if (command=="import" || command=="rescan") {
+		if (argc < 4) {
+			printUsage();
+			return false;
+		}
+		fileFolder = argv[3];
+		long jobs = 0;
+		if (argc > 4 && (!argv[4].ToLong(&jobs) || jobs<0)) {
+			printUsage();
+			return false;
+		}
+		jobCount = jobs;
+		if (argc > 5)
+			traceFile = argv[5];
+	} else if (command!="validate" && command!="stats" && command!="memory") {
+		printUsage();
+		return false;
+	}
+	wxLog::SetComponentLevel("dmdb", wxLOG_Warning);
+	return true;
+}
+
+int CliMain::OnRun()
+{
+	if (!openDatabase())
+		return 2;
+	if (command == "import")
+		return importFiles(false);
+	else if (command == "rescan")
+		return importFiles(true);
+	else if (command == "validate")
+		return validate();
+	else if (command == "memory")
+		return printMemory();
+	else
+		return printStatistics();
+}
+
+int CliMain::OnExit()
+{
+	for (size_t i=0; i<readers.size(); i++)
+		delete readers[i];
+	if (dataBase != NULL)
+		delete dataBase;
+	delete wadFilter;
+	delete mapFilter;
+	return 0;
+}
+
+void CliMain::printUsage()
+{
+	wxPrintf("Usage:\n");
+	wxPrintf("  dmdbcli import <database> <folder> [jobs [trace]]\n");
+	wxPrintf("      Add the wad/zip/pk3 files in folder to the database\n");
+	wxPrintf("  dmdbcli rescan <database> <folder> [jobs [trace]]\n");
+	wxPrintf("      As import, also updating the entries of files already in the database\n");
+	wxPrintf("  dmdbcli validate <database>\n");
+	wxPrintf("      Check the consistency of the database\n");
+	wxPrintf("  dmdbcli stats <database>\n");
+	wxPrintf("      Print statistics for all wads and maps\n");
+	wxPrintf("  dmdbcli memory <database>\n");
+	wxPrintf("      Print the memory used by each structure of the loaded database\n");
+	wxPrintf("jobs is the number of files processed in parallel, by default (or 0) the number of CPUs.\n");
+	wxPrintf("trace is a file to write the timing of the import to, as trace JSON (for Perfetto).\n");
+}
+
+bool CliMain::openDatabase()
+{
+	if (!wxFileName::DirExists(dbFolder)) {
+		wxFprintf(stderr, "Database folder %s not found\n", dbFolder);
+		return false;
+	}
+	dataBase = new DataManager(this);
+	dataBase->setFolder(dbFolder);
+	try {
+		dataBase->load(); //Waits for the maps
+	} catch (GuiError& err) {
+		wxFprintf(stderr, "%s %s\n", err.text1, err.text2);
+		delete dataBase;
+		dataBase = NULL;
+		return false;
+	}
+	wxString error = dataBase->getLoadError();
+	if (!error.IsEmpty()) {
+		wxFprintf(stderr, "%s\n", error);
+		delete dataBase;
+		dataBase = NULL;
+		return false;
+	}
+	wadFilter = new DataFilter(FILTER_WAD);
+	wadFilter->name = "All wads";
+	wadFilter->sortField = WAD_DBID;
+	mapFilter = new DataFilter(FILTER_MAP);
+	mapFilter->name = "All maps";
+	mapFilter->sortField = WAD_DBID;
+	dataBase->initDataFilters(wadFilter, mapFilter);
+	wxPrintf("Loaded %u wads and %u maps from %s\n", dataBase->getWadSize(), dataBase->getMapSize(), dbFolder);
+	return true;
+}
+
+int CliMain::importFiles(bool replExisting)
+{
+	wxArrayString files;
+	wxDir::GetAllFiles(fileFolder, &files, wxEmptyString, wxDIR_FILES);
+	wxFileName fname;
+	wxString ext;
+	for (int i=files.GetCount()-1; i>=0; i--) {
+		fname = wxFileName(files[i]);
+		ext = fname.GetExt();
+		if (!ext.IsSameAs("wad", false) && !ext.IsSameAs("zip", false) && !ext.IsSameAs("pk3", false))
+			files.RemoveAt(i,1);
+	}
+	if (files.GetCount() == 0) {
+		wxPrintf("No relevant files found (zip/wad/pk3)\n");
+		return 0;
+	}
+
+	//The files are dealt out to the jobs in turn
+	int count = (jobCount > 0)? jobCount: wxThread::GetCPUCount();
+	if (count < 1)
+		count = 1;
+	if (count > files.GetCount())
+		count = files.GetCount();
+	vector<wxArrayString*> jobFiles;
+	for (int i=0; i<count; i++)
+		jobFiles.push_back(new wxArrayString());
+	for (size_t i=0; i<files.GetCount(); i++)
+		jobFiles[i%count]->Add(files[i]);
+	wxPrintf("Processing %u files with %i jobs\n", files.GetCount(), count);
+
+	for (int i=0; i<count; i++) {
+		WadReader* reader = createReader(i);
+		readers.push_back(reader);
+		WadImportJob* job = new WadImportJob(this, reader, jobFiles[i],
+			dataBase->getMapImgFolder(), dataBase->getWadHashes());
+		job->setReplaceExisting(replExisting);
+		if (job->Run() != wxTHREAD_NO_ERROR) {
+			wxFprintf(stderr, "Could not start processing files\n");
+			delete job;
+			continue;
+		}
+		jobs.push_back(job);
+		jobsRunning++;
+	}
+	bool started = (jobsRunning == count);
+	if (jobsRunning > 0)
+		MainLoop(); //Until ExitMainLoop from onImportDone
+
+	wxPrintf("Added %i wad entries with %i maps\n", importAdded, importMaps);
+	if (importUpdated > 0)
+		wxPrintf("Updated %i wad entries\n", importUpdated);
+	if (!traceFile.IsEmpty()) {
+		ConsoleReport report;
+		trace.printReport(&report, 0);
+		if (trace.writeFile(traceFile))
+			wxPrintf("Wrote trace to %s\n", traceFile);
+		else
+			wxFprintf(stderr, "Could not write trace to %s\n", traceFile);
+	}
+	dataBase->saveWadsMaps();
+	return started? 0: 1;
+}
+
+int CliMain::validate()
+{
+	ConsoleReport report;
+	report.writeHeading("Validating "+dbFolder);
+	int problems = dataBase->validate(&report);
+	report.writeLine(wxString::Format("%i problems found", problems));
+	return (problems==0)? 0: 1;
+}
+
+int CliMain::printStatistics()
+{
+	ConsoleReport report;
+	WadStatistics* wadStats = dataBase->getWadStatistics();
+	wadStats->printReport(&report);
+	delete wadStats;
+	MapStatistics* mapStats = dataBase->getStatistics(1);
+	mapStats->printReport(&report);
+	delete mapStats;
+	return 0;
+}
+
+int CliMain::printMemory()
+{
+	ConsoleReport report;
+	MemoryUsage* usage = dataBase->getMemoryUsage();
+	usage->printReport(&report);
+	delete usage;
+	return 0;
+}
+
+WadReader* CliMain::createReader(int index)
+{
+	//The ThingDef files are in the folder of the executable
+	wxString appDir = wxFileName(wxStandardPaths::Get().GetExecutablePath()).GetPath();
+	WadReader* reader = new WadReader();
+	reader->setThingFile(1, appDir+wxFILE_SEP_PATH+"doom.thg");
+	reader->setThingFile(2, appDir+wxFILE_SEP_PATH+"doom_zdoom.thg");
+	reader->setThingFile(3, appDir+wxFILE_SEP_PATH+"doom_skulltag.thg");
+	reader->setThingFile(4, appDir+wxFILE_SEP_PATH+"heretic.thg");
+	reader->setThingFile(5, appDir+wxFILE_SEP_PATH+"doom64.thg");
+	reader->setAspects(new WadStatAspects());
+
+	//Each reader clears its temp folder, so they need one each
+	wxString tempFolder = dataBase->getTempFolder()+wxFILE_SEP_PATH+wxString::Format("job%i", index);
+	wxFileName tempDirname(tempFolder, "");
+	tempDirname.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+	reader->setTempFolder(tempFolder);
+	reader->setFailedFolder(dataBase->getFailedFolder());
+	return reader;
+}
+
+void CliMain::deleteRemovedMaps(WadEntry* wadEntry)
+{
+	while (wadEntry->numberOfMaps > 0) {
+		MapEntry* mapEntry = wadEntry->mapPointers[wadEntry->numberOfMaps - 1];
+		if (!(mapEntry->ownFlags & OFLG_DELETE))
+			break;
+		dataBase->deleteMap(mapEntry);
+	}
+}
+
+void CliMain::onTaskLog(wxThreadEvent& event)
+{
+	wxPrintf("%s\n", event.GetString());
+}
+
+void CliMain::onImportEntry(wxThreadEvent& event)
+{
+	WadEntry* wadEntry = event.GetPayload<WadEntry*>();
+	//Another job may have added the same file
+	WadEntry* existing = dataBase->findWad(wadEntry->md5Digest);
+	if (existing == NULL) {
+		importAdded++;
+		importMaps += wadEntry->numberOfMaps;
+		dataBase->addWad(wadEntry);
+	} else {
+		importUpdated++;
+		bool deleted = readers[0]->mergeEntries(existing, wadEntry); //Deletes wadEntry
+		if (deleted)
+			deleteRemovedMaps(existing);
+		dataBase->wadModified(existing);
+	}
+}
+
+void CliMain::onImportDone(wxThreadEvent& event)
+{
+	wxPrintf("%s\n", event.GetString());
+	jobsRunning--;
+	if (jobsRunning > 0)
+		return;
+	for (size_t i=0; i<jobs.size(); i++) {
+		jobs[i]->Wait();
+		trace.add(jobs[i]->takeTiming());
+		delete jobs[i];
+	}
+	jobs.clear();
+	ExitMainLoop();
+}
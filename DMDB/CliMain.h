@@ -0,0 +1,144 @@
+/*!
+* \file CliMain.h
+* \author Lars Thomas Boye 2020
+*
+* CliMain is the command-line tool, using the data classes of the
+* application without any windows. It works on a database folder like
+* the GUI does, to import content files in batch, re-scan files already
+* in the database, check the consistency of the database and print its
+* statistics or memory usage. It can run on a machine without a display.
+*
+* Usage:
+* - dmdbcli import <database> <folder> [jobs [trace]]
+* - dmdbcli rescan <database> <folder> [jobs [trace]]
+* - dmdbcli validate <database>
+* - dmdbcli stats <database>
+* - dmdbcli memory <database>
+*/
+
+#ifndef CLIMAIN_H
+#define CLIMAIN_H
+
+#include "data/CoreBase.h"
+#include <vector>
+#include <wx/app.h>
+#include "TextReport.h"
+#include "data/DataManager.h"
+#include "data/WadReader.h"
+#include "data/WadImportJob.h"
+
+/*!
+* TextReport writing plain text to standard output. Headings are
+* underlined, and tabs are expanded to the tab stops, converted from
+* tenths of a millimeter to character columns.
+*/
+class ConsoleReport : public TextReport
+{
+	public:
+		ConsoleReport();
+		virtual void writeHeading(wxString text);
+		virtual void writeSubHeading(wxString text);
+		virtual void writeText(wxString text);
+		virtual void writeLine(wxString text);
+		virtual void setTabs(const wxArrayInt &tabs);
+
+	private:
+		/*! Writes text, expanding tabs from the current column. */
+		void write(const wxString& text);
+
+		wxArrayInt tabStops; //Character columns
+		size_t column; //Of current line
+};
+
+/*!
+* The command-line application, a wxAppConsole. The command is given
+* by the arguments, and is carried out by OnRun. The database is loaded
+* completely before the command starts.
+*
+* Import and rescan process the files of a folder with a WadImportJob
+* for each CPU core (or the given number of jobs), each job with its own
+* WadReader and temp folder. The files are dealt out to the jobs in turn.
+* The WadEntry objects posted by the jobs are added to the database, or
+* merged with existing entries, on the main thread, like the GUI does.
+* The main loop runs until every job has posted THREAD_WADDONE, and the
+* database is then saved. Rescan replaces existing entries rather than
+* skipping them. If a trace file is given, the timing of the jobs is
+* written to it as trace JSON, and a summary is printed.
+*
+* CliMain is the DataStatusListener of the DataManager, but there are no
+* views to update, so the notifications are ignored.
+*/
+class CliMain : public wxAppConsole, public DataStatusListener
+{
+	public:
+		CliMain();
+
+		/*! Checks the arguments, printing the usage if they are wrong. */
+		virtual bool OnInit();
+
+		/*! Loads the database and carries out the command. */
+		virtual int OnRun();
+
+		/*! Deletes the database. */
+		virtual int OnExit();
+
+		//DataStatusListener:
+		virtual void onWadFilter(const wxString& name, unsigned int wadCount) {}
+		virtual void onMapFilter(const wxString& name, unsigned int mapCount) {}
+		virtual void onTotalCounts(long wads, long maps, long auths) {}
+		virtual void onEntryModified(int type, uint32_t dbid) {}
+		virtual void onListChanged(int type) {}
+
+	private:
+		/*! Prints the usage of the tool. */
+		void printUsage();
+
+		/*! Loads dbFolder, returning false on error. */
+		bool openDatabase();
+
+		/*! The import and rescan commands. Returns the exit code. */
+		int importFiles(bool replExisting);
+
+		/*! The validate command. Returns the exit code. */
+		int validate();
+
+		/*! The stats command. Returns the exit code. */
+		int printStatistics();
+
+		/*! The memory command. Returns the exit code. */
+		int printMemory();
+
+		/*! Creates a WadReader for job number index. */
+		WadReader* createReader(int index);
+
+		/*! Deletes the maps flagged for deletion by WadReader::mergeEntries. */
+		void deleteRemovedMaps(WadEntry* wadEntry);
+
+		//Thread events:
+		void onTaskLog(wxThreadEvent& event);
+		void onImportEntry(wxThreadEvent& event);
+		void onImportDone(wxThreadEvent& event);
+
+		wxString command;
+		wxString dbFolder;
+		wxString fileFolder;
+		int jobCount; //0 for number of CPUs
+		wxString traceFile; //Empty for no trace
+		TaskTrace trace; //Timing of the import jobs
+		DataManager* dataBase;
+		DataFilter* wadFilter; //"All wads" list of dataBase
+		DataFilter* mapFilter; //"All maps" list of dataBase
+		vector<WadReader*> readers; //One for each job
+		vector<WadImportJob*> jobs;
+		int jobsRunning;
+		int importAdded; //New wad entries
+		int importMaps; //Maps in new wad entries
+		int importUpdated; //Existing wad entries
+
+		DECLARE_EVENT_TABLE()
+};
+
+//! A wxWidgets macro for the declaration of wxGetApp implemented by IMPLEMENT_APP
+wxDECLARE_APP(CliMain);
+
+#endif // CLIMAIN_H
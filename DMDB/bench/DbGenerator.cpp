@@ -0,0 +1,120 @@
+/*
+* DbGenerator implementation
+*/
+
+#include "DbGenerator.h"
+
+//Words for names and titles, picked from with the random generator
+const char* GEN_WORDS[] = {"Hell", "Base", "Tower", "Crypt", "Fortress", "Canyon",
+	"Temple", "Station", "Gate", "Abyss", "Outpost", "Sanctum", "Refinery", "Citadel",
+	"Sewers", "Lab"};
+const int GEN_WORD_COUNT = 16;
+const char* GEN_FIRST_NAMES[] = {"John", "Anna", "Erik", "Maria", "Paul", "Kim", "Lars", "Eva"};
+const char* GEN_LAST_NAMES[] = {"Smith", "Berg", "Novak", "Silva", "Moreau", "Tanaka", "Olsen", "Kowalski"};
+const int GEN_NAME_COUNT = 8;
+
+DbGenerator::DbGenerator(uint32_t seed)
+: random(seed)
+{
+}
+
+void DbGenerator::generate(DataManager* dataBase, int wads, int maps, int authors)
+{
+	wxLogVerbose("Generating %i authors, %i wads and %i maps", authors, wads, maps);
+	dataBase->openAuthorTextFile();
+	for (int i=0; i<authors; i++) {
+		AuthorEntry* author = makeAuthor(i);
+		dataBase->addAuthor(author, random.chance(20)? wxString("Generated author biography."): wxString(""));
+		authorList.push_back(author);
+	}
+	dataBase->closeAuthorTextFile();
+	dataBase->saveAuthors();
+
+	if (wads < 1)
+		return;
+	int perWad = maps/wads;
+	int extra = maps%wads;
+	for (int i=0; i<wads; i++) {
+		int count = perWad + ((i<extra)? 1: 0);
+		if (count < 1)
+			count = 1;
+		if (count > 99)
+			count = 99;
+		dataBase->addWad(makeWad(i, count));
+	}
+	dataBase->saveWadsMaps();
+}
+
+wxString DbGenerator::makeTitle(int number)
+{
+	return wxString::Format("%s %s %i", GEN_WORDS[random.range(GEN_WORD_COUNT)],
+		GEN_WORDS[random.range(GEN_WORD_COUNT)], number);
+}
+
+AuthorEntry* DbGenerator::makeAuthor(int number)
+{
+	AuthorEntry* author = new AuthorEntry(0);
+	if (random.chance(70)) {
+		author->namef = GEN_FIRST_NAMES[random.range(GEN_NAME_COUNT)];
+		author->namel = GEN_LAST_NAMES[random.range(GEN_NAME_COUNT)];
+	}
+	author->alias1 = wxString::Format("%s%i", GEN_WORDS[random.range(GEN_WORD_COUNT)], number);
+	return author;
+}
+
+WadEntry* DbGenerator::makeWad(int number, int maps)
+{
+	WadEntry* wad = new WadEntry(0, maps);
+	wad->fileName = wxString::Format("gen%05i.wad", number);
+	if (random.chance(10))
+		wad->extraFiles = wxString::Format("gen%05i.deh", number);
+	wad->title = makeTitle(number);
+	wad->fileSize = 10000 + random.next()%5000000;
+	wad->idGames = random.chance(60)? 1+random.range(20000): 0;
+	//The MD5 must be unique, so it starts with the number
+	for (int i=0; i<16; i++)
+		wad->md5Digest[i] = (i<4)? (number>>(8*i))&0xFF: random.range(256);
+	wad->year = 1994 + random.range(27);
+	wad->flags = random.range(0x100);
+	wad->iwad = IWAD_DOOM + random.range(4);
+	wad->engine = 1 + random.range(DENG_END-1);
+	wad->playStyle = random.chance(90)? 0: 1;
+	wad->rating = random.chance(50)? random.range(101): 255;
+	wad->ownRating = random.chance(20)? random.range(101): 255;
+	for (int i=0; i<maps; i++)
+		wad->addMap(makeMap(wad, i+1));
+	return wad;
+}
+
+MapEntry* DbGenerator::makeMap(WadEntry* wad, int number)
+{
+	MapEntry* map = new MapEntry(0);
+	map->wadPointer = wad;
+	map->name = wxString::Format("MAP%02i", number);
+	if (random.chance(70))
+		map->title = makeTitle(number);
+	if (authorList.size() > 0) {
+		map->author1 = authorList[random.range(authorList.size())];
+		if (random.chance(15))
+			map->author2 = authorList[random.range(authorList.size())];
+	}
+	map->linedefs = 50 + random.range(8000);
+	map->sectors = 5 + map->linedefs/(6+random.range(6));
+	map->things = 20 + random.range(map->linedefs/4+1);
+	map->secrets = random.range(12);
+	map->enemies = random.range(map->things/2+1);
+	map->totalHP = map->enemies*(20+random.range(300));
+	map->healthRatio = random.range(300)/100.0f;
+	map->armorRatio = random.range(200)/100.0f;
+	map->ammoRatio = random.range(400)/100.0f;
+	map->area = (float)map->linedefs * (2000+random.range(20000));
+	map->rating = random.chance(40)? random.range(101): 255;
+	map->singlePlayer = random.range(4);
+	map->cooperative = random.range(4);
+	map->deathmatch = random.range(4);
+	map->ownRating = random.chance(10)? random.range(101): 255;
+	map->played = random.range(5);
+	map->difficulty = random.range(5);
+	map->playTime = random.range(90);
+	return map;
+}
@@ -0,0 +1,52 @@
+/*!
+* \file DbGenerator.h
+* \author Lars Thomas Boye 2020
+*
+* DbGenerator fills a database with synthetic authors, wads and maps for
+* the benchmarks, through the DataManager as the import does, so the files
+* are written by the same code as real databases. Field values are drawn
+* from a seeded pseudo-random generator, so the same seed and counts give
+* the same database.
+*/
+
+#ifndef DBGENERATOR_H
+#define DBGENERATOR_H
+
+#include "../data/CoreBase.h"
+#include <vector>
+#include "../data/DataManager.h"
+#include "WadGenerator.h"
+
+/*!
+* Adds generated entries to a DataManager. The DataManager must be
+* loaded with its data filters set, and should be an empty database.
+*/
+class DbGenerator
+{
+	public:
+		/*! The seed decides all field values. */
+		DbGenerator(uint32_t seed);
+
+		virtual ~DbGenerator() {}
+
+		/*!
+		* Adds the authors, then the wads with the maps dealt out evenly
+		* between them (each wad gets at least one and at most 99 maps).
+		* Maps get random authors, statistics and game modes, and wads
+		* random years, iwads and engines. The database is saved.
+		*/
+		void generate(DataManager* dataBase, int wads, int maps, int authors);
+
+	private:
+		/*! Makes a title of two words and the number. */
+		wxString makeTitle(int number);
+
+		AuthorEntry* makeAuthor(int number);
+		WadEntry* makeWad(int number, int maps);
+		MapEntry* makeMap(WadEntry* wad, int number);
+
+		GenRandom random;
+		vector<AuthorEntry*> authorList;
+};
+
+#endif // DBGENERATOR_H
@@ -0,0 +1,826 @@
+/*
+* WadGenerator implementation
+*/
+
+#include "WadGenerator.h"
+#include <math.h>
+#include <string.h>
+#include <wx/file.h>
+#include <wx/filename.h>
+#include <wx/wfstream.h>
+#include <wx/zipstrm.h>
+
+//Values for the map content, picked from with the random generator
+const uint16_t GEN_THINGS[] = {3004, 9, 3001, 3002, 3005, 2011, 2012, 2014, 2015, 2048, 2049, 2001};
+const int GEN_THING_TYPES = 12;
+const char* GEN_WALLS[] = {"STARTAN3", "STONE2", "BROWN1", "METAL1", "TEKWALL4"};
+const char* GEN_FLATS[] = {"FLOOR4_8", "FLOOR5_1", "NUKAGE1", "CEIL3_5", "FLAT14"};
+const int GEN_TEXTURES = 5;
+
+wxString getGenNodeName(GenNodeFormat format)
+{
+	switch (format) {
+		case GEN_NODES_DOOM: return "doom";
+		case GEN_NODES_DEEP: return "deep";
+		case GEN_NODES_XNOD: return "xnod";
+		case GEN_NODES_XGLN: return "xgln";
+		case GEN_NODES_XGL2: return "xgl2";
+		case GEN_NODES_XGL3: return "xgl3";
+		case GEN_NODES_GLV2: return "glv2";
+		case GEN_NODES_GLV5: return "glv5";
+		default: return "";
+	}
+}
+
+//Lump data is little-endian, like the hosts we read it on
+static void put8(wxMemoryBuffer& buf, uint8_t val) { buf.AppendByte((char)val); }
+static void put16(wxMemoryBuffer& buf, uint16_t val) { buf.AppendData(&val, 2); }
+static void put32(wxMemoryBuffer& buf, uint32_t val) { buf.AppendData(&val, 4); }
+
+static void putName(wxMemoryBuffer& buf, const char* name)
+{
+	char padded[8];
+	memset(padded, 0, 8);
+	strncpy(padded, name, 8);
+	buf.AppendData(padded, 8);
+}
+
+static void putBox(wxMemoryBuffer& buf, const GenChild& child)
+{
+	for (int i=0; i<4; i++)
+		put16(buf, child.box[i]);
+}
+
+//Node child with the sub-sector flag of the format
+static uint16_t child16(const GenChild& child)
+{
+	return child.subsector? (child.index|0x8000): child.index;
+}
+
+static uint32_t child32(const GenChild& child)
+{
+	return child.subsector? (child.index|0x80000000): child.index;
+}
+
+
+//****************************************************************
+//************************ WadGenerator **************************
+//****************************************************************
+
+WadGenerator::WadGenerator(uint32_t seed)
+: random(seed), gridSize(0), cellSize(0), origin(0), subsectors(0)
+{
+	memset(resourceCounts, 0, sizeof(resourceCounts));
+}
+
+void WadGenerator::setMapSize(int linedefs, bool udmf)
+{
+	//A grid of n*n cells has 2*n*(n+1) lines
+	int n = (int)(sqrt(linedefs/2.0)+0.5);
+	if (n < 2)
+		n = 2;
+	//4*n*n sidedefs must fit 16 bits in Doom format. Coordinates
+	//and partition deltas must fit 16 bits in any format.
+	int maxSize = udmf? 32000/8: 127;
+	if (n > maxSize)
+		n = maxSize;
+	gridSize = n;
+	cellSize = 32000/n;
+	if (cellSize > 128)
+		cellSize = 128;
+	origin = -(gridSize*cellSize)/2;
+	makeGrid();
+}
+
+void WadGenerator::getBounds(Vector2D& minXY, Vector2D& maxXY)
+{
+	minXY = Vector2D((double)origin-1.0, (double)origin-1.0);
+	double far = (double)coordX(gridSize)+1.0;
+	maxXY = Vector2D(far, far);
+}
+
+void WadGenerator::makeGrid()
+{
+	int n = gridSize;
+	lines.clear();
+	lines.reserve(2*n*(n+1));
+	//Horizontal lines point east with the cell above on the back,
+	//except the bottom row, which is turned to face the grid.
+	for (int j=0; j<=n; j++) {
+		for (int i=0; i<n; i++) {
+			GenLine line;
+			if (j == 0) {
+				line.v1 = vertexIndex(i+1,0);
+				line.v2 = vertexIndex(i,0);
+				line.front = i;
+				line.back = -1;
+			} else {
+				line.v1 = vertexIndex(i,j);
+				line.v2 = vertexIndex(i+1,j);
+				line.front = (j-1)*n+i;
+				line.back = (j<n)? j*n+i: -1;
+			}
+			lines.push_back(line);
+		}
+	}
+	//Vertical lines point north with the cell to the west on the back,
+	//except the east column, which is turned to face the grid.
+	for (int j=0; j<n; j++) {
+		for (int i=0; i<=n; i++) {
+			GenLine line;
+			if (i == n) {
+				line.v1 = vertexIndex(n,j+1);
+				line.v2 = vertexIndex(n,j);
+				line.front = j*n+n-1;
+				line.back = -1;
+			} else {
+				line.v1 = vertexIndex(i,j);
+				line.v2 = vertexIndex(i,j+1);
+				line.front = j*n+i;
+				line.back = (i>0)? j*n+i-1: -1;
+			}
+			lines.push_back(line);
+		}
+	}
+
+	segs.clear();
+	segs.reserve(4*n*n);
+	nodes.clear();
+	nodes.reserve(n*n);
+	subsectors = 0;
+	buildNodes(0, 0, n, n);
+	wxLogVerbose("Generated grid of %i cells with %i lines and %i nodes", n*n, lines.size(), nodes.size());
+}
+
+GenChild WadGenerator::buildNodes(int x0, int y0, int x1, int y1)
+{
+	GenChild result;
+	result.box[0] = coordY(y1);
+	result.box[1] = coordY(y0);
+	result.box[2] = coordX(x0);
+	result.box[3] = coordX(x1);
+	if (x1-x0==1 && y1-y0==1) {
+		result.index = subsectors++;
+		result.subsector = true;
+		addCellSegs(x0, y0);
+		return result;
+	}
+	//Split the longest side. The right side of a partition is the
+	//east side of a line pointing north, and the south side of a
+	//line pointing east.
+	GenNode node;
+	if (x1-x0 >= y1-y0) {
+		int xm = (x0+x1)/2;
+		node.x = coordX(xm);
+		node.y = coordY(y0);
+		node.dx = 0;
+		node.dy = coordY(y1)-coordY(y0);
+		node.right = buildNodes(xm, y0, x1, y1);
+		node.left = buildNodes(x0, y0, xm, y1);
+	} else {
+		int ym = (y0+y1)/2;
+		node.x = coordX(x0);
+		node.y = coordY(ym);
+		node.dx = coordX(x1)-coordX(x0);
+		node.dy = 0;
+		node.right = buildNodes(x0, y0, x1, ym);
+		node.left = buildNodes(x0, ym, x1, y1);
+	}
+	//Children come before their parent, so the root is last
+	nodes.push_back(node);
+	result.index = nodes.size()-1;
+	result.subsector = false;
+	return result;
+}
+
+void WadGenerator::addCellSegs(int i, int j)
+{
+	addSeg(vertexIndex(i,j), vertexIndex(i,j+1), vLineIndex(i,j), 0x4000);
+	addSeg(vertexIndex(i,j+1), vertexIndex(i+1,j+1), hLineIndex(i,j+1), 0x0000);
+	addSeg(vertexIndex(i+1,j+1), vertexIndex(i+1,j), vLineIndex(i+1,j), 0xC000);
+	addSeg(vertexIndex(i+1,j), vertexIndex(i,j), hLineIndex(i,j), 0x8000);
+}
+
+void WadGenerator::addSeg(uint32_t v1, uint32_t v2, uint32_t line, uint16_t angle)
+{
+	GenSeg seg;
+	seg.v1 = v1;
+	seg.v2 = v2;
+	seg.line = line;
+	seg.side = (lines[line].v1==v1)? 0: 1;
+	seg.angle = angle;
+	segs.push_back(seg);
+}
+
+vector<Vertex>* WadGenerator::makeVertices()
+{
+	vector<Vertex>* result = new vector<Vertex>();
+	result->reserve((gridSize+1)*(gridSize+1));
+	for (int j=0; j<=gridSize; j++) {
+		for (int i=0; i<=gridSize; i++)
+			result->push_back(Vertex(coordX(i), coordY(j)));
+	}
+	return result;
+}
+
+vector<MapLine>* WadGenerator::makeLines()
+{
+	vector<MapLine>* result = new vector<MapLine>();
+	result->reserve(lines.size());
+	for (size_t i=0; i<lines.size(); i++)
+		result->push_back(MapLine(lines[i].v1, lines[i].v2, lines[i].back>=0));
+	return result;
+}
+
+
+//************************ Map lumps ************************
+
+void WadGenerator::makeMap(const string& name, GenNodeFormat format, vector<GenLump*>& lumps)
+{
+	lumps.push_back(new GenLump(name));
+	lumps.push_back(makeThings());
+	lumps.push_back(makeLinedefs());
+	lumps.push_back(makeSidedefs());
+	lumps.push_back(makeVertexes());
+	switch (format) {
+		case GEN_NODES_DEEP:
+			makeDoomNodes(lumps, true);
+			break;
+		case GEN_NODES_XNOD:
+			lumps.push_back(new GenLump("SEGS"));
+			lumps.push_back(new GenLump("SSECTORS"));
+			lumps.push_back(makeZNodes("NODES", format));
+			break;
+		case GEN_NODES_XGLN:
+		case GEN_NODES_XGL2:
+		case GEN_NODES_XGL3:
+			lumps.push_back(new GenLump("SEGS"));
+			lumps.push_back(makeZNodes("SSECTORS", format));
+			lumps.push_back(new GenLump("NODES"));
+			break;
+		default:
+			//glBSP also writes the original nodes
+			makeDoomNodes(lumps, false);
+	}
+	lumps.push_back(makeSectors());
+	if (format==GEN_NODES_GLV2 || format==GEN_NODES_GLV5)
+		makeGLNodes(name, lumps, format==GEN_NODES_GLV5);
+}
+
+void WadGenerator::makeUdmfMap(const string& name, vector<GenLump*>& lumps)
+{
+	lumps.push_back(new GenLump(name));
+	lumps.push_back(makeTextmap());
+	lumps.push_back(makeZNodes("ZNODES", GEN_NODES_XGLN));
+	lumps.push_back(new GenLump("ENDMAP"));
+}
+
+GenLump* WadGenerator::makeThings()
+{
+	GenLump* lump = new GenLump("THINGS");
+	int cells = gridSize*gridSize;
+	for (int c=0; c<cells; c++) {
+		uint16_t type;
+		if (c == 0)
+			type = 1; //Player 1 start
+		else if (random.chance(25))
+			type = GEN_THINGS[random.range(GEN_THING_TYPES)];
+		else
+			continue;
+		int i = c%gridSize;
+		int j = c/gridSize;
+		put16(lump->data, coordX(i)+cellSize/2);
+		put16(lump->data, coordY(j)+cellSize/2);
+		put16(lump->data, 90*random.range(4));
+		put16(lump->data, type);
+		put16(lump->data, random.chance(10)? 0x0017: 0x0007); //Some multiplayer only
+	}
+	return lump;
+}
+
+GenLump* WadGenerator::makeLinedefs()
+{
+	GenLump* lump = new GenLump("LINEDEFS");
+	uint16_t side = 0;
+	for (size_t i=0; i<lines.size(); i++) {
+		GenLine& line = lines[i];
+		put16(lump->data, line.v1);
+		put16(lump->data, line.v2);
+		put16(lump->data, (line.back<0)? 0x0001: 0x0004); //Impassable or two-sided
+		put16(lump->data, 0); //Special
+		put16(lump->data, 0); //Tag
+		put16(lump->data, side++);
+		if (line.back < 0) {
+			put16(lump->data, 0xFFFF);
+		} else {
+			put16(lump->data, side++);
+		}
+	}
+	return lump;
+}
+
+GenLump* WadGenerator::makeSidedefs()
+{
+	GenLump* lump = new GenLump("SIDEDEFS");
+	for (size_t i=0; i<lines.size(); i++) {
+		GenLine& line = lines[i];
+		for (int s=0; s<2; s++) {
+			int sector = (s==0)? line.front: line.back;
+			if (sector < 0)
+				break;
+			put16(lump->data, 0);
+			put16(lump->data, 0);
+			putName(lump->data, "-");
+			putName(lump->data, "-");
+			putName(lump->data, (line.back<0)? GEN_WALLS[random.range(GEN_TEXTURES)]: "-");
+			put16(lump->data, sector);
+		}
+	}
+	return lump;
+}
+
+GenLump* WadGenerator::makeVertexes()
+{
+	GenLump* lump = new GenLump("VERTEXES");
+	for (int j=0; j<=gridSize; j++) {
+		for (int i=0; i<=gridSize; i++) {
+			put16(lump->data, coordX(i));
+			put16(lump->data, coordY(j));
+		}
+	}
+	return lump;
+}
+
+GenLump* WadGenerator::makeSectors()
+{
+	GenLump* lump = new GenLump("SECTORS");
+	int cells = gridSize*gridSize;
+	for (int c=0; c<cells; c++) {
+		put16(lump->data, 0);
+		put16(lump->data, 128);
+		putName(lump->data, GEN_FLATS[random.range(GEN_TEXTURES)]);
+		putName(lump->data, GEN_FLATS[random.range(GEN_TEXTURES)]);
+		put16(lump->data, 96+16*random.range(10));
+		put16(lump->data, random.chance(2)? 9: 0); //Some secrets
+		put16(lump->data, 0);
+	}
+	return lump;
+}
+
+
+//************************ Node lumps ************************
+
+void WadGenerator::makeDoomNodes(vector<GenLump*>& lumps, bool deep)
+{
+	GenLump* segLump = new GenLump("SEGS");
+	for (size_t i=0; i<segs.size(); i++) {
+		GenSeg& seg = segs[i];
+		if (deep) {
+			put32(segLump->data, seg.v1);
+			put32(segLump->data, seg.v2);
+		} else {
+			put16(segLump->data, seg.v1);
+			put16(segLump->data, seg.v2);
+		}
+		put16(segLump->data, seg.angle);
+		put16(segLump->data, seg.line);
+		put16(segLump->data, seg.side);
+		put16(segLump->data, 0); //Offset, segs cover whole lines
+	}
+	lumps.push_back(segLump);
+
+	GenLump* ssLump = new GenLump("SSECTORS");
+	for (uint32_t i=0; i<subsectors; i++) {
+		put16(ssLump->data, 4);
+		if (deep)
+			put32(ssLump->data, 4*i);
+		else
+			put16(ssLump->data, 4*i);
+	}
+	lumps.push_back(ssLump);
+
+	GenLump* nodeLump = new GenLump("NODES");
+	if (deep)
+		nodeLump->data.AppendData("xNd4\0\0\0\0", 8);
+	for (size_t i=0; i<nodes.size(); i++) {
+		GenNode& node = nodes[i];
+		put16(nodeLump->data, node.x);
+		put16(nodeLump->data, node.y);
+		put16(nodeLump->data, node.dx);
+		put16(nodeLump->data, node.dy);
+		putBox(nodeLump->data, node.right);
+		putBox(nodeLump->data, node.left);
+		if (deep) {
+			put32(nodeLump->data, child32(node.right));
+			put32(nodeLump->data, child32(node.left));
+		} else {
+			put16(nodeLump->data, child16(node.right));
+			put16(nodeLump->data, child16(node.left));
+		}
+	}
+	lumps.push_back(nodeLump);
+}
+
+GenLump* WadGenerator::makeZNodes(const string& lumpName, GenNodeFormat format)
+{
+	GenLump* lump = new GenLump(lumpName);
+	wxMemoryBuffer& buf = lump->data;
+	switch (format) {
+		case GEN_NODES_XGLN: buf.AppendData("XGLN", 4); break;
+		case GEN_NODES_XGL2: buf.AppendData("XGL2", 4); break;
+		case GEN_NODES_XGL3: buf.AppendData("XGL3", 4); break;
+		default: buf.AppendData("XNOD", 4);
+	}
+	bool gl = (format != GEN_NODES_XNOD);
+
+	//All vertices are the map vertices
+	put32(buf, (gridSize+1)*(gridSize+1));
+	put32(buf, 0);
+
+	put32(buf, subsectors);
+	for (uint32_t i=0; i<subsectors; i++)
+		put32(buf, 4);
+
+	put32(buf, segs.size());
+	for (size_t i=0; i<segs.size(); i++) {
+		GenSeg& seg = segs[i];
+		put32(buf, seg.v1);
+		put32(buf, gl? 0xFFFFFFFF: seg.v2); //GL segs have partner seg
+		if (format==GEN_NODES_XGL2 || format==GEN_NODES_XGL3)
+			put32(buf, seg.line);
+		else
+			put16(buf, seg.line);
+		put8(buf, seg.side);
+	}
+
+	put32(buf, nodes.size());
+	for (size_t i=0; i<nodes.size(); i++) {
+		GenNode& node = nodes[i];
+		if (format == GEN_NODES_XGL3) {
+			//16.16 fixed point, fraction first
+			put16(buf, 0); put16(buf, node.x);
+			put16(buf, 0); put16(buf, node.y);
+			put16(buf, 0); put16(buf, node.dx);
+			put16(buf, 0); put16(buf, node.dy);
+		} else {
+			put16(buf, node.x);
+			put16(buf, node.y);
+			put16(buf, node.dx);
+			put16(buf, node.dy);
+		}
+		putBox(buf, node.right);
+		putBox(buf, node.left);
+		put32(buf, child32(node.right));
+		put32(buf, child32(node.left));
+	}
+	return lump;
+}
+
+void WadGenerator::makeGLNodes(const string& mapName, vector<GenLump*>& lumps, bool v5)
+{
+	lumps.push_back(new GenLump("GL_"+mapName.substr(0,5)));
+
+	//No extra vertices, the segs only use the map vertices
+	GenLump* vertLump = new GenLump("GL_VERT");
+	vertLump->data.AppendData(v5? "gNd5": "gNd2", 4);
+	lumps.push_back(vertLump);
+
+	GenLump* segLump = new GenLump("GL_SEGS");
+	for (size_t i=0; i<segs.size(); i++) {
+		GenSeg& seg = segs[i];
+		if (v5) {
+			put32(segLump->data, seg.v1);
+			put32(segLump->data, seg.v2);
+			put16(segLump->data, seg.line);
+			put16(segLump->data, seg.side);
+			put32(segLump->data, 0xFFFFFFFF);
+		} else {
+			put16(segLump->data, seg.v1);
+			put16(segLump->data, seg.v2);
+			put16(segLump->data, seg.line);
+			put16(segLump->data, seg.side);
+			put16(segLump->data, 0xFFFF);
+		}
+	}
+	lumps.push_back(segLump);
+
+	GenLump* ssLump = new GenLump("GL_SSECT");
+	for (uint32_t i=0; i<subsectors; i++) {
+		if (v5) {
+			put32(ssLump->data, 4);
+			put32(ssLump->data, 4*i);
+		} else {
+			put16(ssLump->data, 4);
+			put16(ssLump->data, 4*i);
+		}
+	}
+	lumps.push_back(ssLump);
+
+	GenLump* nodeLump = new GenLump("GL_NODES");
+	for (size_t i=0; i<nodes.size(); i++) {
+		GenNode& node = nodes[i];
+		put16(nodeLump->data, node.x);
+		put16(nodeLump->data, node.y);
+		put16(nodeLump->data, node.dx);
+		put16(nodeLump->data, node.dy);
+		putBox(nodeLump->data, node.right);
+		putBox(nodeLump->data, node.left);
+		if (v5) {
+			put32(nodeLump->data, child32(node.right));
+			put32(nodeLump->data, child32(node.left));
+		} else {
+			put16(nodeLump->data, child16(node.right));
+			put16(nodeLump->data, child16(node.left));
+		}
+	}
+	lumps.push_back(nodeLump);
+}
+
+GenLump* WadGenerator::makeTextmap()
+{
+	//One key per line, as written by the map editors
+	wxString text;
+	text.Alloc(200*lines.size());
+	text << "namespace = \"zdoom\";\n\n";
+
+	int cells = gridSize*gridSize;
+	for (int c=0; c<cells; c++) {
+		int type;
+		if (c == 0)
+			type = 1;
+		else if (random.chance(25))
+			type = GEN_THINGS[random.range(GEN_THING_TYPES)];
+		else
+			continue;
+		text << "thing\n{\n";
+		text << wxString::Format("x = %i.000;\ny = %i.000;\n",
+			coordX(c%gridSize)+cellSize/2, coordY(c/gridSize)+cellSize/2);
+		text << wxString::Format("angle = %i;\ntype = %i;\n", 90*random.range(4), type);
+		text << "skill1 = true;\nskill2 = true;\nskill3 = true;\nskill4 = true;\nskill5 = true;\n";
+		if (!random.chance(10))
+			text << "single = true;\n";
+		text << "coop = true;\ndm = true;\n}\n\n";
+	}
+
+	for (int j=0; j<=gridSize; j++) {
+		for (int i=0; i<=gridSize; i++)
+			text << wxString::Format("vertex\n{\nx = %i.000;\ny = %i.000;\n}\n\n", coordX(i), coordY(j));
+	}
+
+	int side = 0;
+	for (size_t i=0; i<lines.size(); i++) {
+		GenLine& line = lines[i];
+		text << wxString::Format("linedef\n{\nv1 = %i;\nv2 = %i;\nsidefront = %i;\n", line.v1, line.v2, side++);
+		if (line.back < 0)
+			text << "blocking = true;\n";
+		else
+			text << wxString::Format("sideback = %i;\ntwosided = true;\n", side++);
+		text << "}\n\n";
+	}
+
+	for (size_t i=0; i<lines.size(); i++) {
+		GenLine& line = lines[i];
+		text << wxString::Format("sidedef\n{\nsector = %i;\n", line.front);
+		if (line.back < 0)
+			text << "texturemiddle = \"" << GEN_WALLS[random.range(GEN_TEXTURES)] << "\";\n";
+		text << "}\n\n";
+		if (line.back >= 0)
+			text << wxString::Format("sidedef\n{\nsector = %i;\n}\n\n", line.back);
+	}
+
+	for (int c=0; c<cells; c++) {
+		text << "sector\n{\n";
+		text << "texturefloor = \"" << GEN_FLATS[random.range(GEN_TEXTURES)] << "\";\n";
+		text << "textureceiling = \"" << GEN_FLATS[random.range(GEN_TEXTURES)] << "\";\n";
+		text << wxString::Format("heightceiling = 128;\nlightlevel = %i;\n", 96+16*random.range(10));
+		if (random.chance(2))
+			text << "special = 1024;\n"; //Secret flag
+		text << "}\n\n";
+	}
+
+	GenLump* lump = new GenLump("TEXTMAP");
+	wxScopedCharBuffer utf = text.utf8_str();
+	lump->data.AppendData(utf.data(), utf.length());
+	return lump;
+}
+
+
+//************************ Files ************************
+
+void WadGenerator::packLumps(vector<GenLump*>& lumps, wxMemoryBuffer& out, vector<DirEntry*>& dir, int32_t base)
+{
+	for (size_t i=0; i<lumps.size(); i++) {
+		DirEntry* de = new DirEntry(lumps[i]->name);
+		de->offset = base + out.GetDataLen();
+		de->size = lumps[i]->data.GetDataLen();
+		out.AppendData(lumps[i]->data.GetData(), de->size);
+		dir.push_back(de);
+		delete lumps[i];
+	}
+	lumps.clear();
+}
+
+size_t WadGenerator::writeWad(wxString fileName, int maps, GenNodeFormat format, bool udmf)
+{
+	if (maps > 99)
+		maps = 99;
+	vector<GenLump*> lumps;
+	for (int i=1; i<=maps; i++) {
+		string name = wxString::Format("MAP%02i", i).ToStdString();
+		if (udmf)
+			makeUdmfMap(name, lumps);
+		else
+			makeMap(name, format, lumps);
+	}
+	return writeLumps(fileName, lumps);
+}
+
+size_t WadGenerator::writeLumps(wxString fileName, vector<GenLump*>& lumps)
+{
+	wxMemoryBuffer body;
+	vector<DirEntry*> dir;
+	packLumps(lumps, body, dir, 12);
+
+	wxFile file;
+	if (!file.Create(fileName, true)) {
+		for (size_t i=0; i<dir.size(); i++)
+			delete dir[i];
+		return 0;
+	}
+	int32_t numLumps = dir.size();
+	int32_t dirOffset = 12 + body.GetDataLen();
+	file.Write("PWAD", 4);
+	file.Write(&numLumps, 4);
+	file.Write(&dirOffset, 4);
+	file.Write(body.GetData(), body.GetDataLen());
+	for (size_t i=0; i<dir.size(); i++) {
+		char name[8];
+		memset(name, 0, 8);
+		strncpy(name, dir[i]->name.c_str(), 8);
+		file.Write(&dir[i]->offset, 4);
+		file.Write(&dir[i]->size, 4);
+		file.Write(name, 8);
+		delete dir[i];
+	}
+	size_t size = file.Length();
+	file.Close();
+	return size;
+}
+
+//Lumps of each kind in a block of a resource wad, adding up to 1000
+const int RES_SPRITES = 400;
+const int RES_PATCHES = 340;
+const int RES_FLATS = 25;
+const int RES_SOUNDS = 60;
+const int RES_MUSIC = 10;
+const int RES_GL = 10; //Sets of four GL_* lumps
+const int RES_DATA = 114;
+const char* RES_GL_LUMPS[] = {"GL_VERT", "GL_SEGS", "GL_SSECT", "GL_NODES"};
+
+size_t WadGenerator::writeResourceWad(wxString fileName, int lumpCount)
+{
+	memset(resourceCounts, 0, sizeof(resourceCounts));
+	int blocks = (lumpCount+500)/1000;
+	if (blocks < 1)
+		blocks = 1;
+	vector<GenLump*> lumps;
+	for (int b=0; b<blocks; b++) {
+		lumps.push_back(new GenLump("S_START"));
+		for (int i=0; i<RES_SPRITES; i++)
+			lumps.push_back(makePicture(spriteName(resourceCounts[WSPRITE]++), 8+random.range(9), 16));
+		lumps.push_back(new GenLump("S_END"));
+
+		lumps.push_back(new GenLump("P_START"));
+		for (int i=0; i<RES_PATCHES; i++) {
+			string name = wxString::Format("PT%06i", resourceCounts[WPATCH]++).ToStdString();
+			lumps.push_back(makePicture(name, 16, 8+random.range(9)));
+		}
+		lumps.push_back(new GenLump("P_END"));
+
+		lumps.push_back(new GenLump("F_START"));
+		for (int i=0; i<RES_FLATS; i++) {
+			string name = wxString::Format("FL%06i", resourceCounts[WFLAT]++).ToStdString();
+			lumps.push_back(makeData(name, 4096));
+		}
+		lumps.push_back(new GenLump("F_END"));
+
+		for (int i=0; i<RES_SOUNDS; i++) {
+			//Format 3, 11025 Hz, samples with 16 bytes of padding each side
+			GenLump* lump = new GenLump(wxString::Format("DS%06i", resourceCounts[WSFX]++).ToStdString());
+			int samples = 64+random.range(64);
+			put16(lump->data, 3);
+			put16(lump->data, 11025);
+			put32(lump->data, samples+32);
+			for (int s=0; s<samples+32; s++)
+				put8(lump->data, 128+random.range(32)-16);
+			lumps.push_back(lump);
+		}
+		for (int i=0; i<RES_MUSIC; i++) {
+			GenLump* lump = new GenLump(wxString::Format("D_%06i", resourceCounts[WMUS]++).ToStdString());
+			lump->data.AppendData("MUS\x1A", 4);
+			put16(lump->data, 32); //Score length
+			put16(lump->data, 16); //Score start
+			for (int s=0; s<40; s++)
+				put8(lump->data, random.next());
+			lumps.push_back(lump);
+		}
+		for (int i=0; i<RES_GL; i++) {
+			for (int g=0; g<4; g++)
+				lumps.push_back(makeData(RES_GL_LUMPS[g], 32+random.range(128)));
+		}
+
+		//Named lumps, then data the signatures don't match
+		lumps.push_back(makeData("PLAYPAL", 768*14));
+		lumps.push_back(makeData("COLORMAP", 256*34));
+		lumps.push_back(makeData("ENDOOM", 4000));
+		GenLump* text = new GenLump("SNDINFO");
+		text->data.AppendData("// Generated\n", 13);
+		lumps.push_back(text);
+		text = new GenLump("DEHACKED");
+		text->data.AppendData("Patch File for DeHackEd v3.0\n", 29);
+		lumps.push_back(text);
+		for (int i=0; i<RES_DATA-5; i++)
+			lumps.push_back(makeData(wxString::Format("XD%02X%04X", b%256, i).ToStdString(), 16+random.range(112)));
+	}
+	return writeLumps(fileName, lumps);
+}
+
+int WadGenerator::getResourceCount(WadContentType type)
+{
+	return resourceCounts[type];
+}
+
+GenLump* WadGenerator::makePicture(const string& name, int width, int height)
+{
+	GenLump* lump = new GenLump(name);
+	put16(lump->data, width);
+	put16(lump->data, height);
+	put16(lump->data, width/2); //Offsets
+	put16(lump->data, height-4);
+	//Each column is a post of all pixels: top, length, pad, pixels, pad, end
+	uint32_t column = 8 + 4*width;
+	for (int i=0; i<width; i++)
+		put32(lump->data, column + i*(height+5));
+	for (int i=0; i<width; i++) {
+		put8(lump->data, 0);
+		put8(lump->data, height);
+		put8(lump->data, 0);
+		for (int j=0; j<height; j++)
+			put8(lump->data, random.next());
+		put8(lump->data, 0);
+		put8(lump->data, 0xFF);
+	}
+	return lump;
+}
+
+GenLump* WadGenerator::makeData(const string& name, int size)
+{
+	GenLump* lump = new GenLump(name);
+	for (int i=0; i<size; i+=4)
+		put32(lump->data, random.next());
+	lump->data.SetDataLen(size);
+	//A negative first word, so it's not taken for a picture or sound
+	((unsigned char*)lump->data.GetData())[1] = 0x80;
+	return lump;
+}
+
+string WadGenerator::spriteName(int n)
+{
+	//Eight frames of each sprite
+	char name[7];
+	int prefix = n/8;
+	for (int i=3; i>=0; i--) {
+		name[i] = 'A' + prefix%26;
+		prefix /= 26;
+	}
+	name[4] = 'A' + n%8;
+	name[5] = '0';
+	name[6] = 0;
+	return string(name);
+}
+
+size_t WadGenerator::writePk3(wxString fileName, int maps, GenNodeFormat format)
+{
+	wxString tempWad = fileName+".tmp";
+	{
+		wxFFileOutputStream out(fileName);
+		if (!out.IsOk())
+			return 0;
+		wxZipOutputStream zip(out);
+		zip.PutNextEntry("credits.txt");
+		wxString credits("Generated for DMDB benchmarks. One wad in maps for each map.\n");
+		wxScopedCharBuffer utf = credits.utf8_str();
+		zip.Write(utf.data(), utf.length());
+		for (int i=1; i<=maps; i++) {
+			//Each map wad is written to a file, then copied into the zip
+			if (writeWad(tempWad, 1, format) == 0)
+				return 0;
+			wxFFileInputStream in(tempWad);
+			zip.PutNextEntry(wxString::Format("maps/MAP%02i.wad", i));
+			zip.Write(in);
+		}
+		zip.Close();
+	}
+	wxRemoveFile(tempWad);
+	return wxFileName::GetSize(fileName).GetLo();
+}
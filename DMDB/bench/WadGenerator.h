@@ -0,0 +1,268 @@
+/*!
+* \file WadGenerator.h
+* \author Lars Thomas Boye 2020
+*
+* WadGenerator writes synthetic wad and pk3 files for the benchmarks.
+* Everything is made from a seeded pseudo-random generator, so the same
+* seed and sizes always give the same bytes, and results can be compared
+* between builds.
+*
+* The map geometry is a square grid of square cells, each cell a sector.
+* Lines between cells are two-sided, and the outer lines one-sided. The
+* node tree splits the grid in half on the longest side until each cell
+* is a sub-sector with four segs, so the map area computed from the nodes
+* is known exactly. Nodes can be written in each of the formats NodeStats
+* reads uncompressed, and the map itself in Doom format or as an UDMF
+* TEXTMAP with ZDoom GL nodes in ZNODES.
+*
+* Resource wads have no maps, but a large number of small lumps of the
+* kinds WadStats categorizes: sprites, patches and flats between their
+* markers, sounds, music, GL node lumps and other named lumps.
+*/
+
+#ifndef WADGENERATOR_H
+#define WADGENERATOR_H
+
+#include "../data/CoreBase.h"
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include <wx/buffer.h>
+#include "../data/WadStats.h"
+#include "../data/NodeStats.h"
+
+/*!
+* Node formats the WadGenerator can write, with the lumps they use.
+*/
+enum GenNodeFormat {
+	GEN_NODES_DOOM, //!< SEGS, SSECTORS and NODES of the original games
+	GEN_NODES_DEEP, //!< DeePBSP, "xNd4" in NODES
+	GEN_NODES_XNOD, //!< ZDoom extended nodes in NODES
+	GEN_NODES_XGLN, //!< ZDoom GL nodes in SSECTORS
+	GEN_NODES_XGL2, //!< ZDoom GL nodes with 32-bit line numbers
+	GEN_NODES_XGL3, //!< ZDoom GL nodes with fixed-point partitions
+	GEN_NODES_GLV2, //!< glBSP v2, GL_* lumps after the map
+	GEN_NODES_GLV5, //!< glBSP v5, GL_* lumps after the map
+	GEN_NODES_END
+};
+
+/*! Short name of a node format, as used in benchmark names. */
+wxString getGenNodeName(GenNodeFormat format);
+
+/*!
+* Small xorshift generator. We don't use rand, as its sequence
+* differs between platforms.
+*/
+class GenRandom
+{
+	public:
+		GenRandom(uint32_t seed) : state((seed==0)? 0x9E3779B9: seed) {}
+
+		/*! Next 32-bit number. */
+		uint32_t next() { state^=state<<13; state^=state>>17; state^=state<<5; return state; }
+
+		/*! Number from 0 to n-1. */
+		int range(int n) { return (n<=1)? 0: next()%n; }
+
+		/*! true with the given probability. */
+		bool chance(int percent) { return range(100) < percent; }
+
+	private:
+		uint32_t state;
+};
+
+/*!
+* A lump made by the WadGenerator, before it is written to a file.
+*/
+struct GenLump
+{
+	string name;
+	wxMemoryBuffer data;
+
+	GenLump(string nam) : name(nam) {}
+};
+
+/*!
+* A child reference in the node tree, to a node or a sub-sector.
+*/
+struct GenChild
+{
+	uint32_t index;
+	bool subsector;
+	int16_t box[4]; //top, bottom, left, right
+};
+
+/*!
+* A node of the grid BSP, in a form which can be written in any format.
+*/
+struct GenNode
+{
+	int16_t x, y, dx, dy;
+	GenChild right, left;
+};
+
+/*!
+* A seg of the grid BSP. Segs of a sub-sector are consecutive.
+*/
+struct GenSeg
+{
+	uint32_t v1, v2;
+	uint32_t line;
+	uint16_t side; //0=front of line, 1=back
+	uint16_t angle; //BAM
+};
+
+/*!
+* A map line of the grid, with the sectors on each side.
+*/
+struct GenLine
+{
+	uint32_t v1, v2;
+	int front, back; //Sector index, -1 for none
+};
+
+/*!
+* Writes deterministic synthetic content files. Set the map size,
+* then write wads or pk3s. The same object can write several files,
+* continuing its random sequence.
+*/
+class WadGenerator
+{
+	public:
+		/*! The seed decides the things, sectors and textures of the maps. */
+		WadGenerator(uint32_t seed);
+
+		virtual ~WadGenerator() {}
+
+		/*!
+		* Set the approximate number of linedefs per map. The grid is made
+		* as close to this as possible, with at least 2x2 cells. Doom format
+		* maps have 16-bit sidedef numbers, limiting them to about 32000
+		* lines, while UDMF maps can be as large as the coordinate range
+		* allows for cells of at least 8 units.
+		*/
+		void setMapSize(int linedefs, bool udmf=false);
+
+		/*! Linedefs of each map with the current size. */
+		uint32_t getLinedefs() { return lines.size(); }
+
+		/*! Sub-sectors (cells) of each map with the current size. */
+		uint32_t getSubsectors() { return gridSize*gridSize; }
+
+		/*! The area NodeStats should compute for each map. */
+		double getMapArea() { return (double)getSubsectors()*cellSize*cellSize; }
+
+		/*! Box around all vertices, with a margin of 1 like MapStats uses. */
+		void getBounds(Vector2D& minXY, Vector2D& maxXY);
+
+		/*!
+		* Makes the lumps of a Doom format map, starting with the marker.
+		* GL node formats add their lumps after the map lumps.
+		*/
+		void makeMap(const string& name, GenNodeFormat format, vector<GenLump*>& lumps);
+
+		/*! Makes the lumps of an UDMF map, with XGLN nodes in ZNODES. */
+		void makeUdmfMap(const string& name, vector<GenLump*>& lumps);
+
+		/*!
+		* Lays out the lumps one after another in a buffer, creating a
+		* directory entry for each with offsets starting at base. The
+		* lumps are deleted.
+		*/
+		static void packLumps(vector<GenLump*>& lumps, wxMemoryBuffer& out, vector<DirEntry*>& dir, int32_t base);
+
+		/*!
+		* Writes a wad with the given number of maps, named MAP01 and up
+		* (at most 99). Returns the file size, or 0 if it couldn't be written.
+		*/
+		size_t writeWad(wxString fileName, int maps, GenNodeFormat format, bool udmf=false);
+
+		/*!
+		* Writes a resource wad with about the given number of lumps, in
+		* blocks of 1000 like a large mod: sprites, patches and flats with
+		* their markers, sounds, music, GL node lumps, named lumps like
+		* PLAYPAL and unknown data. Returns the file size, or 0 if it
+		* couldn't be written.
+		*/
+		size_t writeResourceWad(wxString fileName, int lumpCount);
+
+		/*!
+		* Number of lumps of the type in the last resource wad, as
+		* WadStats should count them: WSPRITE, WPATCH, WFLAT, WSFX and
+		* WMUS. 0 for other types.
+		*/
+		int getResourceCount(WadContentType type);
+
+		/*!
+		* Writes a pk3 with one wad for each map in the maps folder, like
+		* ZDoom mods do, and a text file. Returns the file size, or 0 if it
+		* couldn't be written.
+		*/
+		size_t writePk3(wxString fileName, int maps, GenNodeFormat format);
+
+		/*!
+		* The vertices and lines of the map as MapStats reads them, for
+		* using NodeStats directly. The caller deletes them.
+		*/
+		vector<Vertex>* makeVertices();
+		vector<MapLine>* makeLines();
+
+	private:
+		/*! Writes the lumps as a PWAD, deleting them. Returns the file size or 0. */
+		size_t writeLumps(wxString fileName, vector<GenLump*>& lumps);
+
+		/*! A Doom picture of width*height random pixels, one post per column. */
+		GenLump* makePicture(const string& name, int width, int height);
+
+		/*! A lump of random bytes, at least 2, not matching the sound and picture heuristics. */
+		GenLump* makeData(const string& name, int size);
+
+		/*! Name of sprite number n: Four letters, frame letter and rotation 0. */
+		static string spriteName(int n);
+
+		/*! Makes the grid lines and node tree for the current size. */
+		void makeGrid();
+
+		/*! Builds the node tree for a block of cells, returning the child reference. */
+		GenChild buildNodes(int x0, int y0, int x1, int y1);
+
+		/*! Adds the segs of the cell, clockwise. */
+		void addCellSegs(int i, int j);
+
+		/*! Adds a seg along a line, finding the side from the vertex order. */
+		void addSeg(uint32_t v1, uint32_t v2, uint32_t line, uint16_t angle);
+
+		//Grid coordinates
+		uint32_t vertexIndex(int i, int j) { return j*(gridSize+1)+i; }
+		uint32_t hLineIndex(int i, int j) { return j*gridSize+i; }
+		uint32_t vLineIndex(int i, int j) { return gridSize*(gridSize+1) + j*(gridSize+1)+i; }
+		int16_t coordX(int i) { return origin + i*cellSize; }
+		int16_t coordY(int j) { return origin + j*cellSize; }
+
+		//Doom format map lumps
+		GenLump* makeThings();
+		GenLump* makeLinedefs();
+		GenLump* makeSidedefs();
+		GenLump* makeVertexes();
+		GenLump* makeSectors();
+
+		//Node lumps
+		void makeDoomNodes(vector<GenLump*>& lumps, bool deep);
+		GenLump* makeZNodes(const string& lumpName, GenNodeFormat format);
+		void makeGLNodes(const string& mapName, vector<GenLump*>& lumps, bool v5);
+
+		/*! The UDMF TEXTMAP lump. */
+		GenLump* makeTextmap();
+
+		GenRandom random;
+		int gridSize; //Cells on each side
+		int cellSize; //Map units
+		int16_t origin; //Coordinate of the grid corner, on both axes
+		vector<GenLine> lines;
+		vector<GenSeg> segs;
+		vector<GenNode> nodes;
+		uint32_t subsectors; //While building nodes
+		int resourceCounts[WEND]; //Of the last resource wad
+};
+
+#endif // WADGENERATOR_H
@@ -0,0 +1,48 @@
+/*!
+* \file CoreBase.h
+* \author Lars Thomas Boye 2020
+*
+* CoreBase contains the basic definitions used by the data classes, which
+* must not depend on any gui classes. This makes it possible to build the
+* data classes as a library, used both by the GUI application and by the
+* command-line tool. GuiBase includes this file, so the gui classes see
+* the same definitions.
+*
+* There is the exception struct thrown by the data classes on file and
+* format errors, and the ids of the events posted by worker threads.
+*/
+
+#ifndef COREBASE_H
+#define COREBASE_H
+
+using namespace std;
+
+//Include wxWidgets headers:
+#include "wx/wxprec.h"
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+//Log name
+#define wxLOG_COMPONENT "dmdb"
+
+/*!
+* An error class to throw as exceptions, with two strings to hold information
+* on the error that can be shown in a dialog. Despite the name, it is thrown
+* by the data classes, and caught by the GUI or command-line tool.
+*/
+struct GuiError
+{
+	wxString text1, text2;
+	GuiError(wxString s1, wxString s2 = "") { text1=s1; text2=s2; }
+};
+
+//Ids of wxThreadEvents posted by worker threads:
+//(in the range of the other event ids in GuiBase.h)
+const int THREAD_TASKSTATUS = 206; //!< Task name/progress from worker thread
+const int THREAD_TASKLOG = 207; //!< Task log line from worker thread
+const int THREAD_WADENTRY = 208; //!< WadEntry created by worker thread
+const int THREAD_WADDONE = 209; //!< Worker thread finished
+const int THREAD_MAPSLOADED = 212; //!< Maps read by background load job
+
+#endif // COREBASE_H
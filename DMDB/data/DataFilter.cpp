@@ -1,11 +1,57 @@
 #include "DataFilter.h"
+#include "SortKeys.h"
 
 
 DataFilter::DataFilter(unsigned char t)
-: type(t), name(""), isChanged(false), sortField(MAP_END), sortReverse(false)
+: type(t), name(""), isChanged(false), sortField(MAP_END), sortReverse(false), thenSort()
 {
 }
 
+void DataFilter::setSort(WadMapFields field, bool reverse)
+{
+	if (field != sortField)
+		thenSort.clear();
+	sortField = field;
+	sortReverse = reverse;
+}
+
+bool DataFilter::addSort(WadMapFields field, bool reverse)
+{
+	int index = getSortIndex(field);
+	if (index == 0 || sortField == MAP_END) {
+		sortField = field;
+		sortReverse = reverse;
+	} else if (index > 0) {
+		thenSort[index-1].reverse = reverse;
+	} else if (thenSort.size()+1 < SORT_MAX_KEYS) {
+		SortKey key;
+		key.field = field;
+		key.reverse = reverse;
+		thenSort.push_back(key);
+	} else {
+		return false;
+	}
+	return true;
+}
+
+int DataFilter::getSortIndex(WadMapFields field)
+{
+	if (field == sortField)
+		return 0;
+	for (unsigned int i=0; i<thenSort.size(); i++) {
+		if (thenSort[i].field == field)
+			return i+1;
+	}
+	return -1;
+}
+
+void DataFilter::copySort(DataFilter* other)
+{
+	sortField = other->sortField;
+	sortReverse = other->sortReverse;
+	thenSort = other->thenSort;
+}
+
 //*****************************************************************
 //************************ ComboDataFilter ************************
 //*****************************************************************
@@ -62,6 +108,12 @@ bool ComboDataFilter::includes(MapEntry* me)
 	return true;
 }
 
+void ComboDataFilter::getRanges(vector<FieldRange>& ranges)
+{
+	for (size_t i=0; i<filters.size(); i++)
+		filters[i]->getRanges(ranges);
+}
+
 bool ComboDataFilter::hasChanges()
 {
 	if (isChanged) return true;
@@ -102,6 +154,11 @@ bool DataIdFilter::includes(MapEntry* me)
 	else return (me->dbid == val);
 }
 
+void DataIdFilter::getRanges(vector<FieldRange>& ranges)
+{
+	ranges.push_back(FieldRange((type<FILTER_MAP)? WAD_DBID: MAP_DBID, op, val));
+}
+
 //****************************************************************
 //************************ FileSizeFilter ************************
 //****************************************************************
@@ -125,6 +182,11 @@ bool FileSizeFilter::includes(MapEntry* me)
 	else return (me->wadPointer->fileSize == val);
 }
 
+void FileSizeFilter::getRanges(vector<FieldRange>& ranges)
+{
+	ranges.push_back(FieldRange(WAD_FILESIZE, op, val));
+}
+
 //******************************************************************
 //************************ ExtraFilesFilter ************************
 //******************************************************************
@@ -167,6 +229,11 @@ bool YearFilter::includes(MapEntry* me)
 	else return (me->wadPointer->year < val);
 }
 
+void YearFilter::getRanges(vector<FieldRange>& ranges)
+{
+	ranges.push_back(FieldRange(WAD_YEAR, op, val));
+}
+
 //************************************************************
 //************************ IwadFilter ************************
 //************************************************************
@@ -259,6 +326,11 @@ bool MapCountFilter::includes(MapEntry* me)
 	else return (me->wadPointer->numberOfMaps < val);
 }
 
+void MapCountFilter::getRanges(vector<FieldRange>& ranges)
+{
+	ranges.push_back(FieldRange(WAD_MAPS, op, val));
+}
+
 //*****************************************************************
 //************************ WadFlagsFilter ************************
 //*****************************************************************
@@ -320,6 +392,11 @@ bool RatingFilter::includes(MapEntry* me)
 	else return (me->rating == val);
 }
 
+void RatingFilter::getRanges(vector<FieldRange>& ranges)
+{
+	ranges.push_back(FieldRange((type<FILTER_MAP)? WAD_RATING: MAP_RATING, op, val));
+}
+
 //*****************************************************************
 //************************ OwnRatingFilter ************************
 //*****************************************************************
@@ -343,6 +420,11 @@ bool OwnRatingFilter::includes(MapEntry* me)
 	else return (me->ownRating == val);
 }
 
+void OwnRatingFilter::getRanges(vector<FieldRange>& ranges)
+{
+	ranges.push_back(FieldRange((type<FILTER_MAP)? WAD_OWNRATING: MAP_OWNRATING, op, val));
+}
+
 //****************************************************************
 //************************ OwnFlagsFilter ************************
 //****************************************************************
@@ -386,22 +468,26 @@ bool OwnFlagsInvFilter::includes(MapEntry* me)
 //*******************************************************************
 
 TitleSearchFilter::TitleSearchFilter(unsigned char t, wxString str)
-: DataFilter(t), searchStr(str)
+: DataFilter(t)
 {
-	searchStr.Lower();
+	setSearch(str);
+}
+
+void TitleSearchFilter::setSearch(const wxString& str)
+{
+	searchStr = str;
+	searchKey = ColumnKeys::textKey(str);
 }
 
 bool TitleSearchFilter::includes(WadEntry* we)
 {
-	wxString str1(we->title);
-	if (str1.Lower().Find(searchStr) != wxNOT_FOUND) return true;
+	if (we->title.folded().find(searchKey) != string::npos) return true;
 	else return false;
 }
 
 bool TitleSearchFilter::includes(MapEntry* me)
 {
-	wxString str1(me->title);
-	if (str1.Lower().Find(searchStr) != wxNOT_FOUND) return true;
+	if (me->title.folded().find(searchKey) != string::npos) return true;
 	else return true;
 }
 
@@ -410,30 +496,34 @@ bool TitleSearchFilter::includes(MapEntry* me)
 //******************************************************************
 
 TextSearchFilter::TextSearchFilter(unsigned char t, wxString str)
-: DataFilter(t), searchStr(str)
+: DataFilter(t)
+{
+	setSearch(str);
+}
+
+void TextSearchFilter::setSearch(const wxString& str)
 {
-	searchStr.Lower();
+	searchStr = str;
+	searchLower = str.Lower();
+	searchKey = ColumnKeys::textKey(str);
 }
 
 bool TextSearchFilter::includes(WadEntry* we)
 {
-	wxString str1(we->title);
-	if (str1.Lower().Find(searchStr) != wxNOT_FOUND) return true;
-	wxString str2(we->fileName);
-	if (str2.Lower().Find(searchStr) != wxNOT_FOUND) return true;
+	//The folded strings are made once per distinct string, in the StringPool
+	if (we->title.folded().find(searchKey) != string::npos) return true;
+	if (we->fileName.folded().find(searchKey) != string::npos) return true;
 	return false;
 }
 
 bool TextSearchFilter::includes(MapEntry* me)
 {
-	wxString str1(me->title);
-	if (str1.Lower().Find(searchStr) != wxNOT_FOUND) return true;
-	wxString str2(me->name);
-	if (str2.Lower().Find(searchStr) != wxNOT_FOUND) return true;
+	if (me->title.folded().find(searchKey) != string::npos) return true;
+	if (me->name.folded().find(searchKey) != string::npos) return true;
 	if (me->author1 != NULL)
-		if (me->author1->findLowerCase(searchStr)) return true;
+		if (me->author1->findLowerCase(searchLower)) return true;
 	if (me->author2 != NULL)
-		if (me->author2->findLowerCase(searchStr)) return true;
+		if (me->author2->findLowerCase(searchLower)) return true;
 	return includes(me->wadPointer);
 }
 
@@ -566,6 +656,12 @@ bool AreaFilter::includes(MapEntry* me)
 	else return (me->area == val);
 }
 
+void AreaFilter::getRanges(vector<FieldRange>& ranges)
+{
+	if (type >= FILTER_MAP)
+		ranges.push_back(FieldRange(MAP_AREA, op, val));
+}
+
 //***********************************************************
 //************************ TagFilter ************************
 //***********************************************************
@@ -629,6 +725,12 @@ bool DifficultyFilter::includes(MapEntry* me)
 	else return (me->difficulty < val);
 }
 
+void DifficultyFilter::getRanges(vector<FieldRange>& ranges)
+{
+	if (type >= FILTER_MAP)
+		ranges.push_back(FieldRange(MAP_DIFFICULTY, op, val));
+}
+
 //****************************************************************
 //************************ PlayTimeFilter ************************
 //****************************************************************
@@ -645,13 +747,19 @@ bool PlayTimeFilter::includes(MapEntry* me)
 	else return (me->playTime == val);
 }
 
+void PlayTimeFilter::getRanges(vector<FieldRange>& ranges)
+{
+	if (type >= FILTER_MAP)
+		ranges.push_back(FieldRange(MAP_PLAYTIME, op, val));
+}
+
 //****************************************************************
 //************************ DataListFilter ************************
 //****************************************************************
 
 DataListFilter::DataListFilter(unsigned char t) : DataFilter(t)
 {
-	entries = new list<uint32_t>();
+	entries = new IdBitmap();
 }
 
 DataListFilter::~DataListFilter()
@@ -659,59 +767,51 @@ DataListFilter::~DataListFilter()
 	delete entries;
 }
 
-bool DataListFilter::hasFilter()
-{
-	//This is called before calling includes on each entry
-	//in a list, so we initiate the iterator here.
-	searchIter = entries->begin();
-	return true;
-}
-
 bool DataListFilter::includes(WadEntry* we)
 {
-	if (entries->size()==0 || (we->dbid > entries->back()))
-		return false;
-	while (searchIter!=entries->end() && (*searchIter)<=we->dbid ) {
-		if ( (*searchIter) == we->dbid )
-			return true;
-		searchIter++;
-	}
-	return false;
+	return entries->contains(we->dbid);
 }
 
 bool DataListFilter::includes(MapEntry* me)
 {
-	if (entries->size()==0 || (me->dbid > entries->back()))
-		return false;
-	while (searchIter!=entries->end() && (*searchIter)<=me->dbid ) {
-		if ( (*searchIter) == me->dbid )
-			return true;
-		searchIter++;
-	}
-	return false;
+	return entries->contains(me->dbid);
 }
 
 void DataListFilter::addEntry(uint32_t id)
 {
-	for (list<uint32_t>::iterator it=entries->begin(); it != entries->end(); ++it) {
-		if ((*it) == id)
-			return;
-	}
-	entries->push_back(id);
-	entries->sort();
-	isChanged = true;
+	if (entries->add(id))
+		isChanged = true;
 }
 
 bool DataListFilter::removeEntry(uint32_t id)
 {
-	list<uint32_t>::iterator it = entries->begin();
-	while (it!=entries->end() && (*it)<=id ) {
-		if ((*it) == id) {
-			it = entries->erase(it);
-			isChanged = true;
-			return true;
-		}
-		it++;
+	if (entries->remove(id)) {
+		isChanged = true;
+		return true;
 	}
 	return false;
 }
+
+void DataListFilter::addAll(DataListFilter* other)
+{
+	uint32_t before = entries->count();
+	entries->unite(*(other->entries));
+	if (entries->count() != before)
+		isChanged = true;
+}
+
+void DataListFilter::retainAll(DataListFilter* other)
+{
+	uint32_t before = entries->count();
+	entries->intersect(*(other->entries));
+	if (entries->count() != before)
+		isChanged = true;
+}
+
+void DataListFilter::removeAll(DataListFilter* other)
+{
+	uint32_t before = entries->count();
+	entries->subtract(*(other->entries));
+	if (entries->count() != before)
+		isChanged = true;
+}
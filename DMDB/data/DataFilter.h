@@ -30,12 +30,26 @@
 
 #include <list>
 #include "DataModel.h"
+#include "IdBitmap.h"
 
 const unsigned char FILTER_WAD = 0; //!< For wads, with conditions
 const unsigned char FILTER_WAD_LIST = 1; //!< List of specific wads
 const unsigned char FILTER_MAP = 100; //!< For maps, with conditions
 const unsigned char FILTER_MAP_LIST = 101; //!< List of specific maps
 
+/*! Maximum number of fields to sort on, including sortField. */
+const unsigned int SORT_MAX_KEYS = 4;
+
+/*!
+* A field to sort on, after the fields before it, for entries which
+* have the same values in those.
+*/
+struct SortKey
+{
+	WadMapFields field;
+	bool reverse; //!< true for descending order
+};
+
 /*!
 * Defines a set of boolean operators for conditions.
 */
@@ -45,11 +59,27 @@ enum DataFilterOp {
 	DFOP_LESS
 };
 
+/*!
+* A condition on a numeric field, which the DataManager can look up
+* in a RangeIndex rather than testing every entry. For map entries, a
+* wad field is the value of the map's wad.
+*/
+struct FieldRange
+{
+	WadMapFields field;
+	DataFilterOp op;
+	double val;
+
+	FieldRange(WadMapFields f, DataFilterOp o, double v) : field(f), op(o), val(v) {}
+};
+
 /*!
 * Base class for DataFilter, defining the common interface.
 * The includes-method is used to make the decision for any given entry.
 * The base class does not filter, and returns true for all entries.
 * DataFilter can also be named, and specifies how to sort the entries.
+* Entries are sorted on sortField, then on each of thenSort for entries
+* with equal values in the fields before it.
 */
 class DataFilter
 {
@@ -81,11 +111,41 @@ class DataFilter
 	*/
 	virtual bool includes(MapEntry* me) {return true;}
 
+	/*!
+	* Add conditions of the filter which can be looked up in a range
+	* index. Included entries match all of them, but must still be
+	* tested with includes. The base class has none.
+	*/
+	virtual void getRanges(vector<FieldRange>& ranges) {}
+
+	/*!
+	* Sort on field. The thenSort fields are kept if field is the
+	* current sortField, otherwise they are cleared.
+	*/
+	void setSort(WadMapFields field, bool reverse);
+
+	/*!
+	* Sort on field after the current sort fields, or change its direction
+	* if it is already one of them. Returns false if there are already
+	* SORT_MAX_KEYS fields.
+	*/
+	bool addSort(WadMapFields field, bool reverse);
+
+	/*!
+	* Position of field among the sort fields: 0 for sortField, 1 for
+	* the first of thenSort and so on, or -1 if not sorted on it.
+	*/
+	int getSortIndex(WadMapFields field);
+
+	/*! Copy sortField, sortReverse and thenSort from other. */
+	void copySort(DataFilter* other);
+
 	const unsigned char type; //!< See FILTER_* constants
 	wxString name; //!< To name the filter
 	bool isChanged; //!< true if filter parameters are changed after creation
 	WadMapFields sortField; //!< Specify how to sort the included entries
 	bool sortReverse; //!< true to reverse sort direction
+	vector<SortKey> thenSort; //!< Fields to sort on after sortField
 };
 
 /*!
@@ -110,6 +170,7 @@ class ComboDataFilter : public DataFilter
 	virtual bool isList();
 	virtual bool includes(WadEntry* we);
 	virtual bool includes(MapEntry* me);
+	virtual void getRanges(vector<FieldRange>& ranges);
 
 	/*! true if this or any contained filter isChanged. */
 	bool hasChanges();
@@ -134,6 +195,7 @@ class DataIdFilter : public DataFilter
 	virtual bool hasFilter() {return true;}
 	virtual bool includes(WadEntry* we);
 	virtual bool includes(MapEntry* me);
+	virtual void getRanges(vector<FieldRange>& ranges);
 
 	DataFilterOp op;
 	uint32_t val;
@@ -151,6 +213,7 @@ class FileSizeFilter : public DataFilter
 	virtual bool hasFilter() {return true;}
 	virtual bool includes(WadEntry* we);
 	virtual bool includes(MapEntry* me);
+	virtual void getRanges(vector<FieldRange>& ranges);
 
 	DataFilterOp op;
 	uint32_t val;
@@ -182,6 +245,7 @@ class YearFilter : public DataFilter
 	virtual bool hasFilter() {return true;}
 	virtual bool includes(WadEntry* we);
 	virtual bool includes(MapEntry* me);
+	virtual void getRanges(vector<FieldRange>& ranges);
 
 	DataFilterOp op;
 	uint16_t val;
@@ -258,6 +322,7 @@ class MapCountFilter : public DataFilter
 	virtual bool hasFilter() {return true;}
 	virtual bool includes(WadEntry* we);
 	virtual bool includes(MapEntry* me);
+	virtual void getRanges(vector<FieldRange>& ranges);
 
 	DataFilterOp op;
 	unsigned char val;
@@ -311,6 +376,7 @@ class RatingFilter : public DataFilter
 	virtual bool hasFilter() {return true;}
 	virtual bool includes(WadEntry* we);
 	virtual bool includes(MapEntry* me);
+	virtual void getRanges(vector<FieldRange>& ranges);
 
 	DataFilterOp op;
 	unsigned char val;
@@ -329,6 +395,7 @@ class OwnRatingFilter : public DataFilter
 	virtual bool hasFilter() {return true;}
 	virtual bool includes(WadEntry* we);
 	virtual bool includes(MapEntry* me);
+	virtual void getRanges(vector<FieldRange>& ranges);
 
 	DataFilterOp op;
 	unsigned char val;
@@ -384,7 +451,11 @@ class TitleSearchFilter : public DataFilter
 	virtual bool includes(WadEntry* we);
 	virtual bool includes(MapEntry* me);
 
-	wxString searchStr;
+	/*! Set the string to look for. */
+	void setSearch(const wxString& str);
+
+	wxString searchStr; //!< Set with setSearch
+	string searchKey; //!< searchStr case-folded, as PoolString::folded
 };
 
 /*!
@@ -403,7 +474,12 @@ class TextSearchFilter : public DataFilter
 	virtual bool includes(WadEntry* we);
 	virtual bool includes(MapEntry* me);
 
-	wxString searchStr;
+	/*! Set the string to look for. */
+	void setSearch(const wxString& str);
+
+	wxString searchStr; //!< Set with setSearch
+	wxString searchLower; //!< Lower-case searchStr, for authors
+	string searchKey; //!< searchStr case-folded, as PoolString::folded
 };
 
 /*!
@@ -527,6 +603,7 @@ class AreaFilter : public DataFilter
 	virtual bool hasFilter() {return true;}
 	virtual bool includes(WadEntry* we) {return false;}
 	virtual bool includes(MapEntry* me);
+	virtual void getRanges(vector<FieldRange>& ranges);
 
 	DataFilterOp op;
 	float val;
@@ -596,6 +673,7 @@ class DifficultyFilter : public DataFilter
 	virtual bool hasFilter() {return true;}
 	virtual bool includes(WadEntry* we) {return false;}
 	virtual bool includes(MapEntry* me);
+	virtual void getRanges(vector<FieldRange>& ranges);
 
 	DataFilterOp op;
 	unsigned char val;
@@ -613,6 +691,7 @@ class PlayTimeFilter : public DataFilter
 	virtual bool hasFilter() {return true;}
 	virtual bool includes(WadEntry* we) {return false;}
 	virtual bool includes(MapEntry* me);
+	virtual void getRanges(vector<FieldRange>& ranges);
 
 	DataFilterOp op;
 	unsigned char val;
@@ -620,8 +699,9 @@ class PlayTimeFilter : public DataFilter
 
 /*!
 * A DataFilter specifying the exact subset of entries to include,
-* having a list of dbids. The IDs are kept in sorted order for
-* efficient processing of a list of entries ordered by ID.
+* having a set of dbids. The IDs are kept in an IdBitmap, so includes
+* is a constant-time lookup regardless of the order entries are tested
+* in. Lists can be combined with the set operations.
 */
 class DataListFilter : public DataFilter
 {
@@ -629,15 +709,23 @@ class DataListFilter : public DataFilter
 	DataListFilter(unsigned char t);
 	virtual ~DataListFilter();
 
-	virtual bool hasFilter();
+	virtual bool hasFilter() {return true;}
 	virtual bool isList() {return true;}
 	virtual bool includes(WadEntry* we);
 	virtual bool includes(MapEntry* me);
 	void addEntry(uint32_t id);
 	bool removeEntry(uint32_t id);
 
-	list<uint32_t>* entries; //!< dbids of the entries
-	list<uint32_t>::iterator searchIter;
+	/*! Add the entries of other (union). */
+	void addAll(DataListFilter* other);
+
+	/*! Keep only entries also in other (intersection). */
+	void retainAll(DataListFilter* other);
+
+	/*! Remove the entries of other (difference). */
+	void removeAll(DataListFilter* other);
+
+	IdBitmap* entries; //!< dbids of the entries
 };
 
 #endif // DATAFILTER_H
@@ -3,7 +3,9 @@
 */
 
 #include "DataManager.h"
-#include "../gui/GuiBase.h"
+#include "MapLoadJob.h"
+#include "CoreBase.h"
+#include <cmath>
 
 
 //******************************************************************
@@ -71,252 +73,322 @@ bool filter_comp(const DataFilter* first, const DataFilter* second)
 	return (first->name.compare(second->name) < 0);
 }
 
-bool wad_comp_dbid(WadEntry* first, WadEntry* second)
-{
-	return (first->dbid < second->dbid);
-}
-
-bool wad_comp_fileName(WadEntry* first, WadEntry* second)
-{
-	return (first->fileName.compare(second->fileName) < 0);
-}
-
-bool wad_comp_fileSize(WadEntry* first, WadEntry* second)
-{
-	return (first->fileSize < second->fileSize);
-}
-
-bool wad_comp_idgames(WadEntry* first, WadEntry* second)
-{
-	return (first->idGames < second->idGames);
-}
-
 bool wad_comp_title(WadEntry* first, WadEntry* second)
 {
-	return (first->title.compare(second->title) < 0);
-}
-
-bool wad_comp_year(WadEntry* first, WadEntry* second)
-{
-	return (first->year < second->year);
-}
-
-bool wad_comp_iwad(WadEntry* first, WadEntry* second)
-{
-	return (first->iwad < second->iwad);
-}
-
-bool wad_comp_engine(WadEntry* first, WadEntry* second)
-{
-	return (first->engine < second->engine);
-}
-
-bool wad_comp_playstyle(WadEntry* first, WadEntry* second)
-{
-	return (first->playStyle < second->playStyle);
-}
-
-bool wad_comp_maps(WadEntry* first, WadEntry* second)
-{
-	return (first->numberOfMaps < second->numberOfMaps);
-}
-
-bool wad_comp_rating(WadEntry* first, WadEntry* second)
-{
-	return (first->rating < second->rating);
-}
-
-bool wad_comp_ownrating(WadEntry* first, WadEntry* second)
-{
-	return (first->ownRating < second->ownRating);
-}
-
-bool wad_comp_playtime(WadEntry* first, WadEntry* second)
-{
-	return (first->getTotalPlaytime() < second->getTotalPlaytime());
-}
-
-bool wad_comp_name(WadEntry* first, WadEntry* second)
-{
-	return (first->getName().compare(second->getName()) < 0);
-}
-
-
-bool map_comp_filename(MapEntry* first, MapEntry* second)
-{
-	return (first->wadPointer->fileName.compare(second->wadPointer->fileName) < 0);
-}
-
-bool map_comp_idgames(MapEntry* first, MapEntry* second)
-{
-	return (first->wadPointer->idGames < second->wadPointer->idGames);
-}
-
-bool map_comp_wadtitle(MapEntry* first, MapEntry* second)
-{
-	return (first->wadPointer->title.compare(second->wadPointer->title) < 0);
-}
-
-bool map_comp_year(MapEntry* first, MapEntry* second)
-{
-	return (first->wadPointer->year < second->wadPointer->year);
-}
-
-bool map_comp_iwad(MapEntry* first, MapEntry* second)
-{
-	return (first->wadPointer->iwad < second->wadPointer->iwad);
-}
-
-bool map_comp_engine(MapEntry* first, MapEntry* second)
-{
-	return (first->wadPointer->engine < second->wadPointer->engine);
-}
-
-bool map_comp_playstyle(MapEntry* first, MapEntry* second)
-{
-	return (first->wadPointer->playStyle < second->wadPointer->playStyle);
-}
-
-bool map_comp_dbid(MapEntry* first, MapEntry* second)
-{
-	return (first->dbid < second->dbid);
+	return (first->title.str().compare(second->title.str()) < 0);
 }
 
-bool map_comp_name(MapEntry* first, MapEntry* second)
-{
-	return (first->name.compare(second->name) < 0);
-}
-
-bool map_comp_title(MapEntry* first, MapEntry* second)
-{
-	return (first->title.compare(second->title) < 0);
-}
-
-bool map_comp_author1(MapEntry* first, MapEntry* second)
-{
-	const wxString fir = (first->author1==NULL)? "": authorNamingScheme(first->author1);
-	const wxString sec = (second->author1==NULL)? "": authorNamingScheme(second->author1);
-	return (fir.CmpNoCase(sec) < 0);
-}
-
-bool map_comp_author2(MapEntry* first, MapEntry* second)
-{
-	const wxString fir = (first->author2==NULL)? "": authorNamingScheme(first->author2);
-	const wxString sec = (second->author2==NULL)? "": authorNamingScheme(second->author2);
-	return (fir.CmpNoCase(sec) < 0);
-}
-
-bool map_comp_single(MapEntry* first, MapEntry* second)
-{
-	return (first->singlePlayer < second->singlePlayer);
-}
-
-bool map_comp_coop(MapEntry* first, MapEntry* second)
-{
-	return (first->cooperative < second->cooperative);
-}
-
-bool map_comp_dm(MapEntry* first, MapEntry* second)
-{
-	return (first->deathmatch < second->deathmatch);
-}
-
-bool map_comp_mode(MapEntry* first, MapEntry* second)
-{
-	return (first->otherMode < second->otherMode);
-}
-
-bool map_comp_linedefs(MapEntry* first, MapEntry* second)
-{
-	return (first->linedefs < second->linedefs);
-}
-
-bool map_comp_sectors(MapEntry* first, MapEntry* second)
-{
-	return (first->sectors < second->sectors);
-}
-
-bool map_comp_things(MapEntry* first, MapEntry* second)
-{
-	return (first->things < second->things);
-}
-
-bool map_comp_secrets(MapEntry* first, MapEntry* second)
-{
-	return (first->secrets < second->secrets);
-}
+//*******************************************************************
+//************************ Sort keys ********************************
+//*******************************************************************
 
-bool map_comp_enemies(MapEntry* first, MapEntry* second)
+/*! true if the field is sorted on a text key. */
+bool isTextSortField(WadMapFields field)
 {
-	return (first->enemies < second->enemies);
+	switch (field) {
+	case WAD_FILENAME: case WAD_TITLE:
+	case MAP_NAME: case MAP_TITLE: case MAP_AUTHOR1: case MAP_AUTHOR2:
+		return true;
+	default:
+		return false;
+	}
 }
 
-bool map_comp_totalhp(MapEntry* first, MapEntry* second)
+/*! true if wad lists can be sorted on the field. */
+bool isWadSortField(WadMapFields field)
 {
-	return (first->totalHP < second->totalHP);
+	switch (field) {
+	case WAD_DBID: case WAD_FILENAME: case WAD_FILESIZE:
+	//Not WAD_MD5DIGEST, WAD_EXTRAFILES
+	case WAD_IDGAMES: case WAD_TITLE: case WAD_YEAR: case WAD_IWAD:
+	case WAD_ENGINE: case WAD_PLAYSTYLE: case WAD_MAPS:
+	//Not flags: WAD_WF_IWAD, WAD_WF_SPRITES, WAD_WF_TEX, WAD_WF_GFX, WAD_WF_COLOR,
+	// WAD_WF_SOUND, WAD_WF_MUSIC, WAD_WF_DEHBEX, WAD_WF_THINGS, WAD_WF_SCRIPT,
+	// WAD_WF_GLNODES, WAD_OF_HAVEFILE
+	case WAD_RATING: case WAD_OWNRATING: case WAD_PLAYTIME:
+		return true;
+	default:
+		return false;
+	}
 }
 
-bool map_comp_ammorat(MapEntry* first, MapEntry* second)
+/*! true if map lists can be sorted on the field. */
+bool isMapSortField(WadMapFields field)
 {
-	return (first->ammoRatio < second->ammoRatio);
+	switch (field) {
+	//Wad fields in map list:
+	case WAD_FILENAME:
+	//Not WAD_FILESIZE, WAD_MD5DIGEST, WAD_EXTRAFILES
+	case WAD_IDGAMES: case WAD_TITLE: case WAD_YEAR: case WAD_IWAD:
+	case WAD_ENGINE: case WAD_PLAYSTYLE:
+	//Map fields:
+	case MAP_DBID: case MAP_NAME: case MAP_TITLE: case MAP_AUTHOR1: case MAP_AUTHOR2:
+	case MAP_SINGLE: case MAP_COOP: case MAP_DM: case MAP_MODE:
+	case MAP_LINEDEFS: case MAP_SECTORS: case MAP_THINGS: case MAP_SECRETS:
+	case MAP_ENEMIES: case MAP_TOTALHP: case MAP_AMMORAT: case MAP_HEALTHRAT:
+	case MAP_ARMORRAT: case MAP_AREA: case MAP_LINEDEF_DENS: case MAP_ENEMY_DENS:
+	case MAP_HP_DENS: case MAP_RATING:
+	//Not flags: MAP_MF_SPAWN, MAP_MF_MORESPAWN, MAP_MF_DIFFSET, MAP_MF_VOODOO, MAP_MF_UNKNOWN
+	case MAP_OWNRATING:
+	//case MAP_PLAYED: currently only showed as flag
+	case MAP_DIFFICULTY: case MAP_PLAYTIME:
+		return true;
+	default:
+		return false;
+	}
 }
 
-bool map_comp_healthrat(MapEntry* first, MapEntry* second)
+/*! Set key i to the value of a wad field, which should pass isWadSortField. */
+void setWadSortKey(ColumnKeys& keys, size_t i, WadEntry* we, WadMapFields field)
 {
-	return (first->healthRatio < second->healthRatio);
-}
-
-bool map_comp_armorrat(MapEntry* first, MapEntry* second)
+	switch (field) {
+	case WAD_DBID: keys.setNumber(i, we->dbid); break;
+	case WAD_FILENAME: keys.setTextKey(i, we->fileName.folded()); break;
+	case WAD_FILESIZE: keys.setNumber(i, we->fileSize); break;
+	case WAD_IDGAMES: keys.setNumber(i, we->idGames); break;
+	case WAD_TITLE: keys.setTextKey(i, we->title.folded()); break;
+	case WAD_YEAR: keys.setNumber(i, we->year); break;
+	case WAD_IWAD: keys.setNumber(i, we->iwad); break;
+	case WAD_ENGINE: keys.setNumber(i, we->engine); break;
+	case WAD_PLAYSTYLE: keys.setNumber(i, we->playStyle); break;
+	case WAD_MAPS: keys.setNumber(i, we->numberOfMaps); break;
+	case WAD_RATING: keys.setNumber(i, we->rating); break;
+	case WAD_OWNRATING: keys.setNumber(i, we->ownRating); break;
+	case WAD_PLAYTIME: keys.setNumber(i, we->getTotalPlaytime()); break;
+	default: keys.setNumber(i, 0);
+	}
+}
+
+/*! Value of a wad field with a RangeIndex. */
+double wadRangeValue(WadEntry* we, WadMapFields field)
 {
-	return (first->armorRatio < second->armorRatio);
+	switch (field) {
+	case WAD_DBID: return we->dbid;
+	case WAD_FILESIZE: return we->fileSize;
+	case WAD_YEAR: return we->year;
+	case WAD_MAPS: return we->numberOfMaps;
+	case WAD_RATING: return we->rating;
+	case WAD_OWNRATING: return we->ownRating;
+	default: return 0;
+	}
 }
 
-bool map_comp_area(MapEntry* first, MapEntry* second)
+/*! Value of a map field with a RangeIndex. */
+double mapRangeValue(MapEntry* me, WadMapFields field)
 {
-	return (first->area < second->area);
+	if (field < MAP_DBID) {
+		if (me->wadPointer == NULL) return 0;
+		return wadRangeValue(me->wadPointer, field);
+	}
+	switch (field) {
+	case MAP_DBID: return me->dbid;
+	case MAP_RATING: return me->rating;
+	case MAP_OWNRATING: return me->ownRating;
+	case MAP_AREA: return me->area;
+	case MAP_DIFFICULTY: return me->difficulty;
+	case MAP_PLAYTIME: return me->playTime;
+	default: return 0;
+	}
 }
 
-bool map_comp_lddens(MapEntry* first, MapEntry* second)
+/*! Orders wad or map entries on dbid. */
+template<class T> bool entryIdLess(T a, T b)
 {
-	return (first->linedefDensity() < second->linedefDensity());
+	return a->dbid < b->dbid;
 }
 
-bool map_comp_enemydens(MapEntry* first, MapEntry* second)
+/*! Set key i to the value of a map field, which should pass isMapSortField. */
+void setMapSortKey(ColumnKeys& keys, size_t i, MapEntry* me, WadMapFields field)
 {
-	return (first->enemyDensity() < second->enemyDensity());
-}
-
-bool map_comp_hpdens(MapEntry* first, MapEntry* second)
+	switch (field) {
+	case WAD_FILENAME: keys.setTextKey(i, me->wadPointer->fileName.folded()); break;
+	case WAD_IDGAMES: keys.setNumber(i, me->wadPointer->idGames); break;
+	case WAD_TITLE: keys.setTextKey(i, me->wadPointer->title.folded()); break;
+	case WAD_YEAR: keys.setNumber(i, me->wadPointer->year); break;
+	case WAD_IWAD: keys.setNumber(i, me->wadPointer->iwad); break;
+	case WAD_ENGINE: keys.setNumber(i, me->wadPointer->engine); break;
+	case WAD_PLAYSTYLE: keys.setNumber(i, me->wadPointer->playStyle); break;
+	case MAP_DBID: keys.setNumber(i, me->dbid); break;
+	case MAP_NAME: keys.setTextKey(i, me->name.folded()); break;
+	case MAP_TITLE: keys.setTextKey(i, me->title.folded()); break;
+	case MAP_AUTHOR1: keys.setText(i, (me->author1==NULL)? "": authorNamingScheme(me->author1)); break;
+	case MAP_AUTHOR2: keys.setText(i, (me->author2==NULL)? "": authorNamingScheme(me->author2)); break;
+	case MAP_SINGLE: keys.setNumber(i, me->singlePlayer); break;
+	case MAP_COOP: keys.setNumber(i, me->cooperative); break;
+	case MAP_DM: keys.setNumber(i, me->deathmatch); break;
+	case MAP_MODE: keys.setNumber(i, me->otherMode); break;
+	case MAP_LINEDEFS: keys.setNumber(i, me->linedefs); break;
+	case MAP_SECTORS: keys.setNumber(i, me->sectors); break;
+	case MAP_THINGS: keys.setNumber(i, me->things); break;
+	case MAP_SECRETS: keys.setNumber(i, me->secrets); break;
+	case MAP_ENEMIES: keys.setNumber(i, me->enemies); break;
+	case MAP_TOTALHP: keys.setNumber(i, me->totalHP); break;
+	case MAP_AMMORAT: keys.setNumber(i, ColumnKeys::floatKey(me->ammoRatio)); break;
+	case MAP_HEALTHRAT: keys.setNumber(i, ColumnKeys::floatKey(me->healthRatio)); break;
+	case MAP_ARMORRAT: keys.setNumber(i, ColumnKeys::floatKey(me->armorRatio)); break;
+	case MAP_AREA: keys.setNumber(i, ColumnKeys::floatKey(me->area)); break;
+	case MAP_LINEDEF_DENS: keys.setNumber(i, ColumnKeys::floatKey(me->linedefDensity())); break;
+	case MAP_ENEMY_DENS: keys.setNumber(i, ColumnKeys::floatKey(me->enemyDensity())); break;
+	case MAP_HP_DENS: keys.setNumber(i, ColumnKeys::floatKey(me->hitpointDensity())); break;
+	case MAP_RATING: keys.setNumber(i, me->rating); break;
+	case MAP_OWNRATING: keys.setNumber(i, me->ownRating); break;
+	case MAP_DIFFICULTY: keys.setNumber(i, me->difficulty); break;
+	case MAP_PLAYTIME: keys.setNumber(i, me->playTime); break;
+	default: keys.setNumber(i, 0);
+	}
+}
+
+/*! true if the field is sorted on a floating-point key. */
+bool isFloatSortField(WadMapFields field)
 {
-	return (first->hitpointDensity() < second->hitpointDensity());
+	switch (field) {
+	case MAP_AMMORAT: case MAP_HEALTHRAT: case MAP_ARMORRAT: case MAP_AREA:
+	case MAP_LINEDEF_DENS: case MAP_ENEMY_DENS: case MAP_HP_DENS:
+		return true;
+	default:
+		return false;
+	}
 }
 
-bool map_comp_rating(MapEntry* first, MapEntry* second)
+/*!
+* Search key for finding str in a list sorted on field, as used with
+* ColumnKeys::compareSearch. Returns false if str should be a number
+* but isn't.
+*/
+bool makeSearchKey(WadMapFields field, const wxString& str, uint64_t& number, string& text)
 {
-	return (first->rating < second->rating);
+	number = 0;
+	if (isTextSortField(field)) {
+		text = ColumnKeys::textKey(str);
+		return true;
+	}
+	double val;
+	if (!str.ToCDouble(&val))
+		return false;
+	if (isFloatSortField(field))
+		number = ColumnKeys::floatKey(val);
+	else if (val > 0)
+		number = (uint64_t)ceil(val);
+	return true;
 }
 
-bool map_comp_ownrating(MapEntry* first, MapEntry* second)
+/*!
+* Put the sort fields of filter which pass valid in spec, with directions
+* for sorting ascending on the first field. Returns true if the sorted
+* list must then be reversed to get the order of filter.
+*/
+bool makeSortSpec(DataFilter* filter, bool (*valid)(WadMapFields), vector<SortKey>& spec)
 {
-	return (first->ownRating < second->ownRating);
+	spec.clear();
+	if (!valid(filter->sortField))
+		return false;
+	bool rev = filter->sortReverse;
+	SortKey key;
+	key.field = filter->sortField;
+	key.reverse = false;
+	spec.push_back(key);
+	for (vector<SortKey>::iterator it=filter->thenSort.begin(); it!=filter->thenSort.end(); ++it) {
+		if (valid(it->field)) {
+			key.field = it->field;
+			key.reverse = (it->reverse != rev);
+			spec.push_back(key);
+		}
+	}
+	return rev;
 }
 
-bool map_comp_difficulty(MapEntry* first, MapEntry* second)
+/*! String identifying a sort spec, for the sort caches. */
+string sortSpecKey(const vector<SortKey>& spec)
 {
-	return (first->difficulty < second->difficulty);
+	string key;
+	for (vector<SortKey>::const_iterator it=spec.begin(); it!=spec.end(); ++it) {
+		key.push_back((char)it->field);
+		key.push_back(it->reverse? '-': '+');
+	}
+	return key;
 }
 
-bool map_comp_playtime(MapEntry* first, MapEntry* second)
-{
-	return (first->playTime < second->playTime);
-}
+/*!
+* Orders wad or map entries as sortWadList or sortMapList does, for a
+* binary search in the sorted list. Entries with the same sort values
+* are in dbid order, as in the master list.
+*
+* The keys of the two entries last compared are kept, in a ColumnKeys
+* of two slots for each sort field, so an entry compared against many
+* others (as in a binary search) has its keys made only once, and the
+* comparisons don't allocate. Not copyable, so pass it to standard
+* algorithms with cref.
+*/
+template<class T> class ListOrder
+{
+	public:
+	ListOrder(DataFilter* filter, bool (*valid)(WadMapFields), void (*key)(ColumnKeys&, size_t, T, WadMapFields))
+	: setKey(key) {
+		rev = makeSortSpec(filter, valid, spec);
+		for (vector<SortKey>::iterator it=spec.begin(); it!=spec.end(); ++it)
+			keys.push_back(new ColumnKeys(2, isTextSortField(it->field)));
+		slots[0] = slots[1] = NULL;
+	};
+
+	~ListOrder() {
+		for (size_t i=0; i<keys.size(); i++)
+			delete keys[i];
+	};
+
+	ListOrder(const ListOrder&) = delete;
+	ListOrder& operator=(const ListOrder&) = delete;
+
+	bool operator()(T a, T b) const {
+		size_t sa = slotFor(a, b);
+		size_t sb = slotFor(b, a);
+		int c = 0;
+		for (size_t i=0; c==0 && i<spec.size(); i++)
+			c = spec[i].reverse? keys[i]->compare(sb, sa): keys[i]->compare(sa, sb);
+		if (c == 0)
+			c = (a->dbid < b->dbid)? -1: (a->dbid > b->dbid)? 1: 0;
+		return rev? (c>0): (c<0);
+	};
+
+	private:
+	/*! Slot with the keys of entry, making them in the slot not used by other. */
+	size_t slotFor(T entry, T other) const {
+		if (slots[0] == entry)
+			return 0;
+		if (slots[1] == entry)
+			return 1;
+		size_t s = (slots[0] == other)? 1: 0;
+		for (size_t i=0; i<spec.size(); i++)
+			setKey(*keys[i], s, entry, spec[i].field);
+		slots[s] = entry;
+		return s;
+	};
+
+	vector<SortKey> spec;
+	bool rev;
+	void (*setKey)(ColumnKeys&, size_t, T, WadMapFields);
+	vector<ColumnKeys*> keys; //Two slots for each field of spec
+	mutable T slots[2]; //Entry with its keys in each slot
+};
 
-bool map_comp_wad(MapEntry* first, MapEntry* second)
+/*!
+* Re-test entry against filter, and add it to, move it in or remove it
+* from list, which is sorted by order. Returns true if list changed.
+*/
+template<class T> bool updateListEntry(ListWrapper<T>* list, T entry, DataFilter* filter, const ListOrder<T>& order)
 {
-	if (first->wadPointer == second->wadPointer) //Same wad
-		return (first->name.compare(second->name) < 0);
-	else
-		return (first->wadPointer->getName().compare(second->wadPointer->getName()) < 0);
+	if (list == NULL)
+		return false;
+	bool include = filter->includes(entry);
+	long index = list->find(entry);
+	if (index >= 0) {
+		if (include && (index==0 || !order(entry, list->at(index-1)))
+			&& (index+1==(long)list->getSize() || !order(list->at(index+1), entry)))
+			return false; //Still in place
+		list->remove(index);
+	}
+	if (include)
+		list->insertSorted(entry, order);
+	return (include || index>=0);
 }
 
 
@@ -327,10 +399,11 @@ bool map_comp_wad(MapEntry* first, MapEntry* second)
 DataManager::DataManager(DataStatusListener* l)
 : authorMaster(NULL), nextAuthorId(1), authorMod(false), firstNewAuthor(-1), authorList(NULL),
 authorTextDir(0), authorTextFile(NULL), authorTextIndex(-1), authorText(""),
+authorTextSlots(NULL), authorTextFree(NULL), authorGroups(NULL),
 tagLength(DEFAULT_TAG_LENGTH), tagMaster(), tagList(NULL),
 wadMaster(), nextWadId(1), wadMod(false), wadOwnMod(false), firstNewWad(-1), wadList(NULL),
-mapMaster(), nextMapId(1), mapMod(false), mapOwnMod(false), firstNewMap(-1), mapList(NULL),
-wadText(NULL), dataViewMod(false), wadTitleFilter(NULL)
+mapMaster(), nextMapId(1), mapMod(false), mapOwnMod(false), firstNewMap(-1), mapList(NULL), mapLoader(NULL), mapLoadId(0),
+authorIndex(NULL), tagIndex(NULL), basedOnIndex(NULL), wadSortCache(NULL), mapSortCache(NULL), wadSortUsed(NULL), mapSortUsed(NULL), wadRangeIndex(NULL), mapRangeIndex(NULL), wadText(NULL), wadTextStore(NULL), dataViewMod(false), wadTitleFilter(NULL)
 {
 	listener = l;
 	authorNamingScheme = getAuthorNameFirstLast;
@@ -338,16 +411,35 @@ wadText(NULL), dataViewMod(false), wadTitleFilter(NULL)
 	mapLists = new list<DataListFilter*>();
 	currentWadFilter = new ComboDataFilter(FILTER_WAD);
 	currentMapFilter = new ComboDataFilter(FILTER_MAP);
+	authorTextSlots = new set<uint32_t>();
+	authorTextFree = new set<uint32_t>();
+	authorGroups = new map<uint32_t, vector<AuthorEntry*> >();
+	authorIndex = new MapIndex<uint32_t>();
+	tagIndex = new MapIndex<uint16_t>();
+	basedOnIndex = new MapIndex<uint32_t>();
+	wadSortCache = new map<string, vector<WadEntry*>*>();
+	mapSortCache = new map<string, vector<MapEntry*>*>();
+	wadSortUsed = new list<string>();
+	mapSortUsed = new list<string>();
+	wadRangeIndex = new map<WadMapFields, RangeIndex<WadEntry*>*>();
+	mapRangeIndex = new map<WadMapFields, RangeIndex<MapEntry*>*>();
 }
 
 DataManager::~DataManager()
 {
+	if (mapLoader != NULL) {
+		mapLoader->Delete();
+		delete mapLoader;
+	}
 	unsigned int i;
 	for (i=0; i<authorMaster->size(); i++)
 		delete (*authorMaster)[i];
 	delete authorMaster;
 	if (authorList != NULL)
 		delete authorList;
+	delete authorTextSlots;
+	delete authorTextFree;
+	delete authorGroups;
 	for (i=0; i<tagMaster.size(); i++)
 		delete tagMaster[i];
 	if (tagList != NULL)
@@ -360,8 +452,20 @@ DataManager::~DataManager()
 		delete mapMaster[i];
 	if (mapList != NULL)
 		delete mapList;
+	delete authorIndex;
+	delete tagIndex;
+	delete basedOnIndex;
+	clearSortCache();
+	delete wadSortCache;
+	delete mapSortCache;
+	delete wadRangeIndex;
+	delete mapRangeIndex;
+	delete wadSortUsed;
+	delete mapSortUsed;
 	if (wadText != NULL)
 		delete wadText;
+	if (wadTextStore != NULL)
+		delete wadTextStore;
 	for (list<DataListFilter*>::iterator it=wadLists->begin(); it != wadLists->end(); ++it) {
 		delete (*it);
 	}
@@ -372,25 +476,33 @@ DataManager::~DataManager()
 	delete mapLists;
 	if (wadTitleFilter != NULL)
 		delete wadTitleFilter;
+	//All entries are gone, so their strings can go too
+	StringPool::getPool().clear();
 }
 
-void DataManager::load()
+void DataManager::load(wxEvtHandler* handler)
 {
-	// Author core:
-	loadAuthors();
-	loadAuthorTextDir();
-	makeAuthorList();
+	wxStopWatch watch;
+	// Maps are read while the other files are read
+	startMapLoad(handler);
 
-	// Tags:
-	loadTags();
+	// Author core, tags, wads and persisted filter lists:
+	try {
+		loadParts();
+	} catch (GuiError&) {
+		if (mapLoader != NULL) {
+			mapLoader->Delete();
+			delete mapLoader;
+			mapLoader = NULL;
+		}
+		throw;
+	}
+	makeAuthorList();
 	makeTagList();
+	listener->onTotalCounts(wadMaster.size(), mapMaster.size(), authorMaster->size());
 
-	// Wads & Maps:
-	loadWads();
-	loadMaps();
-
-	// Load persisted filter lists
-	loadDataFilters();
+	// Maps, linked to wads and authors:
+	loadMaps(handler);
 
 	// Make sure sub-folders exist
 	wxFileName mapImgDirname(getMapImgFolder(), "");
@@ -403,6 +515,74 @@ void DataManager::load()
 	tempDirname.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
 	wxFileName failDirname(getFailedFolder(), "");
 	failDirname.Mkdir(wxS_DIR_DEFAULT, wxPATH_MKDIR_FULL);
+
+	// Wad text, migrating text files from earlier versions
+	wadTextStore = new WadTextStore(dbFolder+wxFILE_SEP_PATH+FILE_WADTEXT);
+	if (!wadTextStore->open())
+		wadTextStore->importFolder(getTextFolder());
+	wxLogVerbose("Finished loading in %ld ms%s", watch.Time(),
+		isLoading()? ", maps still loading": "");
+}
+
+void DataManager::loadParts()
+{
+	//Part 0 is read by this thread, the others by new threads
+	vector<DbLoadThread*> threads(LOAD_PARTS, NULL);
+	for (int i=1; i<LOAD_PARTS; i++) {
+		threads[i] = new DbLoadThread(this, i);
+		if (threads[i]->Run() != wxTHREAD_NO_ERROR) {
+			delete threads[i];
+			threads[i] = NULL;
+		}
+	}
+	wxString error1, error2;
+	for (int i=0; i<LOAD_PARTS; i++) {
+		if (threads[i] == NULL) {
+			try {
+				loadPart(i);
+			} catch (GuiError& err) {
+				if (error1.IsEmpty()) {
+					error1 = err.text1;
+					error2 = err.text2;
+				}
+			}
+		} else {
+			threads[i]->Wait();
+			if (error1.IsEmpty()) {
+				error1 = threads[i]->getError();
+				error2 = threads[i]->getErrorFile();
+			}
+			delete threads[i];
+		}
+	}
+	if (!error1.IsEmpty())
+		throw GuiError(error1, error2);
+}
+
+void DataManager::loadPart(int part)
+{
+	wxStopWatch watch;
+	wxString name;
+	switch (part) {
+	case LOAD_WADS:
+		loadWads();
+		name = FILE_WADDB;
+		break;
+	case LOAD_AUTHORS:
+		loadAuthors();
+		loadAuthorTextDir();
+		name = FILE_AUTHORDB;
+		break;
+	case LOAD_TAGS:
+		loadTags();
+		name = FILE_TAGS;
+		break;
+	case LOAD_VIEWS:
+		loadDataFilters();
+		name = FILE_VIEWS;
+		break;
+	}
+	wxLogVerbose("Read %s in %ld ms", name, watch.Time());
 }
 
 
@@ -431,10 +611,20 @@ void DataManager::openAuthorTextFile()
 void DataManager::closeAuthorTextFile()
 {
 	if (authorTextFile != NULL) {
+		//Compact if a large part of the file is free slots
+		wxTempFile* compacted = NULL;
+		uint32_t freeBytes = getAuthorTextFreeBytes();
+		if (freeBytes > AUTHOR_TEXT_COMPACT && freeBytes*4 > authorTextDir)
+			compacted = compactAuthorText();
 		//authorTextFile->Flush();
 		authorTextFile->Close();
 		delete authorTextFile;
 		authorTextFile = NULL;
+		if (compacted != NULL) {
+			compacted->Commit();
+			delete compacted;
+			wxLogVerbose("Compacted author text file, new dir offset is %i", authorTextDir);
+		}
 		wxLogVerbose("Author text file closed");
 	}
 }
@@ -445,10 +635,43 @@ void DataManager::writeAuthorTextDir(wxFile* file)
 		file->Write(&((*it)->dbid), 4);
 		file->Write(&((*it)->textOffset), 4);
 	}
+	writeAuthorTextFree(file);
+}
+
+void DataManager::writeAuthorTextFree(wxFile* file)
+{
+	uint32_t zero = 0;
+	for (set<uint32_t>::iterator it=authorTextFree->begin(); it != authorTextFree->end(); ++it) {
+		file->Write(&zero, 4);
+		file->Write(&(*it), 4);
+	}
+	file->Write(&zero, 4);
+	file->Write(&zero, 4);
+}
+
+void DataManager::updateAuthorTextDir(long index, uint32_t oldDir)
+{
+	if (authorTextDir != oldDir) {
+		//Slot was appended - write whole directory at new offset
+		authorTextFile->Seek(authorTextDir, wxFromStart);
+		writeAuthorTextDir(authorTextFile);
+		authorTextFile->Seek(0, wxFromStart);
+		authorTextFile->Write(&authorTextDir, 4);
+	} else {
+		//Directory in place - write the entry and the free slots after it
+		AuthorEntry* ae = authorMaster->at(index);
+		authorTextFile->Seek(authorTextDir + index*8, wxFromStart);
+		authorTextFile->Write(&(ae->dbid), 4);
+		authorTextFile->Write(&(ae->textOffset), 4);
+		authorTextFile->Seek(authorTextDir + authorMaster->size()*8, wxFromStart);
+		writeAuthorTextFree(authorTextFile);
+	}
 }
 
 void DataManager::loadAuthorTextDir()
 {
+	authorTextSlots->clear();
+	authorTextFree->clear();
 	wxString fname(dbFolder+wxFILE_SEP_PATH+FILE_AUTHORTEXT);
 	if (!wxFile::Exists(fname)) {
 		wxLogVerbose("File %s not found", FILE_AUTHORTEXT);
@@ -466,19 +689,119 @@ void DataManager::loadAuthorTextDir()
 		uint32_t dbid;
 		uint32_t offset;
 		long index = 0;
-		while ((!buf.Eof()) && (index<authorMaster->size())) {
+		size_t authors = 0;
+		while (!buf.Eof()) {
 			buf.Read(&dbid, 4);
 			if (buf.Eof()) break;
 			buf.Read(&offset, 4);
-			if (dbid != (*authorMaster)[index]->dbid)
+			if (dbid == 0) {
+				//Free slot, or end of directory
+				if (offset == 0) break;
+				authorTextSlots->insert(offset);
+				authorTextFree->insert(offset);
+				continue;
+			}
+			//Files from older versions have no end entry, and may have stale
+			//entries after the directory. Only free slots follow the authors.
+			if (authors == authorMaster->size()) break;
+			authors++;
+			if (index<0 || (size_t)index>=authorMaster->size() || dbid != (*authorMaster)[index]->dbid)
 				index = getAuthorMasterIndex(dbid);
 			if (index > -1) {
 				(*authorMaster)[index]->textOffset = offset;
+				if (offset > 0)
+					authorTextSlots->insert(offset);
 			}
 			index++;
 		}
 	}
 	file.Close();
+	wxLogVerbose("Author text file has %i slots, %i free", authorTextSlots->size(), authorTextFree->size());
+}
+
+uint32_t DataManager::getAuthorTextSlotEnd(uint32_t offset)
+{
+	set<uint32_t>::iterator it = authorTextSlots->upper_bound(offset);
+	if (it == authorTextSlots->end())
+		return authorTextDir;
+	else
+		return *it;
+}
+
+uint32_t DataManager::getAuthorTextFreeBytes()
+{
+	uint32_t result = 0;
+	for (set<uint32_t>::iterator it=authorTextFree->begin(); it != authorTextFree->end(); ++it)
+		result += getAuthorTextSlotEnd(*it) - *it;
+	return result;
+}
+
+uint32_t DataManager::allocAuthorTextSlot(uint16_t length)
+{
+	//Whole number of blocks - AUTHOR_DESC_BLOCK
+	uint32_t size = ((length / AUTHOR_DESC_BLOCK) + 1)*AUTHOR_DESC_BLOCK + 2;
+	uint32_t offset, end;
+	//First fit among free slots
+	for (set<uint32_t>::iterator it=authorTextFree->begin(); it != authorTextFree->end(); ++it) {
+		offset = *it;
+		end = getAuthorTextSlotEnd(offset);
+		if (end == authorTextDir) {
+			//Last slot before directory - can be extended
+			authorTextFree->erase(it);
+			authorTextDir = offset + size;
+			return offset;
+		}
+		if (end-offset >= size) {
+			authorTextFree->erase(it);
+			if (end-offset >= size+AUTHOR_DESC_BLOCK+2) {
+				//Split, keeping the rest as a free slot
+				authorTextSlots->insert(offset+size);
+				authorTextFree->insert(offset+size);
+			}
+			return offset;
+		}
+	}
+	//Append at old authorTextDir
+	offset = authorTextDir;
+	authorTextSlots->insert(offset);
+	authorTextDir += size;
+	return offset;
+}
+
+void DataManager::freeAuthorTextSlot(uint32_t offset)
+{
+	authorTextFree->insert(offset);
+	//Merge with following free slot
+	set<uint32_t>::iterator it = authorTextSlots->upper_bound(offset);
+	if (it!=authorTextSlots->end() && authorTextFree->count(*it)>0) {
+		authorTextFree->erase(*it);
+		authorTextSlots->erase(it);
+	}
+	//Merge with preceding free slot
+	it = authorTextSlots->find(offset);
+	if (it!=authorTextSlots->end() && it!=authorTextSlots->begin()) {
+		--it;
+		if (authorTextFree->count(*it) > 0) {
+			authorTextFree->erase(offset);
+			authorTextSlots->erase(offset);
+		}
+	}
+}
+
+void DataManager::writeAuthorTextSlot(uint32_t offset, const wxScopedCharBuffer& buf)
+{
+	authorTextFile->Seek(offset, wxFromStart);
+	uint16_t l = buf.length();
+	authorTextFile->Write(&l, 2);
+	if (l > 0) authorTextFile->Write(buf.data(), l);
+	//Clear rest of slot
+	char zeros[AUTHOR_DESC_BLOCK] = {0};
+	uint32_t left = getAuthorTextSlotEnd(offset) - (offset+l+2);
+	while (left > 0) {
+		uint32_t len = (left < AUTHOR_DESC_BLOCK)? left: AUTHOR_DESC_BLOCK;
+		authorTextFile->Write(zeros, len);
+		left -= len;
+	}
 }
 
 void DataManager::addAuthorText(AuthorEntry* newEntry, wxString text)
@@ -489,27 +812,13 @@ void DataManager::addAuthorText(AuthorEntry* newEntry, wxString text)
 	if (authorTextFile==NULL || !authorTextFile->IsOpened())
 		throw new GuiError("Author text file not open, can't append new entry");
 
-	//Write the text at old authorTextDir
-	newEntry->textOffset = authorTextDir;
-	authorTextFile->Seek(authorTextDir, wxFromStart);
+	uint32_t oldDir = authorTextDir;
 	wxScopedCharBuffer buf = authorText.utf8_str();
-	uint16_t l = buf.length();
-	authorTextFile->Write(&l, 2);
-	if (l > 0) authorTextFile->Write(buf.data(), l);
-	//Whole number of blocks - AUTHOR_DESC_BLOCK
-	int blocks = (l / AUTHOR_DESC_BLOCK) + 1;
-	int left = (blocks*AUTHOR_DESC_BLOCK) - l;
-	char ch = 0;
-	for (int i=0; i<left; i++)
-		authorTextFile->Write(&ch, 1);
-
-	authorTextDir += (blocks*AUTHOR_DESC_BLOCK)+2;
-	writeAuthorTextDir(authorTextFile);
-	//Write new authorTextDir
-	authorTextFile->Seek(0, wxFromStart);
-	authorTextFile->Write(&authorTextDir, 4);
-	wxLogVerbose("Appended %i text blocks to author text file, new dir offset is %i",
-		blocks, authorTextDir);
+	newEntry->textOffset = allocAuthorTextSlot(buf.length());
+	writeAuthorTextSlot(newEntry->textOffset, buf);
+	updateAuthorTextDir(authorTextIndex, oldDir);
+	wxLogVerbose("Added text of author %i - offset %i, dir offset is %i",
+		newEntry->dbid, newEntry->textOffset, authorTextDir);
 }
 
 wxString DataManager::getAuthorText(AuthorEntry* ae)
@@ -546,94 +855,64 @@ void DataManager::authorTextModified(AuthorEntry* ae, wxString text)
 		authorTextIndex = getAuthorMasterIndex(ae->dbid);
 
 	wxScopedCharBuffer buf = authorText.utf8_str();
-	int nextOffset;
-	if ((authorTextIndex+1) < authorMaster->size())
-		nextOffset = authorMaster->at(authorTextIndex+1)->textOffset;
-	else
-		nextOffset = authorTextDir;
-	if ((ae->textOffset+buf.length()+2) < nextOffset) {
-		//Have room in existing space - replace
-		authorTextFile->Seek(ae->textOffset, wxFromStart);
-		uint16_t l = buf.length();
-		authorTextFile->Write(&l, 2);
-		if (l > 0) authorTextFile->Write(buf.data(), l);
-		char ch = 0;
-		for (int i=(ae->textOffset+l+2); i<nextOffset; i++)
-			authorTextFile->Write(&ch, 1);
+	if (ae->textOffset>0 && (ae->textOffset+buf.length()+2) <= getAuthorTextSlotEnd(ae->textOffset)) {
+		//Have room in existing slot - replace
+		writeAuthorTextSlot(ae->textOffset, buf);
 		wxLogVerbose("Updated text of author %i - offset %i",
 			ae->dbid, ae->textOffset);
 	} else {
-		//Must rewrite whole file
-		rewriteAuthorText();
+		//Move to a free or appended slot, only the directory entry changes
+		uint32_t oldDir = authorTextDir;
+		if (ae->textOffset > 0)
+			freeAuthorTextSlot(ae->textOffset);
+		ae->textOffset = allocAuthorTextSlot(buf.length());
+		writeAuthorTextSlot(ae->textOffset, buf);
+		updateAuthorTextDir(authorTextIndex, oldDir);
+		wxLogVerbose("Moved text of author %i to offset %i",
+			ae->dbid, ae->textOffset);
 	}
 }
 
-void DataManager::rewriteAuthorText()
+wxTempFile* DataManager::compactAuthorText()
 {
-	AuthorEntry* ae = authorMaster->at(authorTextIndex);
-	wxLogVerbose("Rewriting author text file to fit entry %i", ae->dbid);
+	wxLogVerbose("Compacting author text file, %i of %i bytes free",
+		getAuthorTextFreeBytes(), authorTextDir);
 	wxTempFile* tempFile = new wxTempFile(dbFolder+wxFILE_SEP_PATH+FILE_AUTHORTEXT);
-	authorTextFile->Seek(0, wxFromStart);
-	char buf[1024];
-	int len;
-	//Copy first part of file - from start to ae->textOffset
-	int offs = 0;
-	while (offs < ae->textOffset) {
-		len = (offs+1024 < ae->textOffset)? 1024: ae->textOffset-offs;
-		authorTextFile->Read(buf, len);
-		tempFile->Write(buf, len);
-		offs += len;
-	}
-	//Skip the entry we are replacing in the old file
-	if ((authorTextIndex+1) < authorMaster->size())
-		offs = authorMaster->at(authorTextIndex+1)->textOffset;
-	else
-		offs = authorTextDir;
-	authorTextFile->Seek(offs, wxFromStart);
-
-	//Write authorText to new file
-	wxScopedCharBuffer cbuf = authorText.utf8_str();
-	uint16_t l = cbuf.length();
-	tempFile->Write(&l, 2);
-	if (l > 0) tempFile->Write(cbuf.data(), l);
-	//Whole number of blocks - AUTHOR_DESC_BLOCK
-	int blocks = (l / AUTHOR_DESC_BLOCK) + 1;
-	int left = (blocks*AUTHOR_DESC_BLOCK) - l;
-	char ch = 0;
-	for (int i=0; i<left; i++)
-		tempFile->Write(&ch, 1);
-
-	//Find change in offset for subsequent entries
-	int nextOffset = ae->textOffset + (blocks*AUTHOR_DESC_BLOCK)+2;
-	int offsetDelta = nextOffset - offs;
-
-	//Copy rest of text entries
-	while (offs < authorTextDir) {
-		len = (offs+1024 < authorTextDir)? 1024: authorTextDir-offs;
-		authorTextFile->Read(buf, len);
-		tempFile->Write(buf, len);
-		offs += len;
-	}
-
-	//Update offsets and directory
-	wxLogVerbose("Written updated text of author %i - subsequent offsets moved %i bytes",
-		ae->dbid, offsetDelta);
-	for (int i=authorTextIndex+1; i<authorMaster->size(); i++)
-		(*authorMaster)[i]->textOffset += offsetDelta;
-	authorTextDir += offsetDelta;
+	uint32_t offs = 4;
+	tempFile->Write(&offs, 4); //Dir offset, written when known
+	char buf[AUTHOR_DESC_LIMIT+AUTHOR_DESC_BLOCK] = {0};
+	uint16_t l;
+	uint32_t size;
+	authorTextSlots->clear();
+	authorTextFree->clear();
+	for (vector<AuthorEntry*>::iterator it=authorMaster->begin(); it != authorMaster->end(); ++it) {
+		if ((*it)->textOffset == 0)
+			continue;
+		authorTextFile->Seek((*it)->textOffset, wxFromStart);
+		authorTextFile->Read(&l, 2);
+		if (l > AUTHOR_DESC_LIMIT) l = AUTHOR_DESC_LIMIT;
+		if (l > 0) authorTextFile->Read(buf, l);
+		//Whole number of blocks - AUTHOR_DESC_BLOCK
+		size = ((l / AUTHOR_DESC_BLOCK) + 1)*AUTHOR_DESC_BLOCK;
+		for (uint32_t i=l; i<size; i++)
+			buf[i] = 0;
+		tempFile->Write(&l, 2);
+		tempFile->Write(buf, size);
+		(*it)->textOffset = offs;
+		authorTextSlots->insert(offs);
+		offs += size+2;
+	}
+	authorTextDir = offs;
+	uint32_t zero = 0;
 	for (vector<AuthorEntry*>::iterator it=authorMaster->begin(); it != authorMaster->end(); ++it) {
 		tempFile->Write(&((*it)->dbid), 4);
 		tempFile->Write(&((*it)->textOffset), 4);
 	}
+	tempFile->Write(&zero, 4);
+	tempFile->Write(&zero, 4);
 	tempFile->Seek(0, wxFromStart);
 	tempFile->Write(&authorTextDir, 4);
-
-	closeAuthorTextFile();
-	tempFile->Commit();
-	delete tempFile;
-	wxLogVerbose("Finished rewriting author text file, new dir offset is %i",
-		authorTextDir);
-	openAuthorTextFile();
+	return tempFile;
 }
 
 void DataManager::addAuthor(AuthorEntry* newEntry, wxString text)
@@ -645,6 +924,8 @@ void DataManager::addAuthor(AuthorEntry* newEntry, wxString text)
 	authorMaster->push_back(newEntry);
 	authorList->push_back(newEntry);
 	authorList->sort(author_comp);
+	if (newEntry->type > 0)
+		indexAuthorGroups();
 	listener->onTotalCounts(wadMaster.size(), mapMaster.size(), authorMaster->size());
 	addAuthorText(newEntry, text);
 }
@@ -653,11 +934,16 @@ void DataManager::authorModified(AuthorEntry* author)
 {
 	author->modified |= OF_MAINMOD;
 	authorMod = true;
+	if (dynamic_cast<AuthorGroupEntry*>(author) != NULL)
+		indexAuthorGroups(); //Members may have changed
 	authorList->sort(author_comp);
+	clearSortCache();
+	listener->onEntryModified(1, 0);
 }
 
 void DataManager::deleteAuthor(AuthorEntry* author)
 {
+	waitForMaps();
 	author->modified |= OFLG_DELETE;
 	removeAuthorFromMaps(author);
 	removeAuthorFromGroups(author); //Empty groups will get OFLG_DELETE
@@ -667,6 +953,7 @@ void DataManager::deleteAuthor(AuthorEntry* author)
 
 void DataManager::mergeAuthors(AuthorEntry* authorDelete, AuthorEntry* authorKeep)
 {
+	waitForMaps();
 	authorDelete->modified |= OFLG_DELETE;
 	removeAuthorFromMaps(authorDelete, authorKeep);
 	removeAuthorFromGroups(authorDelete, authorKeep);
@@ -708,6 +995,8 @@ void DataManager::authorDeleteImpl()
 	vector<AuthorEntry*>* newMaster = new vector<AuthorEntry*>();
 	for (vector<AuthorEntry*>::iterator it=authorMaster->begin(); it != authorMaster->end(); ++it) {
 		if ((*it)->modified & OFLG_DELETE) {
+			if ((*it)->textOffset > 0)
+				freeAuthorTextSlot((*it)->textOffset);
 			delete (*it);
 			delCount++;
 		} else {
@@ -716,15 +1005,18 @@ void DataManager::authorDeleteImpl()
 	}
 	delete authorMaster;
 	authorMaster = newMaster;
+	indexAuthorGroups(); //Groups and members may be gone
 
 	//Rewrite text file directory, at same offset (text is unchanged).
-	//Text of deleted authors stay in place, but the space is free to be reused.
+	//Text of deleted authors stay in place, as free slots to be reused.
 	if (authorTextFile==NULL)
 		openAuthorTextFile();
 	authorTextFile->Seek(authorTextDir, wxFromStart);
 	writeAuthorTextDir(authorTextFile);
 
 	listener->onTotalCounts(wadMaster.size(), mapMaster.size(), authorMaster->size());
+	clearSortCache();
+	listener->onEntryModified(1, 0);
 	wxLogVerbose("Deleted %i author entries", delCount);
 	saveAuthors();
 
@@ -875,7 +1167,7 @@ void DataManager::loadAuthors()
 			group->pointers[j] = getAuthorMasterEntry(group->entryIds[j]);
 		}
 	}
-	listener->onTotalCounts(wadMaster.size(), mapMaster.size(), authorMaster->size());
+	indexAuthorGroups();
 	wxLogVerbose("Finished reading %i entries", authorMaster->size());
 }
 
@@ -897,6 +1189,8 @@ void DataManager::setAuthorNaming(AuthorNaming an)
 		delete authorList;
 		makeAuthorList();
 	}
+	clearSortCache();
+	listener->onEntryModified(1, 0);
 }
 
 wxString DataManager::getAuthorString(AuthorEntry* ae)
@@ -906,13 +1200,53 @@ wxString DataManager::getAuthorString(AuthorEntry* ae)
 
 unsigned int DataManager::getMapAuthorCount(uint32_t dbid)
 {
-	unsigned int result = 0;
-	AuthorFilter af = AuthorFilter(FILTER_MAP, dbid);
-	for (vector<MapEntry*>::iterator it=mapMaster.begin(); it!=mapMaster.end(); ++it) {
-		if (af.includes(*it))
-			result++;
+	waitForMaps();
+	AuthorEntry* author = getAuthorMasterEntry(dbid);
+	if (author == NULL)
+		return 0;
+	vector<AuthorEntry*> groups;
+	findAuthorGroups(author, groups);
+	if (groups.empty())
+		return authorIndex->count(dbid);
+	//Union of maps by the author and each group
+	set<MapEntry*> maps;
+	set<MapEntry*>* authMaps = authorIndex->getMaps(dbid);
+	if (authMaps != NULL)
+		maps.insert(authMaps->begin(), authMaps->end());
+	for (vector<AuthorEntry*>::iterator it=groups.begin(); it!=groups.end(); ++it) {
+		authMaps = authorIndex->getMaps((*it)->dbid);
+		if (authMaps != NULL)
+			maps.insert(authMaps->begin(), authMaps->end());
+	}
+	return maps.size();
+}
+
+void DataManager::findAuthorGroups(AuthorEntry* auth, vector<AuthorEntry*>& groups)
+{
+	map<uint32_t, vector<AuthorEntry*> >::iterator git = authorGroups->find(auth->dbid);
+	if (git == authorGroups->end())
+		return;
+	for (vector<AuthorEntry*>::iterator it=git->second.begin(); it != git->second.end(); ++it) {
+		if (find(groups.begin(), groups.end(), *it) == groups.end()) {
+			groups.push_back(*it);
+			findAuthorGroups(*it, groups);
+		}
+	}
+}
+
+void DataManager::indexAuthorGroups()
+{
+	authorGroups->clear();
+	AuthorGroupEntry* age;
+	for (vector<AuthorEntry*>::iterator it=authorMaster->begin(); it != authorMaster->end(); ++it) {
+		if ((*it)->type > 0) {
+			age = dynamic_cast<AuthorGroupEntry*>(*it);
+			for (int i=0; i<age->type; i++) {
+				if (age->pointers[i] != NULL)
+					(*authorGroups)[age->pointers[i]->dbid].push_back(age);
+			}
+		}
 	}
-	return result;
 }
 
 void DataManager::makeAuthorList()
@@ -1045,20 +1379,25 @@ void DataManager::addTag(TagEntry* newEntry)
 void DataManager::tagModified(TagEntry* tag)
 {
 	tagList->sort(tag_comp);
+	listener->onEntryModified(1, 0);
 }
 
 void DataManager::deleteTag(TagEntry* tag)
 {
+	waitForMaps();
 	tag->tag = "";
 	tagList->remove(tag);
 	removeTagFromMaps(tag->dbid);
+	listener->onEntryModified(1, 0);
 }
 
 void DataManager::mergeTags(TagEntry* tagDelete, uint16_t tagKeep)
 {
+	waitForMaps();
 	tagDelete->tag = "";
 	tagList->remove(tagDelete);
 	removeTagFromMaps(tagDelete->dbid, tagKeep);
+	listener->onEntryModified(1, 0);
 }
 
 void DataManager::saveTags()
@@ -1211,6 +1550,7 @@ void DataManager::clearTagFilter()
 
 void DataManager::addWad(WadEntry* newEntry)
 {
+	waitForMaps();
 	newEntry->dbid = nextWadId++;
 	newEntry->ownFlags |= OF_MAINNEW;
 	newEntry->ownFlags |= OF_OWNNEW;
@@ -1220,10 +1560,8 @@ void DataManager::addWad(WadEntry* newEntry)
 		wadMod = true; //Must write complete file
 	wadMaster.push_back(newEntry);
 	searchIter = wadMaster.begin();
-	if (currentWadFilter->includes(newEntry)) {
-		wadList->add(newEntry);
-		wadList->sort(currentWadFilter->sortReverse);
-	}
+	clearSortCache();
+	bool listChanged = updateWadList(newEntry);
 	if (wadMod || wadOwnMod) {
 		//We must write both files if we have both modified
 		//and new entries.
@@ -1233,6 +1571,7 @@ void DataManager::addWad(WadEntry* newEntry)
 
 	if (newEntry->numberOfMaps > 0) {
 		MapEntry* mapEntry;
+		vector<MapEntry*> newMaps;
 		if (firstNewMap == -1)
 			firstNewMap = mapMaster.size();
 		if (firstNewMap == 0)
@@ -1243,27 +1582,34 @@ void DataManager::addWad(WadEntry* newEntry)
 			mapEntry->ownFlags |= OF_MAINNEW;
 			mapEntry->ownFlags |= OF_OWNNEW;
 			mapMaster.push_back(mapEntry);
-			if (currentMapFilter->includes(mapEntry))
-				mapList->add(mapEntry);
+			indexMap(mapEntry);
+			newMaps.push_back(mapEntry);
 		}
-		mapList->sort(currentMapFilter->sortReverse);
+		insertMaps(newMaps);
 		if (mapMod || mapOwnMod) {
 			mapMod = true;
 			mapOwnMod = true;
 		}
 	}
+	if (listChanged)
+		listener->onListChanged(0);
 	listener->onTotalCounts(wadMaster.size(), mapMaster.size(), authorMaster->size());
 }
 
 void DataManager::wadModified(WadEntry* wad)
 {
+	waitForMaps();
 	if (wad->dbid != 0) {
 		if (wad->ownFlags&OF_MAINMOD)
 			wadMod=true;
 		if (wad->ownFlags&OF_OWNMOD)
 			wadOwnMod=true;
+		clearSortCache();
+		listener->onEntryModified(0, wad->dbid);
+		if (updateWadList(wad))
+			listener->onListChanged(0);
 		MapEntry* mapEntry;
-		bool newMaps = false;
+		vector<MapEntry*> newMaps;
 		for (int i=0; i<wad->numberOfMaps; i++) {
 			mapEntry = wad->mapPointers[i];
 			if (mapEntry->dbid == 0) {
@@ -1274,15 +1620,14 @@ void DataManager::wadModified(WadEntry* wad)
 				mapEntry->ownFlags |= OF_MAINNEW;
 				mapEntry->ownFlags |= OF_OWNNEW;
 				mapMaster.push_back(mapEntry);
-				if (currentMapFilter->includes(mapEntry))
-					mapList->add(mapEntry);
-				newMaps = true;
+				indexMap(mapEntry);
+				newMaps.push_back(mapEntry);
 			} else {
 				mapModified(mapEntry);
 			}
 		}
-		if (newMaps) {
-			mapList->sort(currentMapFilter->sortReverse);
+		if (!newMaps.empty()) {
+			insertMaps(newMaps);
 			if (mapMod || mapOwnMod) {
 				mapMod = true;
 				mapOwnMod = true;
@@ -1294,11 +1639,23 @@ void DataManager::wadModified(WadEntry* wad)
 
 void DataManager::mapModified(MapEntry* me)
 {
+	waitForMaps();
 	if (me->dbid != 0) {
 		if (me->ownFlags&OF_MAINMOD)
 			mapMod=true;
 		if (me->ownFlags&OF_OWNMOD)
 			mapOwnMod=true;
+		indexMap(me);
+		clearSortCache();
+		listener->onEntryModified(1, me->dbid);
+		if (updateMapList(me))
+			listener->onListChanged(1);
+		if ((me->ownFlags&OF_OWNMOD) && me->wadPointer!=NULL) {
+			//The wad shows, sorts and filters on the total play time of its maps
+			listener->onEntryModified(0, me->wadPointer->dbid);
+			if (updateWadList(me->wadPointer))
+				listener->onListChanged(0);
+		}
 	}
 }
 
@@ -1438,6 +1795,7 @@ void DataManager::loadWads()
 		throw GuiError("Wad database file has unsupported version number", FILE_WADDB);
 
 	WadEntry* entry;
+	string text;
 	while (!buf->Eof()) {
 		buf->Read(&id, 4);
 		buf->Read(&ch, 1);
@@ -1447,25 +1805,31 @@ void DataManager::loadWads()
 		do { //fileName
 			buf->Read(&ch, 1);
 			if (ch != 0)
-				entry->fileName += ch;
+				text += ch;
 
 		} while (ch != 0);
+		entry->fileName = text;
+		text.clear();
 		buf->Read(&(entry->fileSize), 4);
 		buf->Read(entry->md5Digest, 16);
 		do { //extraFiles
 			buf->Read(&ch, 1);
 			if (ch != 0)
-				entry->extraFiles += ch;
+				text += ch;
 
 		} while (ch != 0);
+		entry->extraFiles = text;
+		text.clear();
 		buf->Read(&(entry->idGames), 4);
 
 		do { //title
 			buf->Read(&ch, 1);
 			if (ch != 0)
-				entry->title += ch;
+				text += ch;
 
 		} while (ch != 0);
+		entry->title = text;
+		text.clear();
 		buf->Read(&(entry->year), 2);
 		buf->Read(&(entry->iwad), 1);
 		buf->Read(&(entry->engine), 1);
@@ -1481,7 +1845,6 @@ void DataManager::loadWads()
 		nextWadId = wadMaster.back()->dbid + 1;
 		searchIter = wadMaster.begin();
 	}
-	listener->onTotalCounts(wadMaster.size(), mapMaster.size(), authorMaster->size());
 	wxLogVerbose("Finished reading %i wad entries", wadMaster.size());
 	delete buf;
 
@@ -1515,122 +1878,56 @@ void DataManager::loadWads()
 	delete buf;
 }
 
-void DataManager::loadMaps()
+void DataManager::startMapLoad(wxEvtHandler* handler)
 {
 	mapMaster.clear();
-	wxString fname(dbFolder+wxFILE_SEP_PATH+FILE_MAPDB);
-	if (!wxFile::Exists(fname)) {
-		wxLogVerbose("File %s not found", FILE_MAPDB);
+	authorIndex->clear();
+	tagIndex->clear();
+	basedOnIndex->clear();
+	loadError.Clear();
+	mapLoader = new MapLoadJob(handler, dbFolder);
+	mapLoadId = mapLoader->getJobId();
+	if (mapLoader->Run() != wxTHREAD_NO_ERROR) {
+		delete mapLoader;
+		mapLoader = NULL;
+	}
+}
+
+void DataManager::loadMaps(wxEvtHandler* handler)
+{
+	if (mapLoader == NULL) { //No thread, read them here
+		MapLoadJob job(NULL, dbFolder);
+		job.setLinks(wadMaster, *authorMaster);
+		if (!job.readMaps())
+			throw GuiError(job.getError(), job.getErrorFile());
+		job.linkMaps();
+		takeMaps(&job);
 		return;
 	}
-	wxLogVerbose("Reading all map entries from file %s", FILE_MAPDB);
-	wxFileInputStream fileStream(fname);
-	if (!fileStream.IsOk()) throw GuiError("Couldn't open file.", FILE_MAPDB);
-	wxBufferedInputStream* buf = new wxBufferedInputStream(fileStream, 1024);
+	mapLoader->setLinks(wadMaster, *authorMaster);
+	if (handler != NULL) {
+		wxLogVerbose("Reading map entries in the background");
+		return;
+	}
+	completeLoad();
+	if (!loadError.IsEmpty())
+		throw GuiError(loadError);
+}
 
-	unsigned char ch;
-	uint32_t id;
-	buf->Read(&ch, 1);
-	if (ch != MAPDB_FILEV)
-		throw GuiError("Map database file has unsupported version number", FILE_MAPDB);
-
-	MapEntry* entry;
-	wxString str;
-	double doubl;
-	uint16_t* tagPtr;
-	while (!buf->Eof()) {
-		buf->Read(&id, 4);
-		if (buf->Eof())
-			break;
-		entry = new MapEntry(id);
-		buf->Read(&id, 4); //wad id
-		do { //name
-			buf->Read(&ch, 1);
-			if (ch != 0)
-				entry->name += ch;
-
-		} while (ch != 0);
-		do { //title
-			buf->Read(&ch, 1);
-			if (ch != 0)
-				entry->title += ch;
-
-		} while (ch != 0);
-		buf->Read(&(entry->basedOn), 4);
-
-		//Pointer to wad and authors
-		entry->wadPointer = getWadMasterEntry(id);
-		if (entry->wadPointer==NULL)
-			wxLogVerbose("Map %i missing ref to wad %i", entry->dbid, id);
-		else
-			entry->wadPointer->addMap(entry);
-		buf->Read(&id, 4);
-		if (id != 0)
-			entry->author1 = getAuthorMasterEntry(id);
-		buf->Read(&id, 4);
-		if (id != 0)
-			entry->author2 = getAuthorMasterEntry(id);
-
-		buf->Read(&(entry->singlePlayer), 1);
-		buf->Read(&(entry->cooperative), 1);
-		buf->Read(&(entry->deathmatch), 1);
-		buf->Read(&(entry->otherMode), 1);
-
-		buf->Read(&(entry->linedefs), 4);
-		buf->Read(&(entry->sectors), 2);
-		buf->Read(&(entry->things), 2);
-		buf->Read(&(entry->secrets), 2);
-		buf->Read(&(entry->enemies), 2);
-		buf->Read(&(entry->totalHP), 4);
-
-		//Floats are stored as strings
-		do { //healthRatio
-			buf->Read(&ch, 1);
-			if (ch != 0)
-				str << ch;
-
-		} while (ch != 0);
-		str.ToCDouble(&doubl);
-		entry->healthRatio = doubl;
-		str.Clear();
-
-		do { //armorRatio
-			buf->Read(&ch, 1);
-			if (ch != 0)
-				str << ch;
-
-		} while (ch != 0);
-		str.ToCDouble(&doubl);
-		entry->armorRatio = doubl;
-		str.Clear();
-
-		do { //ammoRatio
-			buf->Read(&ch, 1);
-			if (ch != 0)
-				str << ch;
-
-		} while (ch != 0);
-		str.ToCDouble(&doubl);
-		entry->ammoRatio = doubl;
-		str.Clear();
-
-		do { //area
-			buf->Read(&ch, 1);
-			if (ch != 0)
-				str << ch;
-
-		} while (ch != 0);
-		str.ToCDouble(&doubl);
-		entry->area = doubl;
-		str.Clear();
-
-		tagPtr = entry->tags;
-		buf->Read(tagPtr, MAXTAGS*2);
-		buf->Read(&(entry->rating), 1);
-		buf->Read(&(entry->flags), 1);
-
-		//if (entry->dbid != 2319)
-		mapMaster.push_back(entry);
+void DataManager::takeMaps(MapLoadJob* job)
+{
+	vector<MapEntry*>* maps = job->takeMaps();
+	mapMaster.swap(*maps);
+	delete maps;
+	delete authorIndex;
+	authorIndex = job->takeAuthorIndex();
+	delete tagIndex;
+	tagIndex = job->takeTagIndex();
+	delete basedOnIndex;
+	basedOnIndex = job->takeBasedOnIndex();
+	for (vector<MapEntry*>::iterator it=mapMaster.begin(); it!=mapMaster.end(); ++it) {
+		if ((*it)->wadPointer != NULL)
+			(*it)->wadPointer->addMap(*it);
 	}
 	if (mapMaster.size() == 0) {
 		nextMapId = 1;
@@ -1638,44 +1935,198 @@ void DataManager::loadMaps()
 		nextMapId = mapMaster.back()->dbid + 1;
 	}
 	listener->onTotalCounts(wadMaster.size(), mapMaster.size(), authorMaster->size());
-	wxLogVerbose("Finished reading %i map entries", mapMaster.size());
-	delete buf;
+	logEntryMemory();
+}
 
-	// Add personal fields:
-	fname = dbFolder+wxFILE_SEP_PATH+FILE_MAPOWN;
-	if (!wxFile::Exists(fname)) {
-		wxLogVerbose("File %s not found", FILE_MAPOWN);
-		return;
+bool DataManager::completeLoad()
+{
+	if (mapLoader == NULL)
+		return false;
+	mapLoader->Wait();
+	if (mapLoader->getError().IsEmpty()) {
+		takeMaps(mapLoader);
+	} else {
+		loadError = mapLoader->getError() + " " + mapLoader->getErrorFile();
+		wxLogVerbose("Failed reading maps: %s", loadError);
 	}
-	wxFileInputStream fileStream2(fname);
-	if (!fileStream2.IsOk()) return;
-	buf = new wxBufferedInputStream(fileStream2, 1024);
-	wxLogVerbose("Reading personal map entries from file %s", FILE_MAPOWN);
+	delete mapLoader;
+	mapLoader = NULL;
 
-	buf->Read(&ch, 1);
-	if (ch != MAPDB_FILEV) {
-		wxLogVerbose("Map personal file has unsupported version number");
-		delete buf;
-		return;
+	//Views made while loading had no maps, and wads had no map counts
+	clearSortCache();
+	if (wadList != NULL) {
+		makeWadList();
+		listener->onWadFilter(currentWadFilter->name, wadList->getSize());
+	}
+	if (mapList != NULL) {
+		makeMapList();
+		listener->onMapFilter(currentMapFilter->name, mapList->getSize());
 	}
+	if (wadList != NULL)
+		listener->onEntryModified(0, 0);
+	if (mapList != NULL)
+		listener->onEntryModified(1, 0);
+	return true;
+}
 
-	int index = 0;
-	while (!buf->Eof() && index<mapMaster.size()) {
-		entry = mapMaster.at(index);
-		buf->Read(&id, 4); //Must match entry->dbid
-		buf->Read(&(entry->ownRating), 1);
-		//buf->Read(&(entry->ownFlags), 1);
-		buf->Read(&(entry->played), 1);
-		buf->Read(&(entry->difficulty), 1);
-		buf->Read(&(entry->playTime), 1);
-		index++;
+void DataManager::logEntryMemory()
+{
+	//Estimate of a separate heap block: Header, rounded up to 16 bytes
+	size_t wadBlock = (sizeof(WadEntry) + 2*sizeof(void*) + 15) / 16 * 16;
+	size_t mapBlock = (sizeof(MapEntry) + 2*sizeof(void*) + 15) / 16 * 16;
+
+	size_t wadHeap = 0;
+	for (vector<WadEntry*>::iterator it=wadMaster.begin(); it!=wadMaster.end(); ++it)
+		wadHeap += (*it)->mapPointers.capacity() * sizeof(MapEntry*);
+
+	EntryPool& wadPool = WadEntry::getPool();
+	size_t wadCount = wadMaster.size();
+	wxLogVerbose("Wad entries: %i of %i bytes (%i as heap blocks), %i bytes pooled, %i bytes of map lists, %i bytes per entry",
+		wadCount, wadPool.getSlotSize(), wadBlock, wadPool.getReservedBytes(), wadHeap,
+		(wadCount==0)? 0: (wadPool.getReservedBytes()+wadHeap)/wadCount);
+	EntryPool& mapPool = MapEntry::getPool();
+	size_t mapCount = mapMaster.size();
+	wxLogVerbose("Map entries: %i of %i bytes (%i as heap blocks), %i bytes pooled, %i bytes per entry",
+		mapCount, mapPool.getSlotSize(), mapBlock, mapPool.getReservedBytes(),
+		(mapCount==0)? 0: mapPool.getReservedBytes()/mapCount);
+	StringPool& strings = StringPool::getPool();
+	wxLogVerbose("Entry strings: %i distinct strings in %i bytes",
+		strings.getCount(), strings.getBytes());
+}
+
+//Heap bytes of the list filters and their bitmaps
+static size_t listFilterBytes(list<DataListFilter*>* filters)
+{
+	size_t bytes = 0;
+	for (list<DataListFilter*>::iterator it=filters->begin(); it!=filters->end(); ++it) {
+		bytes += MemoryUsage::listNode(sizeof(DataListFilter*));
+		bytes += MemoryUsage::heapBlock(sizeof(DataListFilter)) + MemoryUsage::stringHeap((*it)->name);
+		bytes += MemoryUsage::heapBlock(sizeof(IdBitmap)) + (*it)->entries->getBytes();
+	}
+	return bytes;
+}
+
+MemoryUsage* DataManager::getMemoryUsage()
+{
+	waitForMaps();
+	MemoryUsage* usage = new MemoryUsage();
+
+	//Entries: Pooled objects, wad map lists and master lists
+	size_t bytes = WadEntry::getPool().getReservedBytes();
+	for (vector<WadEntry*>::iterator it=wadMaster.begin(); it!=wadMaster.end(); ++it)
+		bytes += MemoryUsage::heapBlock((*it)->mapPointers.capacity() * sizeof(MapEntry*));
+	bytes += MemoryUsage::heapBlock(wadMaster.capacity() * sizeof(WadEntry*));
+	usage->add("Wad entries", wadMaster.size(), bytes);
+	bytes = MapEntry::getPool().getReservedBytes();
+	bytes += MemoryUsage::heapBlock(mapMaster.capacity() * sizeof(MapEntry*));
+	usage->add("Map entries", mapMaster.size(), bytes);
+	StringPool& strings = StringPool::getPool();
+	usage->add("Entry strings", strings.getCount(), strings.getBytes());
+
+	//Authors, with the slots of the text file
+	bytes = 0;
+	size_t objects = 0;
+	if (authorMaster != NULL) {
+		objects = authorMaster->size();
+		bytes += MemoryUsage::heapBlock(sizeof(*authorMaster));
+		bytes += MemoryUsage::heapBlock(authorMaster->capacity() * sizeof(AuthorEntry*));
+		for (vector<AuthorEntry*>::iterator it=authorMaster->begin(); it!=authorMaster->end(); ++it) {
+			AuthorEntry* ae = *it;
+			if (dynamic_cast<AuthorGroupEntry*>(ae) != NULL)
+				bytes += MemoryUsage::heapBlock(sizeof(AuthorGroupEntry));
+			else
+				bytes += MemoryUsage::heapBlock(sizeof(AuthorEntry));
+			bytes += MemoryUsage::stringHeap(ae->namef) + MemoryUsage::stringHeap(ae->namel);
+			bytes += MemoryUsage::stringHeap(ae->alias1) + MemoryUsage::stringHeap(ae->alias2);
+		}
 	}
-	wxLogVerbose("Finished reading %i map entries", index);
-	delete buf;
+	if (authorList != NULL)
+		bytes += MemoryUsage::heapBlock(sizeof(*authorList)) + authorList->size()*MemoryUsage::listNode(sizeof(AuthorEntry*));
+	bytes += 2*MemoryUsage::heapBlock(sizeof(*authorTextSlots));
+	bytes += (authorTextSlots->size() + authorTextFree->size()) * MemoryUsage::treeNode(sizeof(uint32_t));
+	bytes += MemoryUsage::heapBlock(sizeof(*authorGroups));
+	map<uint32_t, vector<AuthorEntry*> >::iterator git;
+	for (git=authorGroups->begin(); git!=authorGroups->end(); ++git)
+		bytes += MemoryUsage::treeNode(sizeof(*git)) + MemoryUsage::heapBlock(git->second.capacity()*sizeof(AuthorEntry*));
+	bytes += MemoryUsage::stringHeap(authorText);
+	usage->add("Authors", objects, bytes);
+
+	bytes = MemoryUsage::heapBlock(tagMaster.capacity() * sizeof(TagEntry*));
+	for (vector<TagEntry*>::iterator it=tagMaster.begin(); it!=tagMaster.end(); ++it)
+		bytes += MemoryUsage::heapBlock(sizeof(TagEntry)) + MemoryUsage::stringHeap((*it)->tag);
+	if (tagList != NULL)
+		bytes += MemoryUsage::heapBlock(sizeof(*tagList)) + tagList->size()*MemoryUsage::listNode(sizeof(TagEntry*));
+	usage->add("Tags", tagMaster.size(), bytes);
+
+	//Map indexes, counted by keys
+	usage->add("Author index", authorIndex->keyCount(), authorIndex->getBytes());
+	usage->add("Tag index", tagIndex->keyCount(), tagIndex->getBytes());
+	usage->add("Based-on index", basedOnIndex->keyCount(), basedOnIndex->getBytes());
+
+	//Views of the current filters
+	if (wadList != NULL)
+		usage->add("Wad list view", wadList->getSize(), wadList->getBytes());
+	if (mapList != NULL)
+		usage->add("Map list view", mapList->getSize(), mapList->getBytes());
+
+	//Text of the current wad and the directory of all wad texts
+	bytes = 0;
+	objects = 0;
+	if (wadText != NULL) {
+		bytes += MemoryUsage::heapBlock(sizeof(WadText)) + MemoryUsage::stringHeap(wadText->wadMd5);
+		bytes += MemoryUsage::heapBlock(sizeof(*wadText->entries));
+		map<string, wxString>::iterator it;
+		for (it=wadText->entries->begin(); it!=wadText->entries->end(); ++it) {
+			bytes += MemoryUsage::treeNode(sizeof(*it));
+			bytes += MemoryUsage::stringHeap(it->first) + MemoryUsage::stringHeap(it->second);
+		}
+	}
+	if (wadTextStore != NULL) {
+		objects = wadTextStore->size();
+		bytes += MemoryUsage::heapBlock(sizeof(WadTextStore)) + wadTextStore->getBytes();
+	}
+	usage->add("Wad text", objects, bytes);
+
+	usage->add("List filters", wadLists->size()+mapLists->size(),
+		listFilterBytes(wadLists) + listFilterBytes(mapLists));
+
+	//Caches made for sorting and filtering: Sorted lists and range indexes
+	bytes = 2*MemoryUsage::heapBlock(sizeof(*wadSortCache)) + 2*MemoryUsage::heapBlock(sizeof(*wadSortUsed));
+	for (map<string, vector<WadEntry*>*>::iterator it=wadSortCache->begin(); it!=wadSortCache->end(); ++it) {
+		bytes += MemoryUsage::treeNode(sizeof(*it)) + MemoryUsage::stringHeap(it->first);
+		bytes += MemoryUsage::heapBlock(sizeof(*it->second)) + MemoryUsage::heapBlock(it->second->capacity()*sizeof(WadEntry*));
+	}
+	for (map<string, vector<MapEntry*>*>::iterator it=mapSortCache->begin(); it!=mapSortCache->end(); ++it) {
+		bytes += MemoryUsage::treeNode(sizeof(*it)) + MemoryUsage::stringHeap(it->first);
+		bytes += MemoryUsage::heapBlock(sizeof(*it->second)) + MemoryUsage::heapBlock(it->second->capacity()*sizeof(MapEntry*));
+	}
+	for (list<string>::iterator it=wadSortUsed->begin(); it!=wadSortUsed->end(); ++it)
+		bytes += MemoryUsage::listNode(sizeof(string)) + MemoryUsage::stringHeap(*it);
+	for (list<string>::iterator it=mapSortUsed->begin(); it!=mapSortUsed->end(); ++it)
+		bytes += MemoryUsage::listNode(sizeof(string)) + MemoryUsage::stringHeap(*it);
+	usage->add("Sort caches", wadSortCache->size()+mapSortCache->size(), bytes);
+
+	bytes = 2*MemoryUsage::heapBlock(sizeof(*wadRangeIndex));
+	map<WadMapFields, RangeIndex<WadEntry*>*>::iterator wit;
+	for (wit=wadRangeIndex->begin(); wit!=wadRangeIndex->end(); ++wit)
+		bytes += MemoryUsage::treeNode(sizeof(*wit)) + MemoryUsage::heapBlock(sizeof(*wit->second)) + wit->second->getBytes();
+	map<WadMapFields, RangeIndex<MapEntry*>*>::iterator mit;
+	for (mit=mapRangeIndex->begin(); mit!=mapRangeIndex->end(); ++mit)
+		bytes += MemoryUsage::treeNode(sizeof(*mit)) + MemoryUsage::heapBlock(sizeof(*mit->second)) + mit->second->getBytes();
+	usage->add("Range indexes", wadRangeIndex->size()+mapRangeIndex->size(), bytes);
+
+	wxLogVerbose("Memory usage: %i bytes", usage->getTotalBytes());
+	return usage;
 }
 
 void DataManager::saveWadsMaps()
 {
+	waitForMaps();
+	if (!loadError.IsEmpty()) {
+		//The maps in memory are not those of the files, and the wads have no maps
+		wxLogVerbose("Not writing wad and map entries, as maps failed to load");
+		return;
+	}
 	//NOTE: Can't mix firstNew with Mod/OwnMod, unless BOTH Mod and OwnMod are true
 
 	// WadEntries:
@@ -1802,36 +2253,8 @@ WadText* DataManager::getWadText(WadEntry* wad)
 	}
 
 	wadText = new WadText(md5str);
-	wxString filePath = getTextFolder()+wxFILE_SEP_PATH+md5str+".txt";
-	if (wxFileExists(filePath)) {
-		wxLogVerbose("Reading wad text file %s", md5str);
-		wxTextFile* tFile = new wxTextFile(filePath);
-		if (!tFile->Open()) throw GuiError("Couldn't open text file.", filePath);
-		wxString line;
-		wxString entryName = "";
-		wxString entry = "";
-		for ( line=tFile->GetFirstLine(); !tFile->Eof(); line=tFile->GetNextLine() ) {
-			if (line.StartsWith("$")) {
-				//Marks next entry
-				if (entryName.Length() > 0) {
-					//Store last entry
-					wadText->setText(entryName.ToStdString(), entry);
-					entryName.Clear();
-					entry.Clear();
-				}
-				line.StartsWith("$", &entryName); //Gets rest of line
-				//wxLogVerbose("Found entry %s", entryName);
-			} else {
-				//Add to current entry
-				entry.Append(line);
-			}
-		}
-		if (entryName.Length() > 0) {
-			//Store last entry
-			wadText->setText(entryName.ToStdString(), entry);
-		}
-		wxLogVerbose("Loaded %i text entries", wadText->entries->size());
-	}
+	if (wadTextStore->readText(wadText))
+		wxLogVerbose("Loaded %i text entries for wad %s", wadText->entries->size(), md5str);
 	wadText->changed = false;
 	return wadText;
 }
@@ -1841,32 +2264,41 @@ void DataManager::saveWadText(WadText* wt)
 	if (wadText!=NULL && wadText!=wt)
 		delete wadText;
 	wadText = wt;
-	if (!wadText->hasText())
-		return;
+	wxLogVerbose("Writing wad text %s", wadText->wadMd5);
+	wadTextStore->writeText(wadText);
+}
 
-	wxString filePath = getTextFolder()+wxFILE_SEP_PATH+wadText->wadMd5+".txt";
-	wxLogVerbose("Writing wad text file %s", wadText->wadMd5);
-	wxFile* file = new wxFile(filePath, wxFile::write);
-	if (!file->IsOpened()) throw GuiError("Couldn't open file.", filePath);
+void DataManager::getWadTexts(vector<WadEntry*>& wads, vector<WadText*>& texts)
+{
+	vector<WadText*> toRead;
+	for (vector<WadEntry*>::iterator it=wads.begin(); it!=wads.end(); ++it) {
+		WadText* wt = new WadText((*it)->getMd5String());
+		texts.push_back(wt);
+		toRead.push_back(wt);
+	}
+	int count = wadTextStore->readTexts(toRead);
+	wxLogVerbose("Loaded text of %i of %i wads", count, wads.size());
+}
 
-	char nl = '\n';
-	char tag = '$';
-	if (wadText->entries->size() > 0) {
-		for (map<string,wxString>::iterator it=wadText->entries->begin(); it!=wadText->entries->end(); ++it) {
-			file->Write(&tag, 1);
-			file->Write(it->first);
-			file->Write(&nl, 1);
-			file->Write(it->second);
-			file->Write(&nl, 1);
-		}
+void DataManager::findWadsByText(const wxString& searchStr, vector<WadEntry*>& result)
+{
+	vector<string> md5s;
+	wadTextStore->findText(searchStr.Lower(), md5s);
+	WadEntry* we;
+	for (vector<string>::iterator it=md5s.begin(); it!=md5s.end(); ++it) {
+		unsigned char digest[16];
+		for (int i=0; i<16; i++)
+			digest[i] = (unsigned char) strtoul(it->substr(i*2, 2).c_str(), NULL, 16);
+		we = findWad(digest);
+		if (we != NULL)
+			result.push_back(we);
 	}
-	file->Close();
-	delete file;
-	wadText->changed = false;
+	wxLogVerbose("Found text \"%s\" for %i wads", searchStr, result.size());
 }
 
 void DataManager::deleteMap(MapEntry* me, long index)
 {
+	waitForMaps();
 	if (me->wadPointer->numberOfMaps < 2) {
 		//Delete whole wad
 		deleteWad(me->wadPointer);
@@ -1876,36 +2308,26 @@ void DataManager::deleteMap(MapEntry* me, long index)
 		deleteMapFiles(me);
 		//Remove map section from WadText
 		WadText* wt = getWadText(me->wadPointer);
-		if (wt->removeText(me->name)) {
+		if (wt->removeText(me->name.str())) {
 			//Map section was removed
 			//Note that if we only have one map left after deleting,
 			//only the wad entry is used.
-			if (wt->hasText()) {
-				saveWadText(wt);
-			} else {
-				//Delete file, since there are no entries left
-				wxString textPath = getTextFolder()+wxFILE_SEP_PATH+me->wadPointer->getMd5String()+".txt";
-				if (wxFileExists(textPath)) {
-					if (wxRemoveFile(textPath))
-						wxLogVerbose("Deleted text file for wad %s", me->wadPointer->fileName);
-					else
-						wxLogVerbose("Failed to delete text file for wad %s", me->wadPointer->fileName);
-				}
-				delete wadText;
-				wadText = NULL;
-			}
+			//The store removes the record if there are no entries left
+			saveWadText(wt);
 		}
 		wxLogVerbose("Delete map with dbid %i", me->dbid);
 		me->wadPointer->removeMap(i, false);
 		wadMod = true;
+		listener->onEntryModified(0, me->wadPointer->dbid); //Map count changed
+		unindexMap(me);
 		removeBasedOn(me->dbid);
 		removeMapFromFilters(me->dbid);
 		removeMapMaster(me->dbid);
+		if (index < 0)
+			index = mapList->find(me);
 		if (index >= 0) {
-			mapList->setIndex(index);
-			mapList->erase();
-		} else {
-			makeMapList();
+			mapList->remove(index);
+			listener->onListChanged(1);
 		}
 		delete me;
 		listener->onTotalCounts(wadMaster.size(), mapMaster.size(), authorMaster->size());
@@ -1914,6 +2336,7 @@ void DataManager::deleteMap(MapEntry* me, long index)
 
 void DataManager::deleteWad(WadEntry* we, long index)
 {
+	waitForMaps();
 	if (wadText != NULL) {
 		delete wadText;
 		wadText = NULL;
@@ -1921,24 +2344,32 @@ void DataManager::deleteWad(WadEntry* we, long index)
 	deleteWadFiles(we);
 	//Delete maps
 	MapEntry* me;
+	bool mapsRemoved = false;
 	for (int i=0; i<we->numberOfMaps; i++) {
 		me = we->mapPointers.at(i);
 		wxLogVerbose("Delete map with dbid %i", me->dbid);
+		unindexMap(me);
 		removeBasedOn(me->dbid);
 		removeMapFromFilters(me->dbid);
 		removeMapMaster(me->dbid);
+		long listIndex = mapList->find(me);
+		if (listIndex >= 0) {
+			mapList->remove(listIndex);
+			mapsRemoved = true;
+		}
 		delete me;
 	}
-	makeMapList();
+	if (mapsRemoved)
+		listener->onListChanged(1);
 	//Delete wad
 	wxLogVerbose("Delete wad with dbid %i", we->dbid);
 	removeWadFromFilters(we->dbid);
 	removeWadMaster(we->dbid);
+	if (index < 0)
+		index = wadList->find(we);
 	if (index >= 0) {
-		wadList->setIndex(index);
-		wadList->erase();
-	} else {
-		makeWadList();
+		wadList->remove(index);
+		listener->onListChanged(0);
 	}
 	delete we;
 	listener->onTotalCounts(wadMaster.size(), mapMaster.size(), authorMaster->size());
@@ -1965,14 +2396,9 @@ void DataManager::deleteMapFiles(MapEntry* me)
 
 void DataManager::deleteWadFiles(WadEntry* wad)
 {
-	wxLogVerbose("Deleting files for wad %s", wad->fileName);
-	wxString textPath = getTextFolder()+wxFILE_SEP_PATH+wad->getMd5String()+".txt";
-	if (wxFileExists(textPath)) {
-		if (wxRemoveFile(textPath))
-			wxLogVerbose("Deleted text file for wad %s", wad->fileName);
-		else
-			wxLogVerbose("Failed to delete text file for wad %s", wad->fileName);
-	}
+	wxLogVerbose("Deleting files for wad %s", wad->fileName.str());
+	if (wadTextStore->removeText(wad->getMd5String()))
+		wxLogVerbose("Deleted text for wad %s", wad->fileName.str());
 	wxString imgFolder = getMapImgFolder();
 	wxString scrFolder = getScreenshotFolder();
 	for (int i=0; i<wad->numberOfMaps; i++) {
@@ -1996,20 +2422,16 @@ void DataManager::deleteWadFiles(WadEntry* wad)
 
 void DataManager::renameFiles(WadEntry* wad, string newHash)
 {
-	wxString oldPath = getTextFolder()+wxFILE_SEP_PATH+wad->getMd5String()+".txt";
+	waitForMaps();
+	if (wadTextStore->renameText(wad->getMd5String(), newHash))
+		wxLogVerbose("Moved text for new wad hash %s", newHash);
+	wxString oldPath;
 	wxString newPath;
-	if (wxFileExists(oldPath)) {
-		newPath = getTextFolder()+wxFILE_SEP_PATH+newHash+".txt";
-		if (wxRenameFile(oldPath, newPath, false))
-			wxLogVerbose("Renamed text file for new wad hash %s", newHash);
-		else
-			wxLogVerbose("Failed to rename text file to new hash %s", newHash);
-	}
 	wxString imgFolder = getMapImgFolder();
 	wxString scrFolder = getScreenshotFolder();
 	for (int i=0; i<wad->numberOfMaps; i++) {
 		wxString filename = wad->mapPointers.at(i)->fileName();
-		wxString newname = wxString(newHash).Append("_").Append(wad->mapPointers.at(i)->name);
+		wxString newname = wxString(newHash).Append("_").Append(wad->mapPointers.at(i)->name.str());
 		oldPath = imgFolder+wxFILE_SEP_PATH+filename+".png";
 		if (wxFileExists(oldPath)) {
 			newPath = imgFolder+wxFILE_SEP_PATH+newname+".png";
@@ -2039,16 +2461,14 @@ void DataManager::initDataFilters(DataFilter* wadFilter, DataFilter* mapFilter)
 	currentWadFilter->addFilter(wadFilter);
 	currentWadFilter->addFilter(new TextSearchFilter(FILTER_WAD, ""));
 	currentWadFilter->name = wadFilter->name;
-	currentWadFilter->sortField = wadFilter->sortField;
-	currentWadFilter->sortReverse = wadFilter->sortReverse;
+	currentWadFilter->copySort(wadFilter);
 	makeWadList();
 	listener->onWadFilter(currentWadFilter->name, wadList->getSize());
 
 	currentMapFilter->addFilter(mapFilter);
 	currentMapFilter->addFilter(new TextSearchFilter(FILTER_MAP, ""));
 	currentMapFilter->name = mapFilter->name;
-	currentMapFilter->sortField = mapFilter->sortField;
-	currentMapFilter->sortReverse = mapFilter->sortReverse;
+	currentMapFilter->copySort(mapFilter);
 	makeMapList();
 	listener->onMapFilter(currentMapFilter->name, mapList->getSize());
 }
@@ -2060,6 +2480,8 @@ bool DataManager::changeDataFilter(DataFilter* dataFilter)
 			//wxLogVerbose("Setting wad filter %s", dataFilter->name);
 			currentWadFilter->filters[0] = dataFilter;
 			currentWadFilter->isChanged = true;
+			if (isWadSortField(dataFilter->sortField))
+				currentWadFilter->copySort(dataFilter);
 		}
 		if (currentWadFilter->hasChanges()) {
 			currentWadFilter->name = dataFilter->name;
@@ -2075,6 +2497,8 @@ bool DataManager::changeDataFilter(DataFilter* dataFilter)
 			//wxLogVerbose("Setting map filter %s", dataFilter->name);
 			currentMapFilter->filters[0] = dataFilter;
 			currentMapFilter->isChanged = true;
+			if (isMapSortField(dataFilter->sortField))
+				currentMapFilter->copySort(dataFilter);
 		}
 		if (currentMapFilter->hasChanges()) {
 			currentMapFilter->name = dataFilter->name;
@@ -2091,10 +2515,10 @@ bool DataManager::changeDataFilter(DataFilter* dataFilter)
 void DataManager::setTextFilter(wxString filterStr, int filterType, bool update)
 {
 	TextSearchFilter* tsf = dynamic_cast<TextSearchFilter*>(currentWadFilter->filters[1]);
-	tsf->searchStr = filterStr;
+	tsf->setSearch(filterStr);
 	tsf->isChanged = true;
 	tsf = dynamic_cast<TextSearchFilter*>(currentMapFilter->filters[1]);
-	tsf->searchStr = filterStr;
+	tsf->setSearch(filterStr);
 	tsf->isChanged = true;
 	if (filterType < FILTER_MAP) { //wad
 		makeWadList(update);
@@ -2119,7 +2543,9 @@ void DataManager::makeWadList(bool update)
 		else
 			activeFilter = currentWadFilter->filters[1];
 		if (!update) {
-			for (vector<WadEntry*>::iterator it=wadMaster.begin(); it!=wadMaster.end(); ++it) {
+			vector<WadEntry*> candidates;
+			vector<WadEntry*>& entries = planWadList(activeFilter, candidates)? candidates: wadMaster;
+			for (vector<WadEntry*>::iterator it=entries.begin(); it!=entries.end(); ++it) {
 				if (activeFilter->includes(*it))
 					newList->add(*it);
 			}
@@ -2139,7 +2565,7 @@ void DataManager::makeWadList(bool update)
 	}
 	if (update) delete wadList;
 	wadList = newList;
-	setWadSort(currentWadFilter->sortField, currentWadFilter->sortReverse);
+	sortWadList();
 }
 
 void DataManager::makeMapList(bool update)
@@ -2156,7 +2582,9 @@ void DataManager::makeMapList(bool update)
 		else
 			activeFilter = currentMapFilter->filters[1];
 		if (!update) {
-			for (vector<MapEntry*>::iterator it=mapMaster.begin(); it!=mapMaster.end(); ++it) {
+			vector<MapEntry*> candidates;
+			vector<MapEntry*>& entries = planMapList(activeFilter, candidates)? candidates: mapMaster;
+			for (vector<MapEntry*>::iterator it=entries.begin(); it!=entries.end(); ++it) {
 				if (activeFilter->includes(*it))
 					newList->add(*it);
 			}
@@ -2176,85 +2604,44 @@ void DataManager::makeMapList(bool update)
 	}
 	if (update) delete mapList;
 	mapList = newList;
-	setMapSort(currentMapFilter->sortField, currentMapFilter->sortReverse);
+	sortMapList();
 }
 
 bool DataManager::setWadSort(WadMapFields sortField, bool reverse)
 {
-	switch (sortField) {
-	case WAD_DBID: wadList->comp = wad_comp_dbid; break;
-	case WAD_FILENAME: wadList->comp = wad_comp_fileName; break;
-	case WAD_FILESIZE: wadList->comp = wad_comp_fileSize; break;
-	//Not WAD_MD5DIGEST, WAD_EXTRAFILES
-	case WAD_IDGAMES: wadList->comp = wad_comp_idgames; break;
-	case WAD_TITLE: wadList->comp = wad_comp_title; break;
-	case WAD_YEAR: wadList->comp = wad_comp_year; break;
-	case WAD_IWAD: wadList->comp = wad_comp_iwad; break;
-	case WAD_ENGINE: wadList->comp = wad_comp_engine; break;
-	case WAD_PLAYSTYLE: wadList->comp = wad_comp_playstyle; break;
-	case WAD_MAPS: wadList->comp = wad_comp_maps; break;
-	//Not flags: WAD_WF_IWAD, WAD_WF_SPRITES, WAD_WF_TEX, WAD_WF_GFX, WAD_WF_COLOR,
-	// WAD_WF_SOUND, WAD_WF_MUSIC, WAD_WF_DEHBEX, WAD_WF_THINGS, WAD_WF_SCRIPT,
-	// WAD_WF_GLNODES, WAD_OF_HAVEFILE
-	case WAD_RATING: wadList->comp = wad_comp_rating; break;
-	case WAD_OWNRATING: wadList->comp = wad_comp_ownrating; break;
-	case WAD_PLAYTIME : wadList->comp = wad_comp_playtime; break;
-	default: return false;
-	}
-	currentWadFilter->sortField = sortField;
-	currentWadFilter->sortReverse = reverse;
-	if (wadList->getIndex() > -1)
-		wadList->sort(currentWadFilter->sortReverse);
+	if (!isWadSortField(sortField))
+		return false;
+	currentWadFilter->setSort(sortField, reverse);
+	keepSort(currentWadFilter);
+	sortWadList();
+	return true;
+}
+
+bool DataManager::addWadSort(WadMapFields sortField, bool reverse)
+{
+	if (!isWadSortField(sortField) || !currentWadFilter->addSort(sortField, reverse))
+		return false;
+	keepSort(currentWadFilter);
+	sortWadList();
 	return true;
 }
 
 bool DataManager::setMapSort(WadMapFields sortField, bool reverse)
 {
-	switch (sortField) {
-	//Wad fields in map list:
-	case WAD_FILENAME: mapList->comp = map_comp_filename; break;
-	//Not WAD_FILESIZE, WAD_MD5DIGEST, WAD_EXTRAFILES
-	case WAD_IDGAMES: mapList->comp = map_comp_idgames; break;
-	case WAD_TITLE: mapList->comp = map_comp_wadtitle; break;
-	case WAD_YEAR: mapList->comp = map_comp_year; break;
-	case WAD_IWAD: mapList->comp = map_comp_iwad; break;
-	case WAD_ENGINE: mapList->comp = map_comp_engine; break;
-	case WAD_PLAYSTYLE: mapList->comp = map_comp_playstyle; break;
-	//Map fields:
-	case MAP_DBID: mapList->comp = map_comp_dbid; break;
-	case MAP_NAME: mapList->comp = map_comp_name; break;
-	case MAP_TITLE: mapList->comp = map_comp_title; break;
-	case MAP_AUTHOR1: mapList->comp = map_comp_author1; break;
-	case MAP_AUTHOR2: mapList->comp = map_comp_author2; break;
-	case MAP_SINGLE: mapList->comp = map_comp_single; break;
-	case MAP_COOP: mapList->comp = map_comp_coop; break;
-	case MAP_DM: mapList->comp = map_comp_dm; break;
-	case MAP_MODE: mapList->comp = map_comp_mode; break;
-	case MAP_LINEDEFS: mapList->comp = map_comp_linedefs; break;
-	case MAP_SECTORS: mapList->comp = map_comp_sectors; break;
-	case MAP_THINGS: mapList->comp = map_comp_things; break;
-	case MAP_SECRETS: mapList->comp = map_comp_secrets; break;
-	case MAP_ENEMIES: mapList->comp = map_comp_enemies; break;
-	case MAP_TOTALHP: mapList->comp = map_comp_totalhp; break;
-	case MAP_AMMORAT: mapList->comp = map_comp_ammorat; break;
-	case MAP_HEALTHRAT: mapList->comp = map_comp_healthrat; break;
-	case MAP_ARMORRAT: mapList->comp = map_comp_armorrat; break;
-	case MAP_AREA: mapList->comp = map_comp_area; break;
-	case MAP_LINEDEF_DENS: mapList->comp = map_comp_lddens; break;
-	case MAP_ENEMY_DENS: mapList->comp = map_comp_enemydens; break;
-	case MAP_HP_DENS: mapList->comp = map_comp_hpdens; break;
-	case MAP_RATING: mapList->comp = map_comp_rating; break;
-	//Not flags: MAP_MF_SPAWN, MAP_MF_MORESPAWN, MAP_MF_DIFFSET, MAP_MF_VOODOO, MAP_MF_UNKNOWN
-	case MAP_OWNRATING: mapList->comp = map_comp_ownrating; break;
-	//case MAP_PLAYED: currently only showed as flag
-	case MAP_DIFFICULTY: mapList->comp = map_comp_difficulty; break;
-	case MAP_PLAYTIME: mapList->comp = map_comp_playtime; break;
-	default: return false;
-	}
-	currentMapFilter->sortField = sortField;
-	currentMapFilter->sortReverse = reverse;
-	if (mapList->getIndex() > -1)
-		mapList->sort(currentMapFilter->sortReverse);
+	if (!isMapSortField(sortField))
+		return false;
+	currentMapFilter->setSort(sortField, reverse);
+	keepSort(currentMapFilter);
+	sortMapList();
+	return true;
+}
+
+bool DataManager::addMapSort(WadMapFields sortField, bool reverse)
+{
+	if (!isMapSortField(sortField) || !currentMapFilter->addSort(sortField, reverse))
+		return false;
+	keepSort(currentMapFilter);
+	sortMapList();
 	return true;
 }
 
@@ -2264,29 +2651,49 @@ WadEntry* DataManager::getWad(long index)
 	return wadList->entry();
 }
 
-int DataManager::getWadIndex(wxString strStart)
-{
-	if ((strStart.Length()==0) || (wadList->getSize()==0))
-        return -1;
-    int index = -1;
-    if (currentWadFilter->sortField == WAD_FILENAME) {
-		wadList->reset();
-		if ( wxString(wadList->entry()->fileName).CmpNoCase(strStart) >= 0)
-			index = wadList->getIndex();
-		while (wadList->next() && index==-1) {
-			if ( wxString(wadList->entry()->fileName).CmpNoCase(strStart) >= 0)
-				index = wadList->getIndex();
-		}
-    } else if (currentWadFilter->sortField == WAD_TITLE) {
-		wadList->reset();
-		if ( wxString(wadList->entry()->title).CmpNoCase(strStart) >= 0)
-			index = wadList->getIndex();
-		while (wadList->next() && index==-1) {
-			if ( wxString(wadList->entry()->title).CmpNoCase(strStart) >= 0)
-				index = wadList->getIndex();
-		}
-    }
-    return index;
+int DataManager::getWadIndex(wxString strStart, long* rangeStart, long* rangeEnd)
+{
+	WadMapFields field = currentWadFilter->sortField;
+	if ((strStart.Length()==0) || (wadList->getSize()==0) || !isWadSortField(field))
+		return -1;
+	uint64_t number;
+	string text;
+	if (!makeSearchKey(field, strStart, number, text))
+		return -1;
+	ColumnKeys keys(1, isTextSortField(field));
+	if (!keys.isText()) {
+		//Matching numbers aren't within the range of a shorter number
+		rangeStart = NULL;
+		rangeEnd = NULL;
+	}
+	bool desc = currentWadFilter->sortReverse;
+	long first = (rangeStart!=NULL)? *rangeStart: 0;
+	long last = (rangeEnd!=NULL && *rangeEnd>=0)? *rangeEnd: wadList->getSize();
+	if (last > (long)wadList->getSize()) last = wadList->getSize(); //Range from older list
+	if (first > last) first = last;
+	long end = last;
+	long mid;
+	int c;
+	//First entry not before the search key
+	while (first < last) {
+		mid = first + (last-first)/2;
+		setWadSortKey(keys, 0, wadList->at(mid), field);
+		c = keys.compareSearch(0, number, text);
+		if (desc? (c>0): (c<0)) first = mid+1;
+		else last = mid;
+	}
+	long index = first;
+	//First entry after those matching
+	last = end;
+	while (first < last) {
+		mid = first + (last-first)/2;
+		setWadSortKey(keys, 0, wadList->at(mid), field);
+		if (keys.compareSearch(0, number, text) == 0) first = mid+1;
+		else last = mid;
+	}
+	if (rangeStart != NULL) *rangeStart = index;
+	if (rangeEnd != NULL) *rangeEnd = first;
+	return (index < (long)wadList->getSize())? index: -1;
 }
 
 WadEntry* DataManager::findWad(uint32_t id)
@@ -2309,82 +2716,139 @@ WadEntry* DataManager::findWad(unsigned char* md5Digest)
 
 WadEntry* DataManager::findWad(string fileName)
 {
+	const PooledString* key = StringPool::getPool().find(fileName);
+	if (key == NULL)
+		return NULL;
 	for (vector<WadEntry*>::iterator it=wadMaster.begin(); it != wadMaster.end(); ++it) {
-		if ((*it)->fileName.compare(fileName) == 0)
+		if ((*it)->fileName.handle() == key)
 			return *it;
 	}
 	return NULL;
 }
 
+set<string>* DataManager::getWadHashes()
+{
+	set<string>* result = new set<string>();
+	for (vector<WadEntry*>::iterator it=wadMaster.begin(); it != wadMaster.end(); ++it)
+		result->insert((*it)->getMd5String());
+	return result;
+}
+
+int DataManager::validate(TextReport* report)
+{
+	waitForMaps();
+	int problems = 0;
+	wxString line;
+	set<uint32_t> ids;
+	set<string> hashes;
+	for (vector<WadEntry*>::iterator it=wadMaster.begin(); it != wadMaster.end(); ++it) {
+		WadEntry* we = *it;
+		line = "";
+		if (!ids.insert(we->dbid).second)
+			line = wxString::Format("Wad %i: Duplicate dbid", we->dbid);
+		else if (!hashes.insert(we->getMd5String()).second)
+			line = wxString::Format("Wad %i: Duplicate MD5 %s", we->dbid, we->getMd5String());
+		else if (we->numberOfMaps > we->mapPointers.size())
+			line = wxString::Format("Wad %i: %i maps, room for %i", we->dbid, we->numberOfMaps, we->mapPointers.size());
+		else {
+			for (int i=0; i<we->numberOfMaps; i++) {
+				MapEntry* me = we->mapPointers[i];
+				if (me == NULL)
+					line = wxString::Format("Wad %i: Map %i missing", we->dbid, i);
+				else if (me->wadPointer != we)
+					line = wxString::Format("Wad %i: Map %i belongs to another wad", we->dbid, me->dbid);
+				if (!line.IsEmpty())
+					break;
+			}
+		}
+		if (!line.IsEmpty()) {
+			problems++;
+			if (report != NULL)
+				report->writeLine(line);
+		}
+	}
+
+	ids.clear();
+	for (vector<MapEntry*>::iterator it=mapMaster.begin(); it != mapMaster.end(); ++it) {
+		if (!ids.insert((*it)->dbid).second) {
+			problems++;
+			if (report != NULL)
+				report->writeLine(wxString::Format("Map %i: Duplicate dbid", (*it)->dbid));
+		}
+	}
+	for (vector<MapEntry*>::iterator it=mapMaster.begin(); it != mapMaster.end(); ++it) {
+		MapEntry* me = *it;
+		line = "";
+		if (me->wadPointer == NULL)
+			line = wxString::Format("Map %i: No wad", me->dbid);
+		else if (me->wadPointer->getMapIndex(me) < 0)
+			line = wxString::Format("Map %i: Not in wad %i", me->dbid, me->wadPointer->dbid);
+		else if (me->basedOn != 0 && ids.find(me->basedOn) == ids.end())
+			line = wxString::Format("Map %i: Based on missing map %i", me->dbid, me->basedOn);
+		if (!line.IsEmpty()) {
+			problems++;
+			if (report != NULL)
+				report->writeLine(line);
+		}
+	}
+	wxLogVerbose("Validated %i wads and %i maps, %i problems", wadMaster.size(), mapMaster.size(), problems);
+	return problems;
+}
+
 MapEntry* DataManager::getMap(long index)
 {
 	mapList->setIndex(index);
 	return mapList->entry();
 }
 
-int DataManager::getMapIndex(wxString strStart)
-{
-	if ((strStart.Length()==0) || (mapList->getSize()==0))
-        return -1;
-    int index = -1;
-    if (currentMapFilter->sortField == MAP_NAME) {
-		mapList->reset();
-		if ( wxString(mapList->entry()->name).CmpNoCase(strStart) >= 0)
-			index = mapList->getIndex();
-		while (mapList->next() && index==-1) {
-			if ( wxString(mapList->entry()->name).CmpNoCase(strStart) >= 0)
-				index = mapList->getIndex();
-		}
-    } else if (currentMapFilter->sortField == MAP_TITLE) {
-		mapList->reset();
-		if ( wxString(mapList->entry()->title).CmpNoCase(strStart) >= 0)
-			index = mapList->getIndex();
-		while (mapList->next() && index==-1) {
-			if ( wxString(mapList->entry()->title).CmpNoCase(strStart) >= 0)
-				index = mapList->getIndex();
-		}
-    } else if (currentMapFilter->sortField == MAP_AUTHOR1) {
-		mapList->reset();
-		AuthorEntry* ae = mapList->entry()->author1;
-		if (ae!=NULL && getAuthorString(ae).CmpNoCase(strStart) >= 0)
-			index = mapList->getIndex();
-		while (mapList->next() && index==-1) {
-			ae = mapList->entry()->author1;
-			if (ae!=NULL && getAuthorString(ae).CmpNoCase(strStart) >= 0)
-				index = mapList->getIndex();
-		}
-    } else if (currentMapFilter->sortField == MAP_AUTHOR2) {
-		mapList->reset();
-		AuthorEntry* ae = mapList->entry()->author2;
-		if (ae!=NULL && getAuthorString(ae).CmpNoCase(strStart) >= 0)
-			index = mapList->getIndex();
-		while (mapList->next() && index==-1) {
-			ae = mapList->entry()->author2;
-			if (ae!=NULL && getAuthorString(ae).CmpNoCase(strStart) >= 0)
-				index = mapList->getIndex();
-		}
-    } else if (currentMapFilter->sortField == WAD_FILENAME) {
-		mapList->reset();
-		if ( wxString(mapList->entry()->wadPointer->fileName).CmpNoCase(strStart) >= 0)
-			index = mapList->getIndex();
-		while (mapList->next() && index==-1) {
-			if ( wxString(mapList->entry()->wadPointer->fileName).CmpNoCase(strStart) >= 0)
-				index = mapList->getIndex();
-		}
-    } else if (currentMapFilter->sortField == WAD_TITLE) {
-		mapList->reset();
-		if ( wxString(mapList->entry()->wadPointer->title).CmpNoCase(strStart) >= 0)
-			index = mapList->getIndex();
-		while (mapList->next() && index==-1) {
-			if ( wxString(mapList->entry()->wadPointer->title).CmpNoCase(strStart) >= 0)
-				index = mapList->getIndex();
-		}
-    }
-    return index;
+int DataManager::getMapIndex(wxString strStart, long* rangeStart, long* rangeEnd)
+{
+	WadMapFields field = currentMapFilter->sortField;
+	if ((strStart.Length()==0) || (mapList->getSize()==0) || !isMapSortField(field))
+		return -1;
+	uint64_t number;
+	string text;
+	if (!makeSearchKey(field, strStart, number, text))
+		return -1;
+	ColumnKeys keys(1, isTextSortField(field));
+	if (!keys.isText()) {
+		//Matching numbers aren't within the range of a shorter number
+		rangeStart = NULL;
+		rangeEnd = NULL;
+	}
+	bool desc = currentMapFilter->sortReverse;
+	long first = (rangeStart!=NULL)? *rangeStart: 0;
+	long last = (rangeEnd!=NULL && *rangeEnd>=0)? *rangeEnd: mapList->getSize();
+	if (last > (long)mapList->getSize()) last = mapList->getSize(); //Range from older list
+	if (first > last) first = last;
+	long end = last;
+	long mid;
+	int c;
+	//First entry not before the search key
+	while (first < last) {
+		mid = first + (last-first)/2;
+		setMapSortKey(keys, 0, mapList->at(mid), field);
+		c = keys.compareSearch(0, number, text);
+		if (desc? (c>0): (c<0)) first = mid+1;
+		else last = mid;
+	}
+	long index = first;
+	//First entry after those matching
+	last = end;
+	while (first < last) {
+		mid = first + (last-first)/2;
+		setMapSortKey(keys, 0, mapList->at(mid), field);
+		if (keys.compareSearch(0, number, text) == 0) first = mid+1;
+		else last = mid;
+	}
+	if (rangeStart != NULL) *rangeStart = index;
+	if (rangeEnd != NULL) *rangeEnd = first;
+	return (index < (long)mapList->getSize())? index: -1;
 }
 
 MapEntry* DataManager::findMap(uint32_t id)
 {
+	waitForMaps();
 	for (vector<MapEntry*>::iterator it=mapMaster.begin(); it != mapMaster.end(); ++it) {
 		if ((*it)->dbid == id)
 			return *it;
@@ -2409,17 +2873,17 @@ wxString DataManager::getWadField(WadEntry* wad, WadMapFields field)
 	case WAD_DBID:
 		return LtbUtils::intToString(wad->dbid);
 	case WAD_FILENAME:
-		return wad->fileName;
+		return wad->fileName.str();
 	case WAD_FILESIZE:
 		return LtbUtils::intToString(wad->fileSize);
 	case WAD_MD5DIGEST:
 		return wad->getMd5String();
 	case WAD_EXTRAFILES:
-		return wad->extraFiles;
+		return wad->extraFiles.str();
 	case WAD_IDGAMES:
 		return LtbUtils::intToString(wad->idGames);
 	case WAD_TITLE:
-		return wad->title;
+		return wad->title.str();
 	case WAD_YEAR:
 		return LtbUtils::intToString(wad->year);
 	case WAD_IWAD:
@@ -2475,9 +2939,9 @@ wxString DataManager::getMapField(MapEntry* me, WadMapFields field)
 	case MAP_DBID:
 		return LtbUtils::intToString(me->dbid);
 	case MAP_NAME:
-		return me->name;
+		return me->name.str();
 	case MAP_TITLE:
-		return me->title;
+		return me->title.str();
 	case MAP_BASEDON:
 		return ""; //TODO: pointer to MapEntry
 	case MAP_AUTHOR1:
@@ -2574,6 +3038,7 @@ void DataManager::removeWadMaster(uint32_t id)
 		if ((*it)->dbid == id) {
 			wadMaster.erase(it);
 			searchIter = wadMaster.begin();
+			clearSortCache();
 			wadMod = true;
 			wadOwnMod = true;
 			return;
@@ -2586,6 +3051,7 @@ void DataManager::removeMapMaster(uint32_t id)
 	for (vector<MapEntry*>::iterator it=mapMaster.begin(); it != mapMaster.end(); ++it) {
 		if ((*it)->dbid == id) {
 			mapMaster.erase(it);
+			clearSortCache();
 			mapMod = true;
 			mapOwnMod = true;
 			return;
@@ -2593,43 +3059,368 @@ void DataManager::removeMapMaster(uint32_t id)
 	}
 }
 
+void DataManager::sortWads(vector<WadEntry*>& entries, const vector<SortKey>& spec, vector<WadEntry*>& result)
+{
+	//Sort on each field, starting with the least significant
+	vector<uint32_t> perm;
+	for (vector<SortKey>::const_reverse_iterator it=spec.rbegin(); it!=spec.rend(); ++it) {
+		ColumnKeys keys(entries.size(), isTextSortField(it->field));
+		for (size_t i=0; i<entries.size(); i++)
+			setWadSortKey(keys, i, entries[i], it->field);
+		keys.sort(perm, it->reverse);
+	}
+	result.clear();
+	result.reserve(entries.size());
+	if (perm.size() != entries.size()) {
+		result = entries;
+		return;
+	}
+	for (vector<uint32_t>::iterator it=perm.begin(); it!=perm.end(); ++it)
+		result.push_back(entries[*it]);
+}
+
+void DataManager::sortMaps(vector<MapEntry*>& entries, const vector<SortKey>& spec, vector<MapEntry*>& result)
+{
+	//Sort on each field, starting with the least significant
+	vector<uint32_t> perm;
+	for (vector<SortKey>::const_reverse_iterator it=spec.rbegin(); it!=spec.rend(); ++it) {
+		ColumnKeys keys(entries.size(), isTextSortField(it->field));
+		for (size_t i=0; i<entries.size(); i++)
+			setMapSortKey(keys, i, entries[i], it->field);
+		keys.sort(perm, it->reverse);
+	}
+	result.clear();
+	result.reserve(entries.size());
+	if (perm.size() != entries.size()) {
+		result = entries;
+		return;
+	}
+	for (vector<uint32_t>::iterator it=perm.begin(); it!=perm.end(); ++it)
+		result.push_back(entries[*it]);
+}
+
+vector<WadEntry*>* DataManager::getSortedWads(const vector<SortKey>& spec)
+{
+	string key = sortSpecKey(spec);
+	map<string, vector<WadEntry*>*>::iterator it = wadSortCache->find(key);
+	if (it != wadSortCache->end()) {
+		wadSortUsed->remove(key);
+		wadSortUsed->push_back(key);
+		return it->second;
+	}
+	if (wadSortCache->size() >= SORT_CACHE_SIZE) {
+		//Drop least recently used order
+		it = wadSortCache->find(wadSortUsed->front());
+		delete it->second;
+		wadSortCache->erase(it);
+		wadSortUsed->pop_front();
+	}
+	vector<WadEntry*>* sorted = new vector<WadEntry*>();
+	sortWads(wadMaster, spec, *sorted);
+	(*wadSortCache)[key] = sorted;
+	wadSortUsed->push_back(key);
+	return sorted;
+}
+
+vector<MapEntry*>* DataManager::getSortedMaps(const vector<SortKey>& spec)
+{
+	string key = sortSpecKey(spec);
+	map<string, vector<MapEntry*>*>::iterator it = mapSortCache->find(key);
+	if (it != mapSortCache->end()) {
+		mapSortUsed->remove(key);
+		mapSortUsed->push_back(key);
+		return it->second;
+	}
+	if (mapSortCache->size() >= SORT_CACHE_SIZE) {
+		//Drop least recently used order
+		it = mapSortCache->find(mapSortUsed->front());
+		delete it->second;
+		mapSortCache->erase(it);
+		mapSortUsed->pop_front();
+	}
+	vector<MapEntry*>* sorted = new vector<MapEntry*>();
+	sortMaps(mapMaster, spec, *sorted);
+	(*mapSortCache)[key] = sorted;
+	mapSortUsed->push_back(key);
+	return sorted;
+}
+
+void DataManager::clearSortCache()
+{
+	for (map<string, vector<WadEntry*>*>::iterator it=wadSortCache->begin(); it!=wadSortCache->end(); ++it)
+		delete it->second;
+	wadSortCache->clear();
+	wadSortUsed->clear();
+	for (map<string, vector<MapEntry*>*>::iterator it=mapSortCache->begin(); it!=mapSortCache->end(); ++it)
+		delete it->second;
+	mapSortCache->clear();
+	mapSortUsed->clear();
+	for (map<WadMapFields, RangeIndex<WadEntry*>*>::iterator it=wadRangeIndex->begin(); it!=wadRangeIndex->end(); ++it)
+		delete it->second;
+	wadRangeIndex->clear();
+	for (map<WadMapFields, RangeIndex<MapEntry*>*>::iterator it=mapRangeIndex->begin(); it!=mapRangeIndex->end(); ++it)
+		delete it->second;
+	mapRangeIndex->clear();
+}
+
+RangeIndex<WadEntry*>* DataManager::getWadRangeIndex(WadMapFields field)
+{
+	map<WadMapFields, RangeIndex<WadEntry*>*>::iterator it = wadRangeIndex->find(field);
+	if (it != wadRangeIndex->end())
+		return it->second;
+	RangeIndex<WadEntry*>* index = new RangeIndex<WadEntry*>(wadMaster, wadRangeValue, field);
+	(*wadRangeIndex)[field] = index;
+	return index;
+}
+
+RangeIndex<MapEntry*>* DataManager::getMapRangeIndex(WadMapFields field)
+{
+	map<WadMapFields, RangeIndex<MapEntry*>*>::iterator it = mapRangeIndex->find(field);
+	if (it != mapRangeIndex->end())
+		return it->second;
+	RangeIndex<MapEntry*>* index = new RangeIndex<MapEntry*>(mapMaster, mapRangeValue, field);
+	(*mapRangeIndex)[field] = index;
+	return index;
+}
+
+bool DataManager::planWadList(DataFilter* filter, vector<WadEntry*>& candidates)
+{
+	vector<FieldRange> ranges;
+	filter->getRanges(ranges);
+	if (ranges.empty())
+		return false;
+	size_t best = 0;
+	size_t bestCount = wadMaster.size();
+	for (size_t i=0; i<ranges.size(); i++) {
+		size_t count = getWadRangeIndex(ranges[i].field)->count(ranges[i]);
+		if (count < bestCount) {
+			best = i;
+			bestCount = count;
+		}
+	}
+	if (bestCount*RANGE_PLAN_RATIO >= wadMaster.size())
+		return false; //Scanning all is as fast
+	getWadRangeIndex(ranges[best].field)->getEntries(ranges[best], candidates);
+	sort(candidates.begin(), candidates.end(), entryIdLess<WadEntry*>);
+	return true;
+}
+
+bool DataManager::planMapList(DataFilter* filter, vector<MapEntry*>& candidates)
+{
+	vector<FieldRange> ranges;
+	filter->getRanges(ranges);
+	if (ranges.empty())
+		return false;
+	size_t best = 0;
+	size_t bestCount = mapMaster.size();
+	for (size_t i=0; i<ranges.size(); i++) {
+		size_t count = getMapRangeIndex(ranges[i].field)->count(ranges[i]);
+		if (count < bestCount) {
+			best = i;
+			bestCount = count;
+		}
+	}
+	if (bestCount*RANGE_PLAN_RATIO >= mapMaster.size())
+		return false; //Scanning all is as fast
+	getMapRangeIndex(ranges[best].field)->getEntries(ranges[best], candidates);
+	sort(candidates.begin(), candidates.end(), entryIdLess<MapEntry*>);
+	return true;
+}
+
+bool DataManager::updateWadList(WadEntry* we)
+{
+	ListOrder<WadEntry*> order(currentWadFilter, isWadSortField, setWadSortKey);
+	return updateListEntry(wadList, we, currentWadFilter, order);
+}
+
+bool DataManager::updateMapList(MapEntry* me)
+{
+	ListOrder<MapEntry*> order(currentMapFilter, isMapSortField, setMapSortKey);
+	return updateListEntry(mapList, me, currentMapFilter, order);
+}
+
+void DataManager::insertMaps(const vector<MapEntry*>& maps)
+{
+	vector<MapEntry*> delta;
+	for (vector<MapEntry*>::const_iterator it=maps.begin(); it!=maps.end(); ++it) {
+		if (currentMapFilter->includes(*it))
+			delta.push_back(*it);
+	}
+	if (delta.empty())
+		return;
+	ListOrder<MapEntry*> order(currentMapFilter, isMapSortField, setMapSortKey);
+	if (delta.size()*SORT_SUBSET_RATIO < mapList->getSize()) {
+		//Few entries, a binary search for each
+		for (vector<MapEntry*>::iterator it=delta.begin(); it!=delta.end(); ++it)
+			mapList->insertSorted(*it, order);
+	} else {
+		stable_sort(delta.begin(), delta.end(), cref(order));
+		mapList->mergeSorted(delta, order);
+	}
+	listener->onListChanged(1);
+}
+
+void DataManager::keepSort(ComboDataFilter* current)
+{
+	if (current->filters.size() == 0)
+		return;
+	DataFilter* view = current->filters[0];
+	view->copySort(current);
+	if (view->isList())
+		dataViewMod = true;
+}
+
+void DataManager::sortWadList()
+{
+	if (wadList->getSize() == 0)
+		return;
+	vector<SortKey> spec;
+	bool rev = makeSortSpec(currentWadFilter, isWadSortField, spec);
+	if (spec.size() == 0)
+		return;
+	vector<WadEntry*> entries;
+	wadList->toVector(entries);
+	vector<WadEntry*> sorted;
+	if (entries.size()*SORT_SUBSET_RATIO < wadMaster.size()) {
+		//Small subset, sort it directly. The list can be in the previous
+		//sort order, so start from dbid order, as for the master list.
+		sort(entries.begin(), entries.end(), entryIdLess<WadEntry*>);
+		sortWads(entries, spec, sorted);
+	} else {
+		//Pick the entries from the cached sorted master list
+		IdBitmap members;
+		for (vector<WadEntry*>::iterator it=entries.begin(); it!=entries.end(); ++it)
+			members.add((*it)->dbid);
+		vector<WadEntry*>* all = getSortedWads(spec);
+		sorted.reserve(entries.size());
+		for (vector<WadEntry*>::iterator it=all->begin(); it!=all->end(); ++it) {
+			if (members.contains((*it)->dbid))
+				sorted.push_back(*it);
+		}
+	}
+	if (rev)
+		reverse(sorted.begin(), sorted.end());
+	wadList->fromVector(sorted);
+}
+
+void DataManager::sortMapList()
+{
+	if (mapList->getSize() == 0)
+		return;
+	vector<SortKey> spec;
+	bool rev = makeSortSpec(currentMapFilter, isMapSortField, spec);
+	if (spec.size() == 0)
+		return;
+	vector<MapEntry*> entries;
+	mapList->toVector(entries);
+	vector<MapEntry*> sorted;
+	if (entries.size()*SORT_SUBSET_RATIO < mapMaster.size()) {
+		//Small subset, sort it directly. The list can be in the previous
+		//sort order, so start from dbid order, as for the master list.
+		sort(entries.begin(), entries.end(), entryIdLess<MapEntry*>);
+		sortMaps(entries, spec, sorted);
+	} else {
+		//Pick the entries from the cached sorted master list
+		IdBitmap members;
+		for (vector<MapEntry*>::iterator it=entries.begin(); it!=entries.end(); ++it)
+			members.add((*it)->dbid);
+		vector<MapEntry*>* all = getSortedMaps(spec);
+		sorted.reserve(entries.size());
+		for (vector<MapEntry*>::iterator it=all->begin(); it!=all->end(); ++it) {
+			if (members.contains((*it)->dbid))
+				sorted.push_back(*it);
+		}
+	}
+	if (rev)
+		reverse(sorted.begin(), sorted.end());
+	mapList->fromVector(sorted);
+}
+
 void DataManager::removeTagFromMaps(uint16_t tagId, uint16_t repId)
 {
-	for (vector<MapEntry*>::iterator it=mapMaster.begin(); it != mapMaster.end(); ++it) {
+	set<MapEntry*>* indexed = tagIndex->getMaps(tagId);
+	if (indexed == NULL)
+		return;
+	//Copy, as indexMap changes the index
+	vector<MapEntry*> maps(indexed->begin(), indexed->end());
+	for (vector<MapEntry*>::iterator it=maps.begin(); it != maps.end(); ++it) {
 		for (int i=0; i<MAXTAGS; i++) {
 			if ((*it)->tags[i] == tagId)
 				(*it)->tags[i] = repId;
 		}
+		indexMap(*it);
 	}
 	mapMod = true;
 }
 
 void DataManager::removeAuthorFromMaps(AuthorEntry* auth, AuthorEntry* repAuth)
 {
-	for (vector<MapEntry*>::iterator it=mapMaster.begin(); it != mapMaster.end(); ++it) {
+	set<MapEntry*>* indexed = authorIndex->getMaps(auth->dbid);
+	if (indexed == NULL)
+		return;
+	vector<MapEntry*> maps(indexed->begin(), indexed->end());
+	for (vector<MapEntry*>::iterator it=maps.begin(); it != maps.end(); ++it) {
 		if ((*it)->author1 == auth)
 			(*it)->author1 = repAuth;
 		if ((*it)->author2 == auth)
 			(*it)->author2 = repAuth;
+		indexMap(*it);
 	}
 	mapMod = true;
 }
 
 void DataManager::removeBasedOn(uint32_t dbid)
 {
-	for (vector<MapEntry*>::iterator it=mapMaster.begin(); it != mapMaster.end(); ++it) {
-		if ((*it)->basedOn == dbid)
-			(*it)->basedOn = 0;
+	set<MapEntry*>* indexed = basedOnIndex->getMaps(dbid);
+	if (indexed == NULL)
+		return;
+	vector<MapEntry*> maps(indexed->begin(), indexed->end());
+	for (vector<MapEntry*>::iterator it=maps.begin(); it != maps.end(); ++it) {
+		(*it)->basedOn = 0;
+		basedOnIndex->remove(*it);
 	}
 	mapMod = true;
 }
 
+void DataManager::indexMap(MapEntry* me)
+{
+	indexMap(me, authorIndex, tagIndex, basedOnIndex);
+}
+
+void DataManager::indexMap(MapEntry* me, MapIndex<uint32_t>* authorIdx,
+	MapIndex<uint16_t>* tagIdx, MapIndex<uint32_t>* basedOnIdx)
+{
+	if (authorIdx != NULL) {
+		vector<uint32_t> authors;
+		if (me->author1 != NULL)
+			authors.push_back(me->author1->dbid);
+		if (me->author2 != NULL)
+			authors.push_back(me->author2->dbid);
+		authorIdx->update(me, authors);
+	}
+	if (tagIdx != NULL) {
+		vector<uint16_t> tags(me->tags, me->tags+MAXTAGS);
+		tagIdx->update(me, tags);
+	}
+	if (basedOnIdx != NULL) {
+		vector<uint32_t> based(1, me->basedOn);
+		basedOnIdx->update(me, based);
+	}
+}
+
+void DataManager::unindexMap(MapEntry* me)
+{
+	authorIndex->remove(me);
+	tagIndex->remove(me);
+	basedOnIndex->remove(me);
+}
+
 ListWrapper<WadEntry*>* DataManager::getWadTitleList(wxString filterStr, ListWrapper<WadEntry*>* fromOld)
 {
 	if (wadTitleFilter == NULL)
 		wadTitleFilter = new TitleSearchFilter(FILTER_WAD, filterStr);
 	else
-		wadTitleFilter->searchStr = filterStr;
+		wadTitleFilter->setSearch(filterStr);
 	ListWrapper<WadEntry*>* newList = new ListWrapper<WadEntry*>();
 	if (wadTitleFilter->hasFilter()) {
 		if (fromOld == NULL) {
@@ -2698,21 +3489,87 @@ void DataManager::writeDataFilter(wxOutputStream* file, DataFilter* filter)
 	}*/
 	unsigned char fld = filter->sortField;
 	file->Write(&fld, 1);
+	unsigned char ch = filter->sortReverse? 1: 0;
+	file->Write(&ch, 1);
+	ch = filter->thenSort.size();
+	file->Write(&ch, 1);
+	for (vector<SortKey>::iterator it=filter->thenSort.begin(); it!=filter->thenSort.end(); ++it) {
+		fld = it->field;
+		file->Write(&fld, 1);
+		ch = it->reverse? 1: 0;
+		file->Write(&ch, 1);
+	}
 
 	if (filter->type==FILTER_WAD_LIST || filter->type==FILTER_MAP_LIST) {
 		DataListFilter* dlv = dynamic_cast<DataListFilter*>(filter);
 		uint32_t id;
-		if (dlv->entries->size() > 0) {
-			for (list<uint32_t>::iterator it=dlv->entries->begin(); it!=dlv->entries->end(); ++it) {
-				id = *it;
-				file->Write(&id, 4);
-			}
-		}
+		for (id=dlv->entries->next(0); id!=0; id=dlv->entries->next(id))
+			file->Write(&id, 4);
 		id = 0;
 		file->Write(&id, 4);
 	}
 }
 
+DataFilter* DataManager::readDataFilter(wxInputStream* file, unsigned char version)
+{
+	unsigned char type;
+	file->Read(&type, 1);
+	if (file->Eof())
+		return NULL;
+	DataFilter* filter;
+	DataListFilter* dlv = NULL;
+	if (type==FILTER_WAD_LIST || type==FILTER_MAP_LIST) {
+		dlv = new DataListFilter(type);
+		filter = dlv;
+	} else {
+		filter = new DataFilter(type);
+	}
+	uint16_t l;
+	file->Read(&l, 2);
+	if (l > 0) {
+		char* buf = new char[l];
+		file->Read(buf, l);
+		filter->name = wxString::FromUTF8(buf,l);
+		delete[] buf;
+	}
+	/*
+	file->Read(&(view->fieldCount), 1);
+	for (int i=0; i<view->fieldCount; i++) {
+		file->Read(&fld, 1);
+		view->fields[i] = (WadMapFields)fld;
+		file->Read(&(view->width[i]), 2);
+	}*/
+	unsigned char fld;
+	file->Read(&fld, 1);
+	filter->sortField = (WadMapFields)fld;
+	if (version > 1) { //Sort direction and more sort fields
+		unsigned char flag;
+		file->Read(&flag, 1);
+		filter->sortReverse = (flag != 0);
+		unsigned char keys;
+		file->Read(&keys, 1);
+		SortKey key;
+		for (int i=0; i<keys; i++) {
+			file->Read(&fld, 1);
+			file->Read(&flag, 1);
+			key.field = (WadMapFields)fld;
+			key.reverse = (flag != 0);
+			if (filter->thenSort.size()+1 < SORT_MAX_KEYS)
+				filter->thenSort.push_back(key);
+		}
+	}
+
+	if (dlv != NULL) {
+		uint32_t id;
+		file->Read(&id, 4);
+		while (id!=0 && !file->Eof()) {
+			dlv->entries->add(id);
+			file->Read(&id, 4);
+		}
+	}
+	return filter;
+}
+
 bool DataManager::loadDataFilters()
 {
 	wxString fname(dbFolder+wxFILE_SEP_PATH+FILE_VIEWS);
@@ -2725,54 +3582,19 @@ bool DataManager::loadDataFilters()
 	if (!fileStream.IsOk()) throw GuiError("Couldn't open file.", FILE_VIEWS);
 	wxBufferedInputStream* file = new wxBufferedInputStream(fileStream, 1024);
 
-	unsigned char ch;
-	file->Read(&ch, 1);
-	if (ch != VIEWS_FILEV)
+	unsigned char version;
+	file->Read(&version, 1);
+	if (version == 0 || version > VIEWS_FILEV)
 		throw GuiError("List database file has unsupported version number", FILE_VIEWS);
 
 	DataFilter* filter;
-	DataListFilter* dlv = NULL;
-	uint16_t l;
-	char buf[128];
-	unsigned char fld;
-	uint32_t id;
-	while (!file->Eof()) {
-		file->Read(&ch, 1); //Type
-		if (file->Eof())
-			break;
-		if (ch==FILTER_WAD_LIST || ch==FILTER_MAP_LIST) {
-			dlv = new DataListFilter(ch);
-			filter = dlv;
-		} else {
-			filter = new DataFilter(ch);
-		}
-		file->Read(&l, 2);
-		if (l > 0) {
-			file->Read(buf, l);
-			filter->name = wxString::FromUTF8(buf,l);
-		}
-		/*
-		file->Read(&(view->fieldCount), 1);
-		for (int i=0; i<view->fieldCount; i++) {
-			file->Read(&fld, 1);
-			view->fields[i] = (WadMapFields)fld;
-			file->Read(&(view->width[i]), 2);
-		}*/
-		file->Read(&fld, 1);
-		filter->sortField = (WadMapFields)fld;
-
-		if (ch==FILTER_WAD_LIST || ch==FILTER_MAP_LIST) {
-			file->Read(&id, 4);
-			while (id != 0) {
-				dlv->entries->push_back(id);
-				file->Read(&id, 4);
-			}
-			//dlv->entries->sort();
-			if (ch==FILTER_WAD_LIST)
-				wadLists->push_back(dlv);
-			else
-				mapLists->push_back(dlv);
-		}
+	while ((filter = readDataFilter(file, version)) != NULL) {
+		if (filter->type == FILTER_WAD_LIST)
+			wadLists->push_back(dynamic_cast<DataListFilter*>(filter));
+		else if (filter->type == FILTER_MAP_LIST)
+			mapLists->push_back(dynamic_cast<DataListFilter*>(filter));
+		else
+			delete filter;
 	}
 	wadLists->sort(filter_comp);
 	mapLists->sort(filter_comp);
@@ -2878,6 +3700,7 @@ DataFilter* DataManager::getMapFilter(wxString name)
 
 MapStatistics* DataManager::getStatistics(int filterType)
 {
+	waitForMaps();
 	MapStatistics* ms;
 	if (filterType == 0) {
 		ms = new MapStatistics(currentWadFilter->name);
@@ -2909,6 +3732,7 @@ MapStatistics* DataManager::getStatistics(int filterType)
 
 WadStatistics* DataManager::getWadStatistics()
 {
+	waitForMaps();
 	WadStatistics* ws = new WadStatistics(currentWadFilter->name);
 	if (wadList->getSize() > 0) {
 		wadList->reset();
@@ -2923,180 +3747,144 @@ WadStatistics* DataManager::getWadStatistics()
 	return ws;
 }
 
-void DataManager::makeStatisticsWads(StatisticSet* sset)
+void DataManager::makeStatisticsWads(GroupStatSet* sset)
 {
-	if (wadList->getSize() > 0) {
-		wadList->reset();
-		WadEntry* we = wadList->entry();
-		sset->processWad(we);
-		while (wadList->next()) {
-			we = wadList->entry();
-			sset->processWad(we);
-		}
-		sset->computeResults();
-	}
+	vector<WadEntry*> wads;
+	wadList->toVector(wads);
+	sset->processWads(wads);
+	sset->computeResults();
 }
 
-void DataManager::makeStatisticsMaps(StatisticSet* sset)
+void DataManager::makeStatisticsMaps(GroupStatSet* sset)
 {
-	if (mapList->getSize() > 0) {
-		mapList->reset();
-		MapEntry* me = mapList->entry();
-		sset->processMap(me);
-		while (mapList->next()) {
-			me = mapList->entry();
-			sset->processMap(me);
-		}
-		sset->computeResults();
-	}
+	vector<MapEntry*> maps;
+	mapList->toVector(maps);
+	sset->processMaps(maps);
+	sset->computeResults();
 }
 
-StatisticSet* DataManager::getYearStats(int filterType)
+StatisticSet* DataManager::getGroupStats(int filterType, StatGroupKey* key1, StatGroupKey* key2)
 {
-	StatisticSet* ss;
+	waitForMaps();
+	GroupStatSet* ss;
 	if (filterType == 0) {
-		ss = new YearStatSet(currentWadFilter->name);
+		ss = new GroupStatSet(currentWadFilter->name, false, key1, key2);
 		makeStatisticsWads(ss);
 	} else {
-		ss = new YearStatSet(currentMapFilter->name);
+		ss = new GroupStatSet(currentMapFilter->name, false, key1, key2);
 		makeStatisticsMaps(ss);
 	}
 	return ss;
 }
 
-StatisticSet* DataManager::getIwadStats(int filterType)
+StatisticSet* DataManager::getGroupWadStats(StatGroupKey* key1, StatGroupKey* key2)
 {
-	StatisticSet* ss;
-	if (filterType == 0) {
-		ss = new IwadStatSet(currentWadFilter->name);
-		makeStatisticsWads(ss);
-	} else {
-		ss = new IwadStatSet(currentMapFilter->name);
-		makeStatisticsMaps(ss);
-	}
+	waitForMaps();
+	GroupStatSet* ss = new GroupStatSet(currentWadFilter->name, true, key1, key2);
+	makeStatisticsWads(ss);
 	return ss;
 }
 
+StatisticSet* DataManager::getYearStats(int filterType)
+{
+	return getGroupStats(filterType, new YearGroupKey());
+}
+
+StatisticSet* DataManager::getIwadStats(int filterType)
+{
+	return getGroupStats(filterType, new IwadGroupKey());
+}
+
 StatisticSet* DataManager::getEngineStats(int filterType)
 {
-	StatisticSet* ss;
-	if (filterType == 0) {
-		ss = new EngineStatSet(currentWadFilter->name);
-		makeStatisticsWads(ss);
-	} else {
-		ss = new EngineStatSet(currentMapFilter->name);
-		makeStatisticsMaps(ss);
-	}
-	return ss;
+	return getGroupStats(filterType, new EngineGroupKey());
 }
 
 StatisticSet* DataManager::getRatingStats(int filterType)
 {
-	StatisticSet* ss;
-	if (filterType == 0) {
-		ss = new RatingStatSet(currentWadFilter->name);
-		makeStatisticsWads(ss);
-	} else {
-		ss = new RatingStatSet(currentMapFilter->name);
-		makeStatisticsMaps(ss);
-	}
-	return ss;
+	return getGroupStats(filterType, new RatingGroupKey());
 }
 
 StatisticSet* DataManager::getDifficultyStats(int filterType)
 {
-	StatisticSet* ss;
-	if (filterType == 0) {
-		ss = new DifficultyStatSet(currentWadFilter->name);
-		makeStatisticsWads(ss);
-	} else {
-		ss = new DifficultyStatSet(currentMapFilter->name);
-		makeStatisticsMaps(ss);
-	}
-	return ss;
+	return getGroupStats(filterType, new DifficultyGroupKey());
 }
 
 StatisticSet* DataManager::getPlaystyleStats(int filterType)
 {
-	StatisticSet* ss;
-	if (filterType == 0) {
-		ss = new PlaystyleStatSet(currentWadFilter->name);
-		makeStatisticsWads(ss);
-	} else {
-		ss = new PlaystyleStatSet(currentMapFilter->name);
-		makeStatisticsMaps(ss);
-	}
-	return ss;
+	return getGroupStats(filterType, new PlaystyleGroupKey());
 }
 
 StatisticSet* DataManager::getAuthorStats(int filterType)
 {
-	map<int, MapStatistics*>* authorStats = new map<int, MapStatistics*>();
+	map<int, wxString>* names = new map<int, wxString>();
 	AuthorEntry* ae;
 	for (int i=0; i<authorMaster->size(); i++) {
 		ae = (*authorMaster)[i];
-		MapStatistics* ms = new MapStatistics(getAuthorString(ae));
-		(*authorStats)[ae->dbid] = ms;
+		(*names)[ae->dbid] = getAuthorString(ae);
 	}
-
-	StatisticSet* ss;
-	if (filterType == 0) {
-		ss = new AuthorStatSet(currentWadFilter->name, authorStats);
-		makeStatisticsWads(ss);
-	} else {
-		ss = new AuthorStatSet(currentMapFilter->name, authorStats);
-		makeStatisticsMaps(ss);
-	}
-	return ss;
+	return getGroupStats(filterType, new AuthorGroupKey(names));
 }
 
 StatisticSet* DataManager::getTagStats(int filterType)
 {
-	map<int, MapStatistics*>* tagStats = new map<int, MapStatistics*>();
+	map<int, wxString>* names = new map<int, wxString>();
 	TagEntry* te;
 	for (int i=0; i<tagMaster.size(); i++) {
 		te = tagMaster.at(i);
-		if (te->tag.length() > 0) {
-			MapStatistics* ms = new MapStatistics(te->tag);
-			(*tagStats)[te->dbid] = ms;
-		}
-	}
-
-	StatisticSet* ss;
-	if (filterType == 0) {
-		ss = new TagStatSet(currentWadFilter->name, tagStats);
-		makeStatisticsWads(ss);
-	} else {
-		ss = new TagStatSet(currentMapFilter->name, tagStats);
-		makeStatisticsMaps(ss);
+		if (te->tag.length() > 0)
+			(*names)[te->dbid] = te->tag;
 	}
-	return ss;
+	return getGroupStats(filterType, new TagGroupKey(names));
 }
 
 StatisticSet* DataManager::getYearWadStats()
 {
-	StatisticSet* ss = new YearWadStatSet(currentWadFilter->name);
-	makeStatisticsWads(ss);
-	return ss;
+	return getGroupWadStats(new YearGroupKey());
 }
 
 StatisticSet* DataManager::getIwadWadStats()
 {
-	StatisticSet* ss = new IwadWadStatSet(currentWadFilter->name);
-	makeStatisticsWads(ss);
-	return ss;
+	return getGroupWadStats(new IwadGroupKey());
 }
 
 StatisticSet* DataManager::getEngineWadStats()
 {
-	StatisticSet* ss = new EngineWadStatSet(currentWadFilter->name);
-	makeStatisticsWads(ss);
-	return ss;
+	return getGroupWadStats(new EngineGroupKey());
 }
 
 StatisticSet* DataManager::getRatingWadStats()
 {
-	StatisticSet* ss = new RatingWadStatSet(currentWadFilter->name);
-	makeStatisticsWads(ss);
-	return ss;
+	return getGroupWadStats(new RatingGroupKey());
+}
+
+StatisticSet* DataManager::getYearEngineStats(int filterType)
+{
+	return getGroupStats(filterType, new YearGroupKey(), new EngineGroupKey());
+}
+
+StatisticSet* DataManager::getYearEngineWadStats()
+{
+	return getGroupWadStats(new YearGroupKey(), new EngineGroupKey());
+}
+
+
+//**************************************************************
+//************************ DbLoadThread ************************
+//**************************************************************
+
+DbLoadThread::DbLoadThread(DataManager* dataMan, int part)
+: wxThread(wxTHREAD_JOINABLE), dataMan(dataMan), part(part)
+{
+}
+
+wxThread::ExitCode DbLoadThread::Entry()
+{
+	try {
+		dataMan->loadPart(part);
+	} catch (GuiError& err) {
+		error1 = err.text1;
+		error2 = err.text2;
+	}
+	return (wxThread::ExitCode)0;
 }
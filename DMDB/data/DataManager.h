@@ -30,20 +30,42 @@
     #include "wx/wx.h"
 #endif
 
+#include <algorithm>
+#include <functional>
 #include <list>
+#include <set>
 #include <wx/file.h>
 #include <wx/filename.h>
 #include <wx/filefn.h>
 #include <wx/stream.h>
 #include <wx/wfstream.h>
 #include <wx/textfile.h>
+#include <wx/thread.h>
 
 #include "DataModel.h"
 #include "DataFilter.h"
 #include "WadStatistics.h"
 #include "StatisticSet.h"
+#include "WadTextStore.h"
+#include "SortKeys.h"
+#include "RangeIndex.h"
+#include "MemoryUsage.h"
 #include "../LtbUtils.h"
 
+class MapLoadJob;
+
+/*!
+* Parts of the database read in parallel by DataManager::load, each by
+* a DbLoadThread. The maps are read by a MapLoadJob at the same time.
+*/
+enum DbLoadPart {
+	LOAD_WADS, //!< FILE_WADDB and FILE_WADOWN
+	LOAD_AUTHORS, //!< FILE_AUTHORDB and the directory of FILE_AUTHORTEXT
+	LOAD_TAGS, //!< FILE_TAGS
+	LOAD_VIEWS, //!< FILE_VIEWS
+	LOAD_PARTS //!< Number of parts
+};
+
 
 /*! File storing the author table of the core DB. */
 const wxString FILE_AUTHORDB("people.dmdb");
@@ -69,6 +91,9 @@ const wxString FILE_MAPOWN("mymaps.dmdb");
 /*! File storing DataFilters (list definitions). */
 const wxString FILE_VIEWS("lists.dmdb");
 
+/*! File storing the textual descriptions for wads and maps. */
+const wxString FILE_WADTEXT("wtext.dmdb");
+
 
 /*! Version of file format for wad table. */
 const unsigned char WADDB_FILEV = 1;
@@ -76,8 +101,8 @@ const unsigned char WADDB_FILEV = 1;
 /*! Version of file format for map table. */
 const unsigned char MAPDB_FILEV = 1;
 
-/*! Version of file format for view table. */
-const unsigned char VIEWS_FILEV = 1;
+/*! Version of file format for view table. 2 adds sort direction and thenSort. */
+const unsigned char VIEWS_FILEV = 2;
 
 /*! Maximum bytes in author text entry. */
 const int AUTHOR_DESC_LIMIT = 2048;
@@ -85,9 +110,27 @@ const int AUTHOR_DESC_LIMIT = 2048;
 /*! Text entry will be whole number of blocks. */
 const int AUTHOR_DESC_BLOCK = 100;
 
+/*! Free bytes in author text file before it is compacted. */
+const uint32_t AUTHOR_TEXT_COMPACT = 50000;
+
 /*! Bytes per tag string. */
 const unsigned char DEFAULT_TAG_LENGTH = 25;
 
+/*!
+* A wad or map list smaller than 1/SORT_SUBSET_RATIO of all entries is
+* sorted directly, rather than from the cached sorted list of all entries.
+*/
+const size_t SORT_SUBSET_RATIO = 8;
+
+/*! Number of sort orders cached for each of wads and maps. */
+const size_t SORT_CACHE_SIZE = 8;
+
+/*!
+* A wad or map list is made from the entries of a RangeIndex when the
+* filter condition matches fewer than 1/RANGE_PLAN_RATIO of all entries.
+*/
+const size_t RANGE_PLAN_RATIO = 4;
+
 //! Defines the ways author entries can be named and sorted in lists.
 enum AuthorNaming {
 	AUTHNAME_FIRST_LAST, //!< Prefer real name, start with first name
@@ -116,21 +159,40 @@ class DataStatusListener
 
 	/*! Called on any change in number of objects. */
 	virtual void onTotalCounts(long wads, long maps, long auths) = 0;
+
+	/*!
+	* Called when the displayed fields of an entry may have changed, for
+	* views caching them. type is 0 for wad and 1 for map. dbid 0 means
+	* all entries of the type, such as when author names change.
+	*/
+	virtual void onEntryModified(int type, uint32_t dbid) = 0;
+
+	/*!
+	* Called when entries have been added to, moved in or removed from the
+	* current list, after edits rather than a new filter. type is 0 for
+	* the wad list and 1 for the map list.
+	*/
+	virtual void onListChanged(int type) = 0;
 };
 
 
 /*!
 * Wrapper for the current, filtered list of wads or maps.
-* We use std::list, with efficient iteration, sorting and
-* deletion, but we also need to operate based on index, so
-* this utility class gives us an index, kept in sync with
-* an iterator.
+* The entries are kept in a vector, so any entry can be reached
+* by index, such as for the binary search of type-ahead. The
+* wrapper also keeps a current index, for iterating through the
+* list with reset and next.
 */
 template<class T> class ListWrapper
 {
 	public:
 	ListWrapper() : wIterIndex(-1) {
-		wList = new list<T>();
+		wList = new vector<T>();
+	};
+
+	/*! Copy of other, for browsing a list which may be changed. */
+	ListWrapper(const ListWrapper<T>& other) : wIterIndex(other.wIterIndex) {
+		wList = new vector<T>(*other.wList);
 	};
 
 	~ListWrapper() {
@@ -139,33 +201,63 @@ template<class T> class ListWrapper
 	};
 
 	void fromVector(vector<T>& vec, int amount = -1) {
-		if (wList!=NULL && wList->size()>0) {
-			delete wList;
-			wList = new list<T>();
-		}
 		if (amount==-1) amount = vec.size();
-		for (int n=0; n<amount; n++) {
-			wList->push_back(vec.at(n));
-		}
+		wList->assign(vec.begin(), vec.begin()+amount);
 		reset();
 	};
 
+	void toVector(vector<T>& vec) {
+		vec.assign(wList->begin(), wList->end());
+	};
+
 	void add(T item) { wList->push_back(item); };
 
+	/*! Index of item, or -1 if not in the list. */
+	long find(T item) {
+		typename vector<T>::iterator it = std::find(wList->begin(), wList->end(), item);
+		return (it==wList->end())? -1: it-wList->begin();
+	};
+
+	/*! Remove the entry at index. */
+	void remove(long index) {
+		wList->erase(wList->begin()+index);
+		reset();
+	};
+
+	/*!
+	* Insert item in a list sorted by order (comparing two entries like
+	* operator <), after any equal entries. Returns the index of item.
+	*/
+	template<class C> long insertSorted(T item, const C& order) {
+		typename vector<T>::iterator it = upper_bound(wList->begin(), wList->end(), item, cref(order));
+		long index = it - wList->begin();
+		wList->insert(it, item);
+		reset();
+		return index;
+	};
+
+	/*! Merge items, sorted by order, into a list sorted by order. */
+	template<class C> void mergeSorted(const vector<T>& items, const C& order) {
+		size_t middle = wList->size();
+		wList->insert(wList->end(), items.begin(), items.end());
+		inplace_merge(wList->begin(), wList->begin()+middle, wList->end(), cref(order));
+		reset();
+	};
+
 	void reset() {
-		if (wList->size() > 0) {
-			wIter = wList->begin();
+		if (wList->size() > 0)
 			wIterIndex = 0;
-		} else {
+		else
 			wIterIndex = -1;
-		}
 	};
 
-	T entry() { return *wIter; };
+	T entry() { return (*wList)[wIterIndex]; };
+
+	T at(long index) { return (*wList)[index]; };
 
 	void erase() {
 		if (wIterIndex > -1) {
-			wList->erase(wIter);
+			wList->erase(wList->begin()+wIterIndex);
 			reset();
 		}
 	}
@@ -179,9 +271,8 @@ template<class T> class ListWrapper
 	};
 
 	bool previous() {
-		if (wIterIndex==-1 || wIter==wList->begin())
+		if (wIterIndex < 1)
 			return false;
-		wIter--;
 		wIterIndex--;
 		return true;
 	};
@@ -189,29 +280,20 @@ template<class T> class ListWrapper
 	bool next() {
 		if (wIterIndex==-1 || wIterIndex==(wList->size()-1))
 			return false;
-		wIter++;
 		wIterIndex++;
 		return true;
 	};
 
 	void setIndex(long index) {
-		if (wIterIndex>-1 && index>=0 && index<wList->size()) {
-			while (index > wIterIndex) {
-				wIter++;
-				wIterIndex++;
-			}
-			while (index < wIterIndex) {
-				wIter--;
-				wIterIndex--;
-			}
-		}
+		if (wIterIndex>-1 && index>=0 && (size_t)index<wList->size())
+			wIterIndex = index;
 	};
 
 	bool (*comp)(const T, const T); //Map sort
 
 	void sort(bool rev) {
-		wList->sort(*comp);
-		if (rev) wList->reverse();
+		stable_sort(wList->begin(), wList->end(), *comp);
+		if (rev) std::reverse(wList->begin(), wList->end());
 		reset();
 	};
 
@@ -222,12 +304,112 @@ template<class T> class ListWrapper
 
 	long getIndex() { return wIterIndex; };
 
+	/*! Bytes of the wrapper and its list. */
+	size_t getBytes() {
+		size_t bytes = MemoryUsage::heapBlock(sizeof(*this));
+		if (wList != NULL)
+			bytes += MemoryUsage::heapBlock(sizeof(vector<T>)) + MemoryUsage::heapBlock(wList->capacity()*sizeof(T));
+		return bytes;
+	};
+
 	private:
-	list<T>* wList; //Sorted/filtered list
-	typename list<T>::iterator wIter;
+	vector<T>* wList; //Sorted/filtered list
 	long wIterIndex;
 };
 
+/*!
+* Reverse index from a key, such as an author or tag id, to the set of
+* maps referencing it. Each map can have several keys (two authors, up to
+* MAXTAGS tags). The index also remembers the keys each map is indexed
+* with, so that update can be called after the fields of a map have been
+* changed, without knowing the old values. Key value 0 means no reference,
+* and is not indexed.
+*/
+template<class K> class MapIndex
+{
+	public:
+	MapIndex() {
+		keyMaps = new map<K, set<MapEntry*> >();
+		mapKeys = new map<MapEntry*, vector<K> >();
+	};
+
+	~MapIndex() {
+		delete keyMaps;
+		delete mapKeys;
+	};
+
+	/*! Index map with the given keys, replacing any keys it had. */
+	void update(MapEntry* me, const vector<K>& keys) {
+		remove(me);
+		vector<K> used;
+		for (typename vector<K>::const_iterator it=keys.begin(); it!=keys.end(); ++it) {
+			if (*it != 0) {
+				(*keyMaps)[*it].insert(me);
+				used.push_back(*it);
+			}
+		}
+		if (!used.empty())
+			(*mapKeys)[me] = used;
+	};
+
+	/*! Remove map from the index. */
+	void remove(MapEntry* me) {
+		typename map<MapEntry*, vector<K> >::iterator mit = mapKeys->find(me);
+		if (mit == mapKeys->end())
+			return;
+		for (typename vector<K>::iterator it=mit->second.begin(); it!=mit->second.end(); ++it) {
+			typename map<K, set<MapEntry*> >::iterator kit = keyMaps->find(*it);
+			if (kit != keyMaps->end()) {
+				kit->second.erase(me);
+				if (kit->second.empty())
+					keyMaps->erase(kit);
+			}
+		}
+		mapKeys->erase(mit);
+	};
+
+	/*!
+	* Maps indexed with the key, or NULL if none. The set is owned
+	* by the index, and is changed by update and remove.
+	*/
+	set<MapEntry*>* getMaps(K key) {
+		typename map<K, set<MapEntry*> >::iterator kit = keyMaps->find(key);
+		if (kit == keyMaps->end()) return NULL;
+		else return &(kit->second);
+	};
+
+	/*! Number of maps indexed with the key. */
+	unsigned int count(K key) {
+		set<MapEntry*>* maps = getMaps(key);
+		if (maps == NULL) return 0;
+		else return maps->size();
+	};
+
+	void clear() {
+		keyMaps->clear();
+		mapKeys->clear();
+	};
+
+	/*! Number of keys. */
+	size_t keyCount() { return keyMaps->size(); };
+
+	/*! Bytes of the index, with the nodes of both maps and the sets and key lists. */
+	size_t getBytes() {
+		size_t bytes = MemoryUsage::heapBlock(sizeof(*this)) + 2*MemoryUsage::heapBlock(sizeof(*keyMaps));
+		typename map<K, set<MapEntry*> >::iterator kit;
+		for (kit=keyMaps->begin(); kit!=keyMaps->end(); ++kit)
+			bytes += MemoryUsage::treeNode(sizeof(*kit)) + kit->second.size()*MemoryUsage::treeNode(sizeof(MapEntry*));
+		typename map<MapEntry*, vector<K> >::iterator mit;
+		for (mit=mapKeys->begin(); mit!=mapKeys->end(); ++mit)
+			bytes += MemoryUsage::treeNode(sizeof(*mit)) + MemoryUsage::heapBlock(mit->second.capacity()*sizeof(K));
+		return bytes;
+	};
+
+	private:
+	map<K, set<MapEntry*> >* keyMaps; //Key to maps
+	map<MapEntry*, vector<K> >* mapKeys; //Map to keys
+};
+
 /*!
 * The DataManager manages the data objects of the database application,
 * in memory and with file persistence. It is configured with a folder
@@ -270,6 +452,24 @@ template<class T> class ListWrapper
 * DataListFilter which specifies a specific set of items. DataManager keeps
 * a set of DataListFilters which are persisted. DataManager also handles
 * sorting of the current list, sorting on any field of the wads or maps.
+* A sort can have several fields, as given by the sortField and thenSort
+* of the filter, and is done with ColumnKeys built from the field values.
+* The sorted order of all wads or maps is cached for the last sorts used,
+* so that going back to one of them, or reversing the order, doesn't sort
+* again. The current list then takes its entries in the order of the
+* cached list. The cache is cleared when entries are added, modified or
+* deleted, and when author naming changes. The sort of the current list is
+* also kept in the selected view (filters[0] of the ComboDataFilter), and
+* used again when the view is selected.
+*
+* Maps are indexed by author, tag and basedOn with MapIndex objects, so
+* that finding the maps referencing an author, tag or other map doesn't
+* need a scan of all maps. The indexes are updated by mapModified, so this
+* must be called after changing these fields of a map.
+*
+* A large database has many more maps than wads, so the maps can be read
+* in the background after the wads (see load). Until completeLoad, the
+* wads have no maps and the map list is empty.
 *
 * The DataManager can also produce statistics - a MapStatistics for all of
 * the current list and StatisticSets with statistics according to various
@@ -301,7 +501,8 @@ class DataManager
 	wxString getScreenshotFolder() { return dbFolder+wxFILE_SEP_PATH+"sshot"; }
 
 	/*!
-	* Folder for storing text files (sub-folder of database folder).
+	* Folder of wad text files from earlier versions (sub-folder of
+	* database folder). These are imported into FILE_WADTEXT.
 	*/
 	wxString getTextFolder() { return dbFolder+wxFILE_SEP_PATH+"text"; }
 
@@ -318,9 +519,54 @@ class DataManager
 	/*!
 	* Performs the necessary loading of persisted resources
 	* into memory. This will typically be the full set of core
-	* objects.
+	* objects. The files are independent, so the DbLoadParts are
+	* read in parallel, while a MapLoadJob reads the maps. The maps
+	* are then linked to wads and authors. With an event handler,
+	* this is left to the MapLoadJob in the background, so that the
+	* wad list can be shown while it finishes. THREAD_MAPSLOADED is
+	* posted to the handler when the job is done, and completeLoad
+	* must then be called, if the event has the id of getMapLoadId.
+	* Methods depending on the maps wait for the job, so the maps are
+	* not seen before they are all loaded.
+	*/
+	void load(wxEvtHandler* handler=NULL);
+
+	/*!
+	* Reads one DbLoadPart, logging the time used. Called by load
+	* and its DbLoadThreads.
 	*/
-	void load();
+	void loadPart(int part);
+
+	/*!
+	* Takes over the maps read in the background, adding them to
+	* their wads and remaking the current wad and map lists. Waits for the
+	* job if it is not done. Returns false if there was no job.
+	*/
+	bool completeLoad();
+
+	/*!
+	* Job id of the MapLoadJob of the last load, also when it is done,
+	* or 0 if there is none.
+	*/
+	long getMapLoadId() { return mapLoadId; }
+
+	/*! True while maps are being read in the background. */
+	bool isLoading() { return mapLoader!=NULL; }
+
+	/*!
+	* Reason the background map loading failed, or empty. After a failed
+	* load the database must be closed without importing, and
+	* saveWadsMaps will not write the wad and map files.
+	*/
+	wxString getLoadError() { return loadError; }
+
+	/*!
+	* Add map to the given author, tag and basedOn indexes, or update
+	* it. Used for the indexes of the DataManager, and by MapLoadJob
+	* to build new indexes.
+	*/
+	static void indexMap(MapEntry* me, MapIndex<uint32_t>* authorIdx,
+		MapIndex<uint16_t>* tagIdx, MapIndex<uint32_t>* basedOnIdx);
 
 
 	//************************ Author persistence public ************************
@@ -334,7 +580,9 @@ class DataManager
 	void openAuthorTextFile();
 
 	/*!
-	* Close the author text description file.
+	* Close the author text description file. If much of the file is
+	* free slots left by relocated or deleted entries, it is compacted
+	* first.
 	*/
 	void closeAuthorTextFile();
 
@@ -576,8 +824,10 @@ class DataManager
 	/*!
 	* Check if a MapEntry is modified. This must be called whenever
 	* the fields of an existing MapEntry may have changed, and checks
-	* if the MapEntry is marked as modified by flags.  Note that the
-	* change is not persisted until saveWadsMaps() is called.
+	* if the MapEntry is marked as modified by flags. Changes to the
+	* personal fields are also reported for the wad, which shows the
+	* total play time of its maps. Note that the change is not persisted
+	* until saveWadsMaps() is called.
 	*/
 	void mapModified(MapEntry* me);
 
@@ -591,6 +841,7 @@ class DataManager
 	* Persist any changes to the core wads and maps database to file.
 	* This will append new entries to the existing files, or write
 	* the whole files if there are changes in existing entries.
+	* Nothing is written if the maps failed to load.
 	*/
 	void saveWadsMaps();
 
@@ -602,10 +853,24 @@ class DataManager
 	WadText* getWadText(WadEntry* wad);
 
 	/*!
-	* Persist a WadText object to file. The object should not be empty.
+	* Persist a WadText object to file. If the object is empty, any
+	* persisted text for the wad is removed.
 	*/
 	void saveWadText(WadText* wadText);
 
+	/*!
+	* Get the WadText entries of several wads in one pass over the wad
+	* text file. A new WadText object is added to texts for each wad (in
+	* the same order), which the caller must delete.
+	*/
+	void getWadTexts(vector<WadEntry*>& wads, vector<WadText*>& texts);
+
+	/*!
+	* Find wads with a text entry (wad or map description, notes)
+	* containing the search string, ignoring case.
+	*/
+	void findWadsByText(const wxString& searchStr, vector<WadEntry*>& result);
+
 	/*!
 	* Delete a map entry from the database. If the wad entry of this map
 	* has no other maps, the whole wad entry is deleted, as we do not
@@ -686,17 +951,35 @@ class DataManager
 	* on the given field. Not all fields defined by WadMapFields
 	* have sort algorithms (we don't sort on boolean fields). It
 	* returns false if the sortField doesn't support sorting.
+	* Additional sort fields are kept if sortField is unchanged.
 	*/
 	bool setWadSort(WadMapFields sortField, bool reverse=false);
 
+	/*!
+	* Add a field to sort the current wad list on, after the current
+	* sort fields, or change its direction if already sorted on it.
+	* Returns false if the field isn't supported, or there are already
+	* SORT_MAX_KEYS sort fields.
+	*/
+	bool addWadSort(WadMapFields sortField, bool reverse=false);
+
 	/*!
 	* Update the sorting of the current map filter, sorting entries
 	* on the given field. Not all fields defined by WadMapFields
 	* have sort algorithms (we don't sort on boolean fields). It
 	* returns false if the sortField doesn't support sorting.
+	* Additional sort fields are kept if sortField is unchanged.
 	*/
 	bool setMapSort(WadMapFields sortField, bool reverse=false);
 
+	/*!
+	* Add a field to sort the current map list on, after the current
+	* sort fields, or change its direction if already sorted on it.
+	* Returns false if the field isn't supported, or there are already
+	* SORT_MAX_KEYS sort fields.
+	*/
+	bool addMapSort(WadMapFields sortField, bool reverse=false);
+
 	/*!
 	* Sorted/filtered list of wad entries.
 	*/
@@ -725,12 +1008,17 @@ class DataManager
 
 	/*!
 	* Get index in the current sorted wad list based on the strStart.
-	* The list must be sorted on a string field (title or filename),
-	* and searches for the first entry who's string field starts with
-	* the given string. So getWadIndex("H") when sorted on title to
-	* go to H in the list. Otherwise it returns -1.
+	* Searches for the first entry who's value in the sort field starts
+	* with the given string, or has the value of the number for numeric
+	* fields. So getWadIndex("H") when sorted on title to go to H in the
+	* list. If there is no match, the index where it would be is returned,
+	* or -1 if this is past the end. This is a binary search on the sort
+	* keys. If rangeStart and rangeEnd are given, only the entries from
+	* rangeStart up to rangeEnd (-1 for the end of the list) are searched,
+	* and they are set to the range of matching entries. Type-ahead can
+	* pass the range from the last search when more characters are added.
 	*/
-	int getWadIndex(wxString strStart);
+	int getWadIndex(wxString strStart, long* rangeStart=NULL, long* rangeEnd=NULL);
 
 	/*!
 	* Find a WadEntry (in the master list) based on dbid.
@@ -747,6 +1035,21 @@ class DataManager
 	*/
 	WadEntry* findWad(string fileName);
 
+	/*!
+	* Get the md5Digest of every WadEntry as hexadecimal strings, in
+	* a new set (caller must delete). Used by background jobs to check
+	* for existing entries without accessing the DataManager.
+	*/
+	set<string>* getWadHashes();
+
+	/*!
+	* Checks the consistency of the wad and map entries in memory: unique
+	* dbids and MD5 digests, maps linked both ways with their wads, and
+	* basedOn referencing existing maps. Each problem found is written to
+	* report, if given. Returns the number of problems.
+	*/
+	int validate(TextReport* report=NULL);
+
 	/*!
 	* Get a MapEntry based on index in the current sorted
 	* list.
@@ -754,13 +1057,10 @@ class DataManager
 	MapEntry* getMap(long index);
 
 	/*!
-	* Get index in the current sorted map list based on the strStart.
-	* The list must be sorted on a string field (such as name or title),
-	* and searches for the first entry who's string field starts with
-	* the given string. So getMapIndex("H") when sorted on title to
-	* go to H in the list. Otherwise it returns -1.
+	* Get index in the current sorted map list based on the strStart,
+	* searching on the sort field as getWadIndex does.
 	*/
-	int getMapIndex(wxString strStart);
+	int getMapIndex(wxString strStart, long* rangeStart=NULL, long* rangeEnd=NULL);
 
 	/*!
 	* Find a MapEntry (in the master list) based on dbid.
@@ -887,6 +1187,13 @@ class DataManager
 	*/
 	WadStatistics* getWadStatistics();
 
+	/*!
+	* Estimate the memory used by each structure of the database: The
+	* entries, views, indexes, caches and list filters, with strings and
+	* container overhead. The caller deletes the returned object.
+	*/
+	MemoryUsage* getMemoryUsage();
+
 	/*! Get statistics categorized by year of wad. */
 	StatisticSet* getYearStats(int filterType);
 
@@ -923,21 +1230,73 @@ class DataManager
 	/*! Get wad statistics categorized by own rating. */
 	StatisticSet* getRatingWadStats();
 
+	/*! Get statistics categorized by both year and engine. */
+	StatisticSet* getYearEngineStats(int filterType);
+
+	/*! Get wad statistics categorized by both year and engine. */
+	StatisticSet* getYearEngineWadStats();
+
+	/*!
+	* Get map statistics grouped on one or two keys (key2 may be NULL),
+	* for the current map or wad list. The StatisticSet takes ownership
+	* of the keys.
+	*/
+	StatisticSet* getGroupStats(int filterType, StatGroupKey* key1, StatGroupKey* key2=NULL);
+
+	/*! Get wad statistics grouped on one or two keys, for the current wad list. */
+	StatisticSet* getGroupWadStats(StatGroupKey* key1, StatGroupKey* key2=NULL);
+
 
 	private:
 		//************************ Author private ************************
 
-		/*! Writes all author ids + text offsets to the given file. */
+		/*! Writes all author ids + text offsets to the given file, followed by the free slots. */
 		void writeAuthorTextDir(wxFile* file);
 
-		/*! Loads the textOffset entries of the author text file. */
+		/*! Writes the free slots of the author text directory, ending with a 0,0 entry. */
+		void writeAuthorTextFree(wxFile* file);
+
+		/*!
+		* Updates the author text directory after the text of the author at index
+		* has been placed in a slot. If authorTextDir has changed from oldDir, the
+		* whole directory is written at the new offset. Otherwise only the entry of
+		* the author and the list of free slots are written.
+		*/
+		void updateAuthorTextDir(long index, uint32_t oldDir);
+
+		/*!
+		* Loads the textOffset entries and free slots of the author text file.
+		* At most one entry per author is read, as files from older versions
+		* have no 0,0 entry ending the directory.
+		*/
 		void loadAuthorTextDir();
 
-		/*! Append a new author text entry at the end of the file. */
+		/*! End of the author text slot at offset (start of next slot or directory). */
+		uint32_t getAuthorTextSlotEnd(uint32_t offset);
+
+		/*! Total size of the free slots in the author text file. */
+		uint32_t getAuthorTextFreeBytes();
+
+		/*!
+		* Finds a slot for an author text of length bytes - the first free slot
+		* large enough, or new space at the end (moving the directory).
+		*/
+		uint32_t allocAuthorTextSlot(uint16_t length);
+
+		/*! Marks the author text slot as free, merging with adjacent free slots. */
+		void freeAuthorTextSlot(uint32_t offset);
+
+		/*! Writes the text to the author text slot at offset, clearing the rest of the slot. */
+		void writeAuthorTextSlot(uint32_t offset, const wxScopedCharBuffer& buf);
+
+		/*! Puts a new author text entry in a free slot, or at the end of the file. */
 		void addAuthorText(AuthorEntry* newEntry, wxString text);
 
-		/*! Writes a new version of the author text file for the current authorText. */
-		void rewriteAuthorText();
+		/*!
+		* Writes a new version of the author text file without free slots, to be
+		* committed once the file is closed. Updates all textOffset entries.
+		*/
+		wxTempFile* compactAuthorText();
 
 		/*!
 		* Remove the AuthorEntry from any group which has its reference,
@@ -992,8 +1351,32 @@ class DataManager
 		/*! Loads the core wad objects, incl. personal data (wadMaster). */
 		void loadWads();
 
-		/*! Loads the core map objects, incl. personal data (mapMaster). */
-		void loadMaps();
+		/*! Reads all DbLoadParts, with a thread for each. */
+		void loadParts();
+
+		/*! Starts the MapLoadJob reading the maps. */
+		void startMapLoad(wxEvtHandler* handler);
+
+		/*!
+		* Loads the core map objects, incl. personal data (mapMaster), when
+		* wads and authors are loaded. With a handler this is completed in
+		* the background, otherwise right away.
+		*/
+		void loadMaps(wxEvtHandler* handler);
+
+		/*! Takes the maps and indexes of a finished MapLoadJob. */
+		void takeMaps(MapLoadJob* job);
+
+		/*! Completes loading if maps are read in the background. */
+		void waitForMaps() { if (mapLoader!=NULL) completeLoad(); }
+
+		/*!
+		* Logs the memory used by the wad and map entries, as verbose
+		* log messages, with the size they would have as separate heap
+		* blocks for comparison with the EntryPools, and the size of
+		* the StringPool.
+		*/
+		void logEntryMemory();
 
 		/*! Create the sorted wadList with entries from wadMaster. */
 		void makeWadList(bool update=false);
@@ -1019,19 +1402,97 @@ class DataManager
 		/*! Remove any basedOn-references to the given dbid from map entries. */
 		void removeBasedOn(uint32_t dbid);
 
+		/*! Add map to authorIndex, tagIndex and basedOnIndex, or update it. */
+		void indexMap(MapEntry* me);
+
+		/*! Remove map from authorIndex, tagIndex and basedOnIndex. */
+		void unindexMap(MapEntry* me);
+
+		/*! Add the author groups which include auth (directly or in sub-group) to groups. */
+		void findAuthorGroups(AuthorEntry* auth, vector<AuthorEntry*>& groups);
+
+		/*! Remake authorGroups from the groups in authorMaster. */
+		void indexAuthorGroups();
+
+		/*! Put entries in result, sorted on the fields of spec. */
+		void sortWads(vector<WadEntry*>& entries, const vector<SortKey>& spec, vector<WadEntry*>& result);
+
+		/*! Put entries in result, sorted on the fields of spec. */
+		void sortMaps(vector<MapEntry*>& entries, const vector<SortKey>& spec, vector<MapEntry*>& result);
+
+		/*! All wads sorted on the fields of spec, from wadSortCache. */
+		vector<WadEntry*>* getSortedWads(const vector<SortKey>& spec);
+
+		/*! All maps sorted on the fields of spec, from mapSortCache. */
+		vector<MapEntry*>* getSortedMaps(const vector<SortKey>& spec);
+
+		/*!
+		* Clear wadSortCache and mapSortCache, and the range indexes, after
+		* entries have changed.
+		*/
+		void clearSortCache();
+
+		/*! Index of all wads on field, made if not in wadRangeIndex. */
+		RangeIndex<WadEntry*>* getWadRangeIndex(WadMapFields field);
+
+		/*! Index of all maps on field, made if not in mapRangeIndex. */
+		RangeIndex<MapEntry*>* getMapRangeIndex(WadMapFields field);
+
+		/*!
+		* If filter has a range condition matching a small part of the
+		* wads, put the wads matching the most selective one in candidates,
+		* in dbid order, and return true. The candidates must still be
+		* tested with the filter.
+		*/
+		bool planWadList(DataFilter* filter, vector<WadEntry*>& candidates);
+
+		/*! Like planWadList, for maps. */
+		bool planMapList(DataFilter* filter, vector<MapEntry*>& candidates);
+
+		/*!
+		* Re-test wad against currentWadFilter after it has been added or
+		* changed, and add it to, move it in or remove it from wadList,
+		* keeping the sort order. Returns true if wadList changed.
+		*/
+		bool updateWadList(WadEntry* we);
+
+		/*! Like updateWadList, for a map in mapList. */
+		bool updateMapList(MapEntry* me);
+
+		/*!
+		* Add the new maps which pass currentMapFilter to mapList, by
+		* sorting them and merging them into the sorted list.
+		*/
+		void insertMaps(const vector<MapEntry*>& maps);
+
+		/*! Copy the sort of the current filter to its selected view. */
+		void keepSort(ComboDataFilter* current);
+
+		/*! Sort wadList by the sort fields of currentWadFilter. */
+		void sortWadList();
+
+		/*! Sort mapList by the sort fields of currentMapFilter. */
+		void sortMapList();
+
 		//************************ DataFilters private ************************
 
 		/*! Writes a DataFilter object to file. */
 		void writeDataFilter(wxOutputStream* file, DataFilter* filter);
 
+		/*!
+		* Reads a DataFilter object written with writeDataFilter, in the
+		* given file version. Returns NULL at end of file.
+		*/
+		DataFilter* readDataFilter(wxInputStream* file, unsigned char version);
+
 		/*! Loads DataFilters (list definitions), or returns false if not found. */
 		bool loadDataFilters();
 
-		/*! Process each wad in current list with StatisticSet. */
-		void makeStatisticsWads(StatisticSet* sset);
+		/*! Process each wad in current list with GroupStatSet. */
+		void makeStatisticsWads(GroupStatSet* sset);
 
-		/*! Process each map in current list with StatisticSet. */
-		void makeStatisticsMaps(StatisticSet* sset);
+		/*! Process each map in current list with GroupStatSet. */
+		void makeStatisticsMaps(GroupStatSet* sset);
 
 
 	wxString dbFolder; //The files and folders are persisted here
@@ -1049,6 +1510,9 @@ class DataManager
 	wxFile* authorTextFile; //When open
 	long authorTextIndex; //Index in authorMaster for authorText
 	wxString authorText; //An author description in memory
+	set<uint32_t>* authorTextSlots; //Start of all text slots, used and free
+	set<uint32_t>* authorTextFree; //Start of free text slots
+	map<uint32_t, vector<AuthorEntry*> >* authorGroups; //Author dbid to groups it is a member of
 
 	// Tags
 	unsigned char tagLength; //Max chars in tag
@@ -1071,9 +1535,22 @@ class DataManager
 	bool mapOwnMod; //Unsaved changes to personal fields
 	long firstNewMap; //Index of first unsaved entry, or -1
 	ListWrapper<MapEntry*>* mapList; //Sorted/filtered list
+	MapLoadJob* mapLoader; //Reading maps in the background, or NULL
+	long mapLoadId; //Job id of the last mapLoader, or 0
+	wxString loadError; //Why mapLoader failed
+	MapIndex<uint32_t>* authorIndex; //Author dbid to maps with author1/2
+	MapIndex<uint16_t>* tagIndex; //Tag dbid to maps with tag
+	MapIndex<uint32_t>* basedOnIndex; //Map dbid to maps based on it
+	map<string, vector<WadEntry*>*>* wadSortCache; //All wads sorted, by sortSpecKey
+	map<string, vector<MapEntry*>*>* mapSortCache; //All maps sorted, by sortSpecKey
+	list<string>* wadSortUsed; //Keys of wadSortCache, least recently used first
+	list<string>* mapSortUsed; //Keys of mapSortCache, least recently used first
+	map<WadMapFields, RangeIndex<WadEntry*>*>* wadRangeIndex; //All wads by numeric field
+	map<WadMapFields, RangeIndex<MapEntry*>*>* mapRangeIndex; //All maps by numeric field
 
 	// Wad/map text
 	WadText* wadText;
+	WadTextStore* wadTextStore; //Text of all wads
 
 	// DataViews
 	list<DataListFilter*>* wadLists;
@@ -1085,4 +1562,27 @@ class DataManager
 	TitleSearchFilter* wadTitleFilter; //To filter wadTitleList
 };
 
+/*!
+* Joinable thread reading one DbLoadPart for DataManager::load. A
+* GuiError from reading is kept, to be thrown by load.
+*/
+class DbLoadThread : public wxThread
+{
+	public:
+		DbLoadThread(DataManager* dataMan, int part);
+
+		/*! Reason for failure, as the two texts of a GuiError. */
+		wxString getError() { return error1; }
+		wxString getErrorFile() { return error2; }
+
+	protected:
+		virtual ExitCode Entry();
+
+	private:
+		DataManager* dataMan;
+		int part;
+		wxString error1;
+		wxString error2;
+};
+
 #endif
@@ -84,18 +84,39 @@ void AuthorGroupEntry::removeEntry(int index)
 //**********************************************************
 
 WadEntry::WadEntry(uint32_t id, int mapSize)
-: dbid(id), fileName(""), fileSize(0), extraFiles(""), idGames(0),
-title(""), year(0), iwad(0), engine(0), playStyle(0),
-mapPointers(mapSize), numberOfMaps(0), flags(0), rating(255),
+: mapPointers(mapSize),
+dbid(id), fileSize(0), idGames(0), year(0), flags(0),
+iwad(0), engine(0), playStyle(0), numberOfMaps(0), rating(255),
 ownRating(255), ownFlags(0)
 {}
 
-string WadEntry::getName() const
+void* WadEntry::operator new(size_t size)
 {
-	if (title.length()==0)
-		return fileName;
+	if (size != sizeof(WadEntry))
+		return ::operator new(size);
+	return getPool().allocate();
+}
+
+void WadEntry::operator delete(void* ptr, size_t size)
+{
+	if (size != sizeof(WadEntry))
+		::operator delete(ptr);
+	else
+		getPool().release(ptr);
+}
+
+EntryPool& WadEntry::getPool()
+{
+	static EntryPool pool(sizeof(WadEntry), 1024);
+	return pool;
+}
+
+const string& WadEntry::getName() const
+{
+	if (title.empty())
+		return fileName.str();
 	else
-		return title;
+		return title.str();
 }
 
 void WadEntry::addMap(MapEntry* mapEntry)
@@ -104,10 +125,13 @@ void WadEntry::addMap(MapEntry* mapEntry)
 		mapPointers[numberOfMaps++] = mapEntry;
 }
 
-MapEntry* WadEntry::getMap(string& mapName)
+MapEntry* WadEntry::getMap(const string& mapName)
 {
+	const PooledString* key = StringPool::getPool().find(mapName);
+	if (key == NULL)
+		return NULL;
 	for (int i=0; i<numberOfMaps; i++) {
-		if (mapPointers[i]->name.compare(mapName)==0)
+		if (mapPointers[i]->name.handle() == key)
 			return mapPointers[i];
 	}
 	return NULL;
@@ -362,25 +386,47 @@ TagEntry::TagEntry(uint16_t id, string t)
 //**********************************************************
 
 MapEntry::MapEntry(uint32_t id)
-: dbid(id), wadPointer(NULL), name(""), title(""), basedOn(0),
-author1(NULL), author2(NULL), singlePlayer(0), cooperative(0), deathmatch(0), otherMode(0),
-linedefs(0), sectors(0), things(0), secrets(0), enemies(0), totalHP(0),
+: wadPointer(NULL), author1(NULL), author2(NULL),
+dbid(id), basedOn(0), linedefs(0), totalHP(0),
 healthRatio(0.0), armorRatio(0.0), ammoRatio(0.0), area(0.0),
-rating(255), flags(0), ownRating(255), ownFlags(0), played(0), difficulty(0), playTime(0)
+sectors(0), things(0), secrets(0), enemies(0), rating(255),
+singlePlayer(0), cooperative(0), deathmatch(0), otherMode(0),
+flags(0), ownRating(255), ownFlags(0), played(0), difficulty(0), playTime(0)
 {
 	for (int i=0; i<MAXTAGS; i++)
 		tags[i]=0;
 }
 
+void* MapEntry::operator new(size_t size)
+{
+	if (size != sizeof(MapEntry))
+		return ::operator new(size);
+	return getPool().allocate();
+}
+
+void MapEntry::operator delete(void* ptr, size_t size)
+{
+	if (size != sizeof(MapEntry))
+		::operator delete(ptr);
+	else
+		getPool().release(ptr);
+}
+
+EntryPool& MapEntry::getPool()
+{
+	static EntryPool pool(sizeof(MapEntry));
+	return pool;
+}
+
 string MapEntry::getTitle() const
 {
 	if (title.length()>0)
-		return title;
+		return title.str();
 	else
-		return wadPointer->getName() + " " + name;
+		return wadPointer->getName() + " " + name.str();
 }
 
 wxString MapEntry::fileName()
 {
-	return wxString(wadPointer->getMd5String()).Append("_").Append(name);
+	return wxString(wadPointer->getMd5String()).Append("_").Append(name.str());
 }
@@ -39,6 +39,8 @@ using namespace std;
 #include <vector>
 #include <map>
 #include "md5.h"
+#include "EntryPool.h"
+#include "StringPool.h"
 
 
 /*!
@@ -519,26 +521,27 @@ struct MapEntry; //Defined below
 * persistence, thereafter always larger than 0. fileName and md5Digest
 * must be specified, and md5Digest must be unique.
 *
-* ~60-100 bytes
+* Fields are ordered by size, to avoid padding. The persisted order
+* is defined by DataManager, not by this struct. Objects are allocated
+* from an EntryPool, and strings are shared in the StringPool. ~100 bytes.
 */
 struct WadEntry
 {
+	PoolString fileName; //!< Name of main file, ex: "mm.wad"
+	PoolString extraFiles; //!< List of additional files to load, with ';' separator
+	PoolString title; //!< Full title
+	vector<MapEntry*> mapPointers; //!< Pointers to MapEntry-objects (only in memory)
+
 	uint32_t dbid; //!< Wad Database ID (set by counter)
-	string fileName; //!< Name of main file, ex: "mm.wad"
 	uint32_t fileSize; //!< Bytes
-	unsigned char md5Digest[16]; //!< MD5 of main file - 16 bytes. Must be unique
-	string extraFiles; //!< List of additional files to load, with ';' separator
 	uint32_t idGames; //!< Wad id number in idGames database, for HTTP API
-
-	string title; //!< Full title
+	unsigned char md5Digest[16]; //!< MD5 of main file - 16 bytes. Must be unique
 	uint16_t year; //!< Year of (original) release, 0 for none
+	uint16_t flags; //!< Defined by WadFlags enum (mainly resource types)
 	unsigned char iwad; //!< What game/iwad the map is for (index in iwad list)
 	unsigned char engine; //!< What engine/port is needed (index in engine list)
 	unsigned char playStyle; //!< 0=2.5D, 1=3D, 2=special
-
-	vector<MapEntry*> mapPointers; //!< Pointers to MapEntry-objects (only in memory)
 	unsigned char numberOfMaps; //!< Number of entries in mapPointers
-	uint16_t flags; //!< Defined by WadFlags enum (mainly resource types)
 	unsigned char rating; //!< 0-100, an external rating (average?)
 
 	// Personal fields, persisted in separate file
@@ -548,14 +551,25 @@ struct WadEntry
 	/*! Constructor. id=0 if not yet stored. Specify size of mapPointers. */
 	WadEntry(uint32_t id, int mapSize);
 
+	/*! Allocates from the pool of all WadEntry objects. */
+	static void* operator new(size_t size);
+
+	static void operator delete(void* ptr, size_t size);
+
+	/*!
+	* The pool all WadEntry objects are allocated from, in chunks of 1024
+	* entries, as a database has far fewer wads than maps.
+	*/
+	static EntryPool& getPool();
+
 	/*! title if defined, otherwise fileName. */
-	string getName() const;
+	const string& getName() const;
 
 	/*! Add MapEntry, up to size specified by constructor. */
 	void addMap(MapEntry* mapEntry);
 
 	/*! Get MapEntry based on map name. */
-	MapEntry* getMap(string& mapName);
+	MapEntry* getMap(const string& mapName);
 
 	/*! Remove MapEntry at the given index in mapPointers, optionally also deleting the object. */
 	void removeMap(int index, bool del);
@@ -682,44 +696,47 @@ struct TagEntry
 * be NULL - the map must belong to a wad. name must be specified,
 * and must be unique within the wad.
 *
-* ~120 bytes
+* Fields are grouped by size, to avoid padding, so each group has
+* members of different kinds. Objects are allocated from an EntryPool,
+* and strings are shared in the StringPool. ~100 bytes.
 */
 struct MapEntry
 {
 	//Identity:
-	uint32_t dbid; //!< Map Database ID (set by counter, starts at 1)
 	WadEntry* wadPointer; //!< Pointer to WadEntry the map belongs to (wad dbid persisted)
-	string name; //!< Wad lump name, like E1M1 or MAP01, can't be empty
-	string title; //!< Human-readable map name
+	PoolString name; //!< Wad lump name, like E1M1 or MAP01, can't be empty
+	PoolString title; //!< Human-readable map name
 		//Use wadPointer->name if empty?
-	uint32_t basedOn; //!< Database ID of a related map - base/inspiration
 
 	AuthorEntry* author1; //!< Pointer to map designer (author dbid persisted)
 	AuthorEntry* author2; //!< Additional map designer (author dbid persisted)
 	//Can have AuthorGroupEntry with many authors
 
-	//Game mode:
-	unsigned char singlePlayer; //!< No / starts only / should work / made for
-	unsigned char cooperative; //!< No / starts only / should work / made for
-	unsigned char deathmatch; //!< No / starts only / should work / made for
-	unsigned char otherMode; //!< One other mode (index in list)
+	uint32_t dbid; //!< Map Database ID (set by counter, starts at 1)
+	uint32_t basedOn; //!< Database ID of a related map - base/inspiration
 
 	//Statistics:
 	uint32_t linedefs; //!< Number of linedefs in map geometry
-	uint16_t sectors; //!< Number of sectors in map geometry
-	uint16_t things; //!< Number of things in map
-	uint16_t secrets; //!< Number of secret sectors
-	uint16_t enemies;  //!< Number of monsters present (UV)
 	uint32_t totalHP; //!< Total health of all monsters (UV), with 1 bullet damage = 1
 	float healthRatio; //!< Total health of pickups (UV)
 	float armorRatio; //!< Total armor of pickups (UV)
 	float ammoRatio; //!< Total damage of ammo pickups (UV), with 1 bullet damage = 1
 	float area; //!< Total square area of all sectors
+	uint16_t sectors; //!< Number of sectors in map geometry
+	uint16_t things; //!< Number of things in map
+	uint16_t secrets; //!< Number of secret sectors
+	uint16_t enemies;  //!< Number of monsters present (UV)
 
 	//Descriptive:
 	uint16_t tags[MAXTAGS]; //!< Style keywords, from list
 	unsigned char rating; //!< 0-100, an external rating (average?)
 
+	//Game mode:
+	unsigned char singlePlayer; //!< No / starts only / should work / made for
+	unsigned char cooperative; //!< No / starts only / should work / made for
+	unsigned char deathmatch; //!< No / starts only / should work / made for
+	unsigned char otherMode; //!< One other mode (index in list)
+
 	//! The bits of this byte store Boolean flags. The flags are defined by
 	//! the enum MapFlags.
 	unsigned char flags;
@@ -734,6 +751,14 @@ struct MapEntry
 	/*! Constructor - id=0 if not yet stored. */
 	MapEntry(uint32_t id);
 
+	/*! Allocates from the pool of all MapEntry objects. */
+	static void* operator new(size_t size);
+
+	static void operator delete(void* ptr, size_t size);
+
+	/*! The pool all MapEntry objects are allocated from, in chunks of 4096 entries. */
+	static EntryPool& getPool();
+
 	/*! title if defined, otherwise wad name + map name. */
 	string getTitle() const;
 
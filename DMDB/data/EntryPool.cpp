@@ -0,0 +1,62 @@
+/*
+* EntryPool implementation
+*/
+
+#include "EntryPool.h"
+
+/*! Alignment of every slot, enough for pointers and doubles. */
+const size_t POOL_ALIGN = 8;
+
+EntryPool::EntryPool(size_t itemSize, size_t chunkItems)
+: chunkItems(chunkItems), nextSlot(chunkItems), freeList(NULL), live(0)
+{
+	if (itemSize < sizeof(FreeSlot))
+		itemSize = sizeof(FreeSlot);
+	slotSize = (itemSize + POOL_ALIGN - 1) / POOL_ALIGN * POOL_ALIGN;
+}
+
+EntryPool::~EntryPool()
+{
+	for (vector<char*>::iterator it=chunks.begin(); it!=chunks.end(); ++it)
+		delete[] *it;
+}
+
+void* EntryPool::allocate()
+{
+	wxMutexLocker locker(lock);
+	if (freeList != NULL) {
+		FreeSlot* slot = freeList;
+		freeList = slot->next;
+		live++;
+		return slot;
+	}
+	if (nextSlot == chunkItems) {
+		chunks.push_back(new char[slotSize*chunkItems]);
+		nextSlot = 0;
+	}
+	live++;
+	return chunks.back() + slotSize*(nextSlot++);
+}
+
+void EntryPool::release(void* ptr)
+{
+	if (ptr == NULL)
+		return;
+	wxMutexLocker locker(lock);
+	FreeSlot* slot = (FreeSlot*) ptr;
+	slot->next = freeList;
+	freeList = slot;
+	live--;
+}
+
+size_t EntryPool::getLiveCount()
+{
+	wxMutexLocker locker(lock);
+	return live;
+}
+
+size_t EntryPool::getReservedBytes()
+{
+	wxMutexLocker locker(lock);
+	return chunks.size() * slotSize * chunkItems;
+}
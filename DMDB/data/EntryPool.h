@@ -0,0 +1,79 @@
+/*!
+* \file EntryPool.h
+* \author Lars Thomas Boye 2020
+*
+* Memory pool for the many small objects of the core database.
+* WadEntry and MapEntry allocate themselves from an EntryPool, so
+* that a database of hundreds of thousands of entries is not spread
+* over as many separate heap blocks.
+*/
+
+#ifndef ENTRYPOOL_H
+#define ENTRYPOOL_H
+
+//Include wxWidgets headers:
+#include "wx/wxprec.h"
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <vector>
+#include <wx/thread.h>
+
+using namespace std;
+
+/*!
+* Allocates fixed-size slots from large chunks of memory. Slots are
+* handed out in order from the current chunk, so objects created one
+* after another (as when loading the database) lie next to each other
+* in memory, without any per-object heap header. Released slots are
+* kept in a free list and reused before taking new ones. Chunks are
+* only freed when the pool is destroyed.
+*
+* The pool is thread-safe, as entries are also created by the import
+* thread.
+*/
+class EntryPool
+{
+	public:
+		/*!
+		* Pool for objects of itemSize bytes, allocating chunkItems
+		* objects at a time. The WadEntry pool uses 1024, the MapEntry
+		* pool the default 4096.
+		*/
+		EntryPool(size_t itemSize, size_t chunkItems=4096);
+
+		~EntryPool();
+
+		/*! Memory for one object. Throws bad_alloc if out of memory. */
+		void* allocate();
+
+		/*! Returns memory from allocate to the pool. NULL is ignored. */
+		void release(void* ptr);
+
+		/*! Bytes per slot (object size rounded up to alignment). */
+		size_t getSlotSize() const { return slotSize; }
+
+		/*! Number of objects currently allocated. */
+		size_t getLiveCount();
+
+		/*! Total bytes of all chunks. */
+		size_t getReservedBytes();
+
+	private:
+		/*! Released slots are linked through their first bytes. */
+		struct FreeSlot
+		{
+			FreeSlot* next;
+		};
+
+		size_t slotSize;
+		size_t chunkItems;
+		vector<char*> chunks;
+		size_t nextSlot; //Next unused slot in the last chunk
+		FreeSlot* freeList;
+		size_t live;
+		wxMutex lock; //Guards all of the above
+};
+
+#endif // ENTRYPOOL_H
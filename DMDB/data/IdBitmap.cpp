@@ -0,0 +1,200 @@
+/*
+* IdBitmap implementation
+*/
+
+#include "IdBitmap.h"
+#include "MemoryUsage.h"
+
+IdBitmap::IdBitmap()
+: blocks(), size(0)
+{
+}
+
+IdBitmap::IdBitmap(const IdBitmap& other)
+: blocks(), size(0)
+{
+	copyFrom(other);
+}
+
+IdBitmap::~IdBitmap()
+{
+	clear();
+}
+
+IdBitmap& IdBitmap::operator=(const IdBitmap& other)
+{
+	if (this != &other) {
+		clear();
+		copyFrom(other);
+	}
+	return *this;
+}
+
+bool IdBitmap::add(uint32_t id)
+{
+	size_t b = id >> BLOCK_SHIFT;
+	if (b >= blocks.size())
+		blocks.resize(b+1, NULL);
+	if (blocks[b] == NULL) {
+		blocks[b] = new uint32_t[BLOCK_WORDS];
+		for (int i=0; i<BLOCK_WORDS; i++)
+			blocks[b][i] = 0;
+	}
+	uint32_t& word = blocks[b][(id >> 5) & (BLOCK_WORDS-1)];
+	uint32_t bit = 1u << (id & 31);
+	if (word & bit)
+		return false;
+	word |= bit;
+	size++;
+	return true;
+}
+
+bool IdBitmap::remove(uint32_t id)
+{
+	size_t b = id >> BLOCK_SHIFT;
+	if (b >= blocks.size() || blocks[b] == NULL)
+		return false;
+	uint32_t& word = blocks[b][(id >> 5) & (BLOCK_WORDS-1)];
+	uint32_t bit = 1u << (id & 31);
+	if (!(word & bit))
+		return false;
+	word &= ~bit;
+	size--;
+	freeIfEmpty(b);
+	return true;
+}
+
+bool IdBitmap::contains(uint32_t id) const
+{
+	size_t b = id >> BLOCK_SHIFT;
+	if (b >= blocks.size() || blocks[b] == NULL)
+		return false;
+	return (blocks[b][(id >> 5) & (BLOCK_WORDS-1)] & (1u << (id & 31))) != 0;
+}
+
+void IdBitmap::clear()
+{
+	for (size_t b=0; b<blocks.size(); b++) {
+		if (blocks[b] != NULL)
+			delete[] blocks[b];
+	}
+	blocks.clear();
+	size = 0;
+}
+
+uint32_t IdBitmap::next(uint32_t id) const
+{
+	if (id == 0xFFFFFFFF)
+		return 0;
+	id++;
+	size_t b = id >> BLOCK_SHIFT;
+	int w = (id >> 5) & (BLOCK_WORDS-1);
+	uint32_t mask = 0xFFFFFFFF << (id & 31);
+	while (b < blocks.size()) {
+		if (blocks[b] != NULL) {
+			for (; w<BLOCK_WORDS; w++) {
+				uint32_t word = blocks[b][w] & mask;
+				if (word != 0) {
+					int bit = 0;
+					while (!(word & 1)) {
+						word >>= 1;
+						bit++;
+					}
+					return (uint32_t)((b << BLOCK_SHIFT) + (w << 5) + bit);
+				}
+				mask = 0xFFFFFFFF;
+			}
+		}
+		b++;
+		w = 0;
+		mask = 0xFFFFFFFF;
+	}
+	return 0;
+}
+
+void IdBitmap::unite(const IdBitmap& other)
+{
+	if (other.blocks.size() > blocks.size())
+		blocks.resize(other.blocks.size(), NULL);
+	for (size_t b=0; b<other.blocks.size(); b++) {
+		if (other.blocks[b] == NULL)
+			continue;
+		if (blocks[b] == NULL) {
+			blocks[b] = new uint32_t[BLOCK_WORDS];
+			for (int i=0; i<BLOCK_WORDS; i++)
+				blocks[b][i] = 0;
+		}
+		for (int i=0; i<BLOCK_WORDS; i++) {
+			size += bitCount(other.blocks[b][i] & ~blocks[b][i]);
+			blocks[b][i] |= other.blocks[b][i];
+		}
+	}
+}
+
+void IdBitmap::intersect(const IdBitmap& other)
+{
+	for (size_t b=0; b<blocks.size(); b++) {
+		if (blocks[b] == NULL)
+			continue;
+		for (int i=0; i<BLOCK_WORDS; i++) {
+			uint32_t keep = (b<other.blocks.size() && other.blocks[b]!=NULL)? other.blocks[b][i]: 0;
+			size -= bitCount(blocks[b][i] & ~keep);
+			blocks[b][i] &= keep;
+		}
+		freeIfEmpty(b);
+	}
+}
+
+void IdBitmap::subtract(const IdBitmap& other)
+{
+	size_t n = (blocks.size() < other.blocks.size())? blocks.size(): other.blocks.size();
+	for (size_t b=0; b<n; b++) {
+		if (blocks[b] == NULL || other.blocks[b] == NULL)
+			continue;
+		for (int i=0; i<BLOCK_WORDS; i++) {
+			size -= bitCount(blocks[b][i] & other.blocks[b][i]);
+			blocks[b][i] &= ~other.blocks[b][i];
+		}
+		freeIfEmpty(b);
+	}
+}
+
+size_t IdBitmap::getBytes() const
+{
+	size_t bytes = MemoryUsage::heapBlock(blocks.capacity()*sizeof(uint32_t*));
+	for (size_t b=0; b<blocks.size(); b++) {
+		if (blocks[b] != NULL)
+			bytes += MemoryUsage::heapBlock(BLOCK_WORDS*sizeof(uint32_t));
+	}
+	return bytes;
+}
+
+int IdBitmap::bitCount(uint32_t word)
+{
+	word = word - ((word >> 1) & 0x55555555);
+	word = (word & 0x33333333) + ((word >> 2) & 0x33333333);
+	return (((word + (word >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+}
+
+void IdBitmap::freeIfEmpty(size_t b)
+{
+	for (int i=0; i<BLOCK_WORDS; i++) {
+		if (blocks[b][i] != 0)
+			return;
+	}
+	delete[] blocks[b];
+	blocks[b] = NULL;
+}
+
+void IdBitmap::copyFrom(const IdBitmap& other)
+{
+	blocks.resize(other.blocks.size(), NULL);
+	for (size_t b=0; b<other.blocks.size(); b++) {
+		if (other.blocks[b] != NULL) {
+			blocks[b] = new uint32_t[BLOCK_WORDS];
+			for (int i=0; i<BLOCK_WORDS; i++)
+				blocks[b][i] = other.blocks[b][i];
+		}
+	}
+	size = other.size;
+}
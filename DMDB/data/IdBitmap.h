@@ -0,0 +1,84 @@
+/*!
+* \file IdBitmap.h
+* \author Lars Thomas Boye 2020
+*
+* IdBitmap is a set of database IDs (dbid), represented as a bitmap
+* with one bit for each possible ID.
+*/
+
+#ifndef IDBITMAP_H
+#define IDBITMAP_H
+
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+/*!
+* Set of dbids as a bitmap. The bitmap is divided into blocks of 2048
+* IDs, and only blocks with at least one ID are allocated. As dbids are
+* assigned sequentially, this gives a compact representation both for
+* small lists of scattered entries and for large lists covering most of
+* the database. Membership test, add and remove are constant time, and
+* union, intersection and difference are done a word at a time.
+*
+* ID 0 is not used as dbid, and next returns 0 when there are no more
+* IDs. All IDs in ascending order are found with:
+*     for (uint32_t id=bm.next(0); id!=0; id=bm.next(id))
+*/
+class IdBitmap
+{
+	public:
+	IdBitmap();
+	IdBitmap(const IdBitmap& other);
+	~IdBitmap();
+	IdBitmap& operator=(const IdBitmap& other);
+
+	/*! Add id, returning false if it was already in the set. */
+	bool add(uint32_t id);
+
+	/*! Remove id, returning false if it was not in the set. */
+	bool remove(uint32_t id);
+
+	/*! true if id is in the set. */
+	bool contains(uint32_t id) const;
+
+	/*! Number of IDs in the set. */
+	uint32_t count() const { return size; }
+
+	bool empty() const { return size==0; }
+
+	void clear();
+
+	/*! The lowest ID in the set above id, or 0 if none. */
+	uint32_t next(uint32_t id) const;
+
+	/*! Add all IDs in other (union). */
+	void unite(const IdBitmap& other);
+
+	/*! Remove IDs not in other (intersection). */
+	void intersect(const IdBitmap& other);
+
+	/*! Remove all IDs in other (difference). */
+	void subtract(const IdBitmap& other);
+
+	/*! Estimated heap bytes of the block table and blocks. */
+	size_t getBytes() const;
+
+	private:
+	static const int BLOCK_SHIFT = 11; //2048 IDs per block
+	static const int BLOCK_WORDS = 64; //32-bit words per block
+
+	/*! Number of set bits in word. */
+	static int bitCount(uint32_t word);
+
+	/*! Delete block if it has no set bits. */
+	void freeIfEmpty(size_t b);
+
+	void copyFrom(const IdBitmap& other);
+
+	vector<uint32_t*> blocks; //NULL for blocks without IDs
+	uint32_t size;
+};
+
+#endif // IDBITMAP_H
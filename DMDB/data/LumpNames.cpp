@@ -0,0 +1,49 @@
+/*
+* LumpNames implementation
+*/
+
+#include "LumpNames.h"
+
+LumpCode packLumpName(const string& name)
+{
+	if (name.length() > 8)
+		return 0;
+	LumpCode code = 0;
+	for (size_t i=0; i<name.length(); i++)
+		code |= ((LumpCode)(unsigned char)lumpUpper(name[i])) << (8*i);
+	return code;
+}
+
+bool lumpNameMatches(LumpCode code, const char* pattern)
+{
+	char name[9];
+	int len = 0;
+	while (len<8 && (code>>(8*len))&0xFF) {
+		name[len] = (char)((code>>(8*len))&0xFF);
+		len++;
+	}
+	name[len] = 0;
+
+	//Match with backtracking to the last '*'
+	const char* n = name;
+	const char* p = pattern;
+	const char* star = NULL;
+	const char* starName = NULL;
+	while (*n != 0) {
+		if (*p == '*') {
+			star = p++;
+			starName = n;
+		} else if (*p!=0 && (*p=='?' || *p==*n)) {
+			p++;
+			n++;
+		} else if (star != NULL) {
+			p = star+1;
+			n = ++starName;
+		} else {
+			return false;
+		}
+	}
+	while (*p == '*')
+		p++;
+	return *p == 0;
+}
@@ -0,0 +1,53 @@
+/*!
+* \file LumpNames.h
+* \author Lars Thomas Boye 2020
+*
+* Wad lump names packed into 64-bit numbers, so that WadStats can check
+* lump names with integer comparisons instead of string comparisons.
+*/
+
+#ifndef LUMPNAMES_H
+#define LUMPNAMES_H
+
+#include <string>
+#include <stdint.h>
+
+using namespace std;
+
+/*!
+* A lump name of up to 8 characters, upper-cased, with character i in
+* byte i (counting from the least significant byte). Unused bytes are 0,
+* like the name field in the wad directory, so the empty name is 0.
+*/
+typedef uint64_t LumpCode;
+
+/*! Upper-case ASCII character. */
+constexpr char lumpUpper(char c)
+{
+	return (c>='a' && c<='z')? (char)(c-'a'+'A'): c;
+}
+
+/*!
+* LumpCode for a name literal, for comparing with or using in case labels,
+* which makes it a compile-time constant. Only the first 8 characters are
+* used.
+*/
+constexpr LumpCode lumpCode(const char* name, int i=0)
+{
+	return (i>=8 || name[i]==0)? 0:
+		(((LumpCode)(unsigned char)lumpUpper(name[i])) << (8*i)) | lumpCode(name, i+1);
+}
+
+/*!
+* LumpCode for the name of a lump or file. Names longer than 8 characters
+* can't be wad lump names, and give 0, which matches no known name.
+*/
+LumpCode packLumpName(const string& name);
+
+/*!
+* Check LumpCode against a pattern with wildcards, as wxString::Matches.
+* '?' matches any one character and '*' any number of characters.
+*/
+bool lumpNameMatches(LumpCode code, const char* pattern);
+
+#endif // LUMPNAMES_H
@@ -0,0 +1,135 @@
+/*
+* LumpSignature implementation
+*/
+
+#include "LumpSignature.h"
+#include <cstring>
+
+/*!
+* Magic number, as the bytes to compare (mask) and their values, with the
+* first byte of the data in the least significant byte.
+*/
+struct MagicSignature
+{
+	uint64_t mask;
+	uint64_t magic;
+	LumpFormat format;
+	SniffConfidence confidence;
+};
+
+/*! Mask with 0xFF for each of the first length bytes. */
+constexpr uint64_t magicMask(size_t length)
+{
+	return (length >= 8)? ~0ULL: (1ULL << (8*length)) - 1;
+}
+
+/*! Magic number of the string literal (without terminating 0). */
+constexpr uint64_t magicValue(const char* bytes, size_t length, size_t i=0)
+{
+	return (i >= length)? 0: (((uint64_t)(unsigned char)bytes[i]) << (8*i)) | magicValue(bytes, length, i+1);
+}
+
+#define MAGIC(str, format) { magicMask(sizeof(str)-1), magicValue(str, sizeof(str)-1), format, \
+	(sizeof(str)-1 >= 4)? SNIFF_CERTAIN: SNIFF_LIKELY }
+
+/*!
+* The known magic numbers. New formats with a magic number only need an
+* entry here. Matching is a mask and compare for each entry, with no
+* branches, so the compiler can vectorize it.
+*/
+static const MagicSignature signatures[] = {
+	MAGIC("\x89PNG", LFMT_PNG),
+	MAGIC("\xFF\xD8\xFF", LFMT_JPG),
+	MAGIC("BM6", LFMT_BMP),
+	MAGIC("FON1", LFMT_FONT),
+	MAGIC("FON2", LFMT_FONT),
+	MAGIC("MUS\x1A", LFMT_MUS),
+	MAGIC("MThd", LFMT_MIDI),
+	MAGIC("ID3", LFMT_MP3),
+	MAGIC("\xFF\xFA", LFMT_MP3),
+	MAGIC("\xFF\xFB", LFMT_MP3),
+	MAGIC("\xFF\xF3", LFMT_MP3),
+	MAGIC("OggS", LFMT_OGG),
+	MAGIC("RIFF", LFMT_WAV),
+	MAGIC("fLaC", LFMT_FLAC),
+	MAGIC("ACS", LFMT_ACS)
+};
+
+static const size_t signatureCount = sizeof(signatures) / sizeof(signatures[0]);
+
+/*! Little-endian 16-bit value at data[pos]. */
+static int32_t read16(const unsigned char* data, size_t pos, bool sign)
+{
+	uint16_t val = data[pos] | (data[pos+1] << 8);
+	return sign? (int32_t)(int16_t)val: (int32_t)val;
+}
+
+size_t pictureHeaderSize(const unsigned char* data, size_t length, int32_t lumpSize)
+{
+	if (length < 8)
+		return 0;
+	uint32_t columnStart = (read16(data, 0, true)*4) + 8; //Huge if width is negative
+	if ((uint32_t)lumpSize <= columnStart)
+		return 0;
+	return (columnStart < 8)? 8: columnStart; //No column offsets if width <= 0
+}
+
+/*! Doom picture: width, height and offsets, followed by an offset for each column. */
+static bool isPicture(const unsigned char* data, size_t length, int32_t lumpSize)
+{
+	size_t columnStart = pictureHeaderSize(data, length, lumpSize);
+	if (columnStart==0 || columnStart>length)
+		return false;
+	for (size_t pos=8; pos<columnStart; pos+=4) {
+		uint32_t offset = data[pos] | (data[pos+1]<<8) | (data[pos+2]<<16) | ((uint32_t)data[pos+3]<<24);
+		if ((offset>(uint32_t)lumpSize) || (offset<(uint32_t)columnStart))
+			return false;
+	}
+	return true;
+}
+
+LumpSniff sniffLump(const unsigned char* data, size_t length, int32_t lumpSize)
+{
+	LumpSniff result;
+	result.formats = 0;
+	result.format = LFMT_NONE;
+	result.confidence = SNIFF_NONE;
+	memset(result.start, 0, SNIFF_MAGIC);
+	memcpy(result.start, data, (length<SNIFF_MAGIC)? length: SNIFF_MAGIC);
+
+	uint64_t prefix = 0;
+	for (size_t i=0; i<SNIFF_MAGIC; i++)
+		prefix |= ((uint64_t)result.start[i]) << (8*i);
+	uint32_t matched = 0; //Bit for each matching table entry
+	for (size_t i=0; i<signatureCount; i++)
+		matched |= (uint32_t)((prefix & signatures[i].mask) == signatures[i].magic) << i;
+	for (size_t i=0; i<signatureCount; i++) {
+		if (matched & (1u<<i)) {
+			result.formats |= 1u << signatures[i].format;
+			if (signatures[i].confidence > result.confidence) {
+				result.format = signatures[i].format;
+				result.confidence = signatures[i].confidence;
+			}
+		}
+	}
+
+	//Heuristics, for formats without magic numbers
+	if (length >= 4) {
+		if (read16(data, 0, false)==3 && read16(data, 2, false)>=5500)
+			result.formats |= 1u << LFMT_SFX; //Format 3, sample rate
+		if (read16(data, 0, true)==0 && lumpSize==read16(data, 2, true)+4)
+			result.formats |= 1u << LFMT_SPEAKER; //0, sample count
+	}
+	if (isPicture(data, length, lumpSize))
+		result.formats |= 1u << LFMT_PICTURE;
+	if (result.confidence == SNIFF_NONE) {
+		for (int f=LFMT_SFX; f<LFMT_NONE; f++) {
+			if (result.is((LumpFormat)f)) {
+				result.format = (LumpFormat)f;
+				result.confidence = SNIFF_WEAK;
+				break;
+			}
+		}
+	}
+	return result;
+}
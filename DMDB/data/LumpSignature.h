@@ -0,0 +1,82 @@
+/*!
+* \file LumpSignature.h
+* \author Lars Thomas Boye 2020
+*
+* Detection of lump (or file) formats from the first bytes of the data.
+* sniffLump matches the data against a table of magic numbers and a few
+* header heuristics in one pass, reporting all formats which match and
+* the most likely one.
+*/
+
+#ifndef LUMPSIGNATURE_H
+#define LUMPSIGNATURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*! Formats recognized by sniffLump. */
+enum LumpFormat
+{
+	LFMT_PNG,
+	LFMT_JPG,
+	LFMT_BMP,
+	LFMT_FONT, //!< FON1 or FON2
+	LFMT_MUS, //!< Doom-format music
+	LFMT_MIDI,
+	LFMT_MP3,
+	LFMT_OGG,
+	LFMT_WAV,
+	LFMT_FLAC,
+	LFMT_ACS, //!< Compiled ACS script
+	LFMT_SFX, //!< Doom-format sound sample (heuristic)
+	LFMT_SPEAKER, //!< PC speaker sound (heuristic)
+	LFMT_PICTURE, //!< Doom-format image (heuristic)
+	LFMT_NONE
+};
+
+/*! How sure sniffLump is about a format. */
+enum SniffConfidence
+{
+	SNIFF_NONE, //!< No format matched
+	SNIFF_WEAK, //!< Header fields are plausible for the format
+	SNIFF_LIKELY, //!< Short (2 or 3 byte) magic number
+	SNIFF_CERTAIN //!< Magic number of at least 4 bytes
+};
+
+/*! Bytes needed for matching the magic numbers. */
+const size_t SNIFF_MAGIC = 8;
+
+/*!
+* Buffer size for the start of a lump for sniffLump: the Doom picture
+* header with the column offsets of pictures up to 256 wide. Read the
+* first SNIFF_MAGIC bytes, and use pictureHeaderSize to find how many
+* more a picture needs.
+*/
+const size_t SNIFF_SIZE = 8 + 256*4;
+
+/*! Result of sniffLump. */
+struct LumpSniff
+{
+	uint32_t formats; //!< Bit (1<<LumpFormat) for each matching format
+	LumpFormat format; //!< Most likely format, LFMT_NONE if none matched
+	SniffConfidence confidence; //!< Confidence of format
+	unsigned char start[SNIFF_MAGIC]; //!< First bytes of the data, 0-padded
+
+	/*! true if the data matches format f. */
+	bool is(LumpFormat f) const { return (formats & (1u<<f)) != 0; }
+};
+
+/*!
+* Match the first length bytes of a lump with lumpSize bytes against all
+* known formats. Magic numbers need the first SNIFF_MAGIC bytes, while the
+* Doom picture check needs the whole column offset table.
+*/
+LumpSniff sniffLump(const unsigned char* data, size_t length, int32_t lumpSize);
+
+/*!
+* If the data starts with a plausible Doom picture header, the number of
+* bytes needed to check the column offsets. 0 if not a picture.
+*/
+size_t pictureHeaderSize(const unsigned char* data, size_t length, int32_t lumpSize);
+
+#endif // LUMPSIGNATURE_H
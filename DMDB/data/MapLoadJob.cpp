@@ -0,0 +1,395 @@
+/*
+* MapLoadJob implementation
+*/
+
+#include "MapLoadJob.h"
+#include "CoreBase.h"
+
+/*! Orders wad entries on dbid. */
+static bool wadIdLess(WadEntry* a, WadEntry* b)
+{
+	return a->dbid < b->dbid;
+}
+
+/*! Orders a wad entry before a dbid, for lower_bound. */
+static bool wadBeforeId(WadEntry* a, uint32_t id)
+{
+	return a->dbid < id;
+}
+
+/*! Id of the last MapLoadJob made. Jobs are only made by the main thread. */
+static long lastJobId = 0;
+
+/*! Maps per thread for the link phase, below which fewer threads are used. */
+const size_t LINK_PART_MIN = 8192;
+
+MapLoadJob::MapLoadJob(wxEvtHandler* handler, const wxString& folder)
+: wxThread(wxTHREAD_JOINABLE), jobId(++lastJobId), eventHandler(handler), dbFolder(folder), linkReady(0, 1),
+maps(NULL), refs(NULL), authorIndex(NULL), tagIndex(NULL), basedOnIndex(NULL)
+{
+	maps = new vector<MapEntry*>();
+	refs = new vector<MapRefs>();
+	authorIndex = new MapIndex<uint32_t>();
+	tagIndex = new MapIndex<uint16_t>();
+	basedOnIndex = new MapIndex<uint32_t>();
+}
+
+MapLoadJob::~MapLoadJob()
+{
+	if (maps != NULL) {
+		for (vector<MapEntry*>::iterator it=maps->begin(); it!=maps->end(); ++it)
+			delete *it;
+		delete maps;
+	}
+	delete refs;
+	if (authorIndex != NULL)
+		delete authorIndex;
+	if (tagIndex != NULL)
+		delete tagIndex;
+	if (basedOnIndex != NULL)
+		delete basedOnIndex;
+}
+
+void MapLoadJob::setLinks(const vector<WadEntry*>& wadList, const vector<AuthorEntry*>& authorList)
+{
+	wads = wadList;
+	//Wads are normally in dbid order already
+	if (!is_sorted(wads.begin(), wads.end(), wadIdLess))
+		sort(wads.begin(), wads.end(), wadIdLess);
+	for (vector<AuthorEntry*>::const_iterator it=authorList.begin(); it!=authorList.end(); ++it)
+		authors[(*it)->dbid] = *it;
+	linkReady.Post();
+}
+
+wxThread::ExitCode MapLoadJob::Entry()
+{
+	bool ok = readMaps();
+	//Wait for the wads and authors, which are read at the same time
+	while (linkReady.WaitTimeout(50) == wxSEMA_TIMEOUT) {
+		if (TestDestroy())
+			return (wxThread::ExitCode)0; //Database closed
+	}
+	if (TestDestroy())
+		return (wxThread::ExitCode)0;
+	if (ok)
+		linkMaps();
+	if (eventHandler != NULL) {
+		wxThreadEvent* event = new wxThreadEvent(wxEVT_THREAD, THREAD_MAPSLOADED);
+		event->SetInt(maps->size());
+		event->SetExtraLong(jobId);
+		wxQueueEvent(eventHandler, event);
+	}
+	return (wxThread::ExitCode)0;
+}
+
+bool MapLoadJob::readMaps()
+{
+	wxStopWatch watch;
+	try {
+		if (readMapDB())
+			readMapOwn();
+	} catch (GuiError& err) {
+		error1 = err.text1;
+		error2 = err.text2;
+		return false;
+	}
+	wxLogVerbose("Read map files in %ld ms", watch.Time());
+	return true;
+}
+
+void MapLoadJob::linkMaps()
+{
+	wxStopWatch watch;
+	size_t size = maps->size();
+	size_t parts = wxThread::GetCPUCount();
+	if (parts*LINK_PART_MIN > size)
+		parts = size/LINK_PART_MIN;
+	if (parts < 1)
+		parts = 1;
+
+	//The tag and basedOn indexes only need the maps. Wad and author
+	//pointers are resolved in parts, the first by this thread.
+	vector<wxThread*> indexThreads;
+	startPart(indexThreads, LINK_TAGS, 0, size);
+	startPart(indexThreads, LINK_BASEDON, 0, size);
+	vector<wxThread*> refThreads;
+	size_t partSize = size / parts;
+	for (size_t i=1; i<parts; i++) {
+		size_t end = (i==parts-1)? size: (i+1)*partSize;
+		startPart(refThreads, LINK_REFS, i*partSize, end);
+	}
+	linkPart(LINK_REFS, 0, (parts==1)? size: partSize);
+	for (vector<wxThread*>::iterator it=refThreads.begin(); it!=refThreads.end(); ++it) {
+		(*it)->Wait();
+		delete *it;
+	}
+	linkPart(LINK_AUTHORS, 0, size);
+	for (vector<wxThread*>::iterator it=indexThreads.begin(); it!=indexThreads.end(); ++it) {
+		(*it)->Wait();
+		delete *it;
+	}
+	refs->clear();
+	wxLogVerbose("Linked %i maps in %ld ms, %i parts", size, watch.Time(), parts);
+}
+
+void MapLoadJob::startPart(vector<wxThread*>& threads, MapLinkTask task, size_t begin, size_t end)
+{
+	MapLinkThread* thread = new MapLinkThread(this, task, begin, end);
+	if (thread->Run() == wxTHREAD_NO_ERROR) {
+		threads.push_back(thread);
+	} else {
+		delete thread;
+		linkPart(task, begin, end);
+	}
+}
+
+void MapLoadJob::linkPart(MapLinkTask task, size_t begin, size_t end)
+{
+	MapEntry* entry;
+	switch (task) {
+	case LINK_REFS:
+		for (size_t i=begin; i<end; i++) {
+			entry = (*maps)[i];
+			const MapRefs& ref = (*refs)[i];
+			entry->wadPointer = findWad(ref.wad);
+			if (entry->wadPointer==NULL)
+				wxLogVerbose("Map %i missing ref to wad %i", entry->dbid, ref.wad);
+			if (ref.author1 != 0)
+				entry->author1 = findAuthor(ref.author1);
+			if (ref.author2 != 0)
+				entry->author2 = findAuthor(ref.author2);
+		}
+		break;
+	case LINK_AUTHORS:
+		for (size_t i=begin; i<end; i++)
+			DataManager::indexMap((*maps)[i], authorIndex, NULL, NULL);
+		break;
+	case LINK_TAGS:
+		for (size_t i=begin; i<end; i++)
+			DataManager::indexMap((*maps)[i], NULL, tagIndex, NULL);
+		break;
+	case LINK_BASEDON:
+		for (size_t i=begin; i<end; i++)
+			DataManager::indexMap((*maps)[i], NULL, NULL, basedOnIndex);
+		break;
+	}
+}
+
+vector<MapEntry*>* MapLoadJob::takeMaps()
+{
+	vector<MapEntry*>* result = maps;
+	maps = NULL;
+	return result;
+}
+
+MapIndex<uint32_t>* MapLoadJob::takeAuthorIndex()
+{
+	MapIndex<uint32_t>* result = authorIndex;
+	authorIndex = NULL;
+	return result;
+}
+
+MapIndex<uint16_t>* MapLoadJob::takeTagIndex()
+{
+	MapIndex<uint16_t>* result = tagIndex;
+	tagIndex = NULL;
+	return result;
+}
+
+MapIndex<uint32_t>* MapLoadJob::takeBasedOnIndex()
+{
+	MapIndex<uint32_t>* result = basedOnIndex;
+	basedOnIndex = NULL;
+	return result;
+}
+
+bool MapLoadJob::readMapDB()
+{
+	wxString fname(dbFolder+wxFILE_SEP_PATH+FILE_MAPDB);
+	if (!wxFile::Exists(fname)) {
+		wxLogVerbose("File %s not found", FILE_MAPDB);
+		return false;
+	}
+	wxLogVerbose("Reading all map entries from file %s", FILE_MAPDB);
+	wxFileInputStream fileStream(fname);
+	if (!fileStream.IsOk()) throw GuiError("Couldn't open file.", FILE_MAPDB);
+	wxBufferedInputStream* buf = new wxBufferedInputStream(fileStream, 1024);
+
+	unsigned char ch;
+	uint32_t id;
+	buf->Read(&ch, 1);
+	if (ch != MAPDB_FILEV) {
+		delete buf;
+		throw GuiError("Map database file has unsupported version number", FILE_MAPDB);
+	}
+
+	MapEntry* entry;
+	MapRefs ref;
+	string text;
+	wxString str;
+	double doubl;
+	uint16_t* tagPtr;
+	while (!buf->Eof()) {
+		if (maps->size()%1024==0 && IsRunning() && TestDestroy())
+			break;
+		buf->Read(&id, 4);
+		if (buf->Eof())
+			break;
+		entry = new MapEntry(id);
+		buf->Read(&(ref.wad), 4);
+		do { //name
+			buf->Read(&ch, 1);
+			if (ch != 0)
+				text += ch;
+
+		} while (ch != 0);
+		entry->name = text;
+		text.clear();
+		do { //title
+			buf->Read(&ch, 1);
+			if (ch != 0)
+				text += ch;
+
+		} while (ch != 0);
+		entry->title = text;
+		text.clear();
+		buf->Read(&(entry->basedOn), 4);
+
+		//Wad and authors are resolved by linkMaps
+		buf->Read(&(ref.author1), 4);
+		buf->Read(&(ref.author2), 4);
+
+		buf->Read(&(entry->singlePlayer), 1);
+		buf->Read(&(entry->cooperative), 1);
+		buf->Read(&(entry->deathmatch), 1);
+		buf->Read(&(entry->otherMode), 1);
+
+		buf->Read(&(entry->linedefs), 4);
+		buf->Read(&(entry->sectors), 2);
+		buf->Read(&(entry->things), 2);
+		buf->Read(&(entry->secrets), 2);
+		buf->Read(&(entry->enemies), 2);
+		buf->Read(&(entry->totalHP), 4);
+
+		//Floats are stored as strings
+		do { //healthRatio
+			buf->Read(&ch, 1);
+			if (ch != 0)
+				str << ch;
+
+		} while (ch != 0);
+		str.ToCDouble(&doubl);
+		entry->healthRatio = doubl;
+		str.Clear();
+
+		do { //armorRatio
+			buf->Read(&ch, 1);
+			if (ch != 0)
+				str << ch;
+
+		} while (ch != 0);
+		str.ToCDouble(&doubl);
+		entry->armorRatio = doubl;
+		str.Clear();
+
+		do { //ammoRatio
+			buf->Read(&ch, 1);
+			if (ch != 0)
+				str << ch;
+
+		} while (ch != 0);
+		str.ToCDouble(&doubl);
+		entry->ammoRatio = doubl;
+		str.Clear();
+
+		do { //area
+			buf->Read(&ch, 1);
+			if (ch != 0)
+				str << ch;
+
+		} while (ch != 0);
+		str.ToCDouble(&doubl);
+		entry->area = doubl;
+		str.Clear();
+
+		tagPtr = entry->tags;
+		buf->Read(tagPtr, MAXTAGS*2);
+		buf->Read(&(entry->rating), 1);
+		buf->Read(&(entry->flags), 1);
+
+		maps->push_back(entry);
+		refs->push_back(ref);
+	}
+	wxLogVerbose("Finished reading %i map entries", maps->size());
+	delete buf;
+	return true;
+}
+
+void MapLoadJob::readMapOwn()
+{
+	wxString fname(dbFolder+wxFILE_SEP_PATH+FILE_MAPOWN);
+	if (!wxFile::Exists(fname)) {
+		wxLogVerbose("File %s not found", FILE_MAPOWN);
+		return;
+	}
+	wxFileInputStream fileStream(fname);
+	if (!fileStream.IsOk()) return;
+	wxBufferedInputStream* buf = new wxBufferedInputStream(fileStream, 1024);
+	wxLogVerbose("Reading personal map entries from file %s", FILE_MAPOWN);
+
+	unsigned char ch;
+	uint32_t id;
+	buf->Read(&ch, 1);
+	if (ch != MAPDB_FILEV) {
+		wxLogVerbose("Map personal file has unsupported version number");
+		delete buf;
+		return;
+	}
+
+	MapEntry* entry;
+	unsigned int index = 0;
+	while (!buf->Eof() && index<maps->size()) {
+		entry = maps->at(index);
+		buf->Read(&id, 4); //Must match entry->dbid
+		buf->Read(&(entry->ownRating), 1);
+		//buf->Read(&(entry->ownFlags), 1);
+		buf->Read(&(entry->played), 1);
+		buf->Read(&(entry->difficulty), 1);
+		buf->Read(&(entry->playTime), 1);
+		index++;
+	}
+	wxLogVerbose("Finished reading %i map entries", index);
+	delete buf;
+}
+
+WadEntry* MapLoadJob::findWad(uint32_t id)
+{
+	vector<WadEntry*>::iterator it = lower_bound(wads.begin(), wads.end(), id, wadBeforeId);
+	if (it!=wads.end() && (*it)->dbid==id)
+		return *it;
+	return NULL;
+}
+
+AuthorEntry* MapLoadJob::findAuthor(uint32_t id)
+{
+	map<uint32_t, AuthorEntry*>::iterator it = authors.find(id);
+	if (it == authors.end())
+		return NULL;
+	return it->second;
+}
+
+
+//***************************************************************
+//************************ MapLinkThread ************************
+//***************************************************************
+
+MapLinkThread::MapLinkThread(MapLoadJob* job, MapLinkTask task, size_t begin, size_t end)
+: wxThread(wxTHREAD_JOINABLE), job(job), task(task), begin(begin), end(end)
+{
+}
+
+wxThread::ExitCode MapLinkThread::Entry()
+{
+	job->linkPart(task, begin, end);
+	return (wxThread::ExitCode)0;
+}
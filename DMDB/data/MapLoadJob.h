@@ -0,0 +1,171 @@
+/*!
+* \file MapLoadJob.h
+* \author Lars Thomas Boye 2020
+*
+* MapLoadJob reads the map entries of the database in a worker
+* thread, so that the main window can be used while the maps of
+* a large database are loaded.
+*/
+
+#ifndef MAPLOADJOB_H
+#define MAPLOADJOB_H
+
+//Include wxWidgets headers:
+#include "wx/wxprec.h"
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <map>
+#include <vector>
+#include <wx/thread.h>
+#include "DataManager.h"
+
+/*! Tasks of the link phase of MapLoadJob. */
+enum MapLinkTask {
+	LINK_REFS, //!< Wad and author pointers of a range of maps
+	LINK_AUTHORS, //!< Author index of all maps (after LINK_REFS)
+	LINK_TAGS, //!< Tag index of all maps
+	LINK_BASEDON //!< BasedOn index of all maps
+};
+
+/*!
+* MapLoadJob reads FILE_MAPDB and FILE_MAPOWN into a list of new
+* MapEntry objects, and builds the author, tag and basedOn indexes for
+* them. As with WadImportJob, it never touches the DataManager.
+*
+* Reading is done in two phases, so that the map files can be read at
+* the same time as the wad and author files. readMaps parses the files
+* into the new entries, keeping the wad and author dbids of each map in
+* a staging list. When the wads and authors are loaded, the owner calls
+* setLinks with copies of their lists. linkMaps then resolves the dbids
+* to pointers and builds the indexes, splitting the work on several
+* MapLinkThreads. The maps are not added to their wads, as the wads are
+* used by the GUI thread while the job runs. DataManager::completeLoad
+* does this, and takes over the maps and indexes.
+*
+* Run the thread to do both phases in the background, waiting for
+* setLinks between them. THREAD_MAPSLOADED is posted to the event handler
+* when done, if there is one, with the job id as its extra long. Or call
+* readMaps and linkMaps directly to read in the calling thread, such as
+* with a job on the stack. Call Wait to join the thread before taking the
+* results.
+*/
+class MapLoadJob : public wxThread
+{
+	public:
+		/*!
+		* The job reads the map files in folder. handler can be NULL,
+		* for no event when done.
+		*/
+		MapLoadJob(wxEvtHandler* handler, const wxString& folder);
+
+		/*! Deletes maps and indexes which have not been taken. */
+		virtual ~MapLoadJob();
+
+		/*!
+		* Gives the entries maps can refer to, which must not be deleted
+		* until the job is done. A running job waits for this before
+		* linking the maps.
+		*/
+		void setLinks(const vector<WadEntry*>& wads, const vector<AuthorEntry*>& authors);
+
+		/*!
+		* Reads the map files. Returns false if the map DB file can't be
+		* read, with the reason in getError. A missing file means no maps.
+		*/
+		bool readMaps();
+
+		/*! Resolves wad and author references and builds the indexes. */
+		void linkMaps();
+
+		/*!
+		* Does one task of the link phase, for maps begin to end-1. This
+		* is called by linkMaps and its MapLinkThreads.
+		*/
+		void linkPart(MapLinkTask task, size_t begin, size_t end);
+
+		/*!
+		* Number identifying the job, unique in the process. An event from
+		* the job of a closed database can be told from that of the current.
+		*/
+		long getJobId() { return jobId; }
+
+		/*! Reason for failure, as the two texts of a GuiError. */
+		wxString getError() { return error1; }
+		wxString getErrorFile() { return error2; }
+
+		/*! The maps read, in file order. The caller takes over the list. */
+		vector<MapEntry*>* takeMaps();
+
+		/*! Index of maps on author dbid. The caller takes over the index. */
+		MapIndex<uint32_t>* takeAuthorIndex();
+
+		/*! Index of maps on tag dbid. The caller takes over the index. */
+		MapIndex<uint16_t>* takeTagIndex();
+
+		/*! Index of maps on basedOn. The caller takes over the index. */
+		MapIndex<uint32_t>* takeBasedOnIndex();
+
+	protected:
+		virtual ExitCode Entry();
+
+	private:
+		/*! The dbids a map refers to, until resolved by linkMaps. */
+		struct MapRefs
+		{
+			uint32_t wad;
+			uint32_t author1;
+			uint32_t author2;
+		};
+
+		/*! Reads the core map entries from FILE_MAPDB. */
+		bool readMapDB();
+
+		/*! Reads the personal fields from FILE_MAPOWN. */
+		void readMapOwn();
+
+		/*! Runs task in a new thread, added to threads, or right away if that fails. */
+		void startPart(vector<wxThread*>& threads, MapLinkTask task, size_t begin, size_t end);
+
+		/*! Wad with dbid id, from the sorted wads, or NULL. */
+		WadEntry* findWad(uint32_t id);
+
+		/*! Author with dbid id, or NULL. */
+		AuthorEntry* findAuthor(uint32_t id);
+
+		long jobId;
+		wxEvtHandler* eventHandler;
+		wxString dbFolder;
+		wxSemaphore linkReady; //Posted by setLinks
+		vector<WadEntry*> wads; //Sorted on dbid
+		map<uint32_t, AuthorEntry*> authors;
+
+		vector<MapEntry*>* maps;
+		vector<MapRefs>* refs; //Staging, same order as maps
+		MapIndex<uint32_t>* authorIndex;
+		MapIndex<uint16_t>* tagIndex;
+		MapIndex<uint32_t>* basedOnIndex;
+		wxString error1;
+		wxString error2;
+};
+
+/*!
+* Joinable thread doing one task of the link phase of a MapLoadJob,
+* for a range of its maps.
+*/
+class MapLinkThread : public wxThread
+{
+	public:
+		MapLinkThread(MapLoadJob* job, MapLinkTask task, size_t begin, size_t end);
+
+	protected:
+		virtual ExitCode Entry();
+
+	private:
+		MapLoadJob* job;
+		MapLinkTask task;
+		size_t begin, end;
+};
+
+#endif // MAPLOADJOB_H
@@ -0,0 +1,186 @@
+/*
+* MapRaster implementation
+*/
+
+#include "MapRaster.h"
+#include <wx/wfstream.h>
+#include <wx/mstream.h>
+#include <wx/zstream.h>
+#include <cstdlib>
+#include <cstring>
+
+/*! Lookup table for CRC-32, one entry per byte value. */
+struct CrcTable
+{
+	uint32_t values[256];
+
+	CrcTable()
+	{
+		for (uint32_t n=0; n<256; n++) {
+			uint32_t c = n;
+			for (int k=0; k<8; k++)
+				c = (c & 1)? 0xEDB88320 ^ (c >> 1): c >> 1;
+			values[n] = c;
+		}
+	}
+};
+
+/*! CRC-32 of PNG chunks, continuing from crc. */
+static uint32_t pngCrc(uint32_t crc, const uint8_t* data, size_t length)
+{
+	static const CrcTable table; //Initialized once, also with several threads
+	crc = ~crc;
+	for (size_t i=0; i<length; i++)
+		crc = table.values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+/*! Write 32-bit number big-endian, as in PNG. */
+static void putBigEndian(uint8_t* dest, uint32_t val)
+{
+	dest[0] = (val >> 24) & 0xFF;
+	dest[1] = (val >> 16) & 0xFF;
+	dest[2] = (val >> 8) & 0xFF;
+	dest[3] = val & 0xFF;
+}
+
+/*! Write a PNG chunk, with length, type, data and CRC. */
+static void writeChunk(wxOutputStream& out, const char* type, const uint8_t* data, size_t length)
+{
+	uint8_t head[8];
+	putBigEndian(head, length);
+	memcpy(head+4, type, 4);
+	out.Write(head, 8);
+	if (length > 0)
+		out.Write(data, length);
+	uint8_t crc[4];
+	putBigEndian(crc, pngCrc(pngCrc(0, head+4, 4), data, length));
+	out.Write(crc, 4);
+}
+
+MapRaster::MapRaster(int w, int h, int ss)
+: width(w), height(h), supersample(ss)
+{
+	if (supersample < 1)
+		supersample = 1;
+	else if (supersample > RASTER_MAX_SUPERSAMPLE)
+		supersample = RASTER_MAX_SUPERSAMPLE;
+	bufWidth = width*supersample;
+	bufHeight = height*supersample;
+	buffer.resize(bufWidth*bufHeight, 0);
+	for (int i=0; i<3; i++)
+		colours[i][0] = colours[i][1] = colours[i][2] = 0;
+}
+
+void MapRaster::setColour(int index, const wxColour& colour)
+{
+	colours[index][0] = colour.Red();
+	colours[index][1] = colour.Green();
+	colours[index][2] = colour.Blue();
+}
+
+void MapRaster::clear()
+{
+	buffer.assign(buffer.size(), 0);
+}
+
+void MapRaster::drawLine(int x1, int y1, int x2, int y2, uint8_t colour)
+{
+	int dx = abs(x2-x1);
+	int dy = -abs(y2-y1);
+	int sx = (x1<x2)? 1: -1;
+	int sy = (y1<y2)? 1: -1;
+	int err = dx+dy;
+	while (true) {
+		if (x1>=0 && x1<bufWidth && y1>=0 && y1<bufHeight)
+			buffer[y1*bufWidth + x1] = colour;
+		if (x1==x2 && y1==y2)
+			break;
+		int e2 = 2*err;
+		if (e2 >= dy) {
+			err += dy;
+			x1 += sx;
+		}
+		if (e2 <= dx) {
+			err += dx;
+			y1 += sy;
+		}
+	}
+}
+
+void MapRaster::makeImage(vector<uint8_t>& image, vector<uint8_t>& palette)
+{
+	if (supersample == 1) {
+		image = buffer;
+		palette.assign(&colours[0][0], &colours[0][0]+9);
+		return;
+	}
+	//Palette entry for each combination of colour 1 and 2 counts
+	int samples = supersample*supersample;
+	vector<int> entry((samples+1)*(samples+1), -1);
+	palette.clear();
+	image.resize(width*height);
+	for (int y=0; y<height; y++) {
+		for (int x=0; x<width; x++) {
+			int count[3] = {0, 0, 0};
+			for (int sy=0; sy<supersample; sy++) {
+				const uint8_t* row = &buffer[(y*supersample+sy)*bufWidth + x*supersample];
+				for (int sx=0; sx<supersample; sx++)
+					count[row[sx]]++;
+			}
+			int& e = entry[count[1]*(samples+1) + count[2]];
+			if (e < 0) {
+				e = palette.size()/3;
+				for (int c=0; c<3; c++)
+					palette.push_back((count[0]*colours[0][c] + count[1]*colours[1][c] + count[2]*colours[2][c] + samples/2) / samples);
+			}
+			image[y*width + x] = e;
+		}
+	}
+}
+
+bool MapRaster::writePng(wxOutputStream& out)
+{
+	vector<uint8_t> image;
+	vector<uint8_t> palette;
+	makeImage(image, palette);
+
+	static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+	out.Write(signature, 8);
+	uint8_t header[13];
+	putBigEndian(header, width);
+	putBigEndian(header+4, height);
+	header[8] = 8; //Bit depth
+	header[9] = 3; //Indexed colour
+	header[10] = 0; //Deflate
+	header[11] = 0; //Filter method
+	header[12] = 0; //No interlace
+	writeChunk(out, "IHDR", header, 13);
+	writeChunk(out, "PLTE", &palette[0], palette.size());
+
+	//Rows with filter type 0 (none), zlib-compressed
+	wxMemoryOutputStream compressed;
+	{
+		wxZlibOutputStream zlib(compressed, wxZ_BEST_COMPRESSION, wxZLIB_ZLIB);
+		uint8_t filter = 0;
+		for (int y=0; y<height; y++) {
+			zlib.Write(&filter, 1);
+			zlib.Write(&image[y*width], width);
+		}
+		zlib.Close();
+	}
+	size_t length = compressed.GetLength();
+	vector<uint8_t> data(length);
+	compressed.CopyTo(&data[0], length);
+	writeChunk(out, "IDAT", &data[0], length);
+	writeChunk(out, "IEND", NULL, 0);
+	return out.IsOk();
+}
+
+bool MapRaster::savePng(const wxString& fileName)
+{
+	wxFileOutputStream file(fileName);
+	if (!file.IsOk())
+		return false;
+	return writePng(file) && file.Close();
+}
@@ -0,0 +1,73 @@
+/*!
+* \file MapRaster.h
+* \author Lars Thomas Boye 2020
+*
+* MapRaster is a simple software rasterizer for line drawings of maps,
+* drawing into an 8-bit indexed pixel buffer and writing it as a PNG file.
+* It uses no GUI objects, so it can be used from worker threads.
+*/
+
+#ifndef MAPRASTER_H
+#define MAPRASTER_H
+
+//Include wxWidgets headers:
+#include "wx/wxprec.h"
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <vector>
+#include <stdint.h>
+#include <wx/stream.h>
+
+using namespace std;
+
+/*! Highest supersampling factor, which keeps all blends in a 256-colour palette. */
+const int RASTER_MAX_SUPERSAMPLE = 4;
+
+/*!
+* Line drawing in an 8-bit indexed pixel buffer. Colour 0 is the
+* background, and lines are drawn with colour 1 or 2. Lines are drawn
+* with Bresenham's algorithm, and a later line overwrites an earlier one.
+*
+* With supersampling, the buffer has supersample x supersample pixels for
+* each pixel of the image. Line coordinates are then in buffer pixels
+* (use getSupersample to scale). When saving, each image pixel gets a
+* palette entry blending the colours by how many of its buffer pixels
+* have each colour, which gives anti-aliased lines.
+*/
+class MapRaster
+{
+	public:
+	/*! Image of width x height pixels, with supersampling factor (1 for none). */
+	MapRaster(int width, int height, int supersample=1);
+
+	/*! Set the RGB colour for colour index 0 (background), 1 or 2. */
+	void setColour(int index, const wxColour& colour);
+
+	int getSupersample() const { return supersample; }
+
+	/*! Fill the buffer with the background colour. */
+	void clear();
+
+	/*! Draw a line between two points in buffer pixels, with colour index 1 or 2. */
+	void drawLine(int x1, int y1, int x2, int y2, uint8_t colour);
+
+	/*! Write the image as PNG to the stream. */
+	bool writePng(wxOutputStream& out);
+
+	/*! Write the image as PNG to the file. */
+	bool savePng(const wxString& fileName);
+
+	private:
+	/*! Image pixels as indexes into palette, downsampling if needed. */
+	void makeImage(vector<uint8_t>& image, vector<uint8_t>& palette);
+
+	int width, height; //Image size
+	int supersample;
+	int bufWidth, bufHeight; //Buffer size
+	vector<uint8_t> buffer; //bufWidth x bufHeight colour indexes
+	uint8_t colours[3][3]; //RGB of colour indexes
+};
+
+#endif // MAPRASTER_H
@@ -41,13 +41,42 @@ void DBStatistics::setFloatMins(double minValue)
 //************************ MapStatistics ************************
 //***************************************************************
 
+//Histogram bucket edges for each MapDistFields field
+const double countEdges[] = {0, 25, 50, 100, 200, 400, 800, 1600, 3200, 6400};
+const double linedefEdges[] = {0, 100, 250, 500, 1000, 2000, 4000, 8000, 16000, 32000};
+const double secretEdges[] = {0, 1, 2, 3, 5, 10, 20, 50};
+const double areaEdges[] = {0, 1, 2, 4, 8, 16, 32, 64, 128};
+const double hpEdges[] = {0, 1000, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000};
+const double ratioEdges[] = {0, 0.25, 0.5, 0.75, 1, 1.5, 2, 3, 5};
+const double densityEdges[] = {0, 250, 500, 1000, 2000, 4000, 8000, 16000, 32000};
+
+const double* distEdges[] = {
+	linedefEdges, countEdges, countEdges, secretEdges, areaEdges, countEdges,
+	hpEdges, ratioEdges, ratioEdges, ratioEdges, densityEdges
+};
+
+const int distEdgeCounts[] = {10, 10, 10, 8, 9, 10, 10, 9, 9, 9, 9};
+
+//Decimals when printing values of each MapDistFields field
+const int distDecimals[] = {0, 0, 0, 0, 2, 0, 0, 2, 2, 2, 0};
+
 MapStatistics::MapStatistics(wxString name)
 : DBStatistics(name)
 {
+	for (int i=0; i<MDF_END; i++)
+		histograms[i] = new StatHistogram(distEdges[i], distEdgeCounts[i]);
 }
 
 MapStatistics::~MapStatistics()
 {
+	for (int i=0; i<MDF_END; i++)
+		delete histograms[i];
+}
+
+void MapStatistics::addDistValue(MapDistFields field, double value)
+{
+	sketches[field].add(value);
+	histograms[field]->add(value);
 }
 
 void MapStatistics::processMap(MapEntry* mapEntry)
@@ -138,7 +167,12 @@ void MapStatistics::processGeometry(MapEntry* mapEntry)
 		intStats[STS_SECRETS_MIN] = mapEntry->secrets;
 	if (mapEntry->secrets > intStats[STS_SECRETS_MAX])
 		intStats[STS_SECRETS_MAX] = mapEntry->secrets;
+	addDistValue(MDF_LINEDEFS, mapEntry->linedefs);
+	addDistValue(MDF_SECTORS, mapEntry->sectors);
+	addDistValue(MDF_THINGS, mapEntry->things);
+	addDistValue(MDF_SECRETS, mapEntry->secrets);
 	if (mapEntry->area > 0.0) {
+		addDistValue(MDF_AREA, mapEntry->area);
 		intStats[STS_AREAS]++;
 		floatStats[STS_AREA_AVG] += mapEntry->area;
 		if (mapEntry->area < floatStats[STS_AREA_MIN])
@@ -178,10 +212,63 @@ void MapStatistics::processGameplay(MapEntry* mapEntry)
 	if (mapEntry->ammoRatio > floatStats[STS_AMMORAT_MAX])
 		floatStats[STS_AMMORAT_MAX] = mapEntry->ammoRatio;
 
+	addDistValue(MDF_ENEMIES, mapEntry->enemies);
+	addDistValue(MDF_TOTALHP, mapEntry->totalHP);
+	addDistValue(MDF_HEALTHRAT, mapEntry->healthRatio);
+	addDistValue(MDF_ARMORRAT, mapEntry->armorRatio);
+	addDistValue(MDF_AMMORAT, mapEntry->ammoRatio);
+	if (mapEntry->area > 0.0)
+		addDistValue(MDF_HPDENSITY, mapEntry->hitpointDensity());
+
 	if (mapEntry->flags&MF_SPAWN) intStats[STS_MF_SPAWN]++;
 	if (mapEntry->flags&MF_MORESPAWN) intStats[STS_MF_MORESPAWN]++;
 }
 
+//Merge helpers for fields keeping a minimum or maximum
+static void mergeMin(unsigned long& value, unsigned long other) { if (other < value) value = other; }
+static void mergeMax(unsigned long& value, unsigned long other) { if (other > value) value = other; }
+static void mergeMin(double& value, double other) { if (other < value) value = other; }
+static void mergeMax(double& value, double other) { if (other > value) value = other; }
+
+void MapStatistics::merge(DBStatistics* stats)
+{
+	MapStatistics* other = (MapStatistics*)stats;
+	for (int i=0; i<STS_LINEDEFS_AVG; i++) {
+		switch (i) {
+			case STS_YEAR_MIN: case STS_LINEDEFS_MIN: case STS_SECTORS_MIN:
+			case STS_THINGS_MIN: case STS_SECRETS_MIN: case STS_ENEMIES_MIN:
+			case STS_TOTALHP_MIN: case STS_MAPS_MIN: case STS_SIZE_MIN:
+				mergeMin(intStats[i], other->intStats[i]);
+				break;
+			case STS_YEAR_MAX: case STS_LINEDEFS_MAX: case STS_SECTORS_MAX:
+			case STS_THINGS_MAX: case STS_SECRETS_MAX: case STS_ENEMIES_MAX:
+			case STS_TOTALHP_MAX: case STS_MAPS_MAX: case STS_SIZE_MAX:
+				mergeMax(intStats[i], other->intStats[i]);
+				break;
+			default:
+				intStats[i] += other->intStats[i];
+		}
+	}
+	//Before computeResults, the float averages hold sums
+	floatStats[STS_AREA_AVG] += other->floatStats[STS_AREA_AVG];
+	mergeMin(floatStats[STS_AREA_MIN], other->floatStats[STS_AREA_MIN]);
+	mergeMax(floatStats[STS_AREA_MAX], other->floatStats[STS_AREA_MAX]);
+	floatStats[STS_HEALTHRAT_AVG] += other->floatStats[STS_HEALTHRAT_AVG];
+	mergeMin(floatStats[STS_HEALTHRAT_MIN], other->floatStats[STS_HEALTHRAT_MIN]);
+	mergeMax(floatStats[STS_HEALTHRAT_MAX], other->floatStats[STS_HEALTHRAT_MAX]);
+	floatStats[STS_ARMORRAT_AVG] += other->floatStats[STS_ARMORRAT_AVG];
+	mergeMin(floatStats[STS_ARMORRAT_MIN], other->floatStats[STS_ARMORRAT_MIN]);
+	mergeMax(floatStats[STS_ARMORRAT_MAX], other->floatStats[STS_ARMORRAT_MAX]);
+	floatStats[STS_AMMORAT_AVG] += other->floatStats[STS_AMMORAT_AVG];
+	mergeMin(floatStats[STS_AMMORAT_MIN], other->floatStats[STS_AMMORAT_MIN]);
+	mergeMax(floatStats[STS_AMMORAT_MAX], other->floatStats[STS_AMMORAT_MAX]);
+
+	for (int i=0; i<MDF_END; i++) {
+		sketches[i].merge(other->sketches[i]);
+		histograms[i]->merge(*(other->histograms[i]));
+	}
+}
+
 void MapStatistics::computeResults()
 {
 	if (intStats[STS_MAPS] > 0) {
@@ -218,6 +305,14 @@ void MapStatistics::computeResults()
 
 	if (intStats[STS_OWNRATED] > 0)
 		floatStats[STS_OWNRATING_AVG] = (double)intStats[STS_OWNRATING]/(double)intStats[STS_OWNRATED];
+
+	floatStats[STS_LINEDEFS_MED] = sketches[MDF_LINEDEFS].quantile(0.5);
+	floatStats[STS_SECTORS_MED] = sketches[MDF_SECTORS].quantile(0.5);
+	floatStats[STS_THINGS_MED] = sketches[MDF_THINGS].quantile(0.5);
+	floatStats[STS_ENEMIES_MED] = sketches[MDF_ENEMIES].quantile(0.5);
+	floatStats[STS_TOTALHP_MED] = sketches[MDF_TOTALHP].quantile(0.5);
+	floatStats[STS_AREA_MED] = sketches[MDF_AREA].quantile(0.5);
+	floatStats[STS_HPDENSITY_MED] = sketches[MDF_HPDENSITY].quantile(0.5);
 }
 
 void MapStatistics::printReport(TextReport* reportView)
@@ -375,4 +470,50 @@ void MapStatistics::printReport(TextReport* reportView)
 			intStats[STS_OWNRATED]));
 	percent = floatStats[STS_OWNRATING_AVG] / 10.0;
 	reportView->writeLine(wxString::Format("Average rating: %.2f", percent));
+
+	printDistributions(reportView);
+}
+
+//Format value of a MapDistFields field
+static wxString formatDist(int field, double value)
+{
+	if (distDecimals[field] == 0)
+		return wxString::Format("%.0f", value);
+	return wxString::Format("%.2f", value);
+}
+
+void MapStatistics::printDistributions(TextReport* reportView)
+{
+	reportView->writeSubHeading("Percentiles");
+	reportView->writeLine("\tMedian\t90%\t99%\tMaps");
+	for (int i=0; i<MDF_END; i++) {
+		QuantileSketch& sk = sketches[i];
+		reportView->writeText(distLabels[i]+"\t");
+		reportView->writeText(formatDist(i, sk.quantile(0.5))+"\t");
+		reportView->writeText(formatDist(i, sk.quantile(0.9))+"\t");
+		reportView->writeText(formatDist(i, sk.quantile(0.99))+"\t");
+		reportView->writeLine(wxString::Format("%llu", sk.count()));
+	}
+
+	for (int i=0; i<MDF_END; i++) {
+		StatHistogram* hist = histograms[i];
+		if (hist->count() == 0)
+			continue;
+		reportView->writeSubHeading(distLabels[i]+" distribution");
+		//Leave out empty buckets at the top
+		int last = hist->size()-1;
+		while (last>0 && hist->bucketCount(last)==0)
+			last--;
+		for (int b=0; b<=last; b++) {
+			wxString range = formatDist(i, hist->lower(b));
+			if (b < hist->size()-1)
+				range += " - "+formatDist(i, hist->lower(b+1));
+			else
+				range += " +";
+			reportView->writeText(range+"\t");
+			reportView->writeText(wxString::Format("%llu\t", hist->bucketCount(b)));
+			double percent = (double)(hist->bucketCount(b)*100) / (double)hist->count();
+			reportView->writeLine(wxString::Format("%.1f%", percent));
+		}
+	}
 }
@@ -8,7 +8,9 @@
 * corresponding statLabels gives short titles for each field.
 * DBStatistics itself is an abstract class, with MapStatistics being
 * an implementation for map statistics, implementing processing
-* and report generation.
+* and report generation. MapStatistics also keeps the distribution
+* of a set of map fields, given by enum MapDistFields, with a
+* QuantileSketch and StatHistogram for each.
 */
 
 #ifndef MAPSTATISTICS_H
@@ -16,6 +18,7 @@
 
 #include "DataModel.h"
 #include "../TextReport.h"
+#include "StatSketch.h"
 
 /*!
 * Defines values to track with DBStatistics. The first part are
@@ -104,6 +107,13 @@ enum StatFields {
 	STS_MAPS_AVG,
 	STS_SIZE, //!< Total file size in bytes
 	STS_SIZE_AVG,
+	STS_LINEDEFS_MED, //!< Median linedefs
+	STS_SECTORS_MED,
+	STS_THINGS_MED,
+	STS_ENEMIES_MED,
+	STS_TOTALHP_MED,
+	STS_AREA_MED,
+	STS_HPDENSITY_MED, //!< Median enemy hit-points per area
 
 	STS_END
 };
@@ -185,7 +195,48 @@ const wxString statLabels[] = {
 	"Avg.rating%",
 	"Avg.maps",
 	"Bytes",
-	"Avg.bytes"
+	"Avg.bytes",
+	"Med.linedefs",
+	"Med.sectors",
+	"Med.things",
+	"Med.enemies",
+	"Med.hitpoints",
+	"Med.area",
+	"Med.HP/area"
+};
+
+/*!
+* Map fields for which MapStatistics keeps the distribution of
+* values, not just sum, min and max.
+*/
+enum MapDistFields {
+	MDF_LINEDEFS,
+	MDF_SECTORS,
+	MDF_THINGS,
+	MDF_SECRETS,
+	MDF_AREA, //!< Only maps with area
+	MDF_ENEMIES, //!< This and the rest only maps with gamestats
+	MDF_TOTALHP,
+	MDF_HEALTHRAT,
+	MDF_ARMORRAT,
+	MDF_AMMORAT,
+	MDF_HPDENSITY, //!< Enemy hit-points per area, maps with both
+	MDF_END
+};
+
+/*! Names of MapDistFields, for reports. */
+const wxString distLabels[] = {
+	"Linedefs",
+	"Sectors",
+	"Things",
+	"Secrets",
+	"Area (MU)",
+	"Enemies",
+	"Enemy HP",
+	"Health ratio",
+	"Armor ratio",
+	"Ammo ratio",
+	"Enemy HP per MU"
 };
 
 /*! Initial value for integer minimum statistics. */
@@ -239,6 +290,13 @@ class DBStatistics
 		*/
 		virtual void printReport(TextReport* reportView) = 0;
 
+		/*!
+		* Add the entries processed by other, which must be of the
+		* same class, to this. Both must be unfinished, with
+		* computeResults called after merging.
+		*/
+		virtual void merge(DBStatistics* other) = 0;
+
 		/*! A name for the DBStatistics, to show as a heading. */
 		wxString heading;
 
@@ -278,6 +336,11 @@ class DBStatistics
 * once for each map). Either call processMap for each map in
 * the set, or processWad for each wad, which will process each
 * map in the wad.
+*
+* The distribution of each MapDistFields field is tracked in the
+* same pass, giving medians and percentiles without sorting the
+* maps. Objects processing different parts of a set can be combined
+* with merge, before computeResults.
 */
 class MapStatistics : public DBStatistics
 {
@@ -285,14 +348,28 @@ class MapStatistics : public DBStatistics
 		MapStatistics(wxString name);
 		virtual ~MapStatistics();
 
+		/*! Not copyable, as it owns the histograms. */
+		MapStatistics(const MapStatistics&) = delete;
+		MapStatistics& operator=(const MapStatistics&) = delete;
+
 		virtual void processMap(MapEntry* mapEntry);
 		virtual void processWad(WadEntry* wadEntry);
 		virtual void computeResults();
 		virtual void printReport(TextReport* reportView);
+		virtual void merge(DBStatistics* other);
+
+		/*! Approximate value of field at quantile q (0.5 for median). */
+		double quantile(MapDistFields field, double q) { return sketches[field].quantile(q); }
+
+		/*! Distribution of field values in fixed buckets. */
+		StatHistogram* getHistogram(MapDistFields field) { return histograms[field]; }
 
 	protected:
 
 	private:
+		/*! Count value for the distribution of field. */
+		void addDistValue(MapDistFields field, double value);
+
 		/*! Adds statistics for a WadEntry, for a specified number of map entries. */
 		void processWad(WadEntry* wadEntry, int maps);
 
@@ -301,6 +378,12 @@ class MapStatistics : public DBStatistics
 
 		/*! Add statistics for the gameplay fields of a MapEntry. */
 		void processGameplay(MapEntry* mapEntry);
+
+		/*! Write percentiles and histograms. */
+		void printDistributions(TextReport* reportView);
+
+		QuantileSketch sketches[MDF_END];
+		StatHistogram* histograms[MDF_END];
 };
 
 #endif // MAPSTATISTICS_H
@@ -133,6 +133,7 @@ void MapStats::readFile(wxInputStream* file, vector<DirEntry*>* lumps, map<int,
 	}
 
 	//Rest of lumps
+	progress->startPhase("Map lumps");
 	for (int i=0; i<lumps->size(); i++) {
 		lump = lumps->at(i);
 		file->SeekI(lump->offset, wxFromStart);
@@ -156,20 +157,26 @@ void MapStats::readFile(wxInputStream* file, vector<DirEntry*>* lumps, map<int,
 		} else if (lname.CmpNoCase("BLOCKMAP")==0) {
 			processBlockmap(file, lump->size);
 		}
+		progress->addBytes(lump->size);
 	}
+	progress->endPhase();
 
 	if (nodeStats != NULL) {
+		progress->startPhase("Nodes");
 		try {
 			nodeStats->progress = progress;
 			nodeStats->readFile(file,lumps);
 			Vector2D minXY((double)minCorner.x - 1.0, (double)minCorner.y - 1.0);
 			Vector2D maxXY((double)maxCorner.x + 1.0, (double)maxCorner.y + 1.0);
 			bool ok = nodeStats->checkNodes();
+			progress->endPhase();
+			progress->startPhase("Node area");
 			if (ok) area = nodeStats->computeArea(minXY, maxXY);
 		} catch (...) {
 			wxLogVerbose("Failed processing node data");
 			progress->warnError("Invalid node data");
 		}
+		progress->endPhase(); //Nodes or Node area
 	} else {
 		wxLogVerbose("No nodes found, no area calculation");
 	}
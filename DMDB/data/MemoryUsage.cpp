@@ -0,0 +1,60 @@
+/*
+* MemoryUsage implementation
+*/
+
+#include "MemoryUsage.h"
+
+void MemoryUsage::add(wxString name, size_t objects, size_t bytes)
+{
+	items.push_back(MemoryItem(name, objects, bytes));
+}
+
+size_t MemoryUsage::getTotalBytes()
+{
+	size_t total = 0;
+	for (size_t i=0; i<items.size(); i++)
+		total += items[i].bytes;
+	return total;
+}
+
+void MemoryUsage::printReport(TextReport* reportView)
+{
+	reportView->writeHeading("Memory usage");
+	wxArrayInt tabs;
+	tabs.Add(600);tabs.Add(850);tabs.Add(1100);
+	reportView->setTabs(tabs);
+	reportView->writeLine("Structure\tObjects\tKB\tBytes/object");
+	for (size_t i=0; i<items.size(); i++) {
+		MemoryItem& item = items[i];
+		wxString perObject = (item.objects==0)? wxString("-"): wxString::Format("%i", item.bytes/item.objects);
+		reportView->writeLine(wxString::Format("%s\t%i\t%.0f\t%s", item.name, item.objects,
+			item.bytes/1024.0, perObject));
+	}
+	reportView->writeLine(wxString::Format("Total\t\t%.0f", getTotalBytes()/1024.0));
+}
+
+size_t MemoryUsage::heapBlock(size_t size)
+{
+	if (size == 0)
+		return 0;
+	return (size + 2*sizeof(void*) + 15) / 16 * 16;
+}
+
+size_t MemoryUsage::treeNode(size_t valueSize)
+{
+	//Left, right and parent pointers, colour and flags
+	return heapBlock(4*sizeof(void*) + valueSize);
+}
+
+size_t MemoryUsage::listNode(size_t valueSize)
+{
+	return heapBlock(2*sizeof(void*) + valueSize);
+}
+
+size_t MemoryUsage::stringHeap(size_t length, size_t charSize)
+{
+	//Strings of up to 15 bytes are kept in the object
+	if ((length+1)*charSize <= 16)
+		return 0;
+	return heapBlock((length+1)*charSize);
+}
@@ -0,0 +1,83 @@
+/*!
+* \file MemoryUsage.h
+* \author Lars Thomas Boye 2020
+*
+* MemoryUsage is a table of the memory used by the in-memory database,
+* with the number of objects and bytes of each structure, made by
+* DataManager::getMemoryUsage. The byte counts include string payloads
+* and container overhead, estimated with the helper functions here for
+* heap blocks, tree and list nodes and strings, in the way of
+* DataManager::logEntryMemory. They are estimates for a 64-bit build
+* with the Visual C++ library, meant for finding which structure grows
+* and for comparing builds, not exact heap accounting.
+*/
+
+#ifndef MEMORYUSAGE_H
+#define MEMORYUSAGE_H
+
+#include "CoreBase.h"
+#include <vector>
+#include <string>
+#include "../TextReport.h"
+
+/*!
+* One row of MemoryUsage: a structure with its number of objects and
+* the bytes it uses.
+*/
+struct MemoryItem
+{
+	wxString name;
+	size_t objects;
+	size_t bytes;
+
+	MemoryItem(wxString nam, size_t obj, size_t byt) : name(nam), objects(obj), bytes(byt) {}
+};
+
+/*!
+* The memory used by each structure of a DataManager, in the order
+* added. The rows can be read with getItems, or printed as a table.
+*/
+class MemoryUsage
+{
+	public:
+		MemoryUsage() {}
+		virtual ~MemoryUsage() {}
+
+		/*! Adds a row for a structure. */
+		void add(wxString name, size_t objects, size_t bytes);
+
+		/*! The rows, in the order added. */
+		const vector<MemoryItem>& getItems() { return items; }
+
+		/*! Sum of the bytes of all rows. */
+		size_t getTotalBytes();
+
+		/*! Prints the rows as a table, with the total. */
+		void printReport(TextReport* reportView);
+
+		/*! Bytes of a heap block for size bytes: Header, rounded up to 16 bytes, 0 for none. */
+		static size_t heapBlock(size_t size);
+
+		/*! Bytes of a node in a map or set with values of valueSize bytes. */
+		static size_t treeNode(size_t valueSize);
+
+		/*! Bytes of a node in a list with values of valueSize bytes. */
+		static size_t listNode(size_t valueSize);
+
+		/*!
+		* Heap bytes of a string of length characters of charSize bytes,
+		* 0 if short enough to be stored in the string object.
+		*/
+		static size_t stringHeap(size_t length, size_t charSize=1);
+
+		/*! Heap bytes of str. */
+		static size_t stringHeap(const string& str) { return stringHeap(str.capacity()); }
+
+		/*! Heap bytes of str. */
+		static size_t stringHeap(const wxString& str) { return stringHeap(str.length(), sizeof(wxChar)); }
+
+	private:
+		vector<MemoryItem> items;
+};
+
+#endif // MEMORYUSAGE_H
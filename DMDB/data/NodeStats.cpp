@@ -28,16 +28,14 @@ int32_t MapNode32::leftChild() { return leftIndex & 0x7FFFFFFF; }
 //**********************************************************
 
 NodeDraw::NodeDraw(int scale)
-: bm(NULL), dc(NULL), drawScale(scale)
+: raster(NULL), drawScale(scale)
 {
 }
 
 NodeDraw::~NodeDraw()
 {
-	if (dc != NULL) {
-		delete dc;
-		delete bm;
-	}
+	if (raster != NULL)
+		delete raster;
 }
 
 void NodeDraw::setup(Vector2D& minXY, Vector2D& maxXY)
@@ -48,14 +46,10 @@ void NodeDraw::setup(Vector2D& minXY, Vector2D& maxXY)
 	width+=3;
 	int height = (maxXY.y - minXY.y)/drawScale;
 	height+=3;
-	bm = new wxBitmap(width, height, wxBITMAP_SCREEN_DEPTH);
-	dc = new wxMemoryDC(*bm);
-
-	wxBrush bckgrnd(DRAW_BACKGROUND);
-	dc->SetBackground(bckgrnd);
-	dc->Clear();
-	wxPen pen(DRAW_FOREGROUND, 1, wxPENSTYLE_SOLID);
-	dc->SetPen(pen);
+	raster = new MapRaster(width, height);
+	raster->setColour(0, DRAW_BACKGROUND);
+	raster->setColour(1, DRAW_FOREGROUND);
+	raster->clear();
 }
 
 void NodeDraw::drawPoly(vector<Vector2D>* poly)
@@ -67,19 +61,18 @@ void NodeDraw::drawPoly(vector<Vector2D>* poly)
         y1 = (( (poly->at(i).y * -1) + yTrans)/drawScale) + 1;
         x2 = ((poly->at(i+1).x - xTrans)/drawScale) + 1;
         y2 = (( (poly->at(i+1).y * -1) + yTrans)/drawScale) + 1;
-		dc->DrawLine(x1, y1, x2, y2);
+		raster->drawLine(x1, y1, x2, y2, 1);
 	}
 	x1 = ((poly->at(fend).x - xTrans)/drawScale) + 1;
 	y1 = (( (poly->at(fend).y * -1) + yTrans)/drawScale) + 1;
 	x2 = ((poly->at(0).x - xTrans)/drawScale) + 1;
 	y2 = (( (poly->at(0).y * -1) + yTrans)/drawScale) + 1;
-	dc->DrawLine(x1, y1, x2, y2);
+	raster->drawLine(x1, y1, x2, y2, 1);
 }
 
 void NodeDraw::saveImage(wxString fileName)
 {
-	dc->SelectObject(wxNullBitmap);
-	bool ok = bm->SaveFile(fileName, wxBITMAP_TYPE_PNG);
+	raster->savePng(fileName);
 }
 
 
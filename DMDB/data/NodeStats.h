@@ -36,6 +36,7 @@ using namespace std;
 #include <wx/stream.h>
 #include "../TextReport.h"
 #include "WadStats.h"
+#include "MapRaster.h"
 
 /*!
 * A 2D point in map geometry has two signed 16-bit integers.
@@ -164,7 +165,8 @@ const wxColour DRAW_FOREGROUND(0,0,0); //!< Line color: Black
 
 /*!
 * This class can draw each subsector polygon of a node tree,
-* to visualize the structure.
+* to visualize the structure. It draws with a MapRaster, so it
+* needs no GUI objects.
 */
 class NodeDraw
 {
@@ -195,8 +197,7 @@ class NodeDraw
 		void saveImage(wxString fileName);
 
 	private:
-		wxBitmap* bm;
-		wxMemoryDC* dc;
+		MapRaster* raster;
 		int xTrans, yTrans;
 		int drawScale;
 };
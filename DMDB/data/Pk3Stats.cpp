@@ -34,7 +34,11 @@ void Pk3Stats::readFile(TaskProgress* progress, bool findMd5)
 	fileSize = file.Length();
 	wxLogVerbose("Processing file %s of size %i", fileName, fileSize);
 	progress->startCount((fileSize/8)+200);
-	if (findMd5) makeMd5(file);
+	if (findMd5) {
+		progress->startPhase("MD5");
+		makeMd5(file);
+		progress->endPhase(fileSize);
+	}
 	progress->incrCount(100);
 	file.Close();
 
@@ -225,22 +229,24 @@ bool Pk3Stats::processFile(DirEntry* dir, wxZipInputStream& file)
 		return false;
 	}
 
-	if (processLumpName(dir, lname))
+	LumpCode code = packLumpName(lname.ToStdString());
+	if (processLumpName(dir, code))
 		return false;
-	if (processLumpName2(dir, lname))
+	if (processLumpName2(dir, code))
 		return false;
 	//By now we know we won't extract the file, so we can read the first bytes
-	char bytes[4];
-	file.Read(bytes, 4);
-	if (checkTexLists(dir, lname, bytes)) return false;
-	if (checkBmp(dir, bytes)) return false;
-	if (checkFon12(dir, bytes)) return false;
-	if (checkMus(dir, bytes)) return false;
-	if (checkMidi(dir, bytes)) return false;
-	if (checkSfx(dir, bytes)) return false;
-	if (checkWav(dir, bytes)) return false;
-	if (checkPcs(dir, bytes)) return false;
-	if (checkAcs(dir, bytes)) return false;
+	unsigned char data[SNIFF_MAGIC];
+	size_t length = file.Read(data, SNIFF_MAGIC).LastRead();
+	LumpSniff sniff = sniffLump(data, length, dir->size);
+	if (checkTexLists(dir, code, sniff)) return false;
+	if (checkBmp(dir, sniff)) return false;
+	if (checkFon12(dir, sniff)) return false;
+	if (checkMus(dir, sniff)) return false;
+	if (checkMidi(dir, sniff)) return false;
+	if (checkSfx(dir, sniff)) return false;
+	if (checkWav(dir, sniff)) return false;
+	if (checkPcs(dir, sniff)) return false;
+	if (checkAcs(dir, sniff)) return false;
 
 	if (content[WUNKNOWN] == NULL)
 		content[WUNKNOWN] = new WadContentX(WUNKNOWN, "");
@@ -396,7 +402,9 @@ wxString Pk3Stats::extractFile(wxZipInputStream& zip, wxZipEntry* entry, TaskPro
 		progress->fatalError(wxString::Format("Can't extract file %s",tempName.GetFullPath()));
 		return "";
 	}
+	progress->startPhase("Inflate");
 	zip.Read(file);
+	progress->endPhase(file.GetLength());
 	file.Close();
 	wxLogVerbose("Extracted file %s", entry->GetName());
 	extracted->push_back(tempName.GetFullPath());
@@ -0,0 +1,104 @@
+/*!
+* \file RangeIndex.h
+* \author Lars Thomas Boye 2020
+*
+* RangeIndex keeps the wad or map entries ordered on the value of one
+* numeric field, so that the entries matching a numeric filter condition
+* can be found with a binary search rather than by testing all entries.
+*/
+
+#ifndef RANGEINDEX_H
+#define RANGEINDEX_H
+
+#include <algorithm>
+#include <vector>
+#include "DataFilter.h"
+#include "MemoryUsage.h"
+
+using namespace std;
+
+/*!
+* Index of entries (WadEntry* or MapEntry*) on one numeric field. The
+* field value of each entry is copied into the index, so the binary
+* search doesn't touch the entries. The index is a snapshot, made from
+* the master list of entries, which must be made again when entries
+* are added, deleted or changed.
+*/
+template<class T> class RangeIndex
+{
+	public:
+	/*! Index entries on field, with the values given by value. */
+	RangeIndex(const vector<T>& entries, double (*value)(T, WadMapFields), WadMapFields field) {
+		items.reserve(entries.size());
+		for (typename vector<T>::const_iterator it=entries.begin(); it!=entries.end(); ++it) {
+			Item item;
+			item.value = value(*it, field);
+			item.entry = *it;
+			items.push_back(item);
+		}
+		sort(items.begin(), items.end(), itemLess);
+	};
+
+	/*! Number of entries matching the condition of range. */
+	size_t count(const FieldRange& range) {
+		size_t begin, end;
+		find(range, begin, end);
+		return end - begin;
+	};
+
+	/*! Add the entries matching the condition of range to result, in value order. */
+	void getEntries(const FieldRange& range, vector<T>& result) {
+		size_t begin, end;
+		find(range, begin, end);
+		result.reserve(result.size() + end - begin);
+		for (size_t i=begin; i<end; i++)
+			result.push_back(items[i].entry);
+	};
+
+	/*! Number of entries. */
+	size_t size() const { return items.size(); };
+
+	/*! Heap bytes of the item array. */
+	size_t getBytes() const {
+		return MemoryUsage::heapBlock(items.capacity()*sizeof(Item));
+	};
+
+	private:
+	struct Item
+	{
+		double value;
+		T entry;
+	};
+
+	static bool itemLess(const Item& a, const Item& b) {
+		return a.value < b.value;
+	};
+
+	static bool itemBefore(const Item& a, double val) {
+		return a.value < val;
+	};
+
+	static bool itemAfter(double val, const Item& b) {
+		return val < b.value;
+	};
+
+	/*! Items begin to end-1 are the ones matching the condition of range. */
+	void find(const FieldRange& range, size_t& begin, size_t& end) {
+		size_t lower = lower_bound(items.begin(), items.end(), range.val, itemBefore) - items.begin();
+		size_t upper = upper_bound(items.begin(), items.end(), range.val, itemAfter) - items.begin();
+		if (range.op == DFOP_EQUALS) {
+			begin = lower;
+			end = upper;
+		} else if (range.op == DFOP_MORE) {
+			begin = upper;
+			end = items.size();
+		} else {
+			begin = 0;
+			end = lower;
+		}
+	};
+
+	vector<Item> items; //Sorted on value
+};
+
+#endif // RANGEINDEX_H
@@ -0,0 +1,153 @@
+/*
+* ColumnKeys implementation
+*/
+
+#include "SortKeys.h"
+#include <algorithm>
+#include <cstring>
+
+/*! Orders entry indexes on their text keys. */
+struct TextKeyLess
+{
+	const vector<string>* texts;
+	TextKeyLess(const vector<string>* t) : texts(t) {}
+	bool operator()(uint32_t a, uint32_t b) const { return (*texts)[a] < (*texts)[b]; }
+};
+
+/*! Orders entry indexes on their text keys, descending. */
+struct TextKeyGreater
+{
+	const vector<string>* texts;
+	TextKeyGreater(const vector<string>* t) : texts(t) {}
+	bool operator()(uint32_t a, uint32_t b) const { return (*texts)[b] < (*texts)[a]; }
+};
+
+ColumnKeys::ColumnKeys(size_t size, bool text)
+: prefixes(size, 0), texts(NULL)
+{
+	if (text)
+		texts = new vector<string>(size);
+}
+
+ColumnKeys::~ColumnKeys()
+{
+	if (texts != NULL)
+		delete texts;
+}
+
+void ColumnKeys::setText(size_t i, const wxString& str)
+{
+	(*texts)[i] = textKey(str);
+	prefixes[i] = textPrefix((*texts)[i]);
+}
+
+void ColumnKeys::setTextKey(size_t i, const string& key)
+{
+	(*texts)[i] = key;
+	prefixes[i] = textPrefix(key);
+}
+
+int ColumnKeys::compare(size_t a, size_t b) const
+{
+	if (prefixes[a] != prefixes[b])
+		return (prefixes[a] < prefixes[b])? -1: 1;
+	if (texts == NULL)
+		return 0;
+	return (*texts)[a].compare((*texts)[b]);
+}
+
+int ColumnKeys::compareSearch(size_t i, uint64_t number, const string& text) const
+{
+	if (texts == NULL) {
+		if (prefixes[i] == number)
+			return 0;
+		return (prefixes[i] < number)? -1: 1;
+	}
+	return (*texts)[i].compare(0, text.length(), text);
+}
+
+void ColumnKeys::sort(vector<uint32_t>& perm, bool descending) const
+{
+	size_t n = prefixes.size();
+	if (perm.size() != n) {
+		perm.resize(n);
+		for (size_t i=0; i<n; i++)
+			perm[i] = i;
+	}
+	if (n < 2)
+		return;
+	int flip = descending? 0xFF: 0; //Reverses the byte order
+
+	//LSD radix sort, one byte at a time
+	vector<uint32_t> temp(n);
+	size_t counts[256];
+	for (int shift=0; shift<64; shift+=8) {
+		for (int c=0; c<256; c++)
+			counts[c] = 0;
+		for (size_t i=0; i<n; i++)
+			counts[((prefixes[i] >> shift) & 0xFF) ^ flip]++;
+		if (counts[((prefixes[0] >> shift) & 0xFF) ^ flip] == n)
+			continue; //Same byte in all keys
+		size_t pos = 0;
+		for (int c=0; c<256; c++) {
+			size_t cnt = counts[c];
+			counts[c] = pos;
+			pos += cnt;
+		}
+		for (size_t i=0; i<n; i++) {
+			uint32_t e = perm[i];
+			temp[counts[((prefixes[e] >> shift) & 0xFF) ^ flip]++] = e;
+		}
+		perm.swap(temp);
+	}
+
+	if (texts != NULL) {
+		//Sort runs with equal prefix on the whole text
+		size_t start = 0;
+		while (start < n) {
+			size_t end = start+1;
+			while (end<n && prefixes[perm[end]]==prefixes[perm[start]])
+				end++;
+			if (end-start > 1) {
+				if (descending)
+					stable_sort(perm.begin()+start, perm.begin()+end, TextKeyGreater(texts));
+				else
+					stable_sort(perm.begin()+start, perm.begin()+end, TextKeyLess(texts));
+			}
+			start = end;
+		}
+	}
+}
+
+uint64_t ColumnKeys::intKey(int64_t val)
+{
+	//Flip sign bit, so negative numbers come first
+	return ((uint64_t)val) ^ 0x8000000000000000ULL;
+}
+
+uint64_t ColumnKeys::floatKey(double val)
+{
+	uint64_t bits;
+	memcpy(&bits, &val, 8);
+	if (bits & 0x8000000000000000ULL)
+		return ~bits; //Negative - reverse order
+	else
+		return bits ^ 0x8000000000000000ULL;
+}
+
+string ColumnKeys::textKey(const wxString& str)
+{
+	wxScopedCharBuffer buf = str.Lower().utf8_str();
+	return string(buf.data(), buf.length());
+}
+
+uint64_t ColumnKeys::textPrefix(const string& key)
+{
+	uint64_t prefix = 0;
+	for (size_t i=0; i<8; i++) {
+		prefix <<= 8;
+		if (i < key.length())
+			prefix |= (unsigned char)key[i];
+	}
+	return prefix;
+}
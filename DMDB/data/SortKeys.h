@@ -0,0 +1,99 @@
+/*!
+* \file SortKeys.h
+* \author Lars Thomas Boye 2020
+*
+* ColumnKeys holds normalized binary sort keys for one column
+* (field) of a list of entries, and sorts the list on them.
+*/
+
+#ifndef SORTKEYS_H
+#define SORTKEYS_H
+
+//Include wxWidgets headers:
+#include "wx/wxprec.h"
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+using namespace std;
+
+/*!
+* Sort keys for one column of a list of entries. The keys are built once,
+* so that sorting doesn't have to resolve and compare field values for
+* every comparison. Each key is an unsigned 64-bit number, ordered as the
+* field values. Numbers are mapped with intKey or floatKey. For text
+* fields, the text is case-folded and kept as UTF-8, which orders as the
+* characters, and the number is the first 8 bytes of it (big-endian).
+*
+* sort does an LSD radix sort on the numbers, skipping bytes which are the
+* same for all keys. For text keys, runs with the same first 8 bytes are
+* then sorted on the whole text. The sort is stable, and can continue from
+* an order sorted on other keys, so sorting on several fields is done by
+* sorting on each, starting with the least significant.
+*/
+class ColumnKeys
+{
+	public:
+	/*! Keys for size entries, text keys if text is true. */
+	ColumnKeys(size_t size, bool text);
+	~ColumnKeys();
+
+	/*! Not copyable, as it owns texts. */
+	ColumnKeys(const ColumnKeys&) = delete;
+	ColumnKeys& operator=(const ColumnKeys&) = delete;
+
+	bool isText() const { return texts != NULL; }
+
+	size_t size() const { return prefixes.size(); }
+
+	/*! Set key of entry i for a numeric field, from intKey or floatKey. */
+	void setNumber(size_t i, uint64_t key) { prefixes[i] = key; }
+
+	/*! Set key of entry i for a text field. */
+	void setText(size_t i, const wxString& str);
+
+	/*! Set key of entry i for a text field, from a key made by textKey. */
+	void setTextKey(size_t i, const string& key);
+
+	/*! Compare keys of entries a and b, returning <0, 0 or >0. */
+	int compare(size_t a, size_t b) const;
+
+	/*!
+	* Compare key of entry i with a search key, returning <0, 0 or >0.
+	* number is used for numeric keys, and text (from textKey) for text
+	* keys. Only as many bytes of a text key as in text are compared, so
+	* 0 means that the key starts with text.
+	*/
+	int compareSearch(size_t i, uint64_t number, const string& text) const;
+
+	/*!
+	* Fills perm with the entry indexes (0 to size-1) in ascending order
+	* of the keys, or descending order if descending is true. If perm
+	* already has size entries, this is the order to start from, otherwise
+	* the entries start in index order. Entries with equal keys keep their
+	* order.
+	*/
+	void sort(vector<uint32_t>& perm, bool descending=false) const;
+
+	/*! Key for a signed integer. */
+	static uint64_t intKey(int64_t val);
+
+	/*! Key for a floating-point number. */
+	static uint64_t floatKey(double val);
+
+	/*! Case-folded UTF-8 text. */
+	static string textKey(const wxString& str);
+
+	/*! The first 8 bytes of a text key, as a number. */
+	static uint64_t textPrefix(const string& key);
+
+	private:
+	vector<uint64_t> prefixes; //Numeric key or text prefix
+	vector<string>* texts; //Text keys, NULL if numeric
+};
+
+#endif // SORTKEYS_H
@@ -0,0 +1,218 @@
+/*
+* StatGroupKey implementation
+*/
+
+#include "StatGroupKey.h"
+
+StatGroupKey::StatGroupKey(wxString title, uint16_t width, int minKey, int maxKey)
+: title(title), width(width), minKey(minKey), maxKey(maxKey)
+{
+}
+
+//************************ YearGroupKey ************************
+
+YearGroupKey::YearGroupKey()
+: StatGroupKey("Year", 60, 1990, 2089)
+{
+}
+
+int YearGroupKey::wadKeys(WadEntry* wadEntry, int* keys)
+{
+	keys[0] = wadEntry->year;
+	return 1;
+}
+
+wxString YearGroupKey::keyName(int key)
+{
+	if (key == 0)
+		return "Unknown";
+	return wxString::Format("%i", key);
+}
+
+//************************ IwadGroupKey ************************
+
+IwadGroupKey::IwadGroupKey()
+: StatGroupKey("Iwad", 100, 0, IWAD_END-1)
+{
+}
+
+int IwadGroupKey::wadKeys(WadEntry* wadEntry, int* keys)
+{
+	keys[0] = wadEntry->iwad;
+	return 1;
+}
+
+wxString IwadGroupKey::keyName(int key)
+{
+	if (key<=0 || key>=IWAD_END)
+		return "Unknown";
+	return iwadNames[key];
+}
+
+//************************ EngineGroupKey ************************
+
+EngineGroupKey::EngineGroupKey()
+: StatGroupKey("Engine", 100, 0, DENG_END-1)
+{
+}
+
+int EngineGroupKey::wadKeys(WadEntry* wadEntry, int* keys)
+{
+	keys[0] = wadEntry->engine;
+	return 1;
+}
+
+wxString EngineGroupKey::keyName(int key)
+{
+	if (key<=0 || key>=DENG_END)
+		return "Unknown";
+	return engineNames[key];
+}
+
+//************************ PlaystyleGroupKey ************************
+
+PlaystyleGroupKey::PlaystyleGroupKey()
+: StatGroupKey("Playstyle", 120, 0, 2)
+{
+}
+
+int PlaystyleGroupKey::wadKeys(WadEntry* wadEntry, int* keys)
+{
+	keys[0] = wadEntry->playStyle;
+	return 1;
+}
+
+wxString PlaystyleGroupKey::keyName(int key)
+{
+	if (key<0 || key>2)
+		return "Unknown";
+	return playStyles[key];
+}
+
+void PlaystyleGroupKey::fixedKeys(vector<int>& keys)
+{
+	for (int i=0; i<3; i++)
+		keys.push_back(i);
+}
+
+//************************ RatingGroupKey ************************
+
+RatingGroupKey::RatingGroupKey()
+: StatGroupKey("Own rating", 80, 0, 11)
+{
+}
+
+int RatingGroupKey::wadKeys(WadEntry* wadEntry, int* keys)
+{
+	keys[0] = (wadEntry->ownRating<=100)? wadEntry->ownRating/10: 11;
+	return 1;
+}
+
+int RatingGroupKey::mapKeys(MapEntry* mapEntry, int* keys)
+{
+	keys[0] = (mapEntry->ownRating<=100)? mapEntry->ownRating/10: 11;
+	return 1;
+}
+
+wxString RatingGroupKey::keyName(int key)
+{
+	if (key == 11)
+		return "No rating";
+	return wxString::Format("%i", key);
+}
+
+void RatingGroupKey::fixedKeys(vector<int>& keys)
+{
+	for (int i=0; i<=11; i++)
+		keys.push_back(i);
+}
+
+//************************ DifficultyGroupKey ************************
+
+DifficultyGroupKey::DifficultyGroupKey()
+: StatGroupKey("Difficulty", 120, 0, 4)
+{
+}
+
+int DifficultyGroupKey::mapKeys(MapEntry* mapEntry, int* keys)
+{
+	keys[0] = mapEntry->difficulty;
+	return 1;
+}
+
+wxString DifficultyGroupKey::keyName(int key)
+{
+	if (key<=0 || key>4)
+		return "Not rated";
+	return difficultyRatings[key];
+}
+
+void DifficultyGroupKey::fixedKeys(vector<int>& keys)
+{
+	for (int i=0; i<5; i++)
+		keys.push_back(i);
+}
+
+//************************ NamedGroupKey ************************
+
+NamedGroupKey::NamedGroupKey(wxString title, map<int, wxString>* names, wxString other)
+: StatGroupKey(title, 200), names(names), otherName(other)
+{
+}
+
+NamedGroupKey::~NamedGroupKey()
+{
+	delete names;
+}
+
+wxString NamedGroupKey::keyName(int key)
+{
+	map<int, wxString>::iterator it = names->find(key);
+	if (it == names->end())
+		return otherName;
+	return it->second;
+}
+
+void NamedGroupKey::fixedKeys(vector<int>& keys)
+{
+	for (map<int, wxString>::iterator it=names->begin(); it!=names->end(); ++it)
+		keys.push_back(it->first);
+}
+
+//************************ AuthorGroupKey ************************
+
+AuthorGroupKey::AuthorGroupKey(map<int, wxString>* names)
+: NamedGroupKey("Author", names, "Unknown")
+{
+}
+
+int AuthorGroupKey::mapKeys(MapEntry* mapEntry, int* keys)
+{
+	int n = 0;
+	if (mapEntry->author1 != NULL)
+		keys[n++] = mapEntry->author1->dbid;
+	else if (mapEntry->author2 == NULL)
+		keys[n++] = GROUP_KEY_OTHER;
+	if (mapEntry->author2 != NULL)
+		keys[n++] = mapEntry->author2->dbid;
+	return n;
+}
+
+//************************ TagGroupKey ************************
+
+TagGroupKey::TagGroupKey(map<int, wxString>* names)
+: NamedGroupKey("Style tag", names, "None")
+{
+}
+
+int TagGroupKey::mapKeys(MapEntry* mapEntry, int* keys)
+{
+	int n = 0;
+	for (int i=0; i<MAXTAGS; i++) {
+		if (mapEntry->tags[i] != 0)
+			keys[n++] = mapEntry->tags[i];
+	}
+	if (n == 0)
+		keys[n++] = GROUP_KEY_OTHER;
+	return n;
+}
@@ -0,0 +1,196 @@
+/*!
+* \file StatGroupKey.h
+* \author Lars Thomas Boye 2020
+*
+* A StatGroupKey defines a categorization of wads or maps for
+* statistics, by extracting an integer key from each entry, and
+* naming the keys. GroupStatSet uses one or two of these to make
+* a DBStatistics object for each group of entries. There is an
+* implementation for each categorization we support.
+*/
+
+#ifndef STATGROUPKEY_H
+#define STATGROUPKEY_H
+
+#include <map>
+#include <vector>
+#include "DataModel.h"
+#include "MapStatistics.h"
+
+/*! Maximum number of keys of an entry, as a map can have many tags. */
+const int MAX_GROUP_KEYS = MAXTAGS;
+
+/*! Key for entries with no value, such as unknown author. Sorts last. */
+const int GROUP_KEY_OTHER = 0x7FFFFFFF;
+
+/*!
+* Abstract base class for extracting keys from wads and maps.
+* An entry can have several keys, putting it in several groups,
+* or none, leaving it out. Keys of a map are by default the keys
+* of its wad, so categorizations of wads only need to implement
+* wadKeys, while map-only categorizations implement mapKeys.
+*
+* The key range given to the constructor lets GroupStatSet keep the
+* groups in an array indexed by key. Keys outside it are still
+* handled, but slower. Without a range (maxKey < minKey), the groups
+* are always found by hashing.
+*/
+class StatGroupKey
+{
+	public:
+		/*!
+		* Title is the name of the categorization, and width the
+		* column width for the key names.
+		*/
+		StatGroupKey(wxString title, uint16_t width, int minKey=0, int maxKey=-1);
+
+		virtual ~StatGroupKey() {}
+
+		/*! Name of the categorization. */
+		wxString getTitle() { return title; }
+
+		/*! Column width for the key names. */
+		uint16_t getWidth() { return width; }
+
+		/*! true if keys are expected from minKey to maxKey. */
+		bool hasRange() { return maxKey >= minKey; }
+
+		int getMinKey() { return minKey; }
+
+		int getMaxKey() { return maxKey; }
+
+		/*!
+		* Writes the keys of a wad to keys (with space for
+		* MAX_GROUP_KEYS), returning the number of keys.
+		* The default is no keys.
+		*/
+		virtual int wadKeys(WadEntry* wadEntry, int* keys) { return 0; }
+
+		/*! Writes the keys of a map to keys, returning the number of keys. */
+		virtual int mapKeys(MapEntry* mapEntry, int* keys) { return wadKeys(mapEntry->wadPointer, keys); }
+
+		/*! Display name of a key. */
+		virtual wxString keyName(int key) = 0;
+
+		/*!
+		* Adds the keys which should have a group even when no entry
+		* has them, so that all categories are listed. The default is
+		* none, listing only groups with entries.
+		*/
+		virtual void fixedKeys(vector<int>& keys) {}
+
+		/*! false for fields that make no sense in a table with this key. */
+		virtual bool showsField(StatFields field) { return true; }
+
+	protected:
+		wxString title;
+		uint16_t width;
+		int minKey;
+		int maxKey;
+};
+
+/*! Wad year, with 0 for unknown. */
+class YearGroupKey : public StatGroupKey
+{
+	public:
+		YearGroupKey();
+		virtual int wadKeys(WadEntry* wadEntry, int* keys);
+		virtual wxString keyName(int key);
+};
+
+/*! Target iwad, as defined by IwadType. */
+class IwadGroupKey : public StatGroupKey
+{
+	public:
+		IwadGroupKey();
+		virtual int wadKeys(WadEntry* wadEntry, int* keys);
+		virtual wxString keyName(int key);
+};
+
+/*! Target engine, as defined by EngineType. */
+class EngineGroupKey : public StatGroupKey
+{
+	public:
+		EngineGroupKey();
+		virtual int wadKeys(WadEntry* wadEntry, int* keys);
+		virtual wxString keyName(int key);
+};
+
+/*! Wad playstyle (2.5D, 3D, Special). */
+class PlaystyleGroupKey : public StatGroupKey
+{
+	public:
+		PlaystyleGroupKey();
+		virtual int wadKeys(WadEntry* wadEntry, int* keys);
+		virtual wxString keyName(int key);
+		virtual void fixedKeys(vector<int>& keys);
+};
+
+/*!
+* Own rating of the wad or map, divided by ten for the categories
+* 0-10, and 11 for not rated.
+*/
+class RatingGroupKey : public StatGroupKey
+{
+	public:
+		RatingGroupKey();
+		virtual int wadKeys(WadEntry* wadEntry, int* keys);
+		virtual int mapKeys(MapEntry* mapEntry, int* keys);
+		virtual wxString keyName(int key);
+		virtual void fixedKeys(vector<int>& keys);
+		virtual bool showsField(StatFields field) { return field != STS_OWNRATING_AVG; }
+};
+
+/*! Map difficulty rating, with 0 for not rated. */
+class DifficultyGroupKey : public StatGroupKey
+{
+	public:
+		DifficultyGroupKey();
+		virtual int mapKeys(MapEntry* mapEntry, int* keys);
+		virtual wxString keyName(int key);
+		virtual void fixedKeys(vector<int>& keys);
+};
+
+/*!
+* Base class for keys which are dbids of database entries, named
+* by a map from dbid to name. All entries in the map are listed,
+* and GROUP_KEY_OTHER is named by other.
+*/
+class NamedGroupKey : public StatGroupKey
+{
+	public:
+		/*! Takes ownership of names. */
+		NamedGroupKey(wxString title, map<int, wxString>* names, wxString other);
+		virtual ~NamedGroupKey();
+		virtual wxString keyName(int key);
+		virtual void fixedKeys(vector<int>& keys);
+
+	private:
+		map<int, wxString>* names;
+		wxString otherName;
+};
+
+/*!
+* Map authors. A map with two authors is in both groups. Authors
+* in a group are not considered, so if a map has group "a" as
+* author, which consists of people x, y and z, it is only counted
+* for "a", not for x, y or z.
+*/
+class AuthorGroupKey : public NamedGroupKey
+{
+	public:
+		/*! names maps author dbid to name. */
+		AuthorGroupKey(map<int, wxString>* names);
+		virtual int mapKeys(MapEntry* mapEntry, int* keys);
+};
+
+/*! Map style tags. A map is in the group of each of its tags. */
+class TagGroupKey : public NamedGroupKey
+{
+	public:
+		/*! names maps tag dbid to tag. */
+		TagGroupKey(map<int, wxString>* names);
+		virtual int mapKeys(MapEntry* mapEntry, int* keys);
+};
+
+#endif // STATGROUPKEY_H
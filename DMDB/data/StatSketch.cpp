@@ -0,0 +1,147 @@
+/*
+* StatSketch implementation
+*/
+
+#include "StatSketch.h"
+#include <cmath>
+
+/*! Growth factor between sketch buckets, for a relative error of 1%. */
+const double SKETCH_GAMMA = 1.02;
+
+/*! Natural logarithm of SKETCH_GAMMA. */
+const double SKETCH_LOG_GAMMA = log(SKETCH_GAMMA);
+
+//****************************************************************
+//************************ QuantileSketch ************************
+//****************************************************************
+
+QuantileSketch::QuantileSketch()
+: total(0), zeros(0), minValue(0.0), maxValue(0.0), offset(0)
+{
+}
+
+int QuantileSketch::bucketIndex(double value)
+{
+	return (int)ceil(log(value) / SKETCH_LOG_GAMMA);
+}
+
+double QuantileSketch::bucketValue(int index)
+{
+	//Midpoint between the bucket limits, in relative terms
+	return 2.0 * pow(SKETCH_GAMMA, index) / (SKETCH_GAMMA + 1.0);
+}
+
+void QuantileSketch::add(double value)
+{
+	if (total == 0) {
+		minValue = value;
+		maxValue = value;
+	} else {
+		if (value < minValue) minValue = value;
+		if (value > maxValue) maxValue = value;
+	}
+	total++;
+	if (value <= 0.0) {
+		zeros++;
+		return;
+	}
+	int index = bucketIndex(value);
+	if (counts.empty()) {
+		offset = index;
+		counts.push_back(1);
+	} else if (index < offset) {
+		counts.insert(counts.begin(), offset-index, 0);
+		offset = index;
+		counts[0]++;
+	} else {
+		if (index-offset >= (int)counts.size())
+			counts.resize(index-offset+1, 0);
+		counts[index-offset]++;
+	}
+}
+
+void QuantileSketch::merge(const QuantileSketch& other)
+{
+	if (other.total == 0)
+		return;
+	if (total == 0) {
+		minValue = other.minValue;
+		maxValue = other.maxValue;
+	} else {
+		if (other.minValue < minValue) minValue = other.minValue;
+		if (other.maxValue > maxValue) maxValue = other.maxValue;
+	}
+	total += other.total;
+	zeros += other.zeros;
+	if (other.counts.empty())
+		return;
+	if (counts.empty()) {
+		offset = other.offset;
+		counts = other.counts;
+		return;
+	}
+	if (other.offset < offset) {
+		counts.insert(counts.begin(), offset-other.offset, 0);
+		offset = other.offset;
+	}
+	int end = other.offset + other.counts.size();
+	if (end-offset > (int)counts.size())
+		counts.resize(end-offset, 0);
+	for (size_t i=0; i<other.counts.size(); i++)
+		counts[other.offset-offset+i] += other.counts[i];
+}
+
+double QuantileSketch::quantile(double q) const
+{
+	if (total == 0)
+		return 0.0;
+	if (q <= 0.0)
+		return minValue;
+	if (q >= 1.0)
+		return maxValue;
+	uint64_t rank = (uint64_t)(q * (total-1));
+	if (rank < zeros)
+		return (minValue < 0.0)? minValue: 0.0;
+	uint64_t seen = zeros;
+	for (size_t i=0; i<counts.size(); i++) {
+		seen += counts[i];
+		if (seen > rank) {
+			double value = bucketValue(offset+i);
+			if (value < minValue) return minValue;
+			if (value > maxValue) return maxValue;
+			return value;
+		}
+	}
+	return maxValue;
+}
+
+//***************************************************************
+//************************ StatHistogram ************************
+//***************************************************************
+
+StatHistogram::StatHistogram(const double* edges, int edgeCount)
+: edges(edges), buckets(edgeCount), total(0)
+{
+}
+
+void StatHistogram::add(double value)
+{
+	if (counts.empty())
+		counts.resize(buckets, 0);
+	int b = buckets-1;
+	while (b>0 && value<edges[b])
+		b--;
+	counts[b]++;
+	total++;
+}
+
+void StatHistogram::merge(const StatHistogram& other)
+{
+	if (other.total == 0)
+		return;
+	if (counts.empty())
+		counts.resize(buckets, 0);
+	for (int b=0; b<buckets; b++)
+		counts[b] += other.counts[b];
+	total += other.total;
+}
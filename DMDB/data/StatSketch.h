@@ -0,0 +1,104 @@
+/*!
+* \file StatSketch.h
+* \author Lars Thomas Boye 2020
+*
+* Compact summaries of the distribution of a numeric value, built
+* by adding one value at a time. QuantileSketch gives approximate
+* quantiles (median, percentiles), while StatHistogram counts values
+* in fixed buckets. Both can be merged, so summaries built separately
+* (for different categories, or in different threads) can be combined.
+*/
+
+#ifndef STATSKETCH_H
+#define STATSKETCH_H
+
+#include <vector>
+#include <stdint.h>
+
+using namespace std;
+
+/*!
+* Quantile sketch for non-negative values, with a relative accuracy of
+* about 1%. Values are counted in logarithmic buckets, bucket i holding
+* values in (g^(i-1), g^i] for g=SKETCH_GAMMA, and a quantile is
+* answered with the midpoint of the bucket it falls in. Zero (and
+* negative values) are counted separately. The memory use depends only
+* on the range of values, not the number of them: About 120 buckets per
+* factor of 10. Two sketches are merged by adding bucket counts, which
+* gives the same result as adding all values to one sketch.
+*/
+class QuantileSketch
+{
+	public:
+		QuantileSketch();
+
+		/*! Count one value. */
+		void add(double value);
+
+		/*! Add all values counted by other. */
+		void merge(const QuantileSketch& other);
+
+		/*! Number of values counted. */
+		uint64_t count() const { return total; }
+
+		/*!
+		* The value at quantile q (0.0 to 1.0), so 0.5 gives the median
+		* and 0.9 the 90th percentile. 0.0 if nothing counted.
+		*/
+		double quantile(double q) const;
+
+	private:
+		/*! Bucket index for a positive value. */
+		static int bucketIndex(double value);
+
+		/*! Representative value for a bucket index. */
+		static double bucketValue(int index);
+
+		uint64_t total; //Values counted
+		uint64_t zeros; //Values <= 0
+		double minValue; //Exact range, to clamp results
+		double maxValue;
+		int offset; //Bucket index of counts[0]
+		vector<uint32_t> counts;
+};
+
+/*!
+* Counts values in fixed buckets. The bucket limits are given by an
+* ascending array of edges, which is not copied, so it must remain
+* valid (normally a static table). Bucket b holds values from edges[b]
+* up to edges[b+1], the last from the last edge and up. Values below
+* the first edge are counted in the first bucket. Histograms can only
+* be merged if they have the same edges.
+*/
+class StatHistogram
+{
+	public:
+		/*! Histogram with edgeCount buckets, starting at each edge. */
+		StatHistogram(const double* edges, int edgeCount);
+
+		/*! Count one value. */
+		void add(double value);
+
+		/*! Add the counts of other, which must have the same edges. */
+		void merge(const StatHistogram& other);
+
+		/*! Number of buckets. */
+		int size() const { return buckets; }
+
+		/*! Lower limit of bucket b. */
+		double lower(int b) const { return edges[b]; }
+
+		/*! Number of values in bucket b. */
+		uint64_t bucketCount(int b) const { return counts.empty()? 0: counts[b]; }
+
+		/*! Number of values counted. */
+		uint64_t count() const { return total; }
+
+	private:
+		const double* edges;
+		int buckets;
+		uint64_t total;
+		vector<uint64_t> counts; //Empty until the first value
+};
+
+#endif // STATSKETCH_H
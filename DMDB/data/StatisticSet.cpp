@@ -1,4 +1,5 @@
 #include "StatisticSet.h"
+#include <algorithm>
 
 //*************************************************************
 //************************ Comparators ************************
@@ -75,708 +76,362 @@ void StatisticSet::addField(StatFields field, uint16_t w)
 }
 
 
-//*************************************************************
-//************************ YearStatSet ************************
-//*************************************************************
-
-YearStatSet::YearStatSet(wxString setName) : StatisticSet("Year", setName)
-{
-	statMap = new map<int, MapStatistics*>();
-	addField(STS_YEAR_MIN, 60);
-	addField(STS_MAPS, 50);
-	addField(STS_WF_IWAD, 50);
-	addField(STS_WF_THINGS, 50);
-	addField(STS_SINGLE, 50);
-	addField(STS_COOP, 50);
-	addField(STS_DM, 50);
-	addField(STS_LINEDEFS, 80);
-	addField(STS_LINEDEFS_AVG, 80);
-	addField(STS_SECTORS, 80);
-	addField(STS_SECTORS_AVG, 80);
-	addField(STS_THINGS, 80);
-	addField(STS_THINGS_AVG, 80);
-	addField(STS_SECRETS_AVG, 80);
-	addField(STS_ENEMIES_AVG, 80);
-	addField(STS_TOTALHP_AVG, 80);
-	addField(STS_AMMORAT_AVG, 80);
-	addField(STS_HEALTHRAT_AVG, 80);
-	addField(STS_ARMORRAT_AVG, 80);
-	addField(STS_AREA_AVG, 80);
-	addField(STS_OWNRATING_AVG, 60);
-}
-
-YearStatSet::~YearStatSet()
-{
-	if (statMap != NULL)
-		delete statMap;
-}
+//****************************************************************
+//************************ StatGroupTable ************************
+//****************************************************************
 
-void YearStatSet::processMap(MapEntry* mapEntry)
-{
-	map<int,MapStatistics*>::iterator it = statMap->find(mapEntry->wadPointer->year);
-	if (it == statMap->end()) {
-		wxString name = (mapEntry->wadPointer->year==0)? "Unknown" :
-				wxString::Format("%i", mapEntry->wadPointer->year);
-		MapStatistics* ms = new MapStatistics(name);
-		ms->processMap(mapEntry);
-		(*statMap)[mapEntry->wadPointer->year] = ms;
-	} else {
-		it->second->processMap(mapEntry);
+StatGroupTable::StatGroupTable(StatGroupKey* key1, StatGroupKey* key2, bool wads)
+: key1(key1), key2(key2), wadStats(wads), range1(0), range2(0), dense(NULL)
+{
+	if (key1->hasRange() && (key2==NULL || key2->hasRange())) {
+		range1 = key1->getMaxKey() - key1->getMinKey() + 1;
+		range2 = (key2==NULL)? 1: key2->getMaxKey() - key2->getMinKey() + 1;
+		if (range1*range2 <= DENSE_GROUP_LIMIT) {
+			dense = new vector<DBStatistics*>(range1*range2, NULL);
+		} else {
+			range1 = 0;
+			range2 = 0;
+		}
 	}
+	hashed = new unordered_map<int64_t, DBStatistics*>();
 }
 
-void YearStatSet::computeResults()
+StatGroupTable::~StatGroupTable()
 {
-	statList = new list<DBStatistics*>();
-	for (map<int,MapStatistics*>::iterator it=statMap->begin(); it!=statMap->end(); ++it) {
-		it->second->computeResults();
-		statList->push_back(it->second);
+	if (dense != NULL) {
+		for (size_t i=0; i<dense->size(); i++) {
+			if ((*dense)[i] != NULL)
+				delete (*dense)[i];
+		}
+		delete dense;
 	}
-	delete statMap;
-	statMap = NULL;
+	for (unordered_map<int64_t, DBStatistics*>::iterator it=hashed->begin(); it!=hashed->end(); ++it)
+		delete it->second;
+	delete hashed;
 }
 
-
-//*************************************************************
-//************************ IwadStatSet ************************
-//*************************************************************
-
-IwadStatSet::IwadStatSet(wxString setName) : StatisticSet("Iwad", setName)
+DBStatistics*& StatGroupTable::findSlot(int k1, int k2)
 {
-	statMap = new map<int, MapStatistics*>();
-	addField(STS_END, 100);
-	addField(STS_MAPS, 50);
-	addField(STS_WF_IWAD, 50);
-	addField(STS_WF_THINGS, 50);
-	addField(STS_SINGLE, 50);
-	addField(STS_COOP, 50);
-	addField(STS_DM, 50);
-	addField(STS_LINEDEFS, 80);
-	addField(STS_LINEDEFS_AVG, 80);
-	addField(STS_SECTORS, 80);
-	addField(STS_SECTORS_AVG, 80);
-	addField(STS_THINGS, 80);
-	addField(STS_THINGS_AVG, 80);
-	addField(STS_SECRETS_AVG, 80);
-	addField(STS_ENEMIES_AVG, 80);
-	addField(STS_TOTALHP_AVG, 80);
-	addField(STS_AMMORAT_AVG, 80);
-	addField(STS_HEALTHRAT_AVG, 80);
-	addField(STS_ARMORRAT_AVG, 80);
-	addField(STS_AREA_AVG, 80);
-	addField(STS_OWNRATING_AVG, 60);
-}
-
-IwadStatSet::~IwadStatSet()
-{
-	if (statMap != NULL)
-		delete statMap;
-}
-
-void IwadStatSet::processMap(MapEntry* mapEntry)
-{
-	map<int,MapStatistics*>::iterator it = statMap->find(mapEntry->wadPointer->iwad);
-	if (it == statMap->end()) {
-		wxString name = (mapEntry->wadPointer->iwad==0)? "Unknown" :
-				iwadNames[mapEntry->wadPointer->iwad];
-		MapStatistics* ms = new MapStatistics(name);
-		ms->processMap(mapEntry);
-		(*statMap)[mapEntry->wadPointer->iwad] = ms;
-	} else {
-		it->second->processMap(mapEntry);
+	if (dense != NULL) {
+		int i1 = k1 - key1->getMinKey();
+		int i2 = (key2==NULL)? 0: k2 - key2->getMinKey();
+		if (i1>=0 && i1<range1 && i2>=0 && i2<range2)
+			return (*dense)[i1*range2 + i2];
 	}
+	return (*hashed)[pairKey(k1, k2)]; //Added as NULL if not found
 }
 
-void IwadStatSet::computeResults()
+DBStatistics* StatGroupTable::getGroup(int k1, int k2)
 {
-	statList = new list<DBStatistics*>();
-	for (map<int,MapStatistics*>::iterator it=statMap->begin(); it!=statMap->end(); ++it) {
-		it->second->computeResults();
-		statList->push_back(it->second);
+	DBStatistics*& slot = findSlot(k1, k2);
+	if (slot == NULL) {
+		//Heading is set by GroupStatSet when done
+		if (wadStats)
+			slot = new WadStatistics("");
+		else
+			slot = new MapStatistics("");
 	}
-	delete statMap;
-	statMap = NULL;
+	return slot;
 }
 
-
-//***************************************************************
-//************************ EngineStatSet ************************
-//***************************************************************
-
-EngineStatSet::EngineStatSet(wxString setName) : StatisticSet("Engine", setName)
-{
-	statMap = new map<int, MapStatistics*>();
-	addField(STS_END, 100);
-	addField(STS_MAPS, 50);
-	addField(STS_WF_IWAD, 50);
-	addField(STS_WF_THINGS, 50);
-	addField(STS_SINGLE, 50);
-	addField(STS_COOP, 50);
-	addField(STS_DM, 50);
-	addField(STS_LINEDEFS, 80);
-	addField(STS_LINEDEFS_AVG, 80);
-	addField(STS_SECTORS, 80);
-	addField(STS_SECTORS_AVG, 80);
-	addField(STS_THINGS, 80);
-	addField(STS_THINGS_AVG, 80);
-	addField(STS_SECRETS_AVG, 80);
-	addField(STS_ENEMIES_AVG, 80);
-	addField(STS_TOTALHP_AVG, 80);
-	addField(STS_AMMORAT_AVG, 80);
-	addField(STS_HEALTHRAT_AVG, 80);
-	addField(STS_ARMORRAT_AVG, 80);
-	addField(STS_AREA_AVG, 80);
-	addField(STS_OWNRATING_AVG, 60);
-}
-
-EngineStatSet::~EngineStatSet()
+void StatGroupTable::processWad(WadEntry* wadEntry)
 {
-	if (statMap != NULL)
-		delete statMap;
-}
-
-void EngineStatSet::processMap(MapEntry* mapEntry)
-{
-	map<int,MapStatistics*>::iterator it = statMap->find(mapEntry->wadPointer->engine);
-	if (it == statMap->end()) {
-		wxString name = (mapEntry->wadPointer->engine==0)? "Unknown" :
-				engineNames[mapEntry->wadPointer->engine];
-		MapStatistics* ms = new MapStatistics(name);
-		ms->processMap(mapEntry);
-		(*statMap)[mapEntry->wadPointer->engine] = ms;
+	if (!wadStats) {
+		for (int i=0; i<wadEntry->numberOfMaps; i++)
+			processMap(wadEntry->mapPointers.at(i));
+		return;
+	}
+	int keys1[MAX_GROUP_KEYS];
+	int keys2[MAX_GROUP_KEYS];
+	int n1 = key1->wadKeys(wadEntry, keys1);
+	if (key2 == NULL) {
+		for (int i=0; i<n1; i++)
+			getGroup(keys1[i], 0)->processWad(wadEntry);
 	} else {
-		it->second->processMap(mapEntry);
+		int n2 = key2->wadKeys(wadEntry, keys2);
+		for (int i=0; i<n1; i++) {
+			for (int j=0; j<n2; j++)
+				getGroup(keys1[i], keys2[j])->processWad(wadEntry);
+		}
 	}
 }
 
-void EngineStatSet::computeResults()
+void StatGroupTable::processMap(MapEntry* mapEntry)
 {
-	statList = new list<DBStatistics*>();
-	for (map<int,MapStatistics*>::iterator it=statMap->begin(); it!=statMap->end(); ++it) {
-		it->second->computeResults();
-		statList->push_back(it->second);
+	int keys1[MAX_GROUP_KEYS];
+	int keys2[MAX_GROUP_KEYS];
+	int n1 = key1->mapKeys(mapEntry, keys1);
+	if (key2 == NULL) {
+		for (int i=0; i<n1; i++)
+			getGroup(keys1[i], 0)->processMap(mapEntry);
+	} else {
+		int n2 = key2->mapKeys(mapEntry, keys2);
+		for (int i=0; i<n1; i++) {
+			for (int j=0; j<n2; j++)
+				getGroup(keys1[i], keys2[j])->processMap(mapEntry);
+		}
 	}
-	delete statMap;
-	statMap = NULL;
-}
-
-
-//***************************************************************
-//************************ RatingStatSet ************************
-//***************************************************************
-
-RatingStatSet::RatingStatSet(wxString setName) : StatisticSet("Own rating", setName)
-{
-	statMap = new map<int, MapStatistics*>();
-	for (int i=0; i<=10; i++)
-		(*statMap)[i] = new MapStatistics(wxString::Format("%i",i));
-	(*statMap)[11] = new MapStatistics("No rating");
-
-	addField(STS_END, 80);
-	addField(STS_MAPS, 50);
-	addField(STS_WF_IWAD, 50);
-	addField(STS_WF_THINGS, 50);
-	addField(STS_SINGLE, 50);
-	addField(STS_COOP, 50);
-	addField(STS_DM, 50);
-	addField(STS_LINEDEFS, 80);
-	addField(STS_LINEDEFS_AVG, 80);
-	addField(STS_SECTORS, 80);
-	addField(STS_SECTORS_AVG, 80);
-	addField(STS_THINGS, 80);
-	addField(STS_THINGS_AVG, 80);
-	addField(STS_SECRETS_AVG, 80);
-	addField(STS_ENEMIES_AVG, 80);
-	addField(STS_TOTALHP_AVG, 80);
-	addField(STS_AMMORAT_AVG, 80);
-	addField(STS_HEALTHRAT_AVG, 80);
-	addField(STS_ARMORRAT_AVG, 80);
-	addField(STS_AREA_AVG, 80);
 }
 
-RatingStatSet::~RatingStatSet()
+void StatGroupTable::mergeGroup(int k1, int k2, DBStatistics* stats)
 {
-	if (statMap != NULL)
-		delete statMap;
-}
-
-void RatingStatSet::processMap(MapEntry* mapEntry)
-{
-	int rat = 11;
-	if (mapEntry->ownRating<=100)
-		rat = mapEntry->ownRating/10;
-	map<int,MapStatistics*>::iterator it = statMap->find(rat);
-	it->second->processMap(mapEntry);
-}
-
-void RatingStatSet::computeResults()
-{
-	statList = new list<DBStatistics*>();
-	for (map<int,MapStatistics*>::iterator it=statMap->begin(); it!=statMap->end(); ++it) {
-		it->second->computeResults();
-		statList->push_back(it->second);
+	DBStatistics*& slot = findSlot(k1, k2);
+	if (slot == NULL) {
+		slot = stats;
+	} else {
+		slot->merge(stats);
+		delete stats;
 	}
-	delete statMap;
-	statMap = NULL;
-}
-
-
-//*******************************************************************
-//************************ DifficultyStatSet ************************
-//*******************************************************************
-
-DifficultyStatSet::DifficultyStatSet(wxString setName) : StatisticSet("Difficulty", setName)
-{
-	statMap = new map<int, MapStatistics*>();
-	(*statMap)[0] = new MapStatistics("Not rated");
-	for (int i=1; i<5; i++)
-		(*statMap)[i] = new MapStatistics(difficultyRatings[i]);
-
-	addField(STS_END, 120);
-	addField(STS_MAPS, 50);
-	addField(STS_WF_IWAD, 50);
-	addField(STS_WF_THINGS, 50);
-	addField(STS_SINGLE, 50);
-	addField(STS_COOP, 50);
-	addField(STS_DM, 50);
-	addField(STS_LINEDEFS, 80);
-	addField(STS_LINEDEFS_AVG, 80);
-	addField(STS_SECTORS, 80);
-	addField(STS_SECTORS_AVG, 80);
-	addField(STS_THINGS, 80);
-	addField(STS_THINGS_AVG, 80);
-	addField(STS_SECRETS_AVG, 80);
-	addField(STS_ENEMIES_AVG, 80);
-	addField(STS_TOTALHP_AVG, 80);
-	addField(STS_AMMORAT_AVG, 80);
-	addField(STS_HEALTHRAT_AVG, 80);
-	addField(STS_ARMORRAT_AVG, 80);
-	addField(STS_AREA_AVG, 80);
-	addField(STS_OWNRATING_AVG, 60);
 }
 
-DifficultyStatSet::~DifficultyStatSet()
+void StatGroupTable::merge(StatGroupTable* other)
 {
-	if (statMap != NULL)
-		delete statMap;
+	vector<StatGroup> others;
+	other->takeGroups(others);
+	for (size_t i=0; i<others.size(); i++)
+		mergeGroup(others[i].key1, others[i].key2, others[i].stats);
 }
 
-void DifficultyStatSet::processMap(MapEntry* mapEntry)
+/*! Orders StatGroups on keys. */
+bool stat_group_comp(const StatGroup& first, const StatGroup& second)
 {
-	map<int,MapStatistics*>::iterator it = statMap->find(mapEntry->difficulty);
-	it->second->processMap(mapEntry);
+	if (first.key1 != second.key1)
+		return first.key1 < second.key1;
+	return first.key2 < second.key2;
 }
 
-void DifficultyStatSet::computeResults()
+void StatGroupTable::takeGroups(vector<StatGroup>& groups)
 {
-	statList = new list<DBStatistics*>();
-	for (map<int,MapStatistics*>::iterator it=statMap->begin(); it!=statMap->end(); ++it) {
-		it->second->computeResults();
-		statList->push_back(it->second);
+	StatGroup group;
+	if (dense != NULL) {
+		for (size_t i=0; i<dense->size(); i++) {
+			if ((*dense)[i] != NULL) {
+				group.key1 = key1->getMinKey() + i/range2;
+				group.key2 = (key2==NULL)? 0: key2->getMinKey() + i%range2;
+				group.stats = (*dense)[i];
+				groups.push_back(group);
+				(*dense)[i] = NULL;
+			}
+		}
 	}
-	delete statMap;
-	statMap = NULL;
-}
-
-
-//******************************************************************
-//************************ PlaystyleStatSet ************************
-//******************************************************************
-
-PlaystyleStatSet::PlaystyleStatSet(wxString setName) : StatisticSet("Playstyle", setName)
-{
-	statMap = new map<int, MapStatistics*>();
-	for (int i=0; i<3; i++)
-		(*statMap)[i] = new MapStatistics(playStyles[i]);
-
-	addField(STS_END, 120);
-	addField(STS_MAPS, 50);
-	addField(STS_WF_IWAD, 50);
-	addField(STS_WF_THINGS, 50);
-	addField(STS_SINGLE, 50);
-	addField(STS_COOP, 50);
-	addField(STS_DM, 50);
-	addField(STS_LINEDEFS, 80);
-	addField(STS_LINEDEFS_AVG, 80);
-	addField(STS_SECTORS, 80);
-	addField(STS_SECTORS_AVG, 80);
-	addField(STS_THINGS, 80);
-	addField(STS_THINGS_AVG, 80);
-	addField(STS_SECRETS_AVG, 80);
-	addField(STS_ENEMIES_AVG, 80);
-	addField(STS_TOTALHP_AVG, 80);
-	addField(STS_AMMORAT_AVG, 80);
-	addField(STS_HEALTHRAT_AVG, 80);
-	addField(STS_ARMORRAT_AVG, 80);
-	addField(STS_AREA_AVG, 80);
-	addField(STS_OWNRATING_AVG, 60);
-}
-
-PlaystyleStatSet::~PlaystyleStatSet()
-{
-	if (statMap != NULL)
-		delete statMap;
-}
-
-void PlaystyleStatSet::processMap(MapEntry* mapEntry)
-{
-	map<int,MapStatistics*>::iterator it = statMap->find(mapEntry->wadPointer->playStyle);
-	it->second->processMap(mapEntry);
-}
-
-void PlaystyleStatSet::computeResults()
-{
-	statList = new list<DBStatistics*>();
-	for (map<int,MapStatistics*>::iterator it=statMap->begin(); it!=statMap->end(); ++it) {
-		it->second->computeResults();
-		statList->push_back(it->second);
+	for (unordered_map<int64_t, DBStatistics*>::iterator it=hashed->begin(); it!=hashed->end(); ++it) {
+		if (it->second != NULL) {
+			group.key1 = (int)(it->first >> 32);
+			group.key2 = (int)(uint32_t)it->first;
+			group.stats = it->second;
+			groups.push_back(group);
+		}
 	}
-	delete statMap;
-	statMap = NULL;
+	hashed->clear();
+	sort(groups.begin(), groups.end(), stat_group_comp);
 }
 
 
-//***************************************************************
-//************************ AuthorStatSet ************************
-//***************************************************************
+//*****************************************************************
+//************************ StatGroupThread ************************
+//*****************************************************************
 
-AuthorStatSet::AuthorStatSet(wxString setName, map<int, MapStatistics*>* authorStats)
-: StatisticSet("Author", setName)
+StatGroupThread::StatGroupThread(StatGroupTable* table, vector<WadEntry*>* wads,
+	vector<MapEntry*>* maps, size_t begin, size_t end)
+: wxThread(wxTHREAD_JOINABLE), table(table), wads(wads), maps(maps), begin(begin), end(end)
 {
-	unknown = new MapStatistics("Unknown");
-	statMap = authorStats;
-	addField(STS_END, 200);
-	addField(STS_MAPS, 50);
-	addField(STS_WF_IWAD, 50);
-	addField(STS_WF_THINGS, 50);
-	addField(STS_SINGLE, 50);
-	addField(STS_COOP, 50);
-	addField(STS_DM, 50);
-	addField(STS_LINEDEFS, 80);
-	addField(STS_LINEDEFS_AVG, 80);
-	addField(STS_SECTORS, 80);
-	addField(STS_SECTORS_AVG, 80);
-	addField(STS_THINGS, 80);
-	addField(STS_THINGS_AVG, 80);
-	addField(STS_SECRETS_AVG, 80);
-	addField(STS_ENEMIES_AVG, 80);
-	addField(STS_TOTALHP_AVG, 80);
-	addField(STS_AMMORAT_AVG, 80);
-	addField(STS_HEALTHRAT_AVG, 80);
-	addField(STS_ARMORRAT_AVG, 80);
-	addField(STS_AREA_AVG, 80);
-	addField(STS_OWNRATING_AVG, 60);
 }
 
-AuthorStatSet::~AuthorStatSet()
+void StatGroupThread::process(StatGroupTable* table, vector<WadEntry*>* wads,
+	vector<MapEntry*>* maps, size_t begin, size_t end)
 {
-	if (statMap != NULL)
-		delete statMap;
-}
-
-void AuthorStatSet::processMap(MapEntry* mapEntry)
-{
-	if (mapEntry->author1 != NULL) {
-		map<int,MapStatistics*>::iterator it = statMap->find(mapEntry->author1->dbid);
-		it->second->processMap(mapEntry);
-	} else if (mapEntry->author2 == NULL) {
-		unknown->processMap(mapEntry);
-	}
-	if (mapEntry->author2 != NULL) {
-		map<int,MapStatistics*>::iterator it = statMap->find(mapEntry->author2->dbid);
-		it->second->processMap(mapEntry);
+	if (wads != NULL) {
+		for (size_t i=begin; i<end; i++)
+			table->processWad((*wads)[i]);
+	} else {
+		for (size_t i=begin; i<end; i++)
+			table->processMap((*maps)[i]);
 	}
 }
 
-void AuthorStatSet::computeResults()
+wxThread::ExitCode StatGroupThread::Entry()
 {
-	statList = new list<DBStatistics*>();
-	for (map<int,MapStatistics*>::iterator it=statMap->begin(); it!=statMap->end(); ++it) {
-		it->second->computeResults();
-		statList->push_back(it->second);
-	}
-	delete statMap;
-	statMap = NULL;
-	if (unknown->intStats[STS_MAPS] > 0) {
-		statList->push_back(unknown);
-	} else {
-		delete unknown;
-		unknown = NULL;
-	}
+	process(table, wads, maps, begin, end);
+	return (wxThread::ExitCode)0;
 }
 
 
-//************************************************************
-//************************ TagStatSet ************************
-//************************************************************
-
-TagStatSet::TagStatSet(wxString setName, map<int, MapStatistics*>* tagStats)
-: StatisticSet("Style tag", setName)
-{
-	none = new MapStatistics("None");
-	statMap = tagStats;
-	addField(STS_END, 200);
-	addField(STS_MAPS, 50);
-	addField(STS_WF_IWAD, 50);
-	addField(STS_WF_THINGS, 50);
-	addField(STS_SINGLE, 50);
-	addField(STS_COOP, 50);
-	addField(STS_DM, 50);
-	addField(STS_LINEDEFS, 80);
-	addField(STS_LINEDEFS_AVG, 80);
-	addField(STS_SECTORS, 80);
-	addField(STS_SECTORS_AVG, 80);
-	addField(STS_THINGS, 80);
-	addField(STS_THINGS_AVG, 80);
-	addField(STS_SECRETS_AVG, 80);
-	addField(STS_ENEMIES_AVG, 80);
-	addField(STS_TOTALHP_AVG, 80);
-	addField(STS_AMMORAT_AVG, 80);
-	addField(STS_HEALTHRAT_AVG, 80);
-	addField(STS_ARMORRAT_AVG, 80);
-	addField(STS_AREA_AVG, 80);
-	addField(STS_OWNRATING_AVG, 60);
-}
+//**************************************************************
+//************************ GroupStatSet ************************
+//**************************************************************
 
-TagStatSet::~TagStatSet()
+GroupStatSet::GroupStatSet(wxString setName, bool wads, StatGroupKey* key1, StatGroupKey* key2)
+: StatisticSet((key2==NULL)? key1->getTitle(): key1->getTitle()+" / "+key2->getTitle(), setName),
+key1(key1), key2(key2), wadStats(wads)
 {
-	if (statMap != NULL)
-		delete statMap;
-}
+	table = new StatGroupTable(key1, key2, wads);
+	groups = new vector<StatGroup>();
 
-void TagStatSet::processMap(MapEntry* mapEntry)
-{
-	bool bnone = true;
-	for (int i=0; i<MAXTAGS; i++) {
-		if (mapEntry->tags[i] != 0) {
-			map<int,MapStatistics*>::iterator it = statMap->find(mapEntry->tags[i]);
-			it->second->processMap(mapEntry);
-			bnone=false;
+	//List all categories of keys which have fixed keys
+	vector<int> fixed1;
+	vector<int> fixed2;
+	key1->fixedKeys(fixed1);
+	if (key2 == NULL) {
+		for (size_t i=0; i<fixed1.size(); i++)
+			table->getGroup(fixed1[i], 0);
+	} else {
+		key2->fixedKeys(fixed2);
+		for (size_t i=0; i<fixed1.size(); i++) {
+			for (size_t j=0; j<fixed2.size(); j++)
+				table->getGroup(fixed1[i], fixed2[j]);
 		}
 	}
-	if (bnone)
-		none->processMap(mapEntry);
-}
 
-void TagStatSet::computeResults()
-{
-	statList = new list<DBStatistics*>();
-	for (map<int,MapStatistics*>::iterator it=statMap->begin(); it!=statMap->end(); ++it) {
-		it->second->computeResults();
-		statList->push_back(it->second);
-	}
-	delete statMap;
-	statMap = NULL;
-	if (none->intStats[STS_MAPS] > 0) {
-		statList->push_back(none);
+	uint16_t w = key1->getWidth();
+	if (key2 != NULL)
+		w += key2->getWidth();
+	addField(STS_END, w);
+	if (wads) {
+		addField(STS_WADS, 50);
+		addField(STS_WF_IWAD, 50);
+		addField(STS_WF_THINGS, 50);
+		addField(STS_MAPS, 80);
+		addField(STS_MAPS_AVG, 80);
+		addField(STS_MAPS_MIN, 80);
+		addField(STS_MAPS_MAX, 80);
+		addField(STS_SIZE, 100);
+		addField(STS_SIZE_AVG, 80);
 	} else {
-		delete none;
-		none = NULL;
+		addField(STS_MAPS, 50);
+		addField(STS_WF_IWAD, 50);
+		addField(STS_WF_THINGS, 50);
+		addField(STS_SINGLE, 50);
+		addField(STS_COOP, 50);
+		addField(STS_DM, 50);
+		addField(STS_LINEDEFS, 80);
+		addField(STS_LINEDEFS_AVG, 80);
+		addField(STS_SECTORS, 80);
+		addField(STS_SECTORS_AVG, 80);
+		addField(STS_THINGS, 80);
+		addField(STS_THINGS_AVG, 80);
+		addField(STS_SECRETS_AVG, 80);
+		addField(STS_ENEMIES_AVG, 80);
+		addField(STS_TOTALHP_AVG, 80);
+		addField(STS_AMMORAT_AVG, 80);
+		addField(STS_HEALTHRAT_AVG, 80);
+		addField(STS_ARMORRAT_AVG, 80);
+		addField(STS_AREA_AVG, 80);
 	}
+	if (key1->showsField(STS_OWNRATING_AVG) && (key2==NULL || key2->showsField(STS_OWNRATING_AVG)))
+		addField(STS_OWNRATING_AVG, 60);
 }
 
-
-//****************************************************************
-//************************ YearWadStatSet ************************
-//****************************************************************
-
-YearWadStatSet::YearWadStatSet(wxString setName) : StatisticSet("Year", setName)
+GroupStatSet::~GroupStatSet()
 {
-	statMap = new map<int, WadStatistics*>();
-	addField(STS_YEAR_MIN, 60);
-	addField(STS_WADS, 50);
-	addField(STS_WF_IWAD, 50);
-	addField(STS_WF_THINGS, 50);
-	addField(STS_MAPS, 80);
-	addField(STS_MAPS_AVG, 80);
-	addField(STS_MAPS_MIN, 80);
-	addField(STS_MAPS_MAX, 80);
-	addField(STS_SIZE, 100);
-	addField(STS_SIZE_AVG, 80);
-	addField(STS_OWNRATING_AVG, 60);
+	if (table != NULL)
+		delete table;
+	delete groups; //The DBStatistics are in statList
+	delete key1;
+	if (key2 != NULL)
+		delete key2;
 }
 
-YearWadStatSet::~YearWadStatSet()
+void GroupStatSet::processWad(WadEntry* wadEntry)
 {
-	if (statMap != NULL)
-		delete statMap;
+	table->processWad(wadEntry);
 }
 
-void YearWadStatSet::processWad(WadEntry* wadEntry)
+void GroupStatSet::processMap(MapEntry* mapEntry)
 {
-	map<int,WadStatistics*>::iterator it = statMap->find(wadEntry->year);
-	if (it == statMap->end()) {
-		wxString name = (wadEntry->year==0)? "Unknown" :
-				wxString::Format("%i", wadEntry->year);
-		WadStatistics* ms = new WadStatistics(name);
-		ms->processWad(wadEntry);
-		(*statMap)[wadEntry->year] = ms;
-	} else {
-		it->second->processWad(wadEntry);
-	}
+	table->processMap(mapEntry);
 }
 
-void YearWadStatSet::computeResults()
+void GroupStatSet::processWads(vector<WadEntry*>& wads)
 {
-	statList = new list<DBStatistics*>();
-	for (map<int,WadStatistics*>::iterator it=statMap->begin(); it!=statMap->end(); ++it) {
-		it->second->computeResults();
-		statList->push_back(it->second);
+	if (wadStats) {
+		processParallel(&wads, NULL, wads.size());
+	} else {
+		vector<MapEntry*> maps;
+		for (size_t i=0; i<wads.size(); i++) {
+			for (int j=0; j<wads[i]->numberOfMaps; j++)
+				maps.push_back(wads[i]->mapPointers.at(j));
+		}
+		processParallel(NULL, &maps, maps.size());
 	}
-	delete statMap;
-	statMap = NULL;
-}
-
-
-//****************************************************************
-//************************ IwadWadStatSet ************************
-//****************************************************************
-
-IwadWadStatSet::IwadWadStatSet(wxString setName) : StatisticSet("Iwad", setName)
-{
-	statMap = new map<int, WadStatistics*>();
-	addField(STS_END, 100);
-	addField(STS_WADS, 50);
-	addField(STS_WF_IWAD, 50);
-	addField(STS_WF_THINGS, 50);
-	addField(STS_MAPS, 80);
-	addField(STS_MAPS_AVG, 80);
-	addField(STS_MAPS_MIN, 80);
-	addField(STS_MAPS_MAX, 80);
-	addField(STS_SIZE, 100);
-	addField(STS_SIZE_AVG, 80);
-	addField(STS_OWNRATING_AVG, 60);
 }
 
-IwadWadStatSet::~IwadWadStatSet()
+void GroupStatSet::processMaps(vector<MapEntry*>& maps)
 {
-	if (statMap != NULL)
-		delete statMap;
+	processParallel(NULL, &maps, maps.size());
 }
 
-void IwadWadStatSet::processWad(WadEntry* wadEntry)
+void GroupStatSet::processParallel(vector<WadEntry*>* wads, vector<MapEntry*>* maps, size_t size)
 {
-	map<int,WadStatistics*>::iterator it = statMap->find(wadEntry->iwad);
-	if (it == statMap->end()) {
-		wxString name = (wadEntry->iwad==0)? "Unknown" :
-				iwadNames[wadEntry->iwad];
-		WadStatistics* ms = new WadStatistics(name);
-		ms->processWad(wadEntry);
-		(*statMap)[wadEntry->iwad] = ms;
-	} else {
-		it->second->processWad(wadEntry);
+	int parts = wxThread::GetCPUCount();
+	if (parts > 8)
+		parts = 8;
+	if (parts<2 || size<PARALLEL_GROUP_MIN) {
+		StatGroupThread::process(table, wads, maps, 0, size);
+		return;
 	}
-}
 
-void IwadWadStatSet::computeResults()
-{
-	statList = new list<DBStatistics*>();
-	for (map<int,WadStatistics*>::iterator it=statMap->begin(); it!=statMap->end(); ++it) {
-		it->second->computeResults();
-		statList->push_back(it->second);
+	//Part 0 is processed by this thread, the others by new threads
+	vector<StatGroupTable*> tables(parts, NULL);
+	vector<StatGroupThread*> threads(parts, NULL);
+	size_t partSize = size / parts;
+	for (int i=1; i<parts; i++) {
+		size_t end = (i==parts-1)? size: (i+1)*partSize;
+		tables[i] = new StatGroupTable(key1, key2, wadStats);
+		threads[i] = new StatGroupThread(tables[i], wads, maps, i*partSize, end);
+		if (threads[i]->Run() != wxTHREAD_NO_ERROR) {
+			delete threads[i];
+			threads[i] = NULL;
+			StatGroupThread::process(tables[i], wads, maps, i*partSize, end);
+		}
 	}
-	delete statMap;
-	statMap = NULL;
-}
-
-
-//******************************************************************
-//************************ EngineWadStatSet ************************
-//******************************************************************
-
-EngineWadStatSet::EngineWadStatSet(wxString setName) : StatisticSet("Engine", setName)
-{
-	statMap = new map<int, WadStatistics*>();
-	addField(STS_END, 100);
-	addField(STS_WADS, 50);
-	addField(STS_WF_IWAD, 50);
-	addField(STS_WF_THINGS, 50);
-	addField(STS_MAPS, 80);
-	addField(STS_MAPS_AVG, 80);
-	addField(STS_MAPS_MIN, 80);
-	addField(STS_MAPS_MAX, 80);
-	addField(STS_SIZE, 100);
-	addField(STS_SIZE_AVG, 80);
-	addField(STS_OWNRATING_AVG, 60);
-}
-
-EngineWadStatSet::~EngineWadStatSet()
-{
-	if (statMap != NULL)
-		delete statMap;
-}
-
-void EngineWadStatSet::processWad(WadEntry* wadEntry)
-{
-	map<int,WadStatistics*>::iterator it = statMap->find(wadEntry->engine);
-	if (it == statMap->end()) {
-		wxString name = (wadEntry->engine==0)? "Unknown" :
-				engineNames[wadEntry->engine];
-		WadStatistics* ms = new WadStatistics(name);
-		ms->processWad(wadEntry);
-		(*statMap)[wadEntry->engine] = ms;
-	} else {
-		it->second->processWad(wadEntry);
+	StatGroupThread::process(table, wads, maps, 0, partSize);
+	for (int i=1; i<parts; i++) {
+		if (threads[i] != NULL) {
+			threads[i]->Wait();
+			delete threads[i];
+		}
+		table->merge(tables[i]);
+		delete tables[i];
 	}
 }
 
-void EngineWadStatSet::computeResults()
+void GroupStatSet::computeResults()
 {
+	if (table == NULL)
+		return;
+	table->takeGroups(*groups);
+	delete table;
+	table = NULL;
+
 	statList = new list<DBStatistics*>();
-	for (map<int,WadStatistics*>::iterator it=statMap->begin(); it!=statMap->end(); ++it) {
-		it->second->computeResults();
-		statList->push_back(it->second);
+	for (size_t i=0; i<groups->size(); i++) {
+		StatGroup& group = (*groups)[i];
+		if (key2 == NULL)
+			group.stats->heading = key1->keyName(group.key1);
+		else
+			group.stats->heading = key1->keyName(group.key1) + " / " + key2->keyName(group.key2);
+		group.stats->computeResults();
+		statList->push_back(group.stats);
 	}
-	delete statMap;
-	statMap = NULL;
-}
-
-
-//******************************************************************
-//************************ RatingWadStatSet ************************
-//******************************************************************
-
-RatingWadStatSet::RatingWadStatSet(wxString setName) : StatisticSet("Own rating", setName)
-{
-	statMap = new map<int, WadStatistics*>();
-	for (int i=0; i<=10; i++)
-		(*statMap)[i] = new WadStatistics(wxString::Format("%i",i));
-	(*statMap)[11] = new WadStatistics("No rating");
-
-	addField(STS_END, 100);
-	addField(STS_WADS, 50);
-	addField(STS_WF_IWAD, 50);
-	addField(STS_WF_THINGS, 50);
-	addField(STS_MAPS, 80);
-	addField(STS_MAPS_AVG, 80);
-	addField(STS_MAPS_MIN, 80);
-	addField(STS_MAPS_MAX, 80);
-	addField(STS_SIZE, 100);
-	addField(STS_SIZE_AVG, 80);
 }
 
-RatingWadStatSet::~RatingWadStatSet()
+void GroupStatSet::getKeys(int dim, vector<int>& keys)
 {
-	if (statMap != NULL)
-		delete statMap;
-}
-
-void RatingWadStatSet::processWad(WadEntry* wadEntry)
-{
-	int rat = 11;
-	if (wadEntry->ownRating<=100)
-		rat = wadEntry->ownRating/10;
-	map<int,WadStatistics*>::iterator it = statMap->find(rat);
-	it->second->processWad(wadEntry);
+	for (size_t i=0; i<groups->size(); i++) {
+		int key = (dim==0)? (*groups)[i].key1: (*groups)[i].key2;
+		keys.push_back(key);
+	}
+	std::sort(keys.begin(), keys.end());
+	keys.erase(unique(keys.begin(), keys.end()), keys.end());
 }
 
-void RatingWadStatSet::computeResults()
+DBStatistics* GroupStatSet::getGroup(int k1, int k2)
 {
-	statList = new list<DBStatistics*>();
-	for (map<int,WadStatistics*>::iterator it=statMap->begin(); it!=statMap->end(); ++it) {
-		it->second->computeResults();
-		statList->push_back(it->second);
-	}
-	delete statMap;
-	statMap = NULL;
+	StatGroup search;
+	search.key1 = k1;
+	search.key2 = k2;
+	vector<StatGroup>::iterator it = lower_bound(groups->begin(), groups->end(), search, stat_group_comp);
+	if (it!=groups->end() && it->key1==k1 && it->key2==k2)
+		return it->stats;
+	return NULL;
 }
@@ -6,9 +6,9 @@
 * categorization of the wads or maps. One DBStatistics object is
 * created for each category, so this represents a level of
 * aggregation above DBStatistics. StatisticSet is the abstract
-* base class, and we have a number of implementations for
-* different categorizations, such a years and authors, and
-* for different types of DBStatistics.
+* base class, and GroupStatSet the implementation, grouping the
+* entries on categorizations defined by StatGroupKey, such as
+* years and authors.
 */
 
 #ifndef STATISTICSET_H
@@ -16,8 +16,12 @@
 
 #include <list>
 #include <map>
+#include <vector>
+#include <unordered_map>
+#include <wx/thread.h>
 #include "MapStatistics.h"
 #include "WadStatistics.h"
+#include "StatGroupKey.h"
 
 /*!
 * Abstract base class for a statistics table made up of a set of
@@ -107,246 +111,155 @@ class StatisticSet
 	private:
 };
 
-/*!
-* StatisticSet categorizing maps according to year, for a table
-* with a year column.
-*/
-class YearStatSet : public StatisticSet
-{
-	public:
-		YearStatSet(wxString setName);
-		virtual ~YearStatSet();
-
-		virtual void processMap(MapEntry* mapEntry);
-
-		virtual void computeResults();
-
-	private:
-		map<int, MapStatistics*>* statMap; //In map with year
-};
-
-/*!
-* StatisticSet categorizing maps according to the iwad field
-* of WadEntry (which iwad the wad targets, as defined by
-* IwadType enum).
-*/
-class IwadStatSet : public StatisticSet
-{
-	public:
-		IwadStatSet(wxString setName);
-		virtual ~IwadStatSet();
-
-		virtual void processMap(MapEntry* mapEntry);
-
-		virtual void computeResults();
-
-	private:
-		map<int, MapStatistics*>* statMap; //In map with iwad
-};
-
-/*!
-* StatisticSet categorizing maps according to the engine field
-* of WadEntry (which engine the wad targets, as defined by
-* EngineType enum).
-*/
-class EngineStatSet : public StatisticSet
-{
-	public:
-		EngineStatSet(wxString setName);
-		virtual ~EngineStatSet();
+/*! Groups at most this many keys in an array, rather than hashing. */
+const int DENSE_GROUP_LIMIT = 4096;
 
-		virtual void processMap(MapEntry* mapEntry);
+/*! Process lists of at least this size in several threads. */
+const size_t PARALLEL_GROUP_MIN = 20000;
 
-		virtual void computeResults();
-
-	private:
-		map<int, MapStatistics*>* statMap; //In map with engine
-};
-
-/*!
-* StatisticSet categorizing maps according to rating (ownRating
-* field of MapEntry). While the rating value is stored with a
-* range 0-100, this divides this by ten and considers the
-* categories 0-10, plus not rated (value 255), for a total of
-* 12 possible categories.
-*/
-class RatingStatSet : public StatisticSet
+/*! A DBStatistics for one group, with its key pair. */
+struct StatGroup
 {
-	public:
-		RatingStatSet(wxString setName);
-		virtual ~RatingStatSet();
-
-		virtual void processMap(MapEntry* mapEntry);
-
-		virtual void computeResults();
-
-	private:
-		map<int, MapStatistics*>* statMap; //In map with rating
+	int key1;
+	int key2; //0 if one key
+	DBStatistics* stats;
 };
 
 /*!
-* StatisticSet categorizing maps according to difficulty
-* rating. The difficulty rating scale has four values, in
-* addition to "not rated".
+* The groups of a GroupStatSet while processing entries, finding
+* the group of a key pair. When the key ranges are small, groups are
+* kept in an array indexed by the keys. Otherwise, or for keys outside
+* the ranges, a hash map is used. Tables built for different parts of
+* a list (such as in different threads) can be merged.
 */
-class DifficultyStatSet : public StatisticSet
+class StatGroupTable
 {
 	public:
-		DifficultyStatSet(wxString setName);
-		virtual ~DifficultyStatSet();
+		/*! key2 may be NULL. wads=true for WadStatistics groups. */
+		StatGroupTable(StatGroupKey* key1, StatGroupKey* key2, bool wads);
 
-		virtual void processMap(MapEntry* mapEntry);
+		/*! Deletes any groups not taken with takeGroups. */
+		~StatGroupTable();
 
-		virtual void computeResults();
+		/*! Group for a key pair, created if not found. */
+		DBStatistics* getGroup(int k1, int k2);
 
-	private:
-		map<int, MapStatistics*>* statMap; //In map with difficulty
-};
+		/*! Add wad to the group of each of its keys. */
+		void processWad(WadEntry* wadEntry);
 
-/*!
-* StatisticSet categorizing maps according to the playStyle
-* field of WadEntry (2.5D, 3D, Special).
-*/
-class PlaystyleStatSet : public StatisticSet
-{
-	public:
-		PlaystyleStatSet(wxString setName);
-		virtual ~PlaystyleStatSet();
+		/*! Add map to the group of each of its keys. */
+		void processMap(MapEntry* mapEntry);
 
-		virtual void processMap(MapEntry* mapEntry);
+		/*! Moves the groups of other into this. */
+		void merge(StatGroupTable* other);
 
-		virtual void computeResults();
+		/*!
+		* Moves all groups to the groups vector, sorted on keys.
+		* The table is then empty.
+		*/
+		void takeGroups(vector<StatGroup>& groups);
 
 	private:
-		map<int, MapStatistics*>* statMap; //In map with playstyle
-};
+		/*! Key pair combined for the hash map. */
+		static int64_t pairKey(int k1, int k2) { return (((int64_t)k1)<<32) | (uint32_t)k2; }
 
-/*!
-* StatisticSet categorizing maps according to author. A map with a
-* MapStatistics object for each known author must be provided, with
-* author dbid as key. Note that a map can have two authors, in which
-* case it is counted in two MapStatistics objects. Authors in a
-* group is not considered, so if a map has group "a" as author,
-* which consists of people x, y and z, it is only counted for "a",
-* not for x, y or z.
-*/
-class AuthorStatSet : public StatisticSet
-{
-	public:
-		AuthorStatSet(wxString setName, map<int, MapStatistics*>* authorStats);
-		virtual ~AuthorStatSet();
-
-		virtual void processMap(MapEntry* mapEntry);
+		/*! Where the group of a key pair is kept, NULL if none yet. */
+		DBStatistics*& findSlot(int k1, int k2);
 
-		virtual void computeResults();
+		/*! Put stats in the group of a key pair, merging if it exists. */
+		void mergeGroup(int k1, int k2, DBStatistics* stats);
 
-	private:
-		MapStatistics* unknown;
-		map<int, MapStatistics*>* statMap; //In map with author dbid
+		StatGroupKey* key1;
+		StatGroupKey* key2;
+		bool wadStats;
+		int range1, range2; //Key ranges for dense groups, 0 if hashing only
+		vector<DBStatistics*>* dense; //Indexed by keys, NULL if hashing only
+		unordered_map<int64_t, DBStatistics*>* hashed;
 };
 
 /*!
-* StatisticSet categorizing maps according style tags. A map with a
-* MapStatistics object for each known tag must be provided, with
-* tag dbid as key. Note that a map can have multiple tags, and is
-* counted in the MapStatistics object of each tag.
+* StatisticSet grouping wads or maps on one or two StatGroupKeys,
+* making a DBStatistics object for each group. An entry with several
+* keys (such as several tags) is counted in several groups. With two
+* keys, an entry is counted for each combination of them, and the
+* result can also be seen as a pivot table, with the values of the
+* first key as rows and the second as columns.
+*
+* processMaps/processWads processes a whole list, splitting it over
+* several threads if it is long. Each thread builds its own
+* StatGroupTable, and these are merged when done.
 */
-class TagStatSet : public StatisticSet
+class GroupStatSet : public StatisticSet
 {
 	public:
-		TagStatSet(wxString setName, map<int, MapStatistics*>* tagStats);
-		virtual ~TagStatSet();
-
-		virtual void processMap(MapEntry* mapEntry);
-
-		virtual void computeResults();
-
-	private:
-		MapStatistics* none;
-		map<int, MapStatistics*>* statMap; //In map with tag dbid
-};
+		/*!
+		* The set takes ownership of the keys. key2 is NULL for a single
+		* categorization. With wads=false, the groups are MapStatistics,
+		* counting the maps (of each wad given to processWad). With
+		* wads=true they are WadStatistics, counting wads.
+		*/
+		GroupStatSet(wxString setName, bool wads, StatGroupKey* key1, StatGroupKey* key2=NULL);
 
-/*!
-* StatisticSet categorizing wads according to year, for a table
-* with a year column.
-*/
-class YearWadStatSet : public StatisticSet
-{
-	public:
-		YearWadStatSet(wxString setName);
-		virtual ~YearWadStatSet();
+		virtual ~GroupStatSet();
 
 		virtual void processWad(WadEntry* wadEntry);
 
-		virtual void processMap(MapEntry* mapEntry) {}
-
-		virtual void computeResults();
-
-	private:
-		map<int, WadStatistics*>* statMap; //In map with year
-};
-
-/*!
-* StatisticSet categorizing wads according to the iwad field
-* (which iwad the wad targets, as defined by IwadType enum).
-*/
-class IwadWadStatSet : public StatisticSet
-{
-	public:
-		IwadWadStatSet(wxString setName);
-		virtual ~IwadWadStatSet();
+		virtual void processMap(MapEntry* mapEntry);
 
-		virtual void processWad(WadEntry* wadEntry);
+		/*! Process all wads, in several threads if many. */
+		void processWads(vector<WadEntry*>& wads);
 
-		virtual void processMap(MapEntry* mapEntry) {}
+		/*! Process all maps, in several threads if many. */
+		void processMaps(vector<MapEntry*>& maps);
 
 		virtual void computeResults();
 
-	private:
-		map<int, WadStatistics*>* statMap; //In map with iwad
-};
-
-/*!
-* StatisticSet categorizing wads according to the engine field
-* (which engine the wad targets, as defined by EngineType enum).
-*/
-class EngineWadStatSet : public StatisticSet
-{
-	public:
-		EngineWadStatSet(wxString setName);
-		virtual ~EngineWadStatSet();
+		/*! true if grouped on two keys. */
+		bool isPivot() { return key2 != NULL; }
 
-		virtual void processWad(WadEntry* wadEntry);
+		/*! The StatGroupKey of dimension 0 or 1. */
+		StatGroupKey* getKey(int dim) { return (dim==0)? key1: key2; }
 
-		virtual void processMap(MapEntry* mapEntry) {}
+		/*! Sorted keys with any group, for dimension 0 or 1. */
+		void getKeys(int dim, vector<int>& keys);
 
-		virtual void computeResults();
+		/*! The group of a key pair, NULL if none. */
+		DBStatistics* getGroup(int k1, int k2);
 
 	private:
-		map<int, WadStatistics*>* statMap; //In map with engine
+		/*! Process size entries of wads or maps in threads, merging into table. */
+		void processParallel(vector<WadEntry*>* wads, vector<MapEntry*>* maps, size_t size);
+
+		StatGroupKey* key1;
+		StatGroupKey* key2;
+		bool wadStats;
+		StatGroupTable* table; //While processing
+		vector<StatGroup>* groups; //Results, sorted on keys
 };
 
 /*!
-* StatisticSet categorizing wads according to rating (ownRating
-* field of WadEntry). While the rating value is stored with a
-* range 0-100, this divides this by ten and considers the
-* categories 0-10, plus not rated (value 255), for a total of
-* 12 possible categories.
+* Joinable thread processing part of a list of wads or maps into
+* its own StatGroupTable, for GroupStatSet.
 */
-class RatingWadStatSet : public StatisticSet
+class StatGroupThread : public wxThread
 {
 	public:
-		RatingWadStatSet(wxString setName);
-		virtual ~RatingWadStatSet();
-
-		virtual void processWad(WadEntry* wadEntry);
+		/*! Processes entries begin to end-1 of wads or maps (other NULL). */
+		StatGroupThread(StatGroupTable* table, vector<WadEntry*>* wads,
+			vector<MapEntry*>* maps, size_t begin, size_t end);
 
-		virtual void processMap(MapEntry* mapEntry) {}
+		/*! Process entries begin to end-1 of wads or maps into table. */
+		static void process(StatGroupTable* table, vector<WadEntry*>* wads,
+			vector<MapEntry*>* maps, size_t begin, size_t end);
 
-		virtual void computeResults();
+	protected:
+		virtual ExitCode Entry();
 
 	private:
-		map<int, WadStatistics*>* statMap; //In map with rating
+		StatGroupTable* table;
+		vector<WadEntry*>* wads;
+		vector<MapEntry*>* maps;
+		size_t begin, end;
 };
 
 #endif // STATISTICSET_H
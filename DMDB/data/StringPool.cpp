@@ -0,0 +1,77 @@
+/*
+* StringPool implementation
+*/
+
+#include "StringPool.h"
+#include "SortKeys.h"
+
+/*! Heap bytes of a string, 0 if held in the string object itself. */
+static size_t heapBytes(const string& str)
+{
+	const char* data = str.data();
+	const char* obj = (const char*) &str;
+	if (data>=obj && data<obj+sizeof(string))
+		return 0;
+	return str.capacity() + 1;
+}
+
+StringPool& StringPool::getPool()
+{
+	static StringPool pool;
+	return pool;
+}
+
+StringPool::StringPool()
+: bytes(0)
+{
+	empty = &(*strings.insert(PooledString("")).first);
+}
+
+const PooledString* StringPool::intern(const string& str)
+{
+	PooledString key(str);
+	wxMutexLocker locker(lock);
+	unordered_set<PooledString, Hash, Equal>::iterator it = strings.find(key);
+	if (it != strings.end())
+		return &(*it);
+	key.folded = ColumnKeys::textKey(wxString(str));
+	bytes += heapBytes(key.text) + heapBytes(key.folded);
+	return &(*strings.insert(key).first);
+}
+
+const PooledString* StringPool::find(const string& str)
+{
+	PooledString key(str);
+	wxMutexLocker locker(lock);
+	unordered_set<PooledString, Hash, Equal>::iterator it = strings.find(key);
+	if (it == strings.end())
+		return NULL;
+	return &(*it);
+}
+
+void StringPool::clear()
+{
+	wxMutexLocker locker(lock);
+	unordered_set<PooledString, Hash, Equal>::iterator it = strings.begin();
+	while (it != strings.end()) {
+		if (&(*it) == empty)
+			++it;
+		else
+			it = strings.erase(it);
+	}
+	bytes = 0;
+}
+
+size_t StringPool::getCount()
+{
+	wxMutexLocker locker(lock);
+	return strings.size();
+}
+
+size_t StringPool::getBytes()
+{
+	wxMutexLocker locker(lock);
+	//Each element is a hash node with the two strings, plus a bucket
+	return bytes + strings.size()*(sizeof(PooledString) + 2*sizeof(void*))
+		+ strings.bucket_count()*sizeof(void*);
+}
@@ -0,0 +1,139 @@
+/*!
+* \file StringPool.h
+* \author Lars Thomas Boye 2020
+*
+* Interned strings for the text fields of wad and map entries. Names
+* like "MAP01" are shared by thousands of maps, and each std::string
+* member also takes 32 bytes in the entry even when empty. PoolString
+* replaces these members with a pointer to a single, immutable copy of
+* each distinct string in the StringPool, together with its case-folded
+* form for sorting and searching.
+*/
+
+#ifndef STRINGPOOL_H
+#define STRINGPOOL_H
+
+//Include wxWidgets headers:
+#include "wx/wxprec.h"
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <string>
+#include <unordered_set>
+#include <wx/thread.h>
+
+using namespace std;
+
+/*!
+* One distinct string in the StringPool. folded is the key used for
+* sorting and case-insensitive search (ColumnKeys::textKey).
+*/
+struct PooledString
+{
+	string text;
+	string folded;
+
+	PooledString(const string& str) : text(str) {}
+};
+
+/*!
+* Set of distinct strings. Each string is stored once and never changed
+* or removed, so a pointer to it is a stable handle, and two handles from
+* the same pool are equal exactly when the strings are. Strings replaced
+* in an entry are kept until the pool is cleared, which costs little as
+* edits are few compared to loaded entries. The pool is thread-safe, as
+* entries are also made by the import thread.
+*/
+class StringPool
+{
+	public:
+		/*! The pool used by all PoolStrings. */
+		static StringPool& getPool();
+
+		/*! The handle for str, adding it to the pool if new. */
+		const PooledString* intern(const string& str);
+
+		/*! The handle for str if it is in the pool, otherwise NULL. */
+		const PooledString* find(const string& str);
+
+		/*! The handle of the empty string. */
+		const PooledString* getEmpty() { return empty; }
+
+		/*!
+		* Removes all strings except the empty one. Called when a database
+		* is closed, so the next one doesn't carry the strings of the last.
+		* No PoolString other than empty ones may exist at this point.
+		*/
+		void clear();
+
+		/*! Number of distinct strings. */
+		size_t getCount();
+
+		/*! Bytes used by the strings, their folded forms and the set. */
+		size_t getBytes();
+
+	private:
+		StringPool();
+
+		struct Hash
+		{
+			size_t operator()(const PooledString& ps) const { return hash<string>()(ps.text); }
+		};
+
+		struct Equal
+		{
+			bool operator()(const PooledString& a, const PooledString& b) const { return a.text == b.text; }
+		};
+
+		unordered_set<PooledString, Hash, Equal> strings; //Elements never move
+		const PooledString* empty;
+		size_t bytes; //Heap bytes of the string payloads
+		wxMutex lock; //Guards strings and bytes
+};
+
+/*!
+* A string member of an entry, holding only a handle to the string in
+* the StringPool. It is read like a const std::string, and assigned from
+* std::string, char* or wxString, which interns the new value. Handles
+* are compared directly for equality. For ordering, compare folded().
+*/
+class PoolString
+{
+	public:
+		PoolString() : ps(StringPool::getPool().getEmpty()) {}
+
+		PoolString(const string& str) : ps(StringPool::getPool().intern(str)) {}
+
+		PoolString& operator=(const string& str) { ps = StringPool::getPool().intern(str); return *this; }
+
+		PoolString& operator=(const char* str) { ps = StringPool::getPool().intern(str); return *this; }
+
+		PoolString& operator=(const wxString& str) { ps = StringPool::getPool().intern(str.ToStdString()); return *this; }
+
+		/*! The string itself. */
+		const string& str() const { return ps->text; }
+
+		operator const string&() const { return ps->text; }
+
+		/*! Case-folded UTF-8, as ColumnKeys::textKey. */
+		const string& folded() const { return ps->folded; }
+
+		/*! The handle, for comparing with StringPool::find. */
+		const PooledString* handle() const { return ps; }
+
+		size_t length() const { return ps->text.length(); }
+
+		bool empty() const { return ps->text.empty(); }
+
+		const char* c_str() const { return ps->text.c_str(); }
+
+		bool operator==(const PoolString& other) const { return ps == other.ps; }
+
+		bool operator!=(const PoolString& other) const { return ps != other.ps; }
+
+	private:
+		const PooledString* ps;
+};
+
+#endif // STRINGPOOL_H
@@ -7,14 +7,20 @@
 TaskProgress::TaskProgress(wxString nam, TaskProgress* parnt)
 : name(nam), ownCount(false), total(0), count(0), failed(false), error(""), parent(parnt)
 {
+	timing = new TaskSpan(nam);
 	if (parent != NULL)
 		parent->childStarted(nam);
 }
 
 TaskProgress::~TaskProgress()
 {
-	if (parent != NULL)
+	stopTiming();
+	if (parent != NULL) {
 		parent->childDone(name, failed, error);
+		parent->childTiming(timing);
+	} else {
+		delete timing;
+	}
 }
 
 void TaskProgress::startCount(int target)
@@ -60,7 +66,14 @@ bool TaskProgress::hasFailed(bool affectParent)
 		parent->fatalError(error);
 		error = "";
 	}
-	return failed;
+	return failed || isCancelled();
+}
+
+bool TaskProgress::isCancelled()
+{
+	if (parent != NULL)
+		return parent->isCancelled();
+	return false;
 }
 
 void TaskProgress::childStarted(wxString cname)
@@ -86,6 +99,56 @@ void TaskProgress::childDone(wxString cname, bool failed, wxString error)
 		warnError(error);
 }
 
+void TaskProgress::startPhase(wxString phaseName)
+{
+	TaskSpan* span = new TaskSpan(phaseName, true);
+	if (phases.size() > 0)
+		phases.back()->children.push_back(span);
+	else
+		timing->children.push_back(span);
+	phases.push_back(span);
+}
+
+void TaskProgress::endPhase(int64_t bytes)
+{
+	if (phases.size() == 0)
+		return;
+	phases.back()->bytes += bytes;
+	phases.back()->stop();
+	phases.pop_back();
+}
+
+void TaskProgress::addBytes(int64_t bytes)
+{
+	if (phases.size() > 0)
+		phases.back()->bytes += bytes;
+	else
+		timing->bytes += bytes;
+}
+
+void TaskProgress::childTiming(TaskSpan* span)
+{
+	if (phases.size() > 0)
+		phases.back()->children.push_back(span);
+	else
+		timing->children.push_back(span);
+}
+
+TaskSpan* TaskProgress::takeTiming()
+{
+	stopTiming();
+	TaskSpan* span = timing;
+	timing = new TaskSpan(name);
+	return span;
+}
+
+void TaskProgress::stopTiming()
+{
+	while (phases.size() > 0)
+		endPhase();
+	timing->stop();
+}
+
 //*************************************************************
 //************************ WadProgress ************************
 //*************************************************************
@@ -99,7 +162,7 @@ WadProgress::~WadProgress()
 {
 }
 
-void WadProgress::setDialog(GuiProgress* gp)
+void WadProgress::setDialog(ProgressView* gp)
 {
 	dialog = gp;
 	if (dialog != NULL) {
@@ -172,6 +235,8 @@ void WadProgress::childDone(wxString cname, bool cfailed, wxString cerror)
 	wxString line;
 	if (cfailed) {
 		line = cname + " [FAILED: " + cerror + "]";
+	} else if (isCancelled()) {
+		line = cname + " [CANCELLED]";
 	} else if (cerror.Length() > 0) {
 		line = cname + " [DONE: " + cerror + "]";
 	} else {
@@ -181,3 +246,103 @@ void WadProgress::childDone(wxString cname, bool cfailed, wxString cerror)
 	if (dialog != NULL)
 		dialog->logLine(line);
 }
+
+//*************************************************************
+//************************ JobProgress ************************
+//*************************************************************
+
+JobProgress::JobProgress(wxString nam, wxEvtHandler* handler)
+: TaskProgress(nam, NULL), currentTask(nam), unitsPerStep(1), eventHandler(handler),
+cancelled(false)
+{
+}
+
+JobProgress::~JobProgress()
+{
+}
+
+void JobProgress::cancel()
+{
+	wxCriticalSectionLocker lock(cancelLock);
+	cancelled = true;
+}
+
+bool JobProgress::isCancelled()
+{
+	wxCriticalSectionLocker lock(cancelLock);
+	return cancelled;
+}
+
+void JobProgress::startCount(int target)
+{
+	TaskProgress::startCount(target);
+	if (target<=MAX_DIALOG_STEPS)
+		unitsPerStep = 1;
+	else
+		unitsPerStep = target/MAX_DIALOG_STEPS;
+	postStatus();
+}
+
+void JobProgress::incrCount(int delta)
+{
+	int oldSteps = count/unitsPerStep;
+	count += delta;
+	if (count>total) count=total;
+	if ((count/unitsPerStep) > oldSteps)
+		postStatus();
+}
+
+void JobProgress::completeCount()
+{
+	TaskProgress::completeCount();
+	postStatus();
+}
+
+void JobProgress::childStarted(wxString cname)
+{
+	if (cname.Length() > 0) {
+		currentTask = cname;
+		postStatus();
+	}
+}
+
+void JobProgress::childCount(int current, int target)
+{
+	if (!ownCount) {
+		if (target<=MAX_DIALOG_STEPS)
+			unitsPerStep = 1;
+		else
+			unitsPerStep = target/MAX_DIALOG_STEPS;
+		int oldSteps = count/unitsPerStep;
+		count = current;
+		total = target;
+		if ((count==0) || (count==total) || ((count/unitsPerStep) > oldSteps))
+			postStatus();
+	}
+}
+
+void JobProgress::childDone(wxString cname, bool cfailed, wxString cerror)
+{
+	wxString line;
+	if (cfailed) {
+		line = cname + " [FAILED: " + cerror + "]";
+	} else if (isCancelled()) {
+		line = cname + " [CANCELLED]";
+	} else if (cerror.Length() > 0) {
+		line = cname + " [DONE: " + cerror + "]";
+	} else {
+		line = cname + " [DONE]";
+	}
+	wxThreadEvent* event = new wxThreadEvent(wxEVT_THREAD, THREAD_TASKLOG);
+	event->SetString(line);
+	wxQueueEvent(eventHandler, event);
+}
+
+void JobProgress::postStatus()
+{
+	wxThreadEvent* event = new wxThreadEvent(wxEVT_THREAD, THREAD_TASKSTATUS);
+	event->SetString(currentTask);
+	event->SetInt(count);
+	event->SetExtraLong(total);
+	wxQueueEvent(eventHandler, event);
+}
@@ -16,7 +16,9 @@
 #endif
 
 #include <vector>
-#include "../gui/GuiProgress.h"
+#include <wx/thread.h>
+#include "CoreBase.h"
+#include "TaskTiming.h"
 
 /*! How many times to update a progress indicater in UI. */
 const int MAX_DIALOG_STEPS = 100;
@@ -49,6 +51,14 @@ const int MAX_DIALOG_STEPS = 100;
 * is also called when a child task changes its progress counter, and if
 * the parent doesn't have a count of its own, its progress counter will
 * be the same as the child.
+*
+* Each task is also timed, with a TaskSpan started when the TaskProgress
+* is created. Processing code can mark phases of its work with startPhase
+* and endPhase, which become child spans of the task (or of the phase
+* they are nested in), and report the bytes it has processed. When a
+* task is done its span is added to the current span of the parent, so
+* the top-level task collects the timing of the whole process. The top
+* task gives it away with takeTiming, for a TaskTrace.
 */
 class TaskProgress
 {
@@ -101,14 +111,25 @@ class TaskProgress
 		void fatalError(wxString errorMsg);
 
 		/*!
-		* true once fatalError has been called. All task code should check this,
-		* and terminate as soon as possible if it is true, as it means the
-		* task can't be completed. If affectParent is true and the task has
-		* failed, the fatal error will be transferred to any parent task, so
-		* it will be in the failed state.
+		* true once fatalError has been called, or the task is cancelled. All
+		* task code should check this, and terminate as soon as possible if it
+		* is true, as it means the task can't be completed. If affectParent is
+		* true and the task has failed, the fatal error will be transferred to
+		* any parent task, so it will be in the failed state. Cancellation is
+		* not an error, and is not transferred.
 		*/
 		bool hasFailed(bool affectParent=false);
 
+		/*!
+		* true if the task has been cancelled. By default a task is cancelled
+		* when its parent is, so only the top-level task needs to implement
+		* cancellation. hasFailed is also true for a cancelled task, so
+		* processing code only needs to check hasFailed to stop at the next
+		* convenient point. The task is not put in the failed state, and
+		* getError is not changed.
+		*/
+		virtual bool isCancelled();
+
 		/*!
 		* Called by a child task to inform its parent that it has a sub-task.
 		*/
@@ -135,7 +156,41 @@ class TaskProgress
 		*/
 		wxString getError() { return error; }
 
+		/*!
+		* Starts timing a phase of the task, such as reading a lump or
+		* computing the MD5, until endPhase. Phases can be nested.
+		*/
+		void startPhase(wxString phaseName);
+
+		/*!
+		* Ends the last phase started, giving the number of bytes it
+		* processed (if meaningful).
+		*/
+		void endPhase(int64_t bytes=0);
+
+		/*!
+		* Adds to the bytes processed by the current phase, or by the
+		* task if no phase is running.
+		*/
+		void addBytes(int64_t bytes);
+
+		/*!
+		* Called by a child task when it is done, with its timing. The
+		* span is added to the current phase or the task, taking it over.
+		*/
+		virtual void childTiming(TaskSpan* span);
+
+		/*!
+		* Stops the timing of the task so far, and returns it with the
+		* timing of all sub-tasks, for the caller to take over. Timing
+		* starts over from this point, for any further work on the task.
+		*/
+		TaskSpan* takeTiming();
+
 	protected:
+		/*! Stops any phases still running, and the span of the task. */
+		void stopTiming();
+
 		wxString name; // Name of task, to identify it in the user interface
 		bool ownCount; //true when counting progress of this task
 		int total; //Total units of progress to complete task
@@ -143,14 +198,36 @@ class TaskProgress
 		bool failed; //Failed state
 		wxString error;
 		TaskProgress* parent;
+		TaskSpan* timing; //Span of the task
+		vector<TaskSpan*> phases; //Running phases, innermost last
+};
+
+/*!
+* Interface for showing the state of a WadProgress to the user, such as
+* the GuiProgress dialog or a console. Called in the thread of the task.
+*/
+class ProgressView
+{
+	public:
+		/*! Name of the current task in progress. */
+		virtual void setLabel(wxString name) = 0;
+
+		/*! Number of progress units to complete, and units done. */
+		virtual void setRange(int range, int pos=0) = 0;
+
+		/*! Units of progress done, up to the range. */
+		virtual void setProgress(int pos) = 0;
+
+		/*! Log line for a completed sub-task. */
+		virtual void logLine(wxString line) = 0;
 };
 
 /*!
 * WadProgress is a subclass of TaskProgress, for representing the top object
 * for tracking a process where we might want to display the information in
-* a user interface. It can be connected to a GuiProgress dialog, and will
-* show its progress count there as a progress bar along with the namne of
-* the currently active subtask.
+* a user interface. It can be connected to a ProgressView, such as a
+* GuiProgress dialog, and will show its progress count there as a progress
+* bar along with the namne of the currently active subtask.
 */
 class WadProgress :  public TaskProgress
 {
@@ -163,7 +240,7 @@ class WadProgress :  public TaskProgress
 		* the user. It will be updated to reflect changes in state.
 		* Set to NULL to remove the reference.
 		*/
-		void setDialog(GuiProgress* gp);
+		void setDialog(ProgressView* gp);
 
 		virtual void startCount(int target);
 
@@ -181,7 +258,61 @@ class WadProgress :  public TaskProgress
 		wxString currentTask; //Name of currently active child
 		vector<wxString> taskLog; //Completed child tasks
 		int unitsPerStep; //How often to update dialog
-		GuiProgress* dialog;
+		ProgressView* dialog;
+};
+
+/*!
+* JobProgress is the top TaskProgress object for a process running in a
+* worker thread. It can't update a GuiProgress dialog directly, so it
+* posts wxThreadEvents to an event handler in the GUI thread instead.
+* THREAD_TASKSTATUS is sent when the current task name or progress count
+* changes, with the name of the active sub-task as string, the progress
+* count as int and the target count as extra long. These are only sent
+* when the progress has changed by at least one step of MAX_DIALOG_STEPS,
+* to avoid flooding the event queue. THREAD_TASKLOG is sent when a
+* sub-task is done, with the log line for the sub-task as string. The job
+* can be cancelled from the GUI thread with cancel, which makes all tasks
+* in the job report isCancelled.
+*/
+class JobProgress :  public TaskProgress
+{
+	public:
+		/*!
+		* The handler receives the progress events, and must outlive the
+		* JobProgress.
+		*/
+		JobProgress(wxString nam, wxEvtHandler* handler);
+		virtual ~JobProgress();
+
+		/*!
+		* Cancel the job. Safe to call from any thread. Tasks in the job
+		* will fail the next time they check hasFailed.
+		*/
+		void cancel();
+
+		virtual bool isCancelled();
+
+		virtual void startCount(int target);
+
+		virtual void incrCount(int delta=1);
+
+		virtual void completeCount();
+
+		virtual void childStarted(wxString cname);
+
+		virtual void childCount(int current, int target);
+
+		virtual void childDone(wxString cname, bool cfailed, wxString cerror);
+
+	private:
+		/*! Posts a THREAD_TASKSTATUS event with the current state. */
+		void postStatus();
+
+		wxString currentTask; //Name of currently active child
+		int unitsPerStep; //How often to send status events
+		wxEvtHandler* eventHandler; //Receives events in GUI thread
+		wxCriticalSection cancelLock; //Guards cancelled
+		bool cancelled;
 };
 
 #endif // TASKPROGRESS_H
@@ -0,0 +1,387 @@
+/*
+* TaskTiming implementation
+*/
+
+#include "TaskTiming.h"
+#include <new>
+#include <stdlib.h>
+#include <wx/stopwatch.h>
+#include <wx/file.h>
+#include <wx/thread.h>
+#if defined(__WXMSW__)
+	#include <wx/msw/wrapwin.h>
+	#include <malloc.h>
+#else
+	#include <time.h>
+#endif
+
+//Clock for the span times, started with the program
+static wxStopWatch traceClock;
+
+#ifdef DMDB_COUNT_ALLOCS
+
+//Memory allocations made by each thread, counted by operator new
+static thread_local int64_t threadAllocCount = 0;
+
+//**************************************************************
+//********************* Allocation counting ********************
+//**************************************************************
+
+//The global allocation functions are replaced only to count the
+//allocations of each thread, when built with DMDB_COUNT_ALLOCS
+//(for profiling). The memory still comes from malloc.
+
+void* operator new(size_t size)
+{
+	threadAllocCount++;
+	void* ptr = malloc((size>0)? size: 1);
+	if (ptr == NULL)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	threadAllocCount++;
+	return malloc((size>0)? size: 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& nt) noexcept
+{
+	return operator new(size, nt);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void* ptr, size_t size) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void* ptr, size_t size) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept
+{
+	free(ptr);
+}
+
+#ifdef __cpp_aligned_new
+//Over-aligned types, which must be freed by the matching function
+
+static void* alignedAlloc(size_t size, size_t align)
+{
+	if (size == 0)
+		size = 1;
+#if defined(__WXMSW__)
+	return _aligned_malloc(size, align);
+#else
+	void* ptr = NULL;
+	if (posix_memalign(&ptr, (align<sizeof(void*))? sizeof(void*): align, size) != 0)
+		return NULL;
+	return ptr;
+#endif
+}
+
+static void alignedFree(void* ptr)
+{
+#if defined(__WXMSW__)
+	_aligned_free(ptr);
+#else
+	free(ptr);
+#endif
+}
+
+void* operator new(size_t size, std::align_val_t al)
+{
+	threadAllocCount++;
+	void* ptr = alignedAlloc(size, (size_t)al);
+	if (ptr == NULL)
+		throw std::bad_alloc();
+	return ptr;
+}
+
+void* operator new[](size_t size, std::align_val_t al)
+{
+	return operator new(size, al);
+}
+
+void* operator new(size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+	threadAllocCount++;
+	return alignedAlloc(size, (size_t)al);
+}
+
+void* operator new[](size_t size, std::align_val_t al, const std::nothrow_t& nt) noexcept
+{
+	return operator new(size, al, nt);
+}
+
+void operator delete(void* ptr, std::align_val_t al) noexcept
+{
+	alignedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t al) noexcept
+{
+	alignedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t size, std::align_val_t al) noexcept
+{
+	alignedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t size, std::align_val_t al) noexcept
+{
+	alignedFree(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+	alignedFree(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+	alignedFree(ptr);
+}
+#endif
+
+#endif
+
+//**************************************************************
+//************************** TaskSpan **************************
+//**************************************************************
+
+TaskSpan::TaskSpan(wxString nam, bool phse)
+: name(nam), phase(phse), thread(wxThread::GetCurrentId()), start(traceTime()),
+wall(0), cpu(0), bytes(0), allocs(0), running(true)
+{
+	startCpu = threadCpuTime();
+	startAllocs = threadAllocs();
+}
+
+TaskSpan::~TaskSpan()
+{
+	for (size_t i=0; i<children.size(); i++)
+		delete children[i];
+}
+
+void TaskSpan::stop()
+{
+	if (!running)
+		return;
+	running = false;
+	wall = traceTime() - start;
+	if (wxThread::GetCurrentId() == thread) {
+		cpu = threadCpuTime() - startCpu;
+		allocs = (startAllocs<0)? -1: threadAllocs() - startAllocs;
+	} else {
+		cpu = -1;
+		allocs = -1;
+	}
+}
+
+int64_t TaskSpan::traceTime()
+{
+	return traceClock.TimeInMicro().GetValue();
+}
+
+int64_t TaskSpan::threadCpuTime()
+{
+#if defined(__WXMSW__)
+	FILETIME creation, exit, kernel, user;
+	if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user))
+		return 0;
+	//In units of 100 ns
+	int64_t k = ((int64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime;
+	int64_t u = ((int64_t)user.dwHighDateTime << 32) | user.dwLowDateTime;
+	return (k+u) / 10;
+#else
+	timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+		return 0;
+	return (int64_t)ts.tv_sec*1000000 + ts.tv_nsec/1000;
+#endif
+}
+
+int64_t TaskSpan::threadAllocs()
+{
+#ifdef DMDB_COUNT_ALLOCS
+	return threadAllocCount;
+#else
+	return -1;
+#endif
+}
+
+//**************************************************************
+//************************** TaskTrace *************************
+//**************************************************************
+
+TaskTrace::~TaskTrace()
+{
+	clear();
+}
+
+void TaskTrace::add(TaskSpan* span)
+{
+	if (span != NULL)
+		spans.push_back(span);
+}
+
+void TaskTrace::clear()
+{
+	for (size_t i=0; i<spans.size(); i++)
+		delete spans[i];
+	spans.clear();
+}
+
+//Table columns after the name: wall ms, CPU ms, KB, allocations
+static wxString formatTimes(TaskSpan* span)
+{
+	wxString cpu = (span->cpu<0)? wxString("-"): wxString::Format("%.1f", span->cpu/1000.0);
+	wxString allocs = (span->allocs<0)? wxString("-"): wxString::Format("%.0f", (double)span->allocs);
+	return wxString::Format("\t%.1f\t%s\t%.0f\t%s", span->wall/1000.0, cpu, span->bytes/1024.0, allocs);
+}
+
+void TaskTrace::printReport(TextReport* reportView, int depth)
+{
+	reportView->writeHeading("Timing");
+	wxArrayInt tabs;
+	tabs.Add(900);tabs.Add(1100);tabs.Add(1300);tabs.Add(1500);
+	reportView->setTabs(tabs);
+	reportView->writeSubHeading("Tasks");
+	reportView->writeLine("Task\tWall ms\tCPU ms\tKB\tAllocs");
+	for (size_t i=0; i<spans.size(); i++)
+		printSpan(reportView, spans[i], 0, depth);
+
+	vector<TaskSpan*> totals;
+	for (size_t i=0; i<spans.size(); i++)
+		sumPhases(spans[i], totals);
+	if (totals.size() > 0) {
+		reportView->writeSubHeading("Phases");
+		reportView->writeLine("Phase (times)\tWall ms\tCPU ms\tKB\tAllocs");
+		for (size_t i=0; i<totals.size(); i++) {
+			TaskSpan* total = totals[i];
+			reportView->writeLine(wxString::Format("%s (%i)", total->name, total->children.size())
+				+ formatTimes(total));
+			total->children.clear(); //Not owned
+			delete total;
+		}
+	}
+}
+
+void TaskTrace::printSpan(TextReport* reportView, TaskSpan* span, int indent, int depth)
+{
+	if (span->phase)
+		return;
+	wxString name = span->name.IsEmpty()? wxString("(sub-task)"): span->name;
+	reportView->writeLine(wxString(' ', 3*indent) + name + formatTimes(span));
+	if (indent < depth) {
+		for (size_t i=0; i<span->children.size(); i++)
+			printSpan(reportView, span->children[i], indent+1, depth);
+	}
+}
+
+void TaskTrace::sumPhases(TaskSpan* span, vector<TaskSpan*>& totals)
+{
+	if (span->phase) {
+		//The total has the summed phases as children, to count them
+		TaskSpan* total = NULL;
+		for (size_t i=0; i<totals.size(); i++) {
+			if (totals[i]->name == span->name) {
+				total = totals[i];
+				break;
+			}
+		}
+		if (total == NULL) {
+			total = new TaskSpan(span->name, true);
+			total->stop();
+			total->wall = total->cpu = total->bytes = total->allocs = 0;
+			totals.push_back(total);
+		}
+		total->children.push_back(span);
+		total->wall += span->wall;
+		total->bytes += span->bytes;
+		if (total->cpu>=0 && span->cpu>=0)
+			total->cpu += span->cpu;
+		else
+			total->cpu = -1;
+		if (total->allocs>=0 && span->allocs>=0)
+			total->allocs += span->allocs;
+		else
+			total->allocs = -1;
+	}
+	for (size_t i=0; i<span->children.size(); i++)
+		sumPhases(span->children[i], totals);
+}
+
+//Text as a JSON string
+static wxString jsonString(const wxString& text)
+{
+	wxString result("\"");
+	for (wxString::const_iterator it=text.begin(); it!=text.end(); ++it) {
+		wxUniChar ch = *it;
+		if (ch=='"' || ch=='\\')
+			result << '\\' << ch;
+		else if (ch < 0x20)
+			result << wxString::Format("\\u%04x", (int)ch.GetValue());
+		else
+			result << ch;
+	}
+	result << '"';
+	return result;
+}
+
+bool TaskTrace::writeFile(const wxString& fileName)
+{
+	wxString text("{\"traceEvents\":[\n");
+	bool first = true;
+	for (size_t i=0; i<spans.size(); i++)
+		writeSpan(text, spans[i], first);
+	text << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	wxFile file(fileName, wxFile::write);
+	if (!file.IsOpened())
+		return false;
+	bool ok = file.Write(text);
+	file.Close();
+	wxLogVerbose("Wrote trace %s", fileName);
+	return ok;
+}
+
+void TaskTrace::writeSpan(wxString& text, TaskSpan* span, bool& first)
+{
+	//A complete event, with the counts as arguments
+	if (!first)
+		text << ",\n";
+	first = false;
+	text << "{\"name\":" << jsonString(span->name.IsEmpty()? wxString("(sub-task)"): span->name);
+	text << ",\"cat\":" << (span->phase? "\"phase\"": "\"task\"");
+	text << wxString::Format(",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,\"ts\":%.0f,\"dur\":%.0f",
+		span->thread, (double)span->start, (double)span->wall);
+	text << wxString::Format(",\"args\":{\"cpu_us\":%.0f,\"bytes\":%.0f,\"allocs\":%.0f}}",
+		(double)span->cpu, (double)span->bytes, (double)span->allocs);
+	for (size_t i=0; i<span->children.size(); i++)
+		writeSpan(text, span->children[i], first);
+}
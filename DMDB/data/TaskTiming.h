@@ -0,0 +1,120 @@
+/*!
+* \file TaskTiming.h
+* \author Lars Thomas Boye 2020
+*
+* Timing of tasks and the phases within them, recorded by TaskProgress.
+* Each TaskProgress has a TaskSpan, which measures wall time, CPU time
+* of the thread and the number of memory allocations made by the thread
+* while the task runs (only counted when DMDBcore is built with
+* DMDB_COUNT_ALLOCS, which replaces the global operator new).
+* Processing code can mark phases of its work (such as inflating a file,
+* MD5 or node area) as child spans, and report the number of bytes
+* processed. The spans of child tasks are added to their
+* parent when they are done, so the top task ends up with the whole tree.
+* TaskTrace collects such trees, printing a summary table or writing
+* them as a trace file for Chrome's trace viewer or Perfetto.
+*/
+
+#ifndef TASKTIMING_H
+#define TASKTIMING_H
+
+#include "CoreBase.h"
+#include <vector>
+#include <stdint.h>
+#include "../TextReport.h"
+
+/*!
+* The timing of one task or phase, with the spans of its sub-tasks and
+* phases as children. Times are in microseconds. The span starts when
+* created, and stop ends the measurement. CPU time and allocations are
+* counted for the thread which created the span, so if it is stopped by
+* another thread they are unknown, set to -1. Allocations are also -1
+* when they are not counted.
+*/
+struct TaskSpan
+{
+	wxString name;
+	bool phase; //Phase within a task, rather than a TaskProgress
+	unsigned long thread; //Id of thread running the task
+	int64_t start; //Time since program start
+	int64_t wall; //Duration
+	int64_t cpu; //CPU time of the thread, or -1
+	int64_t bytes; //Bytes processed, reported by the task code
+	int64_t allocs; //Memory allocations of the thread, or -1
+	vector<TaskSpan*> children; //Owned
+
+	/*! Starts the span, in the current thread. */
+	TaskSpan(wxString nam, bool phse=false);
+
+	/*! Deletes the children. */
+	~TaskSpan();
+
+	/*! Ends the measurement. Only the first call has effect. */
+	void stop();
+
+	/*! true until stop is called. */
+	bool isRunning() { return running; }
+
+	/*! Time since program start, with microsecond resolution. */
+	static int64_t traceTime();
+
+	/*! CPU time used by the calling thread. */
+	static int64_t threadCpuTime();
+
+	/*! Number of memory allocations (operator new) made by the calling thread,
+	* or -1 if built without DMDB_COUNT_ALLOCS.
+	*/
+	static int64_t threadAllocs();
+
+	private:
+		bool running;
+		int64_t startCpu;
+		int64_t startAllocs;
+};
+
+/*!
+* A set of TaskSpan trees, such as the processing of the files of an
+* import or of a WadReader. It can print the timing as tables, or write
+* it in the Trace Event Format which chrome://tracing and Perfetto
+* read, with each span a complete event on the thread it ran on.
+*/
+class TaskTrace
+{
+	public:
+		TaskTrace() {}
+
+		/*! Deletes the spans. */
+		virtual ~TaskTrace();
+
+		/*! Adds a tree, which is taken over. NULL is ignored. */
+		void add(TaskSpan* span);
+
+		/*! Deletes all spans. */
+		void clear();
+
+		/*! true if there are no spans. */
+		bool isEmpty() { return spans.size()==0; }
+
+		/*!
+		* Prints two tables: The tasks down to the given depth below the
+		* top spans, indented, and the total of each phase by name.
+		*/
+		void printReport(TextReport* reportView, int depth=2);
+
+		/*! Writes all spans as trace JSON. Returns false if the file can't be written. */
+		bool writeFile(const wxString& fileName);
+
+	private:
+		/*! Lines for span and its children down to depth, in the task table. */
+		void printSpan(TextReport* reportView, TaskSpan* span, int indent, int depth);
+
+		/*! Adds the phases of the tree to the phase totals. */
+		void sumPhases(TaskSpan* span, vector<TaskSpan*>& totals);
+
+		/*! Appends the events of the tree to the JSON text. */
+		void writeSpan(wxString& text, TaskSpan* span, bool& first);
+
+		vector<TaskSpan*> spans;
+};
+
+#endif // TASKTIMING_H
@@ -12,7 +12,7 @@
 #include <wx/file.h>
 #include <wx/stream.h>
 #include <wx/wfstream.h>
-#include "../gui/GuiBase.h"
+#include "CoreBase.h"
 #include "../TextReport.h"
 
 /*!
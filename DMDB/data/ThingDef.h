@@ -34,7 +34,7 @@
 #include <wx/stream.h>
 #include <wx/wfstream.h>
 #include <wx/file.h>
-#include "../gui/GuiBase.h" //For GuiError
+#include "CoreBase.h" //For GuiError
 
 using namespace std;
 
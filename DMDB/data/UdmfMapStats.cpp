@@ -26,8 +26,11 @@ void UdmfMapStats::readFile(wxInputStream* file, vector<DirEntry*>* lumps, map<i
 			lump = lumps->at(i);
 			file->SeekI(lump->offset, wxFromStart);
 			wxString lname(lump->name);
-			if (lname.CmpNoCase("TEXTMAP")==0)
+			if (lname.CmpNoCase("TEXTMAP")==0) {
+				progress->startPhase("TEXTMAP");
 				processTextmap(file, lump->size);
+				progress->endPhase(lump->size);
+			}
 			else if (lname.CmpNoCase("ZNODES")==0)
 				findGLNodeType(file, lump->size); //Creates nodeStats
 			else if (lname.CmpNoCase("REJECT")==0)
@@ -40,17 +43,21 @@ void UdmfMapStats::readFile(wxInputStream* file, vector<DirEntry*>* lumps, map<i
 	}
 
 	if (nodeStats != NULL) {
+		progress->startPhase("Nodes");
 		try {
 			nodeStats->progress = progress;
 			nodeStats->readFile(file, lumps);
 			Vector2D minXY((double)minCorner.x - 1.0, (double)minCorner.y - 1.0);
 			Vector2D maxXY((double)maxCorner.x + 1.0, (double)maxCorner.y + 1.0);
 			bool ok = nodeStats->checkNodes();
+			progress->endPhase();
+			progress->startPhase("Node area");
 			if (ok) area = nodeStats->computeArea(minXY, maxXY);
 		} catch (...) {
 			wxLogVerbose("Failed processing node data");
 			progress->warnError("Invalid node data");
 		}
+		progress->endPhase(); //Nodes or Node area
 	} else {
 		wxLogVerbose("No nodes found, no area calculation");
 	}
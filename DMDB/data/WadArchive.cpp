@@ -107,7 +107,9 @@ wxString WadArchive::extractFile(wxZipInputStream* zip, wxZipEntry* entry, TaskP
 		tp->fatalError(wxString::Format("Can't extract file %s",tempName.GetFullPath()));
 		return "";
 	}
+	tp->startPhase("Inflate");
 	zip->Read(file);
+	tp->endPhase(file.GetLength());
 	file.Close();
 	wxLogVerbose("Extracted file %s", ename);
 	extracted->push_back(tempName.GetFullPath());
@@ -22,7 +22,7 @@
 #include <wx/zipstrm.h>
 #include <wx/filefn.h>
 #include "../TextReport.h"
-#include "../gui/GuiBase.h"
+#include "CoreBase.h"
 #include "TaskProgress.h"
 
 /*!
@@ -0,0 +1,101 @@
+/*
+* WadImportJob implementation
+*/
+
+#include "WadImportJob.h"
+
+WadImportJob::WadImportJob(wxEvtHandler* handler, WadReader* reader, wxArrayString* files,
+	const wxString& imgFold, set<string>* wadHashes)
+: wxThread(wxTHREAD_JOINABLE), eventHandler(handler), wadReader(reader), fileList(files),
+imgFolder(imgFold), knownWads(wadHashes), iwad(IWAD_NONE), engine(DENG_NONE),
+mapTemp(NULL), replExisting(false), timing(NULL)
+{
+	progress = new JobProgress("Process files in folder", handler);
+}
+
+WadImportJob::~WadImportJob()
+{
+	delete fileList;
+	delete knownWads;
+	if (mapTemp != NULL)
+		delete mapTemp;
+	delete progress;
+	if (timing != NULL)
+		delete timing;
+}
+
+wxThread::ExitCode WadImportJob::Entry()
+{
+	int fcount = fileList->GetCount();
+	int wadsCreated = 0;
+	int wadsSkipped = 0;
+	int wadsFailed = 0;
+	delete progress->takeTiming(); //Restart timing in the job thread
+	progress->startCount(fcount*2);
+	for (int i=0; i<fcount; i++) {
+		if (progress->isCancelled())
+			break;
+		wxFileName fname((*fileList)[i]);
+		TaskProgress* fileProg = new TaskProgress(fname.GetFullName(), progress);
+		wadReader->initReader((*fileList)[i], fileProg);
+		wadReader->processWads(fileProg); //Creates WadStats for each wad/pk3, best-guess iwad and engine
+		if (!fileProg->hasFailed()) {
+			if (iwad != IWAD_NONE)
+				wadReader->setIwad(iwad);
+			if (engine != DENG_NONE)
+				wadReader->setEngine(engine);
+			wadReader->findThingDefs(fileProg); //Set correct thingDefs, process decorate and dehacked
+		}
+		progress->incrCount();
+		if (!fileProg->hasFailed()) {
+			MD5 md5Hash;
+			unsigned char* chptr = wadReader->getMainDigest();
+			for (int j=0; j<16; j++)
+				md5Hash.setBytedigest(j, chptr[j]);
+			string hash = md5Hash.hexdigest();
+			bool existing = (knownWads->find(hash) != knownWads->end());
+			if (existing && !replExisting) {
+				//Skipping existing wads - log with warnError
+				fileProg->warnError("Existing entry found, skipping");
+				wadsSkipped++;
+			} else {
+				//Template only applies to new entries
+				WadEntry* wadEntry = wadReader->createEntries(imgFolder, fileProg, existing? NULL: mapTemp);
+				if (fileProg->hasFailed()) {
+					wadReader->deleteEntries(wadEntry);
+				} else {
+					knownWads->insert(hash);
+					wadsCreated++;
+					wxThreadEvent* event = new wxThreadEvent(wxEVT_THREAD, THREAD_WADENTRY);
+					event->SetPayload<WadEntry*>(wadEntry);
+					wxQueueEvent(eventHandler, event);
+				}
+			}
+		}
+		if (fileProg->hasFailed() && !progress->isCancelled())
+			wadsFailed++;
+		delete fileProg;
+		wadReader->clearState();
+		progress->incrCount();
+	}
+	progress->completeCount();
+	timing = progress->takeTiming();
+
+	bool cancelled = progress->isCancelled();
+	wxString summary = wxString::Format("Processed %i files, %i skipped, %i failed",
+		wadsCreated, wadsSkipped, wadsFailed);
+	if (cancelled)
+		summary = "Cancelled. " + summary;
+	wxThreadEvent* event = new wxThreadEvent(wxEVT_THREAD, THREAD_WADDONE);
+	event->SetInt(cancelled? 1: 0);
+	event->SetString(summary);
+	wxQueueEvent(eventHandler, event);
+	return (wxThread::ExitCode)0;
+}
+
+TaskSpan* WadImportJob::takeTiming()
+{
+	TaskSpan* span = timing;
+	timing = NULL;
+	return span;
+}
@@ -0,0 +1,118 @@
+/*!
+* \file WadImportJob.h
+* \author Lars Thomas Boye 2020
+*
+* WadImportJob is a worker thread processing a list of content
+* files with a WadReader, so that the main window stays responsive
+* during large imports.
+*/
+
+#ifndef WADIMPORTJOB_H
+#define WADIMPORTJOB_H
+
+//Include wxWidgets headers:
+#include "wx/wxprec.h"
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <set>
+#include <wx/thread.h>
+#include "WadReader.h"
+#include "TaskProgress.h"
+
+/*!
+* WadImportJob runs the WadReader pipeline (initReader, processWads,
+* findThingDefs, createEntries) for a list of files in a joinable
+* worker thread. It never touches the DataManager, as the database is
+* only modified by the GUI thread. Instead, a WadEntry is created for each
+* file and posted to an event handler as a wxThreadEvent with id
+* THREAD_WADENTRY. The payload is the new WadEntry (with its MapEntry
+* objects), which is then owned by the receiver. The handler calls
+* DataManager::addWad for new entries, or merges the result
+* into the existing entry with WadReader::mergeEntries followed by
+* DataManager::wadModified. Progress and the log of processed files are
+* posted by the job's JobProgress. THREAD_WADDONE is the last event, with
+* int 1 if the job was cancelled and a summary string.
+*
+* To know which files are already in the database without accessing
+* the DataManager, the job is given the set of MD5 hashes of all wad
+* entries when it is created. Files matching an existing entry are
+* skipped unless replaceExisting is set.
+*
+* The job is cancelled with cancel, which is checked between files, and
+* by the processing code between lumps and between maps (through
+* TaskProgress::hasFailed). The WadReader belongs to the job while it
+* is running, so it must not be used by the GUI thread until the job
+* has finished, except for mergeEntries (which only reads the aspects).
+* Call Wait to join the thread before deleting the job.
+*
+* The job is timed by its JobProgress, with a child span for each file.
+* After the job has finished, the timing can be taken with takeTiming.
+*/
+class WadImportJob : public wxThread
+{
+	public:
+		/*!
+		* The job processes each file in files (full paths), which is
+		* taken over by the job. imgFolder is where to put map drawings.
+		* wadHashes is the set of MD5 hex strings of existing wad entries,
+		* also taken over by the job.
+		*/
+		WadImportJob(wxEvtHandler* handler, WadReader* reader, wxArrayString* files,
+			const wxString& imgFolder, set<string>* wadHashes);
+
+		virtual ~WadImportJob();
+
+		/*! Override best-guess iwad for all files, unless IWAD_NONE. */
+		void setIwad(IwadType iwd) { iwad=iwd; }
+
+		/*! Override best-guess engine for all files, unless DENG_NONE. */
+		void setEngine(EngineType eng) { engine=eng; }
+
+		/*!
+		* Template MapEntry with values to give the maps of new entries.
+		* The job takes over the object.
+		*/
+		void setMapTemplate(MapEntry* mapTempl) { mapTemp=mapTempl; }
+
+		/*! Process files with existing entries, rather than skipping them. */
+		void setReplaceExisting(bool repl) { replExisting=repl; }
+
+		/*! Number of files the job will process. */
+		int numberOfFiles() { return fileList->GetCount(); }
+
+		/*!
+		* Stop the job as soon as possible. Safe to call from the GUI
+		* thread. The THREAD_WADDONE event is still sent.
+		*/
+		void cancel() { progress->cancel(); }
+
+		/*! true once cancel has been called. */
+		bool isCancelled() { return progress->isCancelled(); }
+
+		/*!
+		* The timing of the job, for the caller to take over. Only call
+		* after the job has finished. Returns NULL if already taken.
+		*/
+		TaskSpan* takeTiming();
+
+	protected:
+		/*! Thread entry point. */
+		virtual ExitCode Entry();
+
+	private:
+		wxEvtHandler* eventHandler; //Receives all events
+		WadReader* wadReader; //Used only by the job while running
+		wxArrayString* fileList; //Files to process
+		wxString imgFolder; //Map image folder
+		set<string>* knownWads; //MD5 hashes of wads in DB
+		IwadType iwad;
+		EngineType engine;
+		MapEntry* mapTemp;
+		bool replExisting;
+		JobProgress* progress;
+		TaskSpan* timing; //Of the finished job
+};
+
+#endif // WADIMPORTJOB_H
@@ -21,6 +21,7 @@ archive(NULL), aspects(NULL), wadStatList(NULL), dehacked(NULL), decorate(NULL),
 mapinfo(NULL)
 {
 	fileSystem = new wxFileSystem();
+	timing = new TaskTrace();
 }
 
 WadReader::~WadReader()
@@ -32,6 +33,7 @@ WadReader::~WadReader()
 	clearState();
 	if (aspects != NULL)
 		delete aspects;
+	delete timing;
 }
 
 void WadReader::setThingFile(int type, wxString file)
@@ -90,6 +92,7 @@ void WadReader::clearState()
 		delete mapinfo;
 		mapinfo = NULL;
 	}
+	timing->clear();
 	if (thingDefs!=NULL && thingDefs->hasModifiedDefs()) {
 		//ThingDefs are modified, need to reload from file
 		delete thingDefs;
@@ -135,7 +138,7 @@ void WadReader::processWads(TaskProgress* tp)
 		for (int i=0; i<archive->numberOfWads(); i++) {
 			wxString fileName = archive->extractWad(i,tp);
 			if (tp->hasFailed()) {
-				if (aspects->copyFailedFiles && mainFile.FileExists()) {
+				if (aspects->copyFailedFiles && !tp->isCancelled() && mainFile.FileExists()) {
 					wxString dest = failedFolder+wxFILE_SEP_PATH+mainFile.GetFullName();
 					wxCopyFile(mainFile.GetFullPath(), dest);
 				}
@@ -404,31 +407,40 @@ MapStats* WadReader::processMap(string fileName, string mapName, TaskProgress* t
 
 WadEntry* WadReader::createEntries(wxString& imgFileFolder, TaskProgress* tp, MapEntry* mapTempl)
 {
-	int mapCount = 0;
-	for (int i=0; i<wadStatList->size(); i++) {
-		WadContentX* wcx = wadStatList->at(i)->getMapContent();
-		while (wcx != NULL) {
-			mapCount++;
-			wcx = wcx->next;
-		}
-	}
-	WadEntry* result = new WadEntry(0, mapCount);
+	WadEntry* result = new WadEntry(0, numberOfMaps());
 	result->ownFlags = OF_MAINNEW|OF_OWNNEW;
-	updateEntries(result, imgFileFolder, tp, true);
+	readEntries(result, imgFileFolder, tp, true);
 	if (mapTempl != NULL)
 		result->setCommonFields(mapTempl);
 	return result;
 }
 
-bool WadReader::updateEntries(WadEntry* wadEntry, wxString& imgFileFolder, TaskProgress* progress, bool newEntry)
+bool WadReader::updateEntries(WadEntry* wadEntry, wxString& imgFileFolder, TaskProgress* progress, bool newHash)
 {
-	WadStats* wadStats = wadStatList->at(0); // First WadStats is primary file
-	if (newEntry || aspects->wadFile) {
-		wadEntry->fileName = wadStats->fileName;
-		wadEntry->fileSize = wadStats->fileSize;
+	//Read into a new entry, and merge this with the existing one
+	WadEntry* newEntry = new WadEntry(0, numberOfMaps());
+	newEntry->ownFlags = OF_MAINNEW|OF_OWNNEW;
+	readEntries(newEntry, imgFileFolder, progress, aspects->mapAspects());
+	if (progress->hasFailed()) {
+		deleteEntries(newEntry);
+		return false;
+	}
+	if (newHash && !aspects->wadFile) {
+		wadEntry->fileName = newEntry->fileName;
+		wadEntry->fileSize = newEntry->fileSize;
 		for (int i=0; i<16; i++)
-			wadEntry->md5Digest[i] = wadStats->md5Digest[i];
+			wadEntry->md5Digest[i] = newEntry->md5Digest[i];
 	}
+	return mergeEntries(wadEntry, newEntry);
+}
+
+void WadReader::readEntries(WadEntry* wadEntry, wxString& imgFileFolder, TaskProgress* progress, bool readMaps)
+{
+	WadStats* wadStats = wadStatList->at(0); // First WadStats is primary file
+	wadEntry->fileName = wadStats->fileName;
+	wadEntry->fileSize = wadStats->fileSize;
+	for (int i=0; i<16; i++)
+		wadEntry->md5Digest[i] = wadStats->md5Digest[i];
 	if (aspects->wadFile) {
 		wadEntry->year = wadStats->year;
 		if ((wadStats->wadType.compare("IWAD")==0) || (wadStats->wadType.compare("iwad")==0))
@@ -442,17 +454,15 @@ bool WadReader::updateEntries(WadEntry* wadEntry, wxString& imgFileFolder, TaskP
 			if (i==1)
 				wadEntry->extraFiles = wadStatList->at(i)->fileName;
 			else
-				wadEntry->extraFiles = wadEntry->extraFiles+";"+wadStatList->at(i)->fileName;
+				wadEntry->extraFiles = wadEntry->extraFiles.str()+";"+wadStatList->at(i)->fileName;
 			exFiles=true;
 		}
 		if ((dehacked!=NULL) && (dehacked->getFileName().Len()>0)) {
 			if (exFiles)
-				wadEntry->extraFiles = wadEntry->extraFiles+";"+dehacked->getFileName();
+				wadEntry->extraFiles = wadEntry->extraFiles.str()+";"+dehacked->getFileName();
 			else
 				wadEntry->extraFiles = dehacked->getFileName();
 		}
-		if (!(wadEntry->ownFlags&OF_MAINNEW))
-			wadEntry->ownFlags |= OF_MAINMOD;
 	}
 
 	//Content flags
@@ -465,34 +475,16 @@ bool WadReader::updateEntries(WadEntry* wadEntry, wxString& imgFileFolder, TaskP
 			if (dehacked->thingChanges() > 0)
 				wadEntry->flags |= WF_THINGS;
 		}
-		if (!(wadEntry->ownFlags&OF_MAINNEW))
-			wadEntry->ownFlags |= OF_MAINMOD;
 	}
 
 	wxLogVerbose("Processed WadEntry for %s, will process map entries",
-		wadEntry->fileName);
-	if (!aspects->mapAspects() && (!newEntry))
-		return false;
+		wadEntry->fileName.str());
+	if (!readMaps)
+		return;
 
-	//Find number of maps
-	int mapCount = 0;
-	for (int i=0; i<wadStatList->size(); i++) {
-		WadContentX* wcx = wadStatList->at(i)->getMapContent();
-		while (wcx != NULL) {
-			mapCount++;
-			wcx = wcx->next;
-		}
-	}
+	int mapCount = wadEntry->mapPointers.size();
 	if (mapCount>1)
 		progress->startCount(mapCount);
-	//If we update an old WadEntry, we move maps from oldMaps to newMaps
-	//when they are updated. Maps left in oldMaps will need to be deleted.
-	list<MapEntry*> oldMaps;
-	list<MapEntry*> newMaps;
-	if (wadEntry->numberOfMaps > 0) {
-		for (int i=0; i<wadEntry->numberOfMaps; i++)
-			oldMaps.push_back(wadEntry->mapPointers[i]);
-	}
 
 	//Need to keep track of repeating use of same map name
 	//Add letter postfix to make unique: "MAP01a", "MAP01b", ...
@@ -504,6 +496,7 @@ bool WadReader::updateEntries(WadEntry* wadEntry, wxString& imgFileFolder, TaskP
 		WadContentX* wcx = wadStatList->at(i)->getMapContent();
 		bool glNodes = false;
 		while (wcx != NULL) {
+			if (progress->hasFailed()) break; //Cancelled
 			TaskProgress* sub = new TaskProgress(wxString::Format("Processing map %s",wcx->lumps->at(0)->name), progress);
 			MapStats* ms = loadMap(wcx, sub);
 			bool failed = sub->hasFailed(true);
@@ -520,19 +513,13 @@ bool WadReader::updateEntries(WadEntry* wadEntry, wxString& imgFileFolder, TaskP
 				mapName += postfix;
 			if (ms->hasGLNodes())
 				glNodes = true;
-			MapEntry* me = wadEntry->getMap(mapName);
-			if (me == NULL) {
-				//No existing entry to update - make new
-				me = new MapEntry(0);
-				me->name = mapName;
-				me->ownFlags = OF_MAINNEW|OF_OWNNEW;
-				me->wadPointer = wadEntry;
-			} else {
-				oldMaps.remove(me);
-			}
+			MapEntry* me = new MapEntry(0);
+			me->name = mapName;
+			me->ownFlags = OF_MAINNEW|OF_OWNNEW;
+			me->wadPointer = wadEntry;
 			updateMapEntry(me, ms);
-			newMaps.push_back(me);
-			wxLogVerbose("Processed MapEntry for %s", me->name);
+			wadEntry->addMap(me);
+			wxLogVerbose("Processed MapEntry for %s", me->name.str());
 			if (aspects->mapImages) {
 				wxString imgFile = imgFileFolder+wxFILE_SEP_PATH+me->fileName()+".png";
 				storeMapImage(ms, imgFile);
@@ -555,41 +542,124 @@ bool WadReader::updateEntries(WadEntry* wadEntry, wxString& imgFileFolder, TaskP
 		progress->completeCount();
 	delete mapNames;
 
-	//Put newMaps into WadEntry. The WadEntry is either new, with empty vector of
-	//correct size, or we are updating an existing WadEntry.
-	int totalCount = newMaps.size() + oldMaps.size();
-	if (totalCount != wadEntry->mapPointers.size())
-		wadEntry->mapPointers.resize(totalCount);
-	wadEntry->numberOfMaps = 0;
-	for (list<MapEntry*>::iterator it=newMaps.begin(); it != newMaps.end(); ++it)
-		wadEntry->addMap(*it);
-
 	if (wadEntry->numberOfMaps==1 && aspects->mapMain) {
 		wadEntry->title = wadEntry->mapPointers.at(0)->title;
 	}
+}
+
+bool WadReader::mergeEntries(WadEntry* wadEntry, WadEntry* newEntry)
+{
+	if (aspects->wadFile) {
+		wadEntry->fileName = newEntry->fileName;
+		wadEntry->fileSize = newEntry->fileSize;
+		for (int i=0; i<16; i++)
+			wadEntry->md5Digest[i] = newEntry->md5Digest[i];
+		wadEntry->year = newEntry->year;
+		wadEntry->flags |= (newEntry->flags & WF_IWAD);
+		wadEntry->ownFlags |= OF_HAVEFILE;
+		wadEntry->iwad = newEntry->iwad;
+		wadEntry->engine = newEntry->engine;
+		wadEntry->extraFiles = newEntry->extraFiles;
+		wadEntry->ownFlags |= OF_MAINMOD;
+	}
+	if (aspects->wadFlags) {
+		wadEntry->flags |= (newEntry->flags & ~WF_IWAD);
+		wadEntry->ownFlags |= OF_MAINMOD;
+	}
+
+	bool deleted = false;
+	if (aspects->mapAspects()) {
+		//Maps are moved from oldMaps to newMaps when they are updated.
+		//Maps left in oldMaps will need to be deleted.
+		list<MapEntry*> oldMaps;
+		list<MapEntry*> newMaps;
+		for (int i=0; i<wadEntry->numberOfMaps; i++)
+			oldMaps.push_back(wadEntry->mapPointers[i]);
+		for (int i=0; i<newEntry->numberOfMaps; i++) {
+			MapEntry* src = newEntry->mapPointers[i];
+			MapEntry* me = wadEntry->getMap(src->name);
+			if (me == NULL) {
+				//New map, move to wadEntry
+				src->wadPointer = wadEntry;
+				newMaps.push_back(src);
+				newEntry->mapPointers[i] = NULL;
+				continue;
+			}
+			oldMaps.remove(me);
+			mergeMapEntry(me, src);
+			newMaps.push_back(me);
+		}
 
-	//Any entries left in oldMaps need to be deleted. They are included in the WadEntry,
-	//but flagged for deletion, and the function returns true.
-	if (oldMaps.size() > 0) {
-		wxLogVerbose("%i old map entries were not found in new version, will be deleted", oldMaps.size());
-		for (list<MapEntry*>::iterator it=oldMaps.begin(); it != oldMaps.end(); ++it) {
-			(*it)->ownFlags |= OFLG_DELETE;
+		//Updated and new maps first, then any maps to delete. These are
+		//flagged for deletion, and the function returns true.
+		wadEntry->mapPointers.resize(newMaps.size() + oldMaps.size());
+		wadEntry->numberOfMaps = 0;
+		for (list<MapEntry*>::iterator it=newMaps.begin(); it != newMaps.end(); ++it)
 			wadEntry->addMap(*it);
+		if (wadEntry->numberOfMaps==1 && aspects->mapMain)
+			wadEntry->title = wadEntry->mapPointers.at(0)->title;
+		if (oldMaps.size() > 0) {
+			wxLogVerbose("%i old map entries were not found in new version, will be deleted", oldMaps.size());
+			for (list<MapEntry*>::iterator it=oldMaps.begin(); it != oldMaps.end(); ++it) {
+				(*it)->ownFlags |= OFLG_DELETE;
+				wadEntry->addMap(*it);
+			}
+			deleted = true;
 		}
-		return true;
-	} else {
-		//No maps to delete
-		return false;
 	}
+
+	deleteEntries(newEntry);
+	return deleted;
+}
+
+void WadReader::mergeMapEntry(MapEntry* mapEntry, MapEntry* newMap)
+{
+	//Without MAPINFO or Dehacked there is no title, so the old one is kept
+	if (aspects->mapMain && !newMap->title.empty()) {
+		mapEntry->title = newMap->title;
+		mapEntry->ownFlags |= OF_MAINMOD;
+	}
+	if (aspects->gameModes) {
+		mapEntry->singlePlayer = newMap->singlePlayer;
+		mapEntry->cooperative = newMap->cooperative;
+		mapEntry->deathmatch = newMap->deathmatch;
+	}
+	if (aspects->mapStats) {
+		mapEntry->linedefs = newMap->linedefs;
+		mapEntry->sectors = newMap->sectors;
+		mapEntry->things = newMap->things;
+		mapEntry->secrets = newMap->secrets;
+		mapEntry->area = newMap->area;
+		mapEntry->flags |= (newMap->flags & (MF_DIFFSET|MF_VOODOO|MF_UNKNOWN));
+	}
+	if (aspects->gameStats) {
+		mapEntry->enemies = newMap->enemies;
+		mapEntry->totalHP = newMap->totalHP;
+		mapEntry->healthRatio = newMap->healthRatio;
+		mapEntry->armorRatio = newMap->armorRatio;
+		mapEntry->ammoRatio = newMap->ammoRatio;
+		mapEntry->flags |= (newMap->flags & MF_SPAWN);
+	}
+	if (aspects->gameModes || aspects->mapStats || aspects->gameStats)
+		mapEntry->ownFlags |= OF_MAINMOD;
+}
+
+void WadReader::deleteEntries(WadEntry* wadEntry)
+{
+	for (int i=0; i<wadEntry->numberOfMaps; i++) {
+		if (wadEntry->mapPointers[i] != NULL)
+			delete wadEntry->mapPointers[i];
+	}
+	delete wadEntry;
 }
 
 void WadReader::updateMapEntry(MapEntry* mapEntry, MapStats* mapStats)
 {
 	if (aspects->mapMain) {
 		if (mapinfo != NULL)
-			mapEntry->title = mapinfo->getMapTitle(mapEntry->name);
+			mapEntry->title = mapinfo->getMapTitle(mapEntry->name.str());
 		else if (dehacked != NULL)
-			mapEntry->title = dehacked->getMapTitle(mapEntry->name);
+			mapEntry->title = dehacked->getMapTitle(mapEntry->name.str());
 	}
 	if (aspects->gameModes) {
 		if (mapStats->getThingCount(THING_PLAYER1) > 0) {
@@ -728,12 +798,14 @@ bool WadReader::processDecorate(WadStats* wadStats, TaskProgress* tp)
 					if (mapinfo!=NULL)
 						decorate->setActorNums(mapinfo->exportDoomEdNums());
 				}
+				tp->startPhase("DECORATE");
 				try {
 					decorate->parseFile(wcx->name, de->offset, de->size);
 					result = true;
 				} catch (GuiError e) {
 					tp->warnError("Failed parsing decorate");
 				}
+				tp->endPhase(de->size);
 			}
 		}
 		wcx = wcx->next;
@@ -822,11 +894,9 @@ void WadReader::storeMapImage(MapStats* mapStats, wxString& fileName)
 		width+=3;
 		height+=3;
 		wxLogVerbose("Drawing map PNG of %i x %i pixels", width, height);
-		wxBitmap bm(width, height, wxBITMAP_SCREEN_DEPTH);
-		wxMemoryDC temp_dc(bm);
-		drawMap(mapStats, temp_dc);
-		temp_dc.SelectObject(wxNullBitmap);
-		bool ok = bm.SaveFile(fileName, wxBITMAP_TYPE_PNG);
+		MapRaster raster(width, height, DRAW_SUPERSAMPLE);
+		drawMap(mapStats, raster);
+		bool ok = raster.savePng(fileName);
 		if (ok)
 			wxLogVerbose("Map PNG saved to file");
 		else
@@ -834,32 +904,27 @@ void WadReader::storeMapImage(MapStats* mapStats, wxString& fileName)
 	}
 }
 
-void WadReader::drawMap(MapStats* mapStats, wxDC& dc)
+void WadReader::drawMap(MapStats* mapStats, MapRaster& raster)
 {
-	wxBrush bckgrnd(MAP_BACKGROUNDCOLOR);
-	dc.SetBackground(bckgrnd);
-	dc.Clear();
-
-	wxPen wall1Pen(MAP_WALL1, 1, wxPENSTYLE_SOLID);
-	wxPen wall2Pen(MAP_WALL2, 1, wxPENSTYLE_SOLID);
+	raster.setColour(0, MAP_BACKGROUNDCOLOR);
+	raster.setColour(1, MAP_WALL1);
+	raster.setColour(2, MAP_WALL2);
+	raster.clear();
 
 	vector<Vertex>* vertices = mapStats->getVertices();
 	vector<MapLine>* lines = mapStats->getLines();
 	int xTrans = mapStats->getStartCorner().x;
 	int yTrans = mapStats->getEndCorner().y;
+	int ss = raster.getSupersample();
 
 	MapLine l;
 	int x1, x2, y1, y2;
 	for (int i=0; i<lines->size(); i++) {
 		l = lines->at(i);
-		if (l.twoSided)
-			dc.SetPen(wall2Pen);
-		else
-			dc.SetPen(wall1Pen);
-        x1 = ((vertices->at(l.v1).x - xTrans)/DRAW_SCALE) + 1;
-        y1 = (( (vertices->at(l.v1).y * -1) + yTrans)/DRAW_SCALE) + 1;
-        x2 = ((vertices->at(l.v2).x - xTrans)/DRAW_SCALE) + 1;
-        y2 = (( (vertices->at(l.v2).y * -1) + yTrans)/DRAW_SCALE) + 1;
-		dc.DrawLine(x1, y1, x2, y2);
+        x1 = ((vertices->at(l.v1).x - xTrans)*ss/DRAW_SCALE) + ss;
+        y1 = (( (vertices->at(l.v1).y * -1) + yTrans)*ss/DRAW_SCALE) + ss;
+        x2 = ((vertices->at(l.v2).x - xTrans)*ss/DRAW_SCALE) + ss;
+        y2 = (( (vertices->at(l.v2).y * -1) + yTrans)*ss/DRAW_SCALE) + ss;
+		raster.drawLine(x1, y1, x2, y2, l.twoSided? 2: 1);
 	}
 }
@@ -32,6 +32,7 @@
 #include "MapStats64.h"
 #include "DehackedParser.h"
 #include "DataModel.h"
+#include "MapRaster.h"
 
 //Map drawing:
 /*!
@@ -42,6 +43,12 @@
 */
 const int DRAW_SCALE = 16;
 
+/*!
+* Supersampling factor for the map image, 1 for none. With 2 or more,
+* lines are anti-aliased, at the cost of drawing a larger buffer.
+*/
+const int DRAW_SUPERSAMPLE = 1;
+
 const wxColour MAP_BACKGROUNDCOLOR(255,255,255); //!< Canvas background color: White
 const wxColour MAP_WALL1(0,0,0); //!< Line color for single-sided map lines: Black
 const wxColour MAP_WALL2(128,128,128); //!< Line color for double-sided map lines: Dark grey
@@ -242,6 +249,16 @@ class WadReader
 	*/
 	void printReport(TextReport* reportView);
 
+	/*!
+	* Adds the timing of a task processing the current files (from
+	* TaskProgress::takeTiming), which is taken over. The timing is
+	* cleared with the other results by clearState.
+	*/
+	void addTiming(TaskSpan* span) { timing->add(span); }
+
+	/*! The timing of the processing of the current files. */
+	TaskTrace* getTiming() { return timing; }
+
 	/*!
 	* Process an additional resource file, adding a WadStats object to
 	* the list of analyzed wads. pk3=true for a zip archive, otherwise
@@ -326,9 +343,10 @@ class WadReader
 
 	/*!
 	* Update an existing WadEntry object and its MapEntry objects, with
-	* the current results from processed wad(s). MapEntry objects in the
-	* existing WadEntry are matched with maps from processed wad(s) based
-	* on map names. New maps not found in WadEntry will have new entries
+	* the current results from processed wad(s). The results are read
+	* into a new WadEntry, which is merged in with mergeEntries. MapEntry
+	* objects in the existing WadEntry are matched with maps from processed
+	* wad(s) based on map names. New maps not found in WadEntry will have new entries
 	* added to it. Old entries with names NOT found in the current results
 	* will stay in the WadEntry but have the ownFlag OFLG_DELETE set, to
 	* mark them for deletion. And all entries marked for deletion will be
@@ -338,9 +356,29 @@ class WadReader
 	* and delete maps from the database with the flag set. Note that if a
 	* wad used to have just MAP01, and now has this map moved to MAP02 with
 	* a new MAP01, the old MapEntry for MAP01 will be updated to reflect the
-	* new MAP01 while a new entry will be added for MAP02.
+	* new MAP01 while a new entry will be added for MAP02. With newHash,
+	* the file name, size and hash are set even if the wadFile aspect is
+	* not. If progress fails, wadEntry is not changed.
 	*/
-	bool updateEntries(WadEntry* wadEntry, wxString& imgFileFolder, TaskProgress* progress, bool newEntry=false);
+	bool updateEntries(WadEntry* wadEntry, wxString& imgFileFolder, TaskProgress* progress, bool newHash=false);
+
+	/*!
+	* Update an existing WadEntry object and its MapEntry objects, with
+	* the content of a new WadEntry created by createEntries for the same
+	* file. This is the second half of updateEntries. It doesn't need
+	* the processing results, so the new WadEntry can be created in a
+	* background job while the existing one is only touched by the GUI
+	* thread. Only the aspects currently set are copied. MapEntry objects
+	* are matched on map names. New maps are moved from newEntry to
+	* wadEntry, while old maps not found in newEntry are flagged with
+	* OFLG_DELETE and placed at the back of mapPointers, as with
+	* updateEntries, and the function returns true if there are any.
+	* newEntry and its remaining MapEntry objects are deleted.
+	*/
+	bool mergeEntries(WadEntry* wadEntry, WadEntry* newEntry);
+
+	/*! Deletes a WadEntry which is not in the database, with its maps. */
+	void deleteEntries(WadEntry* wadEntry);
 
 	/*!
 	* Update a single MapEntry object with data from a MapStats
@@ -368,11 +406,24 @@ class WadReader
 		/*! Set WadEntry content flags from WadStats. */
 		void setWadFlags(WadEntry* wadEntry, WadStats* wadStats);
 
-		/*! Draw a line map, storing it to a PNG file. */
+		/*!
+		* Fills a new WadEntry from the processed wad(s), with a MapEntry
+		* for each map if readMaps is true. Map names repeated in several
+		* wads get a letter postfix: "MAP01a", "MAP01b", ...
+		*/
+		void readEntries(WadEntry* wadEntry, wxString& imgFileFolder, TaskProgress* progress, bool readMaps);
+
+		/*! Copies the current aspects of newMap to mapEntry, for mergeEntries. */
+		void mergeMapEntry(MapEntry* mapEntry, MapEntry* newMap);
+
+		/*!
+		* Draw a line map, storing it to a PNG file. Uses MapRaster rather
+		* than GUI bitmaps, so it can run in worker threads.
+		*/
 		void storeMapImage(MapStats* mapStats, wxString& fileName);
 
 		/*! Does the actual drawing. */
-		void drawMap(MapStats* mapStats, wxDC& dc);
+		void drawMap(MapStats* mapStats, MapRaster& raster);
 
 
 	wxFileSystem* fileSystem; //Used to get wxFSFile objects for files, to get date
@@ -392,6 +443,7 @@ class WadReader
 	DehackedParser* dehacked; //Parsed dehacked patch
 	DecorateParser* decorate; //Parsed Decorate lump
 	MapinfoParser* mapinfo; //Parsed MAPINFO lump
+	TaskTrace* timing; //Timing of tasks on the current files
 };
 
 #endif
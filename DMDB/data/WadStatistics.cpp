@@ -49,6 +49,25 @@ void WadStatistics::processWad(WadEntry* wadEntry)
 	}
 }
 
+void WadStatistics::merge(DBStatistics* other)
+{
+	for (int i=0; i<STS_LINEDEFS_AVG; i++) {
+		switch (i) {
+			case STS_YEAR_MIN: case STS_MAPS_MIN: case STS_SIZE_MIN:
+				if (other->intStats[i] < intStats[i])
+					intStats[i] = other->intStats[i];
+				break;
+			case STS_YEAR_MAX: case STS_MAPS_MAX: case STS_SIZE_MAX:
+				if (other->intStats[i] > intStats[i])
+					intStats[i] = other->intStats[i];
+				break;
+			default:
+				intStats[i] += other->intStats[i];
+		}
+	}
+	floatStats[STS_SIZE] += other->floatStats[STS_SIZE];
+}
+
 void WadStatistics::computeResults()
 {
 	if (intStats[STS_WADS] > 0) {
@@ -26,6 +26,7 @@ class WadStatistics : public DBStatistics
 		virtual void processWad(WadEntry* wadEntry);
 		virtual void computeResults();
 		virtual void printReport(TextReport* reportView);
+		virtual void merge(DBStatistics* other);
 };
 
 #endif // WADSTATISTICS_H
@@ -140,6 +140,12 @@ bool WadContentX::containsLump(string lumpName)
 //************************ WadStats ************************
 //**********************************************************
 
+/*! true for the sizes of flats: 64x64, Hexen iwad (8192) or Heretic iwad (4160, 4). */
+static bool isFlatSize(int32_t size)
+{
+	return (size==4096 || size==8192 || size==4160 || size==4);
+}
+
 WadStats::WadStats(wxString file)
 : year(0), wadType(), hexenMap(false), hexenLumps(false), iwad(IWAD_NONE),
 engine(DENG_ORIGINAL), priority(0), currentMap(NULL)
@@ -208,19 +214,16 @@ void WadStats::readFile(TaskProgress* progress, bool findMd5)
 	vector<DirEntry*> directory(numberOfLumps);
 	wxFileInputStream* fileStream = new wxFileInputStream(file);
 	wxBufferedInputStream* buf = new wxBufferedInputStream(*fileStream, 1024); //16*numberOfLumps
-	bool ok = true;
+	char entry[16]; //offset, size and name
 	for (int i=0; i<numberOfLumps; i++) {
 		directory[i] = new DirEntry();
-		buf->Read(lng, 4);
-		directory[i]->offset = *lng;
-		buf->Read(lng, 4);
-		directory[i]->size = *lng;
-		ok = true;
-		for (int j=0; j<8; j++) {
-			buf->Read(ch, 1);
-			if (ok && (*ch != 0)) directory[i]->name += *ch;
-			else ok = false;
-		}
+		buf->Read(entry, 16);
+		std::memcpy(&directory[i]->offset, entry, 4);
+		std::memcpy(&directory[i]->size, entry+4, 4);
+		int len = 0;
+		while (len<8 && entry[8+len]!=0)
+			len++;
+		directory[i]->name.assign(entry+8, len);
 		if ((i<(numberOfLumps-1)) && (buf->Eof())) {
 			numberOfLumps = i+1;
 			progress->fatalError("Premature end of file.");
@@ -236,12 +239,20 @@ void WadStats::readFile(TaskProgress* progress, bool findMd5)
 			delete directory[i];
 	} else {
 		unsigned int dirIndex = 0;
+		progress->startPhase("Lumps");
 		while (dirIndex < directory.size()) {
-			processLump(directory[dirIndex], fileStream);
+			if (!progress->hasFailed()) //Stop processing if cancelled
+				processLump(directory[dirIndex], fileStream);
 			delete directory[dirIndex];
 			dirIndex++;
 			progress->incrCount();
 		}
+		progress->endPhase(fileSize);
+		if (progress->hasFailed()) {
+			delete fileStream;
+			file.Close();
+			return;
+		}
 		if (content[WDECORATE]!=NULL && content[WUNKNOWN]!=NULL)
 			findLumpIncludes(WDECORATE, progress);
 		if (content[WMAPINFO]!=NULL && content[WUNKNOWN]!=NULL)
@@ -253,7 +264,11 @@ void WadStats::readFile(TaskProgress* progress, bool findMd5)
 			validateMaps();
 
 		checkIwadEngine();
-		if (findMd5) makeMd5(file);
+		if (findMd5) {
+			progress->startPhase("MD5");
+			makeMd5(file);
+			progress->endPhase(fileSize);
+		}
 		progress->completeCount();
 		if (content[WERROR] != NULL) {
 			//Log number of lump errors
@@ -348,105 +363,105 @@ void WadStats::lumpError(wxString error, DirEntry* lump)
 	content[WERROR]->addLump(lump);
 }
 
-void WadStats::processMarkerLump(DirEntry* lump, const wxString& lname)
+void WadStats::processMarkerLump(DirEntry* lump, LumpCode code)
 {
-	if (lname.Matches("S*_START")) { //Sprites
+	if (lumpNameMatches(code, "S*_START")) { //Sprites
 		wxLogVerbose("Start marker for SPRITES");
 		if (content[WSPRITE] == NULL)
 			content[WSPRITE] = new WadContent(WSPRITE);
 		content[WSPRITE]->markerStack++;
-	} else if (lname.Matches("S*_END")) {
+	} else if (lumpNameMatches(code, "S*_END")) {
 		wxLogVerbose("End marker for SPRITES");
 		if (content[WSPRITE]==NULL || content[WSPRITE]->markerStack==0) {
 			lumpError("S_END marker without start", lump);
 		} else {
 			content[WSPRITE]->markerStack--;
 		}
-	} else if (lname.Matches("P*_START")) {
+	} else if (lumpNameMatches(code, "P*_START")) {
 		wxLogVerbose("Start marker for PATCHES");
 		if (content[WPATCH] == NULL)
 			content[WPATCH] = new WadContent(WPATCH);
 		content[WPATCH]->markerStack++;
-	} else if (lname.Matches("P*_END")) {
+	} else if (lumpNameMatches(code, "P*_END")) {
 		wxLogVerbose("End marker for PATCHES");
 		if (content[WPATCH]==NULL || content[WPATCH]->markerStack==0) {
 			lumpError("P_END marker without start", lump);
 		} else {
 			content[WPATCH]->markerStack--;
 		}
-	} else if (lname.Matches("F*_START")) {
+	} else if (lumpNameMatches(code, "F*_START")) {
 		wxLogVerbose("Start marker for FLATS");
 		if (content[WFLAT] == NULL)
 			content[WFLAT] = new WadContent(WFLAT);
 		content[WFLAT]->markerStack++;
-	} else if (lname.Matches("F*_END")) {
+	} else if (lumpNameMatches(code, "F*_END")) {
 		wxLogVerbose("End marker for FLATS");
 		if (content[WFLAT]==NULL || content[WFLAT]->markerStack==0) {
 			lumpError("F_END marker without start", lump);
 		} else {
 			content[WFLAT]->markerStack--;
 		}
-	} else if (lname.IsSameAs("C_START")) {
+	} else if (code == lumpCode("C_START")) {
 		wxLogVerbose("Start marker for COLORMAPS");
 		if (content[WCOLORMAP] == NULL)
 			content[WCOLORMAP] = new WadContent(WCOLORMAP);
 		content[WCOLORMAP]->markerStack++;
 		if (engine<DENG_BOOM) engine=DENG_BOOM;
-	} else if (lname.IsSameAs("C_END")) {
+	} else if (code == lumpCode("C_END")) {
 		wxLogVerbose("End marker for COLORMAPS");
 		if (content[WCOLORMAP]==NULL || content[WCOLORMAP]->markerStack==0) {
 			lumpError("C_END marker without start", lump);
 		} else {
 			content[WCOLORMAP]->markerStack--;
 		}
-	} else if (lname.Matches("FONT*_S")) {
+	} else if (lumpNameMatches(code, "FONT*_S")) {
 		wxLogVerbose("Start marker for FONT");
 		if (content[WFONT] == NULL)
 			content[WFONT] = new WadContent(WFONT);
 		content[WFONT]->markerStack++;
 	}
-	else if (lname.Matches("FONT*_E")) {
+	else if (lumpNameMatches(code, "FONT*_E")) {
 		wxLogVerbose("End marker for FONT");
 		if (content[WFONT] == NULL || content[WFONT]->markerStack == 0) {
 			lumpError("FONT end marker without start", lump);
 		} else {
 			content[WFONT]->markerStack--;
 		}
-	} else if (lname.IsSameAs("T_START")) {
+	} else if (code == lumpCode("T_START")) {
 		wxLogVerbose("Start marker for D64 TEXTURES");
 		if (content[WTX] == NULL)
 			content[WTX] = new WadContent(WTX);
 		content[WTX]->markerStack++;
 		engine = DENG_DOOM64;
-	} else if (lname.IsSameAs("T_END")) {
+	} else if (code == lumpCode("T_END")) {
 		wxLogVerbose("End marker for D64 TEXTURES");
 		if (content[WTX] == NULL || content[WTX]->markerStack == 0) {
 			lumpError("T_END marker without start", lump);
 		} else {
 			content[WTX]->markerStack--;
 		}
-	} else if (lname.IsSameAs("TX_START")) {
+	} else if (code == lumpCode("TX_START")) {
 		wxLogVerbose("Start marker for TEXTURES");
 		if (content[WTX] == NULL)
 			content[WTX] = new WadContent(WTX);
 		content[WTX]->markerStack++;
 		if (engine<DENG_ZDOOM) engine=DENG_ZDOOM;
-	} else if (lname.IsSameAs("TX_END")) {
+	} else if (code == lumpCode("TX_END")) {
 		wxLogVerbose("End marker for TEXTURES");
 		if (content[WTX]==NULL || content[WTX]->markerStack==0) {
 			lumpError("TX_END marker without start", lump);
 		} else {
 			content[WTX]->markerStack--;
 		}
-	} else if (lname.Matches("*_START") || lname.Matches("*_END")) {
-		wxLogVerbose("Unknown marker %s", lname);
-	} else if (lname.IsSameAs("ENDOFWAD")) {
+	} else if (lumpNameMatches(code, "*_START") || lumpNameMatches(code, "*_END")) {
+		wxLogVerbose("Unknown marker %s", lump->name);
+	} else if (code == lumpCode("ENDOFWAD")) {
 		wxLogVerbose("End marker for DOOM64 iwad");
 		engine = DENG_DOOM64;
 		iwad = IWAD_DOOM64;
-	} else if (lname.StartsWith("_")) {
+	} else if (lumpNameMatches(code, "_*")) {
 		//Comment marker
-	} else if (lname.Length()==0) {
+	} else if (code == 0) {
 		//Empty marker - junk
 	} else { //Should be map
 		mapMarker(lump);
@@ -497,150 +512,150 @@ void WadStats::mapMarker(DirEntry* lump)
 	}
 }
 
-bool WadStats::processLumpName(DirEntry* lump, const wxString& lname)
+bool WadStats::processLumpName(DirEntry* lump, LumpCode code)
 {
-	if (lname.IsSameAs("PLAYPAL")) {
+	if (code == lumpCode("PLAYPAL")) {
 		if (content[WPLAYPAL] == NULL)
 			content[WPLAYPAL] = new WadContent(WPLAYPAL);
 		content[WPLAYPAL]->addLump(lump);
 		return true;
 	}
-	if (lname.IsSameAs("E2PAL")) {
+	if (code == lumpCode("E2PAL")) {
 		if (content[WPLAYPAL] == NULL)
 			content[WPLAYPAL] = new WadContent(WPLAYPAL);
 		content[WPLAYPAL]->addLump(lump);
 		iwad = IWAD_HERETIC;
 		return true;
 	}
-	if (lname.IsSameAs("COLORMAP")) {
+	if (code == lumpCode("COLORMAP")) {
 		if (content[WCOLORMAP] == NULL)
 			content[WCOLORMAP] = new WadContent(WCOLORMAP);
 		content[WCOLORMAP]->addLump(lump);
 		return true;
 	}
-	if (lname.IsSameAs("ENDOOM") && lump->size==4000) {
+	if (code == lumpCode("ENDOOM") && lump->size==4000) {
 		if (content[WENDOOM] == NULL)
 			content[WENDOOM] = new WadContent(WENDOOM);
 		content[WENDOOM]->addLump(lump);
 		return true;
 	}
-	if (lname.IsSameAs("ENDTEXT") && lump->size==4000) {
+	if (code == lumpCode("ENDTEXT") && lump->size==4000) {
 		if (content[WENDOOM] == NULL)
 			content[WENDOOM] = new WadContent(WENDOOM);
 		content[WENDOOM]->addLump(lump);
 		iwad = IWAD_HERETIC;
 		return true;
 	}
-	if (lname.IsSameAs("ENDBOOM") && lump->size==4000) {
+	if (code == lumpCode("ENDBOOM") && lump->size==4000) {
 		if (content[WENDOOM] == NULL)
 			content[WENDOOM] = new WadContent(WENDOOM);
 		content[WENDOOM]->addLump(lump);
 		if (engine<DENG_BOOM) engine=DENG_BOOM;
 		return true;
 	}
-	if ((lname.IsSameAs("DMXGUS")) || (lname.IsSameAs("GENMIDI")) ||
-			(lname.IsSameAs("DMXGUSC"))) {
+	if ((code == lumpCode("DMXGUS")) || (code == lumpCode("GENMIDI")) ||
+			(code == lumpCode("DMXGUSC"))) {
 		if (content[WOTHER] == NULL)
 			content[WOTHER] = new WadContent(WOTHER);
 		content[WOTHER]->addLump(lump);
 		return true;
 	}
-	if (lname.IsSameAs("_DEUTEX_")) {
+	if (code == lumpCode("_DEUTEX_")) {
 		if (content[WOTHER] == NULL)
 			content[WOTHER] = new WadContent(WOTHER);
 		content[WOTHER]->addLump(lump);
 		return true;
 	}
-	if (lname.IsSameAs("TEXTCOLO")) {
+	if (code == lumpCode("TEXTCOLO")) {
 		if (content[WOTHER] == NULL)
 			content[WOTHER] = new WadContent(WOTHER);
 		content[WOTHER]->addLump(lump);
 		if (engine<DENG_ZDOOM) engine = DENG_ZDOOM;
 		return true;
 	}
-	if (lname.Matches("DEMO?")) {
+	if (lumpNameMatches(code, "DEMO?")) {
 		if (content[WDEMOS] == NULL)
 			content[WDEMOS] = new WadContent(WDEMOS);
 		content[WDEMOS]->addLump(lump);
 		return true;
     }
-    if ((lname.IsSameAs("ANIMATED")) || (lname.IsSameAs("SWITCHES"))) {
+    if ((code == lumpCode("ANIMATED")) || (code == lumpCode("SWITCHES"))) {
 		if (content[WANIM] == NULL)
 			content[WANIM] = new WadContent(WANIM);
 		content[WANIM]->addLump(lump);
 		if (engine<DENG_BOOM) engine=DENG_BOOM;
 		return true;
 	}
-	if (lname.IsSameAs("ANIMDEFS")) {
+	if (code == lumpCode("ANIMDEFS")) {
 		if (content[WANIM] == NULL)
 			content[WANIM] = new WadContent(WANIM);
 		content[WANIM]->addLump(lump);
 		hexenLumps = true;
 		return true;
 	}
-	if ((lname.IsSameAs("SNDSEQ")) || (lname.IsSameAs("SNDINFO"))) {
+	if ((code == lumpCode("SNDSEQ")) || (code == lumpCode("SNDINFO"))) {
 		if (content[WSNDDEF] == NULL)
 			content[WSNDDEF] = new WadContent(WSNDDEF);
 		content[WSNDDEF]->addLump(lump);
 		hexenLumps = true;
 		return true;
 	}
-	if (lname.IsSameAs("SNDCURVE")) {
+	if (code == lumpCode("SNDCURVE")) {
 		if (content[WSNDDEF] == NULL)
 			content[WSNDDEF] = new WadContent(WSNDDEF);
 		content[WSNDDEF]->addLump(lump);
 		return true;
 	}
-	if (lname.IsSameAs("DECALDEF")) {
+	if (code == lumpCode("DECALDEF")) {
 		if (content[WZDEF] == NULL)
 			content[WZDEF] = new WadContent(WZDEF);
 		content[WZDEF]->addLump(lump);
 		if (engine<DENG_ZDOOM) engine = DENG_ZDOOM;
 		return true;
 	}
-	if (lname.IsSameAs("DEHACKED")) {
+	if (code == lumpCode("DEHACKED")) {
 		if (content[WDEHACKED] == NULL)
 			content[WDEHACKED] = new WadContentX(WDEHACKED, filePathName);
 		content[WDEHACKED]->addLump(lump);
 		return true;
 	}
-	if (lname.IsSameAs("DECORATE")) {
+	if (code == lumpCode("DECORATE")) {
 		if (content[WDECORATE] == NULL)
 			content[WDECORATE] = new WadContentX(WDECORATE, filePathName);
 		content[WDECORATE]->addLump(lump);
 		if (engine<DENG_ZDOOM) engine = DENG_ZDOOM;
 		return true;
 	}
-	if (lname.IsSameAs("MAPINFO")) {
+	if (code == lumpCode("MAPINFO")) {
 		if (content[WMAPINFO] == NULL)
 			content[WMAPINFO] = new WadContentX(WMAPINFO, filePathName);
 		content[WMAPINFO]->addLump(lump);
 		hexenLumps = true;
 		return true;
 	}
-	if (lname.IsSameAs("ZMAPINFO")) {
+	if (code == lumpCode("ZMAPINFO")) {
 		if (content[WMAPINFO] == NULL)
 			content[WMAPINFO] = new WadContentX(WMAPINFO, filePathName);
 		content[WMAPINFO]->addLump(lump);
 		if (engine<DENG_ZDOOM) engine = DENG_ZDOOM;
 		return true;
 	}
-	if (lname.IsSameAs("KEYCONF")) {
+	if (code == lumpCode("KEYCONF")) {
 		if (content[WOTHER] == NULL)
 			content[WOTHER] = new WadContent(WOTHER);
 		content[WOTHER]->addLump(lump);
 		if (engine<DENG_ZDOOM) engine = DENG_ZDOOM;
 		return true;
 	}
-	if (lname.IsSameAs("TERRAIN")) {
+	if (code == lumpCode("TERRAIN")) {
 		if (content[WZDEF] == NULL)
 			content[WZDEF] = new WadContent(WZDEF);
 		content[WZDEF]->addLump(lump);
 		if (engine<DENG_ZDOOM) engine = DENG_ZDOOM;
 		return true;
 	}
-	if ((lname.IsSameAs("GAMEINFO")) || (lname.IsSameAs("SBARINFO"))
-		|| (lname.IsSameAs("MENUDEF")))
+	if ((code == lumpCode("GAMEINFO")) || (code == lumpCode("SBARINFO"))
+		|| (code == lumpCode("MENUDEF")))
 	{
 		if (content[WZDEF] == NULL)
 			content[WZDEF] = new WadContent(WZDEF);
@@ -648,48 +663,48 @@ bool WadStats::processLumpName(DirEntry* lump, const wxString& lname)
 		if (engine<DENG_ZDOOM) engine = DENG_ZDOOM;
 		return true;
 	}
-	if (lname.IsSameAs("LOCKDEFS")) {
+	if (code == lumpCode("LOCKDEFS")) {
 		if (content[WZDEF] == NULL)
 			content[WZDEF] = new WadContent(WZDEF);
 		content[WZDEF]->addLump(lump);
 		if (engine<DENG_ZDOOM) engine = DENG_ZDOOM;
 		return true;
 	}
-	if (lname.IsSameAs("FONTDEFS")) {
+	if (code == lumpCode("FONTDEFS")) {
 		if (content[WZDEF] == NULL)
 			content[WZDEF] = new WadContent(WZDEF);
 		content[WZDEF]->addLump(lump);
 		if (engine<DENG_ZDOOM) engine = DENG_ZDOOM;
 		return true;
 	}
-	if (lname.IsSameAs("GLDEFS") || lname.IsSameAs("DOOMDEFS")) {
+	if (code == lumpCode("GLDEFS") || code == lumpCode("DOOMDEFS")) {
 		if (content[WGLDEF] == NULL)
 			content[WGLDEF] = new WadContent(WGLDEF);
 		content[WGLDEF]->addLump(lump);
 		if (engine<DENG_GZDOOM) engine = DENG_GZDOOM;
 		return true;
 	}
-	if (lname.IsSameAs("LOADACS")) {
+	if (code == lumpCode("LOADACS")) {
 		if (content[WACS] == NULL)
 			content[WACS] = new WadContent(WACS);
 		content[WACS]->addLump(lump);
 		if (engine<DENG_ZDOOM) engine = DENG_ZDOOM;
 		return true;
 	}
-	if (lname.IsSameAs("SCRIPT??")) {
+	if (code == lumpCode("SCRIPT??")) {
 		if (content[WACS] == NULL)
 			content[WACS] = new WadContent(WACS);
 		content[WACS]->addLump(lump);
 		return true;
 	}
-	if (lname.IsSameAs("ZSCRIPT")) {
+	if (code == lumpCode("ZSCRIPT")) {
 		if (content[WZSCRIPT] == NULL)
 			content[WZSCRIPT] = new WadContentX(WZSCRIPT, filePathName);
 		content[WZSCRIPT]->addLump(lump);
 		if (engine<DENG_ZDOOM) engine = DENG_ZDOOM;
 		return true;
 	}
-	if (lname.IsSameAs("CVARINFO")) {
+	if (code == lumpCode("CVARINFO")) {
 		if (content[WOTHER] == NULL)
 			content[WOTHER] = new WadContent(WOTHER);
 		content[WOTHER]->addLump(lump);
@@ -699,29 +714,29 @@ bool WadStats::processLumpName(DirEntry* lump, const wxString& lname)
 	return false;
 }
 
-bool WadStats::processLumpName2(DirEntry* lump, const wxString& lname)
+bool WadStats::processLumpName2(DirEntry* lump, LumpCode code)
 {
-	if ((lname.IsSameAs("FOGMAP")) || lname.StartsWith("TRANTBL")) {
+	if ((code == lumpCode("FOGMAP")) || lumpNameMatches(code, "TRANTBL*")) {
 		if (content[WCOLORMAP] == NULL)
 			content[WCOLORMAP] = new WadContent(WCOLORMAP);
 		content[WCOLORMAP]->addLump(lump);
 		hexenLumps = true;
 		return true;
 	}
-	if (lname.IsSameAs("TINTTAB")) {
+	if (code == lumpCode("TINTTAB")) {
 		if (content[WCOLORMAP] == NULL)
 			content[WCOLORMAP] = new WadContent(WCOLORMAP);
 		content[WCOLORMAP]->addLump(lump);
 		return true;
 	}
-	if (lname.Matches("CLUS?MSG") || lname.Matches("WIN?MSG")) {
+	if (lumpNameMatches(code, "CLUS?MSG") || lumpNameMatches(code, "WIN?MSG")) {
 		if (content[WTEXT] == NULL)
 			content[WTEXT] = new WadContent(WTEXT);
 		content[WTEXT]->addLump(lump);
 		iwad = IWAD_HEXEN;
 		return true;
 	}
-	if (lname.IsSameAs("HTICDEFS")) {
+	if (code == lumpCode("HTICDEFS")) {
 		if (content[WGLDEF] == NULL)
 			content[WGLDEF] = new WadContent(WGLDEF);
 		content[WGLDEF]->addLump(lump);
@@ -729,7 +744,7 @@ bool WadStats::processLumpName2(DirEntry* lump, const wxString& lname)
 		iwad = IWAD_HERETIC;
 		return true;
 	}
-	if (lname.IsSameAs("HEXNDEFS")) {
+	if (code == lumpCode("HEXNDEFS")) {
 		if (content[WGLDEF] == NULL)
 			content[WGLDEF] = new WadContent(WGLDEF);
 		content[WGLDEF]->addLump(lump);
@@ -737,7 +752,7 @@ bool WadStats::processLumpName2(DirEntry* lump, const wxString& lname)
 		iwad = IWAD_HEXEN;
 		return true;
 	}
-	if (lname.IsSameAs("STRFDEFS")) {
+	if (code == lumpCode("STRFDEFS")) {
 		if (content[WGLDEF] == NULL)
 			content[WGLDEF] = new WadContent(WGLDEF);
 		content[WGLDEF]->addLump(lump);
@@ -745,43 +760,43 @@ bool WadStats::processLumpName2(DirEntry* lump, const wxString& lname)
 		iwad = IWAD_STRIFE;
 		return true;
 	}
-	if (lname.IsSameAs("AUTOPAGE")) {
+	if (code == lumpCode("AUTOPAGE")) {
 		//Heretic/Hexen automap background
 		if (content[WBITMAP] == NULL)
 			content[WBITMAP] = new WadContent(WBITMAP);
 		content[WBITMAP]->addLump(lump);
 		return true;
 	}
-	if (lname.IsSameAs("XLATAB")) {
+	if (code == lumpCode("XLATAB")) {
 		if (content[WCOLORMAP] == NULL)
 			content[WCOLORMAP] = new WadContent(WCOLORMAP);
 		content[WCOLORMAP]->addLump(lump);
 		iwad = IWAD_STRIFE;
 		return true;
 	}
-	if (lname.IsSameAs("ENDSTRF")) {
+	if (code == lumpCode("ENDSTRF")) {
 		if (content[WENDOOM] == NULL)
 			content[WENDOOM] = new WadContent(WENDOOM);
 		content[WENDOOM]->addLump(lump);
 		iwad = IWAD_STRIFE;
 		return true;
 	}
-	if (lname.IsSameAs("T1TEXT") || lname.IsSameAs("C1TEXT")
-			|| lname.IsSameAs("COPYRITE")) {
+	if (code == lumpCode("T1TEXT") || code == lumpCode("C1TEXT")
+			|| code == lumpCode("COPYRITE")) {
 		if (content[WTEXT] == NULL)
 			content[WTEXT] = new WadContent(WTEXT);
 		content[WTEXT]->addLump(lump);
 		iwad = IWAD_STRIFE;
 		return true;
 	}
-	if (lname.Matches("LOG*")) {
+	if (lumpNameMatches(code, "LOG*")) {
 		if (content[WTEXT] == NULL)
 			content[WTEXT] = new WadContent(WTEXT);
 		content[WTEXT]->addLump(lump);
 		iwad = IWAD_STRIFE;
 		return true;
 	}
-	if (lname.Matches("LANGUAGE")) {
+	if (lumpNameMatches(code, "LANGUAGE")) {
 		//Pk3 can have multiple such files with different extensions
 		if (content[WTEXT] == NULL)
 			content[WTEXT] = new WadContent(WTEXT);
@@ -789,62 +804,62 @@ bool WadStats::processLumpName2(DirEntry* lump, const wxString& lname)
 		if (engine<DENG_ZDOOM) engine = DENG_ZDOOM;
 		return true;
 	}
-	if (lname.IsSameAs("LOADING") && lump->size==4000) {
+	if (code == lumpCode("LOADING") && lump->size==4000) {
 		if (content[WOTHER] == NULL)
 			content[WOTHER] = new WadContent(WOTHER);
 		content[WOTHER]->addLump(lump);
 		return true;
 	}
-	if (lname.IsSameAs("EXTENDED")) {
+	if (code == lumpCode("EXTENDED")) {
 		if (content[WOTHER] == NULL)
 			content[WOTHER] = new WadContent(WOTHER);
 		content[WOTHER]->addLump(lump);
 		return true;
 	}
-	if (lname.IsSameAs("SERIAL")) {
+	if (code == lumpCode("SERIAL")) {
 		if (content[WOTHER] == NULL)
 			content[WOTHER] = new WadContent(WOTHER);
 		content[WOTHER]->addLump(lump);
 		return true;
 	}
-	if (lname.IsSameAs("GFRAG")) {
+	if (code == lumpCode("GFRAG")) {
 		//In Heretic iwad, sound fx?
 		if (content[WSFX] == NULL)
 			content[WSFX] = new WadContent(WSFX);
 		content[WSFX]->addLump(lump);
 		return true;
 	}
-	if (lname.IsSameAs("FSGLOBAL")) { //FraggleScript global
+	if (code == lumpCode("FSGLOBAL")) { //FraggleScript global
 		if (content[WACS] == NULL)
 			content[WACS] = new WadContent(WACS);
 		content[WACS]->addLump(lump);
 		return true;
 	}
-	if (lname.IsSameAs("NOTCH") || (lump->size==184)) {
+	if (code == lumpCode("NOTCH") || (lump->size==184)) {
 		if (content[WOTHER] == NULL)
 			content[WOTHER] = new WadContent(WOTHER);
 		content[WOTHER]->addLump(lump);
 		return true;
 	}
-	if (lname.IsSameAs("NETNOTCH") || (lump->size==32)) {
+	if (code == lumpCode("NETNOTCH") || (lump->size==32)) {
 		if (content[WOTHER] == NULL)
 			content[WOTHER] = new WadContent(WOTHER);
 		content[WOTHER]->addLump(lump);
 		return true;
 	}
-	if (lname.IsSameAs("STARTUP") && (lump->size==153648)) {
+	if (code == lumpCode("STARTUP") && (lump->size==153648)) {
 		if (content[WOTHER] == NULL)
 			content[WOTHER] = new WadContent(WOTHER);
 		content[WOTHER]->addLump(lump);
 		return true;
 	}
-	if (lname.IsSameAs("REVERBS")) {
+	if (code == lumpCode("REVERBS")) {
 		if (content[WSNDDEF] == NULL)
 			content[WSNDDEF] = new WadContent(WSNDDEF);
 		content[WSNDDEF]->addLump(lump);
 		return true;
 	}
-	if (lname.IsSameAs("SQU-SWE1")) { //Marker for Adventures of Square
+	if (code == lumpCode("SQU-SWE1")) { //Marker for Adventures of Square
 		if (content[WOTHER] == NULL)
 			content[WOTHER] = new WadContent(WOTHER);
 		content[WOTHER]->addLump(lump);
@@ -857,47 +872,50 @@ bool WadStats::processLumpName2(DirEntry* lump, const wxString& lname)
 void WadStats::processLump(DirEntry* lump, wxInputStream* file)
 {
 	wxLogVerbose("Lump %s of size %i @ %i", lump->name, lump->size, lump->offset);
-	wxString lname(lump->name);
-	lname.MakeUpper();
+	LumpCode code = packLumpName(lump->name);
 	if (currentMap != NULL) {
 		if (currentMap->containsLump(lump->name)) {
 			lumpError("Duplicate map lump", lump);
 			return;
 		}
-		if (lname.IsSameAs("LINEDEFS") || lname.IsSameAs("SIDEDEFS") || lname.IsSameAs("VERTEXES") || lname.IsSameAs("SECTORS"))
-		{
+		switch (code) {
+		case lumpCode("LINEDEFS"):
+		case lumpCode("SIDEDEFS"):
+		case lumpCode("VERTEXES"):
+		case lumpCode("SECTORS"):
 			if (lump->size < 4)
 				lumpError("Empty map lump", lump);
 			else
 				currentMap->addLump(lump);
 			return;
-		}
-		if (lname.IsSameAs("THINGS") || lname.IsSameAs("SEGS") || lname.IsSameAs("SSECTORS")
-			|| lname.IsSameAs("NODES") || lname.IsSameAs("REJECT") || lname.IsSameAs("BLOCKMAP"))
-		{
-			currentMap->addLump(lump);
-			return;
-		}
+		case lumpCode("THINGS"):
+		case lumpCode("SEGS"):
+		case lumpCode("SSECTORS"):
+		case lumpCode("NODES"):
+		case lumpCode("REJECT"):
+		case lumpCode("BLOCKMAP"):
 		//TODO: GL_ map marker node (GL_MAP?? or GL_E?M?) can have content
-		if (lname.IsSameAs("GL_VERT") || lname.IsSameAs("GL_SEGS") || lname.IsSameAs("GL_SSECT")
-			|| lname.IsSameAs("GL_NODES") || lname.IsSameAs("GL_PVS"))
-		{
+		case lumpCode("GL_VERT"):
+		case lumpCode("GL_SEGS"):
+		case lumpCode("GL_SSECT"):
+		case lumpCode("GL_NODES"):
+		case lumpCode("GL_PVS"):
 			currentMap->addLump(lump);
 			return;
-		}
-		if (lname.IsSameAs("TEXTMAP") || lname.IsSameAs("DIALOGUE") || lname.IsSameAs("ZNODES")) {
+		case lumpCode("TEXTMAP"):
+		case lumpCode("DIALOGUE"):
+		case lumpCode("ZNODES"):
 			//UDMF
 			currentMap->addLump(lump);
 			if (engine<DENG_ZDOOM) engine=DENG_ZDOOM;
 			return;
-		}
-		if (lname.IsSameAs("LEAFS") || lname.IsSameAs("LIGHTS")) {
+		case lumpCode("LEAFS"):
+		case lumpCode("LIGHTS"):
 			//Doom64/PS
 			currentMap->addLump(lump);
 			if (engine < DENG_PLAYSTATION) engine = DENG_PLAYSTATION;
 			return;
-		}
-		if (lname.IsSameAs("MACROS")) {
+		case lumpCode("MACROS"):
 			//Doom64 script
 			currentMap->addLump(lump);
 			engine = DENG_DOOM64;
@@ -908,90 +926,92 @@ void WadStats::processLump(DirEntry* lump, wxInputStream* file)
 				content[WBEHAVIOR]->addLump(lump);
 			}
 			return;
-		}
-		if ((currentMap->lumps!=NULL) && (currentMap->lumps->size()>0)) {
-			if (lname.IsSameAs("BEHAVIOR") || lname.IsSameAs("SCRIPTS")) {
+		case lumpCode("BEHAVIOR"):
+		case lumpCode("SCRIPTS"):
+			if ((currentMap->lumps!=NULL) && (currentMap->lumps->size()>0)) {
 				currentMap->addLump(lump);
 				hexenMap = true;
-				if (lname.IsSameAs("BEHAVIOR") && lump->size>1) {
+				if (code == lumpCode("BEHAVIOR") && lump->size>1) {
 					if (content[WBEHAVIOR] == NULL)
 						content[WBEHAVIOR] = new WadContent(WBEHAVIOR);
 					content[WBEHAVIOR]->addLump(lump);
 				}
 				return;
 			}
-		}
-		if (lname.IsSameAs("ENDMAP") && (lump->size==0)) {
-			currentMap = NULL;
-			return;
+			break;
+		case lumpCode("ENDMAP"):
+			if (lump->size == 0) {
+				currentMap = NULL;
+				return;
+			}
+			break;
 		}
 	} //end map lumps
-	if (lname.IsSameAs("LINEDEFS") || lname.IsSameAs("SIDEDEFS") || lname.IsSameAs("VERTEXES") || lname.IsSameAs("SECTORS")
-		|| lname.IsSameAs("THINGS") || lname.IsSameAs("SEGS") || lname.IsSameAs("SSECTORS") || lname.IsSameAs("NODES")
-		|| lname.IsSameAs("REJECT") || lname.IsSameAs("BLOCKMAP") || lname.IsSameAs("BEHAVIOR"))
-	{
+	switch (code) {
+	case lumpCode("LINEDEFS"):
+	case lumpCode("SIDEDEFS"):
+	case lumpCode("VERTEXES"):
+	case lumpCode("SECTORS"):
+	case lumpCode("THINGS"):
+	case lumpCode("SEGS"):
+	case lumpCode("SSECTORS"):
+	case lumpCode("NODES"):
+	case lumpCode("REJECT"):
+	case lumpCode("BLOCKMAP"):
+	case lumpCode("BEHAVIOR"):
 		lumpError("Map lump without map marker", lump);
 		return;
 	}
 
 	if (lump->size == 0) {
-		processMarkerLump(lump, lname);
+		processMarkerLump(lump, code);
 		return;
 	}
-	//Read first 4 bytes
-	char bytes[4];
-	file->SeekI(lump->offset, wxFromStart);
-	file->Read(bytes, 4);
-	bool checkedPicture = false;
+	//Flats are known from their size, without reading them, unless the
+	//lump could also be a sprite, patch or texture list
+	if ((content[WFLAT]!=NULL) && (content[WFLAT]->markerStack>0) && isFlatSize(lump->size)
+		&& ((content[WSPRITE]==NULL) || (content[WSPRITE]->markerStack==0))
+		&& ((content[WPATCH]==NULL) || (content[WPATCH]->markerStack==0))
+		&& code!=lumpCode("PNAMES") && code!=lumpCode("TEXTURE1") && code!=lumpCode("TEXTURE2")) {
+		content[WFLAT]->addLump(lump);
+		return;
+	}
+	//Read start of lump, matching it against known formats
+	LumpSniff sniff = readSignature(lump, file);
 
-	if (checkTexLists(lump, lname, bytes)) return;
+	if (checkTexLists(lump, code, sniff)) return;
 
 	if ((content[WSPRITE]!=NULL) && (content[WSPRITE]->markerStack>0)) {
-		if (checkPicture(lump, file, WSPRITE)) return;
-		checkedPicture = true;
-		if (checkPng(lump, bytes, WSPRITE)) return;
+		if (checkPicture(lump, sniff, WSPRITE)) return;
+		if (checkPng(lump, sniff, WSPRITE)) return;
 	}
 	if ((content[WPATCH]!=NULL) && (content[WPATCH]->markerStack>0)) {
-		if (!checkedPicture && checkPicture(lump, file, WPATCH)) return;
-		checkedPicture = true;
-		if (checkPng(lump, bytes, WPATCH)) return;
+		if (checkPicture(lump, sniff, WPATCH)) return;
+		if (checkPng(lump, sniff, WPATCH)) return;
 	}
 	if ((content[WFLAT]!=NULL) && (content[WFLAT]->markerStack>0)) {
-		if (lump->size == 4096) {
-			content[WFLAT]->addLump(lump);
-			return;
-		}
-		//Other sizes
-		if (lump->size == 8192) {
-			//Hexen iwad
-			content[WFLAT]->addLump(lump);
-			//iwad = IWAD_HEXEN;
-			return;
-		}
-		if (lump->size==4160 || lump->size==4) {
-			//Heretic iwad
+		if (isFlatSize(lump->size)) {
 			content[WFLAT]->addLump(lump);
 			return;
 		}
-		if (checkPng(lump, bytes, WFLAT)) return;
+		if (checkPng(lump, sniff, WFLAT)) return;
 	}
 	if ((content[WFONT]!=NULL) && (content[WFONT]->markerStack>0)) {
-		if (!checkedPicture && checkPicture(lump, file, WFONT)) return;
-		checkedPicture = true;
+		if (checkPicture(lump, sniff, WFONT)) return;
 	}
 
-	if (processLumpName(lump, lname)) return;
+	if (processLumpName(lump, code)) return;
 
-    if (lname.StartsWith("DS")) {
-		if (checkSfx(lump, bytes)) return;
-		if (checkWav(lump, bytes)) return;
+    if (lumpNameMatches(code, "DS*")) {
+		if (checkSfx(lump, sniff)) return;
+		if (checkWav(lump, sniff)) return;
     }
-    if (lname.StartsWith("DP")) {
-		if (checkPcs(lump, bytes)) return;
+    if (lumpNameMatches(code, "DP*")) {
+		if (checkPcs(lump, sniff)) return;
     }
-	if (lname.StartsWith("D_")) {
-		if (checkMus(lump, bytes)) return;
-		if (checkMidi(lump, bytes)) return;
+	if (lumpNameMatches(code, "D_*")) {
+		if (checkMus(lump, sniff)) return;
+		if (checkMidi(lump, sniff)) return;
 	}
 	if ((content[WCOLORMAP]!=NULL) && (content[WCOLORMAP]->markerStack>0)) {
 		//Assume this lump is a Boom colormap
@@ -1003,36 +1023,33 @@ void WadStats::processLump(DirEntry* lump, wxInputStream* file)
 		content[WTX]->addLump(lump);
 		return;
 	}
-	if (lname.IsSameAs("HIRESTEX") || lname.IsSameAs("TEXTURES")) {
+	if (code == lumpCode("HIRESTEX") || code == lumpCode("TEXTURES")) {
 		if (content[WTEXTURES] == NULL)
 			content[WTEXTURES] = new WadContent(WTEXTURES);
 		content[WTEXTURES]->bytes += lump->size;
 		if (engine<DENG_ZDOOM) engine = DENG_ZDOOM;
 		return;
 	}
-	if (lname.Matches("MAP??") || lname.Matches("E?M?") || lname.Matches("GL_MAP??") || lname.Matches("GL_E?M?")) {
+	if (lumpNameMatches(code, "MAP??") || lumpNameMatches(code, "E?M?") || lumpNameMatches(code, "GL_MAP??") || lumpNameMatches(code, "GL_E?M?")) {
 		//Map marker, even though the lump size is not zero
 		mapMarker(lump);
 		return;
 	}
-	if (checkPng(lump, bytes, WGFX)) return;
-	if (checkMus(lump, bytes)) return;
-	if (checkSfx(lump, bytes)) return;
-	if (checkWav(lump, bytes)) return;
-	if (checkFlac(lump, bytes)) return;
-	if (checkPcs(lump, bytes)) return;
-	if (checkMidi(lump, bytes)) return;
-	if (checkMp3Ogg(lump, bytes)) return;
-	if (checkFon12(lump, bytes)) return;
-	if (checkAcs(lump, bytes)) return;
-	if (!checkedPicture) {
-		if (checkPicture(lump, file, WGFX)) return;
-		checkedPicture = true;
-	}
-	if (checkJpg(lump, bytes)) return;
-	if (checkBmp(lump, bytes)) return;
-
-	if (processLumpName2(lump, lname)) return;
+	if (checkPng(lump, sniff, WGFX)) return;
+	if (checkMus(lump, sniff)) return;
+	if (checkSfx(lump, sniff)) return;
+	if (checkWav(lump, sniff)) return;
+	if (checkFlac(lump, sniff)) return;
+	if (checkPcs(lump, sniff)) return;
+	if (checkMidi(lump, sniff)) return;
+	if (checkMp3Ogg(lump, sniff)) return;
+	if (checkFon12(lump, sniff)) return;
+	if (checkAcs(lump, sniff)) return;
+	if (checkPicture(lump, sniff, WGFX)) return;
+	if (checkJpg(lump, sniff)) return;
+	if (checkBmp(lump, sniff)) return;
+
+	if (processLumpName2(lump, code)) return;
 
 	if (lump->size == 4096) {
 		if (content[WFLAT] == NULL)
@@ -1049,9 +1066,9 @@ void WadStats::processLump(DirEntry* lump, wxInputStream* file)
 		if (content[WBITMAP] == NULL)
 			content[WBITMAP] = new WadContent(WBITMAP);
 		content[WBITMAP]->addLump(lump);
-		if (lname.IsSameAs("FINAL1"))
+		if (code == lumpCode("FINAL1"))
 			iwad = IWAD_HERETIC;
-		else if (lname.IsSameAs("FINALE1"))
+		else if (code == lumpCode("FINALE1"))
 			iwad = IWAD_HEXEN;
 		return;
 	}
@@ -1061,60 +1078,67 @@ void WadStats::processLump(DirEntry* lump, wxInputStream* file)
 	content[WUNKNOWN]->addLump(lump);
 }
 
-bool WadStats::checkPicture(DirEntry* lump, wxInputStream* file, WadContentType t)
+LumpSniff WadStats::readSignature(DirEntry* lump, wxInputStream* file)
 {
-	int16_t w, h, x, y;
+	//The magic numbers only need the first bytes. These also give the
+	//size of the picture header, if the lump can be a Doom picture.
+	unsigned char data[SNIFF_SIZE];
+	size_t length = ((size_t)lump->size < SNIFF_MAGIC)? lump->size: SNIFF_MAGIC;
 	file->SeekI(lump->offset, wxFromStart);
-	file->Read(&w, 2);
-	file->Read(&h, 2);
-	file->Read(&x, 2);
-	file->Read(&y, 2);
-	uint32_t columnStart = (w*4) + 8;
-	if (lump->size <= columnStart)
+	length = file->Read(data, length).LastRead();
+	size_t header = pictureHeaderSize(data, length, lump->size);
+	if (header <= length)
+		return sniffLump(data, length, lump->size);
+	if (header <= SNIFF_SIZE) {
+		length += file->Read(&data[length], header-length).LastRead();
+		return sniffLump(data, length, lump->size);
+	}
+	//Picture wider than 256, read all column offsets
+	vector<unsigned char> wide(header);
+	std::memcpy(&wide[0], data, length);
+	length += file->Read(&wide[length], header-length).LastRead();
+	return sniffLump(&wide[0], length, lump->size);
+}
+
+bool WadStats::checkPicture(DirEntry* lump, const LumpSniff& sniff, WadContentType t)
+{
+	if (!sniff.is(LFMT_PICTURE))
 		return false;
-    uint32_t offset=0;
-    for (int i=0; i<w; i++) {
-		//Each value is an offset for a column of the image
-		file->Read(&offset, 4);
-		if ((offset>lump->size) || (offset<columnStart))
-			return false;
-    }
-	//wxLogVerbose("Image header w %i h %i x %i y %i", w, h, x, y);
 	if (content[t] == NULL)
 		content[t] = new WadContent(t);
 	content[t]->addLump(lump);
 	return true;
 }
 
-bool WadStats::checkTexLists(DirEntry* lump, const wxString& lname, char* bytes)
+bool WadStats::checkTexLists(DirEntry* lump, LumpCode code, const LumpSniff& sniff)
 {
-	if (lname.IsSameAs("PNAMES")) {
+	if (code == lumpCode("PNAMES")) {
 		if (content[WPNAMES] == NULL) {
 			content[WPNAMES] = new WadContent(WPNAMES);
 			content[WPNAMES]->bytes = lump->size;
 			int32_t num(0);
-			std::memcpy(&num, bytes, 4);
+			std::memcpy(&num, sniff.start, 4);
 			content[WPNAMES]->count = num;
 		} else {
 			lumpError("Multiple PNAMES lumps", lump);
 		}
 		return true;
 	}
-	if (lname.IsSameAs("TEXTURE1") || lname.IsSameAs("TEXTURE2")) {
+	if (code == lumpCode("TEXTURE1") || code == lumpCode("TEXTURE2")) {
 		if (content[WTEXTURES] == NULL)
 			content[WTEXTURES] = new WadContent(WTEXTURES);
 		content[WTEXTURES]->bytes += lump->size;
 		int32_t num(0);
-		std::memcpy(&num, bytes, 4);
+		std::memcpy(&num, sniff.start, 4);
 		content[WTEXTURES]->count += num;
 		return true;
 	}
 	return false;
 }
 
-bool WadStats::checkPng(DirEntry* lump, char* bytes, WadContentType t)
+bool WadStats::checkPng(DirEntry* lump, const LumpSniff& sniff, WadContentType t)
 {
-	if (bytes[0]==0x89 && bytes[1]==0x50 && bytes[2]==0x4e && bytes[3]==0x47) {
+	if (sniff.is(LFMT_PNG)) {
 		if (content[t] == NULL)
 			content[t] = new WadContent(t);
 		content[t]->addLump(lump);
@@ -1126,9 +1150,9 @@ bool WadStats::checkPng(DirEntry* lump, char* bytes, WadContentType t)
 	}
 }
 
-bool WadStats::checkJpg(DirEntry* lump, char* bytes)
+bool WadStats::checkJpg(DirEntry* lump, const LumpSniff& sniff)
 {
-	if (bytes[0]==0xff && bytes[1]==0xd8 && bytes[2]==0xff) {
+	if (sniff.is(LFMT_JPG)) {
 		if (content[WGFX] == NULL)
 			content[WGFX] = new WadContent(WGFX);
 		content[WGFX]->addLump(lump);
@@ -1140,9 +1164,9 @@ bool WadStats::checkJpg(DirEntry* lump, char* bytes)
 	}
 }
 
-bool WadStats::checkBmp(DirEntry* lump, char* bytes)
+bool WadStats::checkBmp(DirEntry* lump, const LumpSniff& sniff)
 {
-	if (bytes[0]=='B' && bytes[1]=='M' && bytes[2]=='6') {
+	if (sniff.is(LFMT_BMP)) {
 		if (content[WGFX] == NULL)
 			content[WGFX] = new WadContent(WGFX);
 		content[WGFX]->addLump(lump);
@@ -1154,23 +1178,20 @@ bool WadStats::checkBmp(DirEntry* lump, char* bytes)
 	}
 }
 
-bool WadStats::checkFon12(DirEntry* lump, char* bytes)
+bool WadStats::checkFon12(DirEntry* lump, const LumpSniff& sniff)
 {
 	//Starts with "FON1" or "FON2"
-	if (bytes[0] != 0x46) return false;
-	if (bytes[1] != 0x4f) return false;
-	if (bytes[2] != 0x4e) return false;
-	if ((bytes[3]!=0x31) && (bytes[3]!=0x32)) return false;
+	if (!sniff.is(LFMT_FONT)) return false;
 	if (content[WFONT] == NULL)
 		content[WFONT] = new WadContent(WFONT);
 	content[WFONT]->addLump(lump);
 	return true;
 }
 
-bool WadStats::checkMus(DirEntry* lump, char* bytes)
+bool WadStats::checkMus(DirEntry* lump, const LumpSniff& sniff)
 {
 	//Starts with "MUS" + 0x1A
-	if (bytes[0]==0x4d && bytes[1]==0x55 && bytes[2]==0x53 && bytes[3]==0x1a) {
+	if (sniff.is(LFMT_MUS)) {
 		if (content[WMUS] == NULL)
 			content[WMUS] = new WadContent(WMUS);
 		content[WMUS]->addLump(lump);
@@ -1180,10 +1201,10 @@ bool WadStats::checkMus(DirEntry* lump, char* bytes)
 	}
 }
 
-bool WadStats::checkMidi(DirEntry* lump, char* bytes)
+bool WadStats::checkMidi(DirEntry* lump, const LumpSniff& sniff)
 {
 	//Starts with "MThd"
-	if (bytes[0]==0x4d && bytes[1]==0x54 && bytes[2]==0x68 && bytes[3]==0x64) {
+	if (sniff.is(LFMT_MIDI)) {
 		if (content[WMIDI] == NULL)
 			content[WMIDI] = new WadContent(WMIDI);
 		content[WMIDI]->addLump(lump);
@@ -1195,24 +1216,10 @@ bool WadStats::checkMidi(DirEntry* lump, char* bytes)
 	}
 }
 
-bool WadStats::checkMp3Ogg(DirEntry* lump, char* bytes)
+bool WadStats::checkMp3Ogg(DirEntry* lump, const LumpSniff& sniff)
 {
-	//Starts with "ID3"
-	if (bytes[0]=='I' && bytes[1]=='D' && bytes[2]=='3') {
-		if (content[WOTHERMUS] == NULL)
-			content[WOTHERMUS] = new WadContent(WOTHERMUS);
-		content[WOTHERMUS]->addLump(lump);
-		if (engine<DENG_LIMITREM)
-			engine=DENG_LIMITREM;
-		return true;
-	} else if (bytes[0]==0xff && (bytes[1]==0xfa || bytes[1]==0xfb || bytes[1]==0xf3)) { //MP3
-		if (content[WOTHERMUS] == NULL)
-			content[WOTHERMUS] = new WadContent(WOTHERMUS);
-		content[WOTHERMUS]->addLump(lump);
-		if (engine<DENG_LIMITREM)
-			engine=DENG_LIMITREM;
-		return true;
-	} else if (bytes[0]=='O' && bytes[1]=='g' && bytes[2]=='g' && bytes[3]=='S') {
+	//Starts with "ID3", MP3 frame sync or "OggS"
+	if (sniff.is(LFMT_MP3) || sniff.is(LFMT_OGG)) {
 		if (content[WOTHERMUS] == NULL)
 			content[WOTHERMUS] = new WadContent(WOTHERMUS);
 		content[WOTHERMUS]->addLump(lump);
@@ -1224,23 +1231,20 @@ bool WadStats::checkMp3Ogg(DirEntry* lump, char* bytes)
 	}
 }
 
-bool WadStats::checkSfx(DirEntry* lump, char* bytes)
+bool WadStats::checkSfx(DirEntry* lump, const LumpSniff& sniff)
 {
-	uint16_t val(0);
-	std::memcpy(&val, bytes, 2);
-	if (val != 3) return false;
-	std::memcpy(&val, bytes+2, 2);
-	if (val < 5500) return false;
+	//Format 3, sample rate at least 5500
+	if (!sniff.is(LFMT_SFX)) return false;
 	if (content[WSFX] == NULL)
 		content[WSFX] = new WadContent(WSFX);
 	content[WSFX]->addLump(lump);
 	return true;
 }
 
-bool WadStats::checkWav(DirEntry* lump, char* bytes)
+bool WadStats::checkWav(DirEntry* lump, const LumpSniff& sniff)
 {
 	//Starts with "RIFF"
-	if (bytes[0]==0x52 && bytes[1]==0x49 && bytes[2]==0x46 && bytes[3]==0x46) {
+	if (sniff.is(LFMT_WAV)) {
 		if (content[WWAV] == NULL)
 			content[WWAV] = new WadContent(WWAV);
 		content[WWAV]->addLump(lump);
@@ -1252,10 +1256,10 @@ bool WadStats::checkWav(DirEntry* lump, char* bytes)
 	}
 }
 
-bool WadStats::checkFlac(DirEntry* lump, char* bytes)
+bool WadStats::checkFlac(DirEntry* lump, const LumpSniff& sniff)
 {
 	//Starts with "fLaC"
-	if (bytes[0]==0x66 && bytes[1]==0x4c && bytes[2]==0x61 && bytes[3]==0x43) {
+	if (sniff.is(LFMT_FLAC)) {
 		if (content[WOTHERSND] == NULL)
 			content[WOTHERSND] = new WadContent(WOTHERSND);
 		content[WOTHERSND]->addLump(lump);
@@ -1267,23 +1271,20 @@ bool WadStats::checkFlac(DirEntry* lump, char* bytes)
 	}
 }
 
-bool WadStats::checkPcs(DirEntry* lump, char* bytes)
+bool WadStats::checkPcs(DirEntry* lump, const LumpSniff& sniff)
 {
-	int16_t val(0);
-	std::memcpy(&val, bytes, 2);
-	if (val != 0) return false;
-	std::memcpy(&val, bytes+2, 2);
-	if (lump->size != (val+4)) return false;
+	//0, followed by sample count
+	if (!sniff.is(LFMT_SPEAKER)) return false;
 	if (content[WSPEAKER] == NULL)
 		content[WSPEAKER] = new WadContent(WSPEAKER);
 	content[WSPEAKER]->addLump(lump);
 	return true;
 }
 
-bool WadStats::checkAcs(DirEntry* lump, char* bytes)
+bool WadStats::checkAcs(DirEntry* lump, const LumpSniff& sniff)
 {
 	//Starts with "ACS"
-	if (bytes[0]=='A' && bytes[1]=='C' && bytes[2]=='S') {
+	if (sniff.is(LFMT_ACS)) {
 		if (content[WACS] == NULL)
 			content[WACS] = new WadContent(WACS);
 		content[WACS]->addLump(lump);
@@ -43,11 +43,13 @@
 #include <wx/stream.h>
 #include <wx/wfstream.h>
 #include "DataModel.h"
+#include "LumpNames.h"
+#include "LumpSignature.h"
 #include "MapinfoParser.h"
 #include "IncludeParser.h"
 #include "DecorateParser.h"
 #include "TaskProgress.h"
-#include "../gui/GuiBase.h"
+#include "CoreBase.h"
 #include "../TextReport.h"
 
 
@@ -391,71 +393,76 @@ class WadStats
 		/*! Register wad error, adding to content[WERROR]. */
 		void lumpError(wxString error, DirEntry* lump);
 
-		/*! Process DirEntry of size 0. */
-		void processMarkerLump(DirEntry* lump, const wxString& lname);
+		/*! Process DirEntry of size 0, with the packed lump name. */
+		void processMarkerLump(DirEntry* lump, LumpCode code);
 
 		/*! Process map marker lump. */
 		void mapMarker(DirEntry* lump);
 
 		/*!
 		* Process DirEntry, categorizing it. Most entries are processed by
-		* DirEntry alone, but for some entries we read the first few bytes for
-		* additional info, from the provided stream. The stream must be seekable,
-		* but need not be buffered, since we seek to the offset found in the
-		* DirEntry and only read a few bytes (so a buffer will be wasted).
+		* DirEntry alone, but for others we read the start of the lump once
+		* (see readSignature), from the provided stream. The stream must be
+		* seekable, but need not be buffered, since we seek to the offset found
+		* in the DirEntry and only read the start (so a buffer will be wasted).
 		*/
 		void processLump(DirEntry* lump, wxInputStream* file);
 
-		/*! Process DirEntry name, checking if lname matches special lump names. */
-		bool processLumpName(DirEntry* lump, const wxString& lname);
+		/*! Process DirEntry name, checking if the packed name matches special lump names. */
+		bool processLumpName(DirEntry* lump, LumpCode code);
 
 		/*! Checks for more rare lump names, such as stuff from iwads of other games. */
-		bool processLumpName2(DirEntry* lump, const wxString& lname);
+		bool processLumpName2(DirEntry* lump, LumpCode code);
 
 		/*!
-		* Check if lump is Doom-format image, adding it to stats of t.
-		* The wxInputStream must be seekable.
+		* Read the start of the lump from the stream, which must be seekable,
+		* and match it against known formats with sniffLump. Only the bytes
+		* of the magic numbers are read, and the column offsets if the lump
+		* can be a Doom picture.
 		*/
-		bool checkPicture(DirEntry* lump, wxInputStream* file, WadContentType t);
+		LumpSniff readSignature(DirEntry* lump, wxInputStream* file);
 
-		/*! Check for patch and texture lists, from DirEntry and first 4 bytes. */
-		bool checkTexLists(DirEntry* lump, const wxString& lname, char* bytes);
+		/*! Check if lump is Doom-format image, adding it to stats of t. */
+		bool checkPicture(DirEntry* lump, const LumpSniff& sniff, WadContentType t);
 
-		/*! Check if lump is PNG image, from DirEntry and first 4 bytes. */
-		bool checkPng(DirEntry* lump, char* bytes, WadContentType t);
+		/*! Check for patch and texture lists, from DirEntry and lump signature. */
+		bool checkTexLists(DirEntry* lump, LumpCode code, const LumpSniff& sniff);
 
-		/*! Check if lump is JPG image, from DirEntry and first 4 bytes. */
-		bool checkJpg(DirEntry* lump, char* bytes);
+		/*! Check if lump is PNG image, from DirEntry and lump signature. */
+		bool checkPng(DirEntry* lump, const LumpSniff& sniff, WadContentType t);
 
-		/*! Check if lump is BMP image, from DirEntry and first 4 bytes. */
-		bool checkBmp(DirEntry* lump, char* bytes);
+		/*! Check if lump is JPG image, from DirEntry and lump signature. */
+		bool checkJpg(DirEntry* lump, const LumpSniff& sniff);
 
-		/*! Check if font lump FON1 or FON2, from DirEntry and first 4 bytes. */
-		bool checkFon12(DirEntry* lump, char* bytes);
+		/*! Check if lump is BMP image, from DirEntry and lump signature. */
+		bool checkBmp(DirEntry* lump, const LumpSniff& sniff);
 
-		/*! Check if lump is Doom-format music, from DirEntry and first 4 bytes. */
-		bool checkMus(DirEntry* lump, char* bytes);
+		/*! Check if font lump FON1 or FON2, from DirEntry and lump signature. */
+		bool checkFon12(DirEntry* lump, const LumpSniff& sniff);
 
-		/*! Check if lump is midi music, from DirEntry and first 4 bytes. */
-		bool checkMidi(DirEntry* lump, char* bytes);
+		/*! Check if lump is Doom-format music, from DirEntry and lump signature. */
+		bool checkMus(DirEntry* lump, const LumpSniff& sniff);
 
-		/*! Check if lump is mp3 or Ogg Vorbis, from DirEntry and first 4 bytes. */
-		bool checkMp3Ogg(DirEntry* lump, char* bytes);
+		/*! Check if lump is midi music, from DirEntry and lump signature. */
+		bool checkMidi(DirEntry* lump, const LumpSniff& sniff);
 
-		/*! Check if lump is Doom-format sound sample, from DirEntry and first 4 bytes. */
-		bool checkSfx(DirEntry* lump, char* bytes);
+		/*! Check if lump is mp3 or Ogg Vorbis, from DirEntry and lump signature. */
+		bool checkMp3Ogg(DirEntry* lump, const LumpSniff& sniff);
 
-		/*! Check if lump is Wav-format sound sample, from DirEntry and first 4 bytes. */
-		bool checkWav(DirEntry* lump, char* bytes);
+		/*! Check if lump is Doom-format sound sample, from DirEntry and lump signature. */
+		bool checkSfx(DirEntry* lump, const LumpSniff& sniff);
 
-		/*! Check if lump is FLAC sound sample, from DirEntry and first 4 bytes. */
-		bool checkFlac(DirEntry* lump, char* bytes);
+		/*! Check if lump is Wav-format sound sample, from DirEntry and lump signature. */
+		bool checkWav(DirEntry* lump, const LumpSniff& sniff);
 
-		/*! Check if lump is PC speaker soundfx, from DirEntry and first 4 bytes. */
-		bool checkPcs(DirEntry* lump, char* bytes);
+		/*! Check if lump is FLAC sound sample, from DirEntry and lump signature. */
+		bool checkFlac(DirEntry* lump, const LumpSniff& sniff);
 
-		/*! Check if lump is compiled ACS script, from DirEntry and first 4 bytes. */
-		bool checkAcs(DirEntry* lump, char* bytes);
+		/*! Check if lump is PC speaker soundfx, from DirEntry and lump signature. */
+		bool checkPcs(DirEntry* lump, const LumpSniff& sniff);
+
+		/*! Check if lump is compiled ACS script, from DirEntry and lump signature. */
+		bool checkAcs(DirEntry* lump, const LumpSniff& sniff);
 
 		/*! Parse lump of given type for #includes, moving referenced lumps from WUNKNOWN to wct. */
 		void findLumpIncludes(WadContentType wct, TaskProgress* progress);
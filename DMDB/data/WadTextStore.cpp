@@ -0,0 +1,399 @@
+/*
+* WadTextStore implementation
+*/
+
+#include "WadTextStore.h"
+#include "CoreBase.h" //For GuiError
+#include <algorithm>
+#include <cstring>
+#include "MemoryUsage.h"
+
+bool slot_comp(const pair<string,WadTextSlot>& s1, const pair<string,WadTextSlot>& s2)
+{
+	return s1.second.offset < s2.second.offset;
+}
+
+WadTextStore::WadTextStore(const wxString& filePath)
+: path(filePath), file(NULL), dirOffset(5), fileEnd(5), unused(0)
+{
+	slots = new map<string, WadTextSlot>();
+}
+
+WadTextStore::~WadTextStore()
+{
+	close();
+	delete slots;
+}
+
+bool WadTextStore::open()
+{
+	if (file != NULL)
+		return true;
+	slots->clear();
+	unused = 0;
+	bool existed = wxFile::Exists(path);
+	if (!existed) {
+		wxLogVerbose("Creating wad text file %s", path);
+		wxFile newFile(path, wxFile::write);
+		if (!newFile.IsOpened()) throw GuiError("Couldn't create file.", path);
+		unsigned char header[9];
+		header[0] = WADTEXT_FILEV;
+		uint32_t val = 5; //Directory offset
+		memcpy(header+1, &val, 4);
+		val = 0; //Empty directory
+		memcpy(header+5, &val, 4);
+		if (newFile.Write(header, 9) != 9 || !newFile.Close())
+			throw GuiError("Couldn't write to file.", path);
+	}
+	file = new wxFile(path, wxFile::read_write);
+	if (!file->IsOpened()) {
+		delete file;
+		file = NULL;
+		throw GuiError("Couldn't open file.", path);
+	}
+	unsigned char ch;
+	file->Read(&ch, 1);
+	if (ch != WADTEXT_FILEV)
+		throw GuiError("Wad text file has unsupported version number", path);
+	readDirectory();
+	wxLogVerbose("Opened wad text file with %i records, %i bytes unused", slots->size(), unused);
+	return existed;
+}
+
+void WadTextStore::readDirectory()
+{
+	slots->clear();
+	file->Seek(1, wxFromStart);
+	file->Read(&dirOffset, 4);
+	file->Seek(dirOffset, wxFromStart);
+	uint32_t count;
+	if (file->Read(&count, 4) < 4)
+		throw GuiError("Wad text file has no directory", path);
+	uint32_t used = 0;
+	char md5[32];
+	WadTextSlot slot;
+	for (uint32_t i=0; i<count; i++) {
+		file->Read(md5, 32);
+		file->Read(&slot.offset, 4);
+		if (file->Read(&slot.length, 4) < 4)
+			throw GuiError("Wad text file directory is truncated", path);
+		(*slots)[string(md5, 32)] = slot;
+		used += slot.length;
+	}
+	//Anything after the directory is left from an interrupted write
+	fileEnd = file->Length();
+	unused = fileEnd - 5 - used - (4 + count*40);
+}
+
+void WadTextStore::close()
+{
+	if (file == NULL)
+		return;
+	if (unused > WADTEXT_COMPACT && unused > dirOffset/2) {
+		compact();
+	} else {
+		file->Close();
+		delete file;
+		file = NULL;
+	}
+}
+
+bool WadTextStore::hasText(const string& md5)
+{
+	return slots->find(md5) != slots->end();
+}
+
+size_t WadTextStore::getBytes()
+{
+	//Each key is a 32-character MD5 string
+	size_t bytes = MemoryUsage::heapBlock(sizeof(*slots));
+	bytes += slots->size() * (MemoryUsage::treeNode(sizeof(pair<const string,WadTextSlot>))
+		+ MemoryUsage::stringHeap(32));
+	return bytes;
+}
+
+bool WadTextStore::readText(WadText* wt)
+{
+	map<string, WadTextSlot>::iterator it = slots->find(wt->wadMd5);
+	if (it == slots->end())
+		return false;
+	readRecord(it->second, wt);
+	return true;
+}
+
+int WadTextStore::readTexts(vector<WadText*>& texts)
+{
+	vector<pair<uint32_t,WadText*> > toRead;
+	for (vector<WadText*>::iterator it=texts.begin(); it!=texts.end(); ++it) {
+		map<string, WadTextSlot>::iterator sit = slots->find((*it)->wadMd5);
+		if (sit != slots->end())
+			toRead.push_back(pair<uint32_t,WadText*>(sit->second.offset, *it));
+	}
+	sort(toRead.begin(), toRead.end());
+	for (vector<pair<uint32_t,WadText*> >::iterator it=toRead.begin(); it!=toRead.end(); ++it)
+		readRecord((*slots)[it->second->wadMd5], it->second);
+	return toRead.size();
+}
+
+void WadTextStore::writeText(WadText* wt)
+{
+	map<string, WadTextSlot>::iterator it = slots->find(wt->wadMd5);
+	if (it != slots->end()) {
+		unused += it->second.length;
+		slots->erase(it);
+	}
+	try {
+		if (wt->hasText())
+			appendRecord(wt);
+	} catch (GuiError& err) {
+		readDirectory();
+		throw;
+	}
+	writeDirectory();
+	wt->changed = false;
+}
+
+bool WadTextStore::removeText(const string& md5)
+{
+	map<string, WadTextSlot>::iterator it = slots->find(md5);
+	if (it == slots->end())
+		return false;
+	unused += it->second.length;
+	slots->erase(it);
+	writeDirectory();
+	return true;
+}
+
+bool WadTextStore::renameText(const string& oldMd5, const string& newMd5)
+{
+	map<string, WadTextSlot>::iterator it = slots->find(oldMd5);
+	if (it == slots->end())
+		return false;
+	WadTextSlot slot = it->second;
+	slots->erase(it);
+	it = slots->find(newMd5);
+	if (it != slots->end())
+		unused += it->second.length;
+	(*slots)[newMd5] = slot;
+	writeDirectory();
+	return true;
+}
+
+void WadTextStore::findText(const wxString& sub, vector<string>& result)
+{
+	vector<pair<string,WadTextSlot> > sorted;
+	sortedSlots(sorted);
+	for (vector<pair<string,WadTextSlot> >::iterator it=sorted.begin(); it!=sorted.end(); ++it) {
+		WadText wt(it->first);
+		readRecord(it->second, &wt);
+		for (map<string,wxString>::iterator eit=wt.entries->begin(); eit!=wt.entries->end(); ++eit) {
+			if (eit->second.Length()>=sub.Length() && eit->second.Lower().Find(sub)!=wxNOT_FOUND) {
+				result.push_back(it->first);
+				break;
+			}
+		}
+	}
+}
+
+int WadTextStore::importFolder(const wxString& folder)
+{
+	if (!wxDirExists(folder))
+		return 0;
+	wxArrayString files;
+	wxDir::GetAllFiles(folder, &files, "*.txt", wxDIR_FILES);
+	int count = 0;
+	for (size_t i=0; i<files.GetCount(); i++) {
+		wxFileName fname(files[i]);
+		string md5str = fname.GetName().ToStdString();
+		if (md5str.length()!=32 || hasText(md5str))
+			continue;
+		wxTextFile tFile(files[i]);
+		if (!tFile.Open()) {
+			wxLogVerbose("Couldn't open text file %s", files[i]);
+			continue;
+		}
+		WadText wt(md5str);
+		wxString line;
+		wxString entryName = "";
+		wxString entry = "";
+		for ( line=tFile.GetFirstLine(); !tFile.Eof(); line=tFile.GetNextLine() ) {
+			if (line.StartsWith("$")) {
+				//Marks next entry
+				if (entryName.Length() > 0) {
+					//Store last entry
+					wt.setText(entryName.ToStdString(), entry);
+					entryName.Clear();
+					entry.Clear();
+				}
+				line.StartsWith("$", &entryName); //Gets rest of line
+			} else {
+				//Add to current entry
+				entry.Append(line);
+			}
+		}
+		if (entryName.Length() > 0) {
+			//Store last entry
+			wt.setText(entryName.ToStdString(), entry);
+		}
+		tFile.Close();
+		if (wt.hasText()) {
+			try {
+				appendRecord(&wt);
+			} catch (GuiError& err) {
+				readDirectory();
+				throw;
+			}
+			count++;
+		}
+	}
+	writeDirectory();
+	wxLogVerbose("Imported %i wad text files from %s", count, folder);
+	return count;
+}
+
+void WadTextStore::readRecord(const WadTextSlot& slot, WadText* wt)
+{
+	if (slot.length < 2)
+		return;
+	char* buf = new char[slot.length];
+	file->Seek(slot.offset, wxFromStart);
+	if (file->Read(buf, slot.length) < (ssize_t)slot.length) {
+		delete[] buf;
+		throw GuiError("Wad text file is truncated", path);
+	}
+	uint32_t pos = 0;
+	uint16_t count = *((uint16_t*)buf);
+	pos += 2;
+	uint16_t keyLen;
+	uint32_t textLen;
+	for (int i=0; i<count && pos+6<=slot.length; i++) {
+		keyLen = *((uint16_t*)(buf+pos));
+		pos += 2;
+		if (pos+keyLen+4 > slot.length)
+			break; //Corrupt record
+		string key(buf+pos, keyLen);
+		pos += keyLen;
+		textLen = *((uint32_t*)(buf+pos));
+		pos += 4;
+		if (textLen > slot.length-pos)
+			break;
+		(*(wt->entries))[key] = wxString::FromUTF8(buf+pos, textLen);
+		pos += textLen;
+	}
+	delete[] buf;
+	wt->changed = false;
+}
+
+void WadTextStore::writeData(const void* data, size_t length)
+{
+	if (file->Write(data, length) != length)
+		throw GuiError("Couldn't write to file.", path);
+}
+
+void WadTextStore::appendRecord(WadText* wt)
+{
+	wxMemoryBuffer record;
+	uint16_t count = wt->entries->size();
+	record.AppendData(&count, 2);
+	for (map<string,wxString>::iterator it=wt->entries->begin(); it!=wt->entries->end(); ++it) {
+		uint16_t keyLen = it->first.length();
+		record.AppendData(&keyLen, 2);
+		record.AppendData(it->first.data(), keyLen);
+		wxScopedCharBuffer text = it->second.utf8_str();
+		uint32_t textLen = text.length();
+		record.AppendData(&textLen, 4);
+		record.AppendData(text.data(), textLen);
+	}
+	WadTextSlot slot;
+	slot.offset = fileEnd;
+	slot.length = record.GetDataLen();
+	file->Seek(fileEnd, wxFromStart);
+	writeData(record.GetData(), slot.length);
+	fileEnd += slot.length;
+	(*slots)[wt->wadMd5] = slot;
+}
+
+void WadTextStore::writeDirectory()
+{
+	wxMemoryBuffer dir;
+	uint32_t count = slots->size();
+	dir.AppendData(&count, 4);
+	uint32_t used = 0;
+	for (map<string, WadTextSlot>::iterator it=slots->begin(); it!=slots->end(); ++it) {
+		dir.AppendData(it->first.data(), 32);
+		dir.AppendData(&(it->second.offset), 4);
+		dir.AppendData(&(it->second.length), 4);
+		used += it->second.length;
+	}
+	//The header is changed last, when the new directory is on disk
+	uint32_t newOffset = fileEnd;
+	try {
+		file->Seek(newOffset, wxFromStart);
+		writeData(dir.GetData(), dir.GetDataLen());
+		if (!file->Flush())
+			throw GuiError("Couldn't write to file.", path);
+		file->Seek(1, wxFromStart);
+		writeData(&newOffset, 4);
+		if (!file->Flush())
+			throw GuiError("Couldn't write to file.", path);
+	} catch (GuiError& err) {
+		readDirectory();
+		throw;
+	}
+	dirOffset = newOffset;
+	fileEnd = newOffset + dir.GetDataLen();
+	unused = fileEnd - 5 - used - dir.GetDataLen();
+}
+
+void WadTextStore::sortedSlots(vector<pair<string,WadTextSlot> >& sorted)
+{
+	sorted.assign(slots->begin(), slots->end());
+	sort(sorted.begin(), sorted.end(), slot_comp);
+}
+
+void WadTextStore::compact()
+{
+	wxLogVerbose("Compacting wad text file, %i of %i bytes unused", unused, dirOffset);
+	vector<pair<string,WadTextSlot> > sorted;
+	sortedSlots(sorted);
+	//The old file is only replaced when the new one is complete
+	wxTempFile* tempFile = new wxTempFile(path);
+	bool ok = tempFile->IsOpened();
+	ok = ok && tempFile->Write(&WADTEXT_FILEV, 1);
+	uint32_t offs = 5;
+	ok = ok && tempFile->Write(&offs, 4); //Directory offset, written when known
+	for (vector<pair<string,WadTextSlot> >::iterator it=sorted.begin(); ok && it!=sorted.end(); ++it) {
+		char* buf = new char[it->second.length];
+		file->Seek(it->second.offset, wxFromStart);
+		ok = (file->Read(buf, it->second.length) == (ssize_t)it->second.length);
+		ok = ok && tempFile->Write(buf, it->second.length);
+		delete[] buf;
+		(*slots)[it->first].offset = offs;
+		offs += it->second.length;
+	}
+	uint32_t count = slots->size();
+	ok = ok && tempFile->Write(&count, 4);
+	for (map<string, WadTextSlot>::iterator it=slots->begin(); ok && it!=slots->end(); ++it) {
+		ok = tempFile->Write(it->first.data(), 32)
+			&& tempFile->Write(&(it->second.offset), 4)
+			&& tempFile->Write(&(it->second.length), 4);
+	}
+	ok = ok && tempFile->Seek(1, wxFromStart)!=wxInvalidOffset;
+	ok = ok && tempFile->Write(&offs, 4);
+	file->Close();
+	delete file;
+	file = NULL;
+	if (ok)
+		ok = tempFile->Commit();
+	else
+		tempFile->Discard();
+	delete tempFile;
+	if (!ok) {
+		//The store is closed, and the directory is read again from the old file
+		wxLogVerbose("Failed compacting wad text file, keeping it as it was");
+		return;
+	}
+	dirOffset = offs;
+	unused = 0;
+	wxLogVerbose("Compacted wad text file, new dir offset is %i", dirOffset);
+}
@@ -0,0 +1,158 @@
+/*!
+* \file WadTextStore.h
+* \author Lars Thomas Boye 2020
+*
+* WadTextStore keeps the WadText of all wads in one packed file,
+* indexed by wad MD5.
+*/
+
+#ifndef WADTEXTSTORE_H
+#define WADTEXTSTORE_H
+
+//Include wxWidgets headers:
+#include "wx/wxprec.h"
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <wx/file.h>
+#include <wx/textfile.h>
+#include <wx/dir.h>
+#include <wx/filename.h>
+#include "DataModel.h"
+
+/*! Version of file format for wad text file. */
+const unsigned char WADTEXT_FILEV = 1;
+
+/*! Unused bytes in wad text file before it is compacted on close. */
+const uint32_t WADTEXT_COMPACT = 100000;
+
+/*! Location of the record of a wad in the wad text file. */
+struct WadTextSlot
+{
+	uint32_t offset;
+	uint32_t length;
+};
+
+/*!
+* WadTextStore is a single file holding the text entries of all wads,
+* replacing one text file per wad. The file starts with a version byte
+* and the offset of the directory. Then follows a record for each wad,
+* with the number of text entries and then the key (uint16 length and
+* UTF-8) and text (uint32 length and UTF-8) of each entry. The directory
+* at the end has the number of records, then the MD5 hex string, offset
+* and length of each record.
+*
+* The directory is read into memory when the store is opened, while
+* records are read from the open file only when requested. A changed
+* record is appended after the end of the file, followed by a new
+* directory, and the header is only pointed at the new directory when
+* both have been written and flushed. Until then the old directory and
+* records are untouched, so an interrupted write loses only the change.
+* Old records and directories are left as unused space. The file is
+* compacted when it is closed, if much of it is unused. Writes which
+* fail throw GuiError, and the directory is then read back from the
+* file, so that it matches what is stored.
+*
+* readTexts and findText process many records in file order, so that
+* browsing or searching all wad descriptions is done in one pass over
+* one file. importFolder migrates the old folder of <md5>.txt files.
+*/
+class WadTextStore
+{
+	public:
+	/*! The store uses the file at filePath, created by open if it doesn't exist. */
+	WadTextStore(const wxString& filePath);
+
+	/*! Closes the file. */
+	~WadTextStore();
+
+	/*!
+	* Open the file and read the directory. Returns false if the file
+	* did not exist, and was created empty.
+	*/
+	bool open();
+
+	/*! Close the file, compacting it if needed. */
+	void close();
+
+	/*! Number of wads with text. */
+	unsigned int size() { return slots->size(); }
+
+	/*! Estimated bytes of the directory in memory. */
+	size_t getBytes();
+
+	/*! true if there is a record for the wad. */
+	bool hasText(const string& md5);
+
+	/*!
+	* Read the entries for wt->wadMd5 into wt. Returns false if there
+	* is no record for the wad.
+	*/
+	bool readText(WadText* wt);
+
+	/*!
+	* Read the entries of each of the WadText objects, which should be
+	* empty, in file order. Returns the number of objects with text.
+	*/
+	int readTexts(vector<WadText*>& texts);
+
+	/*!
+	* Persist the entries of wt, replacing any record for the wad. The
+	* record is removed if wt has no text.
+	*/
+	void writeText(WadText* wt);
+
+	/*! Remove the record for the wad, returning false if there is none. */
+	bool removeText(const string& md5);
+
+	/*! Move the record of a wad to a new MD5 (the wad file has changed). */
+	bool renameText(const string& oldMd5, const string& newMd5);
+
+	/*!
+	* Find wads with a text entry containing sub, which must be lower
+	* case. The MD5 of each such wad is added to result.
+	*/
+	void findText(const wxString& sub, vector<string>& result);
+
+	/*!
+	* Add records from the <md5>.txt files in a folder, as written by
+	* earlier versions. Wads which already have a record are skipped.
+	* Returns the number of files imported.
+	*/
+	int importFolder(const wxString& folder);
+
+	private:
+	/*! Read a record from file and add its entries to wt. */
+	void readRecord(const WadTextSlot& slot, WadText* wt);
+
+	/*! Read the directory from the header offset, replacing slots. */
+	void readDirectory();
+
+	/*! Write to file at the current position, throwing GuiError if not all is written. */
+	void writeData(const void* data, size_t length);
+
+	/*! Write a record for wt at fileEnd, without updating the directory. */
+	void appendRecord(WadText* wt);
+
+	/*!
+	* Write the directory at fileEnd, and then its offset in the header.
+	* Throws GuiError if a write fails, after reading back the directory.
+	*/
+	void writeDirectory();
+
+	/*! Slots in file order. */
+	void sortedSlots(vector<pair<string,WadTextSlot> >& sorted);
+
+	/*! Write a new file without unused space, and replace the old one. */
+	void compact();
+
+	wxString path; //File path
+	wxFile* file; //When open
+	map<string, WadTextSlot>* slots; //Directory, by MD5 hex string
+	uint32_t dirOffset; //Offset of current directory
+	uint32_t fileEnd; //End of file, where new records are written
+	uint32_t unused; //Bytes of old records and directories
+};
+
+#endif // WADTEXTSTORE_H
@@ -65,6 +65,7 @@ wxMenuBar* GuiMenubarManager::createMenubar(wxFrame* parent)
     //fileMenu->Append(LFILE_NEW, "New database\tCtrl+N");
     fileMenu->Append(LFILE_READ, "Read wad...\tCtrl+R");
     fileMenu->Append(LFILE_READALL, "Read folder...");
+    fileMenu->Append(LFILE_CANCELREAD, "Cancel reading");
     fileMenu->AppendCheckItem(LFILE_MODE, "Edit mode");
     fileMenu->AppendSeparator();
     fileMenu->Append(LDATA_PEOPLE, "People");
@@ -84,12 +85,16 @@ wxMenuBar* GuiMenubarManager::createMenubar(wxFrame* parent)
 	statsMenu->Append(LSTATS_PLAYST, "Statistics by playstyle");
 	statsMenu->Append(LSTATS_PEOPLE, "Statistics by authors");
 	statsMenu->Append(LSTATS_TAGS, "Statistics by tags");
+	statsMenu->Append(LSTATS_YEARENGINE, "Statistics by year and engine");
 	statsMenu->AppendSeparator();
 	statsMenu->Append(LSTATS_WTOTAL, "Wad statistics");
 	statsMenu->Append(LSTATS_WYEARS, "Statistics by year");
 	statsMenu->Append(LSTATS_WIWAD, "Statistics by Iwad");
 	statsMenu->Append(LSTATS_WENGINE, "Statistics by engine");
 	statsMenu->Append(LSTATS_WRATING, "Statistics by rating");
+	statsMenu->Append(LSTATS_WYEARENGINE, "Statistics by year and engine");
+	statsMenu->AppendSeparator();
+	statsMenu->Append(LSTATS_MEMORY, "Memory usage");
 
     //ThingDef menu:
 	wxMenu* toolsMenu=new wxMenu();
@@ -116,6 +121,7 @@ wxMenuBar* GuiMenubarManager::createMenubar(wxFrame* parent)
 
     parent->SetMenuBar(menuBar);
     currentMenubar=menuBar;
+    currentMenubar->Enable(LFILE_CANCELREAD, false);
     return menuBar;
 }
 
@@ -135,11 +141,24 @@ void GuiMenubarManager::enableItems(bool hasDB)
 	currentMenubar->Enable(LSTATS_PLAYST, hasDB);
 	currentMenubar->Enable(LSTATS_PEOPLE, hasDB);
 	currentMenubar->Enable(LSTATS_TAGS, hasDB);
+	currentMenubar->Enable(LSTATS_YEARENGINE, hasDB);
 	currentMenubar->Enable(LSTATS_WTOTAL, hasDB);
 	currentMenubar->Enable(LSTATS_WYEARS, hasDB);
 	currentMenubar->Enable(LSTATS_WIWAD, hasDB);
 	currentMenubar->Enable(LSTATS_WENGINE, hasDB);
 	currentMenubar->Enable(LSTATS_WRATING, hasDB);
+	currentMenubar->Enable(LSTATS_WYEARENGINE, hasDB);
+	currentMenubar->Enable(LSTATS_MEMORY, hasDB);
+}
+
+void GuiMenubarManager::enableReadItems(bool reading)
+{
+	currentMenubar->Enable(LFILE_OPEN, !reading);
+	currentMenubar->Enable(LFILE_READ, !reading);
+	currentMenubar->Enable(LFILE_READALL, !reading);
+	currentMenubar->Enable(LFILE_CANCELREAD, reading);
+	currentMenubar->Enable(LFILE_CLOSE, !reading);
+	currentMenubar->Enable(LOPT_APPSETTINGS, !reading);
 }
 
 void GuiMenubarManager::enableWadItems(bool wadList)
@@ -149,6 +168,7 @@ void GuiMenubarManager::enableWadItems(bool wadList)
 	currentMenubar->Enable(LSTATS_WIWAD, wadList);
 	currentMenubar->Enable(LSTATS_WENGINE, wadList);
 	currentMenubar->Enable(LSTATS_WRATING, wadList);
+	currentMenubar->Enable(LSTATS_WYEARENGINE, wadList);
 }
 
 void GuiMenubarManager::setItemState(ApplicationMenuEvents toolId, bool newState)
@@ -232,6 +252,13 @@ void GuiToolbarManager::enableItems(bool hasDB)
 	currentToolbar->EnableTool(LDATA_TAGS, hasDB);
 }
 
+void GuiToolbarManager::enableReadItems(bool reading)
+{
+	currentToolbar->EnableTool(LFILE_READ, !reading);
+	currentToolbar->EnableTool(LFILE_READALL, !reading);
+	currentToolbar->EnableTool(LOPT_APPSETTINGS, !reading);
+}
+
 void GuiToolbarManager::setToolState(ApplicationMenuEvents toolId, bool newState)
 {
     if (toolId == LFILE_MODE) {
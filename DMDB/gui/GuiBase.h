@@ -34,13 +34,11 @@ using namespace std;
 #endif
 
 #include <wx/srchctrl.h>
+#include "../data/CoreBase.h"
 
 //Use native toolbar, not generic:
 #define USE_GENERIC_TBAR 0
 
-//Log name
-#define wxLOG_COMPONENT "dmdb"
-
 //Any application-specific declarations needed should be included here...
 
 
@@ -68,15 +66,7 @@ extern int SSHOT_HEIGHT; // = 480;
 wxString wxIntToString(int i); //!< Converts int to wxString
 wxString wxDoubleToString(double d, int decimals=5); //!< Converts floating-point number to wxString
 
-/*!
-* An error class to throw as exceptions, with two strings to hold information
-* on the error that can be shown in a dialog.
-*/
-struct GuiError
-{
-	wxString text1, text2;
-	GuiError(wxString s1, wxString s2 = "") { text1=s1; text2=s2; }
-};
+//GuiError is defined in CoreBase.h
 
 //Macros for custom event types:
 //DECLARE_EVENT_TYPE(wxEVT_MYEVENT, -1)
@@ -115,12 +105,15 @@ enum ApplicationMenuEvents {
 	BUTTON_TAGDEL,
 	BUTTON_PREVMAP,
 	BUTTON_NEXTMAP,
+	BUTTON_TIMING,
+	BUTTON_SAVE,
 	//File menu:
 	LFILE_NEW,		//!< Create empty database (not currently used)
 	LFILE_OPEN,		//!< Open a database (select folder)
 	LFILE_MODE,     //!< Toggle between edit and read-only mode
 	LFILE_READ,		//!< Read wad (Doom content file), possibly adding to database
 	LFILE_READALL,  //!< Read and add all content in folder
+	LFILE_CANCELREAD, //!< Cancel reading of folder running in background
 	LFILE_CLOSE,	//!< Close database (not currently used)
 	LFILE_EXIT,		//!< Close application
 	//Data menu:
@@ -143,11 +136,14 @@ enum ApplicationMenuEvents {
 	LSTATS_PLAYST,	//!< Categorized by playstyle
 	LSTATS_PEOPLE,	//!< Categorized by author
 	LSTATS_TAGS,	//!< Categorized by style tags
+	LSTATS_YEARENGINE, //!< Categorized by year and engine
 	LSTATS_WTOTAL,	//!< Uncategorized wad statistics
 	LSTATS_WYEARS,
 	LSTATS_WIWAD,
 	LSTATS_WENGINE,
 	LSTATS_WRATING,
+	LSTATS_WYEARENGINE,
+	LSTATS_MEMORY,	//!< Memory used by the database
 	//Options menu:
 	LOPT_TEST,		//!< Debug only
 	LOPT_APPSETTINGS, //!< Show dialog to set application settings
@@ -167,6 +163,9 @@ const int FRAME_SPLITTER = 202;	//!< Main frame splitter
 const int LVIEW_LIST = 203;	//!< List
 const int LVIEW_TREE = 204;	//!< Tree
 const int SEARCH_FIELD = 205; //!< Search control
+//206-209 and 212 are the worker thread events in CoreBase.h
+const int THREAD_IMAGELOADED = 210; //!< Image decoded by image cache thread
+const int STATS_FIELD = 211; //!< Field choice of statistics pivot table
 
 
 /*!
@@ -195,6 +194,10 @@ class GuiMenubarManager
 	//! Enables/disables toolbar items based on whether a database is loaded.
 	void enableItems(bool hasDB);
 
+	//! Call with true while a folder is read in the background, to disable other
+	//! reading and enable cancelling.
+	void enableReadItems(bool reading);
+
 	//! Call with true when we have a wad list, false when we have a map list.
 	void enableWadItems(bool wadList);
 
@@ -233,6 +236,9 @@ class GuiToolbarManager
 	//! Enables/disables toolbar items based on whether a database is loaded.
 	void enableItems(bool hasDB);
 
+	//! Disables toolbar items for reading while a folder is read in the background.
+	void enableReadItems(bool reading);
+
 	//The rest of the functions access specific items:
 	void setToolState(ApplicationMenuEvents toolId, bool newState); //!< Sets the state of a toggle tool
 	bool getToolState(ApplicationMenuEvents toolId); //!< Gets the on/off state of a toggle tool
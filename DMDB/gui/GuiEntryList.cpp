@@ -4,10 +4,13 @@
 GuiEntryList::GuiEntryList(wxWindow* parent, GuiEntryListener* l, ApplicationSettings* as)
 : wxListCtrl(parent,LVIEW_LIST,wxDefaultPosition, wxDefaultSize,
 			wxLC_REPORT|wxLC_VIRTUAL|wxLC_HRULES|wxLC_VRULES|wxLC_SINGLE_SEL),
-			settings(as), dataBase(NULL), listener(l), dataType(-1), searchChars(0)
+			settings(as), dataBase(NULL), listener(l), dataType(-1), searchChars(0), searchFrom(0), searchTo(-1),
+			lastDbid(0), lastRow(NULL)
 {
 	fields[0] = NULL;
 	fields[1] = NULL;
+	cellCache = new map<uint32_t, wxArrayString>();
+	cacheOrder = new list<uint32_t>();
 	SetSizeHints(wxSize(80,40));
 }
 
@@ -15,12 +18,15 @@ GuiEntryList::~GuiEntryList()
 {
 	if (fields[0] != NULL) delete fields[0];
 	if (fields[1] != NULL) delete fields[1];
+	delete cellCache;
+	delete cacheOrder;
 }
 
 void GuiEntryList::setDataManager(DataManager* dataMan)
 {
 	dataBase = dataMan;
 	ClearAll();
+	clearCache();
 	dataType = -1; //No current list
 }
 
@@ -86,17 +92,14 @@ void GuiEntryList::createList()
 {
 	if (dataBase==NULL) return;
 	ClearAll();
+	clearCache(); //Columns may have changed
 	//SetHeaderAttr(wxItemAttr(*wxBLACK, *wxLIGHT_GREY, *wxNORMAL_FONT));
 	//Only in newer versions of wxWidgets?
 	EntryListFields* fld = fields[dataType];
-	WadMapFields sfield = (dataType==0)? dataBase->getWadFilter()->sortField: dataBase->getMapFilter()->sortField;
 	for (int i=0; i<fld->fieldCount; i++) {
 		wxListItem col;
 		//col.SetId(i);
-		if (fld->fields[i] == sfield)
-			col.SetText(wxString("<")+wadMapLabels[fld->fields[i]]+">");
-		else
-			col.SetText(wadMapLabels[fld->fields[i]]);
+		col.SetText(columnLabel(fld->fields[i]));
 		col.SetWidth(fld->width[i]);
 		col.SetAlign(wxLIST_FORMAT_LEFT);
 		//col.SetTextColour(*wxRED);
@@ -119,6 +122,45 @@ void GuiEntryList::refreshList()
 		i = dataBase->getMapSize();
 	SetItemCount(i);
 	RefreshItems(0, i-1);
+	searchFrom = 0; //List may have changed
+	searchTo = -1;
+}
+
+void GuiEntryList::invalidateCells(int type, uint32_t dbid)
+{
+	if (type==0 && dataType==1) {
+		//Map rows can show wad fields, of any of the wad's maps
+		clearCache();
+		return;
+	}
+	if (type != dataType)
+		return;
+	if (dbid == 0) {
+		clearCache();
+	} else if (cellCache->erase(dbid) > 0) {
+		cacheOrder->remove(dbid);
+		lastRow = NULL;
+	}
+}
+
+void GuiEntryList::clearCache()
+{
+	cellCache->clear();
+	cacheOrder->clear();
+	lastRow = NULL;
+}
+
+wxString GuiEntryList::columnLabel(WadMapFields field)
+{
+	DataFilter* filter = (dataType==0)? dataBase->getWadFilter(): dataBase->getMapFilter();
+	int index = filter->getSortIndex(field);
+	if (index == -1)
+		return wadMapLabels[field];
+	bool rev = (index==0)? filter->sortReverse: filter->thenSort[index-1].reverse;
+	wxString label = rev? (wxString(">")+wadMapLabels[field]+"<"): (wxString("<")+wadMapLabels[field]+">");
+	if (index > 0)
+		label << (index+1);
+	return label;
 }
 
 void GuiEntryList::onSearchText(wxString sstr)
@@ -140,7 +182,12 @@ void GuiEntryList::onSearchText(wxString sstr)
 			else dataBase->setTextFilter("", FILTER_MAP);
 			refreshList();
 		}
-        int i = (dataType==0)? dataBase->getWadIndex(sstr): dataBase->getMapIndex(sstr);
+        if (sstr.Length() <= searchChars) { //Not adding to last search
+			searchFrom = 0;
+			searchTo = -1;
+        }
+        int i = (dataType==0)? dataBase->getWadIndex(sstr, &searchFrom, &searchTo):
+			dataBase->getMapIndex(sstr, &searchFrom, &searchTo);
         if (i > -1) {
 			EnsureVisible(i);
 			SetItemState(i, wxLIST_STATE_SELECTED, wxLIST_STATE_SELECTED);
@@ -161,13 +208,49 @@ void GuiEntryList::readFields(int type)
 
 wxString GuiEntryList::OnGetItemText(long item, long column) const
 {
+	wxArrayString* row = getRow(item);
+	if (row==NULL || column>=row->GetCount())
+		return "";
+	return (*row)[column];
+}
+
+wxArrayString* GuiEntryList::getRow(long item) const
+{
+	WadEntry* we = NULL;
+	MapEntry* me = NULL;
+	uint32_t dbid;
 	if (dataType==0) {
-		WadEntry* we = dataBase->getWad(item);
-		return dataBase->getWadField(we, fields[0]->fields[column]);
+		we = dataBase->getWad(item);
+		if (we == NULL) return NULL;
+		dbid = we->dbid;
 	} else {
-		MapEntry* me = dataBase->getMap(item);
-		return dataBase->getMapField(me, fields[1]->fields[column]);
+		me = dataBase->getMap(item);
+		if (me == NULL) return NULL;
+		dbid = me->dbid;
 	}
+	if (lastRow!=NULL && dbid==lastDbid)
+		return lastRow; //Same row as last cell
+	map<uint32_t, wxArrayString>::iterator it = cellCache->find(dbid);
+	if (it == cellCache->end()) {
+		//Format all cells of the row
+		EntryListFields* fld = fields[dataType];
+		wxArrayString cells;
+		for (int i=0; i<fld->fieldCount; i++) {
+			if (dataType==0)
+				cells.Add(dataBase->getWadField(we, fld->fields[i]));
+			else
+				cells.Add(dataBase->getMapField(me, fld->fields[i]));
+		}
+		if (cellCache->size() >= ENTRYLIST_CACHE) {
+			cellCache->erase(cacheOrder->front());
+			cacheOrder->pop_front();
+		}
+		it = cellCache->insert(pair<uint32_t, wxArrayString>(dbid, cells)).first;
+		cacheOrder->push_back(dbid);
+	}
+	lastDbid = dbid;
+	lastRow = &(it->second);
+	return lastRow;
 }
 
 wxListItemAttr* GuiEntryList::OnGetItemAttr(long item) const
@@ -184,6 +267,7 @@ BEGIN_EVENT_TABLE(GuiEntryList, wxListCtrl)
 	EVT_LIST_COL_CLICK(LVIEW_LIST, GuiEntryList::colClicked)
 	//EVT_LIST_COL_END_DRAG(LVIEW_LIST, GuiEntryList::colDragged)
 	EVT_LIST_BEGIN_DRAG(LVIEW_LIST, GuiEntryList::beginDrag)
+	EVT_LIST_CACHE_HINT(LVIEW_LIST, GuiEntryList::cacheHint)
 END_EVENT_TABLE()
 
 void GuiEntryList::itemActivated(wxListEvent& event)
@@ -267,36 +351,26 @@ void GuiEntryList::rightClick(wxListEvent& event)
 void GuiEntryList::colClicked(wxListEvent& event)
 {
 	int col = event.GetColumn();
+	WadMapFields field = fields[dataType]->fields[col];
+	DataFilter* filter = (dataType==0)? dataBase->getWadFilter(): dataBase->getMapFilter();
+	bool add = wxGetKeyState(WXK_SHIFT); //Sort on field after current fields
+	int index = filter->getSortIndex(field);
+	bool rev = false;
+	if (index == 0)
+		rev = !filter->sortReverse;
+	else if (index > 0 && add)
+		rev = !filter->thenSort[index-1].reverse;
 	bool ok;
-	WadMapFields oldField;
-	bool rev;
-	if (dataType==0) {
-		oldField = dataBase->getWadFilter()->sortField;
-		rev = dataBase->getWadFilter()->sortReverse;
-	} else {
-		oldField = dataBase->getMapFilter()->sortField;
-		rev = dataBase->getMapFilter()->sortReverse;
-	}
-	int oldCol = fields[dataType]->findIndex(oldField);
-	if (col == oldCol) rev = !rev;
-	else rev = false;
-	if (dataType==0) {
-		ok = dataBase->setWadSort(fields[0]->fields[col], rev);
-	} else {
-		ok = dataBase->setMapSort(fields[1]->fields[col], rev);
-	}
-	if (ok) { //Changed sort column
-		if (oldCol > -1) {
-			wxListItem old = wxListItem();
-			old.SetText(wadMapLabels[fields[dataType]->fields[oldCol]]);
-			SetColumn(oldCol, old);
+	if (dataType==0)
+		ok = add? dataBase->addWadSort(field, rev): dataBase->setWadSort(field, rev);
+	else
+		ok = add? dataBase->addMapSort(field, rev): dataBase->setMapSort(field, rev);
+	if (ok) { //Changed sorting
+		for (int i=0; i<fields[dataType]->fieldCount; i++) {
+			wxListItem item = wxListItem();
+			item.SetText(columnLabel(fields[dataType]->fields[i]));
+			SetColumn(i, item);
 		}
-		wxListItem item = wxListItem();
-		if (rev)
-			item.SetText(wxString(">")+wadMapLabels[fields[dataType]->fields[col]]+"<");
-		else
-			item.SetText(wxString("<")+wadMapLabels[fields[dataType]->fields[col]]+">");
-		SetColumn(col, item);
 		refreshList();
 	}
 	//item.SetWidth(fld->width[i]);
@@ -330,3 +404,15 @@ void GuiEntryList::beginDrag(wxListEvent& event)
 		wxDragResult result = dragSource.DoDragDrop(true);
 	}
 }
+
+void GuiEntryList::cacheHint(wxListEvent& event)
+{
+	if (dataBase==NULL || dataType<0)
+		return;
+	long from = event.GetCacheFrom() - ENTRYLIST_PREFETCH;
+	long to = event.GetCacheTo() + ENTRYLIST_PREFETCH;
+	if (from < 0) from = 0;
+	if (to >= GetItemCount()) to = GetItemCount()-1;
+	for (long i=from; i<=to; i++)
+		getRow(i);
+}
@@ -18,6 +18,7 @@
 #endif
 
 #include <list>
+#include <map>
 #include <wx/listctrl.h>
 #include <wx/msgdlg.h>
 #include <wx/dnd.h>
@@ -26,6 +27,12 @@
 #include "../data/DataModel.h"
 #include "../data/DataManager.h"
 
+/*! Maximum number of rows in the cell cache of GuiEntryList. */
+const unsigned int ENTRYLIST_CACHE = 1000;
+
+/*! Rows to format in advance on each side of the rows to be shown. */
+const long ENTRYLIST_PREFETCH = 50;
+
 /*!
 * Listener for events from the GuiEntryList (callbacks
 * on the selection of entries).
@@ -71,6 +78,17 @@ class GuiEntryListener
 * ApplicationSettings storing which columns to show and their widths.
 * Column widths and order can be changed directly in the list interface.
 * Currently only widths are persistent.
+*
+* Clicking a column header sorts on that field, or reverses the direction
+* if already sorted on it. Shift-clicking adds the field as a further sort
+* field, for entries equal in the fields before it. The header shows the
+* direction, and the position of further sort fields.
+*
+* The text of all columns of a row is formatted at once and kept in a cache
+* by dbid, so repainting doesn't go through the DataManager field formatting
+* for every cell. Rows around the visible part are formatted in advance on
+* cache hints from the list control. The owner must call invalidateCells when
+* entries change (see DataStatusListener::onEntryModified).
 */
 class GuiEntryList : public wxListCtrl
 {
@@ -104,6 +122,14 @@ class GuiEntryList : public wxListCtrl
 		/*! Update list content from database (when content may have changed). */
 		void refreshList();
 
+		/*!
+		* Remove cached cells of an entry of the given type (0 for wad, 1 for
+		* map), or of all entries of the type if dbid is 0. A wad change
+		* clears all cached map rows, as these can show wad fields. The list
+		* is not refreshed.
+		*/
+		void invalidateCells(int type, uint32_t dbid);
+
 		/*!
 		* Apply a search string to the list, going to the first matching entry
 		* or filtering out all non-matching entries.
@@ -116,6 +142,7 @@ class GuiEntryList : public wxListCtrl
 		void colClicked(wxListEvent& event); //!< Clicked header, for sorting
 		//void colDragged(wxListEvent& event);
 		void beginDrag(wxListEvent& event); //!< Drag'n'drop entry from list
+		void cacheHint(wxListEvent& event); //!< Rows about to be shown - prefetch cells
 
 	protected:
 		//Implementation for virtual list, provoding the cells when needed
@@ -125,6 +152,9 @@ class GuiEntryList : public wxListCtrl
 	private:
 		void createList(); //!< Create list of current dataType
 		void readFields(int type); //!< Read current column properties from UI
+		wxArrayString* getRow(long item) const; //!< Cells of row, formatting them if not cached
+		void clearCache(); //!< Remove all cached cells
+		wxString columnLabel(WadMapFields field); //!< Header text, with sort marks
 
 		ApplicationSettings* settings;
 		DataManager* dataBase;
@@ -132,6 +162,12 @@ class GuiEntryList : public wxListCtrl
 		EntryListFields* fields[2];
 		int dataType; //Index in fields, -1 for none
 		int searchChars; //Length of search string
+		long searchFrom; //Entries matching search string, for type-ahead
+		long searchTo; //End of matching entries, -1 for end of list
+		map<uint32_t, wxArrayString>* cellCache; //Formatted cells by dbid, for current type and columns
+		list<uint32_t>* cacheOrder; //dbids in cellCache, oldest first
+		mutable uint32_t lastDbid; //Entry of lastRow
+		mutable wxArrayString* lastRow; //Last row used, or NULL
 
 	//Macro for the event table
 	DECLARE_EVENT_TABLE()
@@ -22,7 +22,8 @@
 //wxFrame constructor sets window style.
 GuiFrame::GuiFrame(const wxString& title)
 : wxFrame(0, -1, title, wxDefaultPosition, wxDefaultSize, wxDEFAULT_FRAME_STYLE),
-logText(NULL), logNull(NULL), wadReader(NULL), dataBase(NULL),
+logText(NULL), logNull(NULL), wadReader(NULL), dataBase(NULL), imageCache(NULL), importJob(NULL),
+importDialog(NULL), importAdded(0), importMaps(0), importUpdated(0), importRefresh(false), importJoined(false),
 wadPanel(NULL), mapPanel(NULL), consoleText(NULL), editMode(false)
 {
 	//This constructor should create objects for handling settings and child
@@ -38,6 +39,8 @@ wadPanel(NULL), mapPanel(NULL), consoleText(NULL), editMode(false)
 	appSettings = new ApplicationSettings();
 	appSettings->loadConfig(configObject);
 	SSHOT_WIDTH = appSettings->getValue(IMG_WIDTH);
+	imageCache = new ImageCache();
+	GuiImagePanel::setImageCache(imageCache);
 	SSHOT_HEIGHT = appSettings->getValue(IMG_HEIGHT);
 	editMode = appSettings->getFlag(DB_EDITMODE);
 
@@ -226,7 +229,12 @@ void GuiFrame::setDatabase(const wxString& folder)
 
 	wadReader->setTempFolder(dataBase->getTempFolder());
 	wadReader->setFailedFolder(dataBase->getFailedFolder());
-	dataBase->load();
+	dataBase->load(this);
+	if (dataBase->isLoading()) {
+		//No imports until all maps are there
+		menuBar->enableReadItems(true);
+		toolbarMan->enableReadItems(true);
+	}
 	if (wadPanel != NULL)
 		wadPanel->setDataManager(dataBase);
 	if (mapPanel != NULL)
@@ -242,6 +250,8 @@ void GuiFrame::setDatabase(const wxString& folder)
 
 void GuiFrame::closeDatabase()
 {
+	if (importJob != NULL)
+		stopImport();
 	toolbarMan->enableItems(false);
 	menuBar->enableItems(false);
 	SetStatusText("", 1);
@@ -289,6 +299,10 @@ GuiFrame::~GuiFrame()
 	//Any other objects should be deleted here.
 	delete wadReader;
 	delete appSettings;
+	if (imageCache != NULL) {
+		GuiImagePanel::setImageCache(NULL);
+		delete imageCache;
+	}
 }
 
 //************************ GuiFrame GuiParent ************************
@@ -326,6 +340,21 @@ void GuiFrame::onTotalCounts(long wads, long maps, long auths)
 	SetStatusText(wxString::Format("Total content: [%i] wads  [%i] maps  [%i] people", wads, maps, auths), 3);
 }
 
+void GuiFrame::onEntryModified(int type, uint32_t dbid)
+{
+	mapList->invalidateCells(type, dbid);
+}
+
+void GuiFrame::onListChanged(int type)
+{
+	if (type != mapList->getCurrentType())
+		return;
+	if (importJob != NULL)
+		importRefresh = true; //Refreshed with the progress of the job
+	else
+		mapList->refreshList();
+}
+
 //************************ Event table macro ************************
 //This connects wxWidgets events with the functions (event handlers) which
 //process them. All events processed by the frame are listed here.
@@ -336,6 +365,7 @@ BEGIN_EVENT_TABLE(GuiFrame, wxFrame)
 	//EVT_MENU(LFILE_NEW, GuiFrame::onFileNew)
 	EVT_MENU(LFILE_READ, GuiFrame::onFileRead)
     EVT_MENU(LFILE_READALL, GuiFrame::onFolderRead)
+    EVT_MENU(LFILE_CANCELREAD, GuiFrame::onCancelRead)
 	EVT_MENU(LFILE_CLOSE, GuiFrame::onClose)
     EVT_MENU(LFILE_EXIT, GuiFrame::onExit)
     //Data menu:
@@ -358,11 +388,14 @@ BEGIN_EVENT_TABLE(GuiFrame, wxFrame)
 	EVT_MENU(LSTATS_PLAYST, GuiFrame::onStatsPlaystyle)
 	EVT_MENU(LSTATS_PEOPLE, GuiFrame::onStatsPeople)
 	EVT_MENU(LSTATS_TAGS, GuiFrame::onStatsTags)
+	EVT_MENU(LSTATS_YEARENGINE, GuiFrame::onStatsYearEngine)
 	EVT_MENU(LSTATS_WTOTAL, GuiFrame::onWadStatsTotal)
 	EVT_MENU(LSTATS_WYEARS, GuiFrame::onWadStatsYears)
 	EVT_MENU(LSTATS_WIWAD, GuiFrame::onWadStatsIwad)
 	EVT_MENU(LSTATS_WENGINE, GuiFrame::onWadStatsEngine)
 	EVT_MENU(LSTATS_WRATING, GuiFrame::onWadStatsRating)
+	EVT_MENU(LSTATS_WYEARENGINE, GuiFrame::onWadStatsYearEngine)
+	EVT_MENU(LSTATS_MEMORY, GuiFrame::onStatsMemory)
 	//Options menu:
 	EVT_MENU(LOPT_TEST, GuiFrame::onTest)
 	EVT_MENU(LOPT_APPSETTINGS, GuiFrame::onAppSettings)
@@ -372,6 +405,11 @@ BEGIN_EVENT_TABLE(GuiFrame, wxFrame)
     //EVT_SEARCH(SEARCH_FIELD, GuiFrame::onSearch) Not found
     //EVT_SEARCH_CANCEL(SEARCH_FIELD, GuiFrame::onSearchCancel) Not found
     //Other events:
+    EVT_THREAD(THREAD_TASKSTATUS, GuiFrame::onTaskStatus)
+    EVT_THREAD(THREAD_TASKLOG, GuiFrame::onTaskLog)
+    EVT_THREAD(THREAD_WADENTRY, GuiFrame::onImportEntry)
+    EVT_THREAD(THREAD_WADDONE, GuiFrame::onImportDone)
+    EVT_THREAD(THREAD_MAPSLOADED, GuiFrame::onMapsLoaded)
 
     EVT_CLOSE(GuiFrame::onClose)
     //EVT_SIZE(GuiFrame::onSize)
@@ -483,71 +521,138 @@ void GuiFrame::onFolderRead(wxCommandEvent& event)
 		return;
 	}
 
-	//Loop over each file found (zip, pk3, wad)
-	int wadsAdded = 0;
-	int mapsAdded = 0;
-	int wadsUpdated = 0;
-	WadProgress* progress = new WadProgress("Process files in folder");
-	GuiProgress* progDialog = new GuiProgress(this, getDialogPos(400,600), wxSize(400,600), true);
-	progDialog->Show();
-	progress->setDialog(progDialog);
-	progress->startCount(fcount*2);
-	WadEntry* wadEntry;
-	wxString imgFolder = dataBase->getMapImgFolder();
-	for (int i=0; i<fcount; i++) {
-		fname = wxFileName((*files)[i]);
-		//wxLogVerbose("Process file %s", (*files)[i]);
-		TaskProgress* fileProg = new TaskProgress(fname.GetFullName(), progress);
-		wadReader->initReader((*files)[i], fileProg);
-		wadReader->processWads(fileProg); //Creates WadStats for each wad/pk3, best-guess iwad and engine
-		if (!fileProg->hasFailed()) {
-			if (iwad != IWAD_NONE)
-				wadReader->setIwad(iwad);
-			if (engine != DENG_NONE)
-				wadReader->setEngine(engine);
-			wadReader->findThingDefs(fileProg); //Set correct thingDefs, process decorate and dehacked
-		}
-		progress->incrCount();
-		if (!fileProg->hasFailed()) {
-			unsigned char* chptr = wadReader->getMainDigest();
-			wadEntry = dataBase->findWad(chptr); //If DB has match, skip or update existing?
-			//wadReader->getMainFileName(); //If DB has match, add anyway or update existing?
-			if (wadEntry == NULL) {
-				wadEntry = wadReader->createEntries(imgFolder, fileProg, mapTemp); //Create new entry
-				if (!fileProg->hasFailed()) {
-					wadsAdded++;
-					mapsAdded += wadEntry->numberOfMaps;
-					dataBase->addWad(wadEntry);
-				}
-			} else if (replExisting) {
-				bool deleted = wadReader->updateEntries(wadEntry, imgFolder, fileProg); //Update entry
-				if (!fileProg->hasFailed()) {
-					wadsUpdated++;
-					if (deleted)
-						deleteRemovedMaps(wadEntry);
-					dataBase->wadModified(wadEntry);
-				}
-			} else {
-				//Skipping existing wads - log with warnError
-				fileProg->warnError("Existing entry found, skipping");
-			}
-		}
-		delete fileProg;
-		wadReader->clearState();
-		progress->incrCount();
+	//Process the files in a background job, which posts each new WadEntry
+	//back to onImportEntry. The main window can be used meanwhile.
+	importJob = new WadImportJob(this, wadReader, files, dataBase->getMapImgFolder(),
+		dataBase->getWadHashes());
+	importJob->setIwad(iwad);
+	importJob->setEngine(engine);
+	importJob->setMapTemplate(mapTemp);
+	importJob->setReplaceExisting(replExisting);
+	importAdded = 0;
+	importMaps = 0;
+	importUpdated = 0;
+	importRefresh = false;
+	importDialog = new GuiProgress(this, getDialogPos(400,600), wxSize(400,600), true, true);
+	importDialog->Show();
+	if (importJob->Run() != wxTHREAD_NO_ERROR) {
+		delete importJob;
+		importJob = NULL;
+		importDialog->logLine("Could not start processing files");
+		importDialog->finished();
+		importDialog = NULL;
+		return;
 	}
-	progress->completeCount();
-	progDialog->logLine(wxString::Format("Added %i wad entries with %i maps",wadsAdded,mapsAdded));
-	if (wadsUpdated > 0)
-		progDialog->logLine(wxString::Format("Updated %i wad entries",wadsUpdated));
-	progDialog->finished();
-	delete files;
-	delete progress;
+	menuBar->enableReadItems(true);
+	toolbarMan->enableReadItems(true);
+}
+
+void GuiFrame::onCancelRead(wxCommandEvent& event)
+{
+	if (importJob != NULL)
+		importJob->cancel();
+}
+
+void GuiFrame::onTaskStatus(wxThreadEvent& event)
+{
+	if (importDialog != NULL) {
+		importDialog->setLabel(event.GetString());
+		importDialog->setRange(event.GetExtraLong(), event.GetInt());
+	}
+	//Entries added since the last status are shown in one refresh
+	if (importRefresh) {
+		importRefresh = false;
+		mapList->refreshList();
+	}
+}
+
+void GuiFrame::onTaskLog(wxThreadEvent& event)
+{
+	if (importDialog != NULL)
+		importDialog->logLine(event.GetString());
+}
+
+void GuiFrame::onImportEntry(wxThreadEvent& event)
+{
+	WadEntry* wadEntry = event.GetPayload<WadEntry*>();
+	//The entry may have been added or deleted since the job started
+	WadEntry* existing = dataBase->findWad(wadEntry->md5Digest);
+	if (existing == NULL) {
+		importAdded++;
+		importMaps += wadEntry->numberOfMaps;
+		dataBase->addWad(wadEntry);
+	} else {
+		importUpdated++;
+		bool deleted = wadReader->mergeEntries(existing, wadEntry); //Deletes wadEntry
+		if (deleted)
+			deleteRemovedMaps(existing);
+		dataBase->wadModified(existing);
+	}
+	//The list is refreshed by onTaskStatus and onImportDone, if the entry is in it
+}
+
+void GuiFrame::onImportDone(wxThreadEvent& event)
+{
+	if (!importJoined)
+		importJob->Wait();
+	importJoined = false;
+	delete importJob;
+	importJob = NULL;
+	if (importDialog != NULL) {
+		importDialog->logLine(event.GetString());
+		importDialog->logLine(wxString::Format("Added %i wad entries with %i maps",importAdded,importMaps));
+		if (importUpdated > 0)
+			importDialog->logLine(wxString::Format("Updated %i wad entries",importUpdated));
+		importDialog->finished();
+		importDialog = NULL; //Closed by user
+	}
+	menuBar->enableReadItems(false);
+	toolbarMan->enableReadItems(false);
+	importRefresh = false;
 	mapList->refreshList();
 	dataBase->saveWadsMaps();
 	//TODO: Go to new wad list?
 }
 
+void GuiFrame::onMapsLoaded(wxThreadEvent& event)
+{
+	//The event can be from the load of a database since closed
+	if (dataBase == NULL || event.GetExtraLong() != dataBase->getMapLoadId())
+		return;
+	dataBase->completeLoad(); //Nothing to do if already waited for
+	wxString error = dataBase->getLoadError();
+	if (!error.IsEmpty()) {
+		//Without its maps the database can't be used, like a failed open
+		wxMessageDialog* dlg = new wxMessageDialog(this, error,
+			"File error", wxOK | wxICON_ERROR);
+		dlg->ShowModal();
+		dlg->Destroy();
+		closeDatabase();
+		return;
+	}
+	viewSelect->mapsLoaded();
+	menuBar->enableReadItems(false);
+	toolbarMan->enableReadItems(false);
+	mapList->refreshList();
+	//Both lists were remade, show the count of the one in view
+	if (mapList->getCurrentType() == 0)
+		onWadFilter(dataBase->getWadFilter()->name, dataBase->getWadSize());
+	else
+		onMapFilter(dataBase->getMapFilter()->name, dataBase->getMapSize());
+}
+
+void GuiFrame::stopImport()
+{
+	//Join the job, then handle the events it has posted, so that entries
+	//already processed are added before the database is closed. The last
+	//one is THREAD_WADDONE, which deletes the job.
+	importJob->cancel();
+	importJob->Wait();
+	importJoined = true;
+	while (importJob != NULL && HasPendingEvents())
+		ProcessPendingEvents();
+}
+
 void GuiFrame::deleteRemovedMaps(WadEntry* wadEntry)
 {
 	MapEntry* mapEntry = wadEntry->mapPointers[wadEntry->numberOfMaps - 1];
@@ -570,6 +675,7 @@ void GuiFrame::onFileRead(wxCommandEvent& event)
         progress = new WadProgress("");
 		wadReader->initReader(fdlg->GetPath(), progress);
 		//Don't care if this fails
+		wadReader->addTiming(progress->takeTiming());
 		delete progress;
 		fdlg->Destroy();
 	} else {
@@ -604,6 +710,7 @@ void GuiFrame::onFileRead(wxCommandEvent& event)
 		wxBeginBusyCursor(wxHOURGLASS_CURSOR);
 		wadReader->findThingDefs(progress);
 		wxEndBusyCursor();
+		wadReader->addTiming(progress->takeTiming());
 		if (progress->hasFailed()) {
 			wxMessageDialog* dlg = new wxMessageDialog(this, progress->getError(),
 				"File error", wxOK | wxICON_ERROR);
@@ -886,6 +993,15 @@ void GuiFrame::onStatsTags(wxCommandEvent& event)
 	delete stats;
 }
 
+void GuiFrame::onStatsYearEngine(wxCommandEvent& event)
+{
+	StatisticSet* stats = dataBase->getYearEngineStats(mapList->getCurrentType());
+	GuiStatistics* dialog = new GuiStatistics(this, getDialogPos(300,400), stats);
+	int result = dialog->ShowModal();
+	dialog->Destroy();
+	delete stats;
+}
+
 void GuiFrame::onWadStatsTotal(wxCommandEvent& event)
 {
 	WadStatistics* stats = dataBase->getWadStatistics();
@@ -931,6 +1047,24 @@ void GuiFrame::onWadStatsRating(wxCommandEvent& event)
 	delete stats;
 }
 
+void GuiFrame::onWadStatsYearEngine(wxCommandEvent& event)
+{
+	StatisticSet* stats = dataBase->getYearEngineWadStats();
+	GuiStatistics* dialog = new GuiStatistics(this, getDialogPos(300,400), stats);
+	int result = dialog->ShowModal();
+	dialog->Destroy();
+	delete stats;
+}
+
+void GuiFrame::onStatsMemory(wxCommandEvent& event)
+{
+	MemoryUsage* usage = dataBase->getMemoryUsage();
+	StatisticsReport* report = new StatisticsReport(this, getDialogPos(400,400), usage);
+	int result = report->ShowModal();
+	report->Destroy();
+	delete usage;
+}
+
 void GuiFrame::onNewThing(wxCommandEvent& event)
 {
 	wxString folder;
@@ -1179,8 +1313,18 @@ void GuiFrame::onViewSelected(DataFilter* dataView)
 
 void GuiFrame::onWadActivated(long index, int dialogType)
 {
+	WadEntry* we = dataBase->getWad(index);
 	if (wadPanel!=NULL) wadPanel->readChanges();
 	if (mapPanel!=NULL) mapPanel->readChanges();
+	//The dialog browses a copy, as edits can move entries in the list
+	ListWrapper<WadEntry*> wadLst(*dataBase->getWadList());
+	index = wadLst.find(we);
+	if (index >= 0) {
+		wadLst.setIndex(index);
+	} else { //No longer in the list after the changes
+		vector<WadEntry*> single(1, we);
+		wadLst.fromVector(single);
+	}
 	DoomDialogMode m = (editMode)? DDMODE_EDIT: DDMODE_VIEW;
 	bool combo = false;
 	if (dialogType == 0)
@@ -1193,9 +1337,7 @@ void GuiFrame::onWadActivated(long index, int dialogType)
 		int y = (int) configObject->Read("/ComboEntry/y", 100);
 		int w = (int) configObject->Read("/ComboEntry/w", 1150);
 		int h = (int) configObject->Read("/ComboEntry/h", 600);
-		ListWrapper<WadEntry*>* wadLst = dataBase->getWadList();
-		wadLst->setIndex(index);
-		GuiComboDialog* comboDialog = new GuiComboDialog(this, wxPoint(x,y), wxSize(w,h), wadLst, dataBase, m);
+		GuiComboDialog* comboDialog = new GuiComboDialog(this, wxPoint(x,y), wxSize(w,h), &wadLst, dataBase, m);
 		int result = comboDialog->ShowModal();
 		comboDialog->savePlacement(configObject);
 		comboDialog->Destroy();
@@ -1205,9 +1347,7 @@ void GuiFrame::onWadActivated(long index, int dialogType)
 		int y = (int) configObject->Read("/WadEntry/y", 200);
 		int w = (int) configObject->Read("/WadEntry/w", 900);
 		int h = (int) configObject->Read("/WadEntry/h", 600);
-		ListWrapper<WadEntry*>* wadLst = dataBase->getWadList();
-		wadLst->setIndex(index);
-		GuiWadEntry* wadDialog = new GuiWadEntry(this, wxPoint(x,y), wxSize(w,h), wadLst, dataBase, m, true);
+		GuiWadEntry* wadDialog = new GuiWadEntry(this, wxPoint(x,y), wxSize(w,h), &wadLst, dataBase, m, true);
 		int result = wadDialog->ShowModal();
 		wadDialog->savePlacement(configObject);
 		wadDialog->Destroy();
@@ -1227,15 +1367,22 @@ void GuiFrame::onWadFocused(long index)
 		if (index==-1) {
 			wadPanel->clearWad();
 		} else {
-			wadPanel->readChanges();
 			WadEntry* wad = dataBase->getWad(index);
+			wadPanel->readChanges(); //Can move entries in the list
 			wadPanel->setWad(wad);
+			//The map dialog of this or a neighbour is likely next
+			wadPanel->prefetchImages(wad);
+			if (index > 0)
+				wadPanel->prefetchImages(dataBase->getWad(index-1));
+			if (index+1 < dataBase->getWadSize())
+				wadPanel->prefetchImages(dataBase->getWad(index+1));
 		}
     }
 }
 
 void GuiFrame::onMapActivated(long index, int dialogType)
 {
+	MapEntry* me = dataBase->getMap(index);
 	if (wadPanel!=NULL) wadPanel->readChanges();
 	if (mapPanel!=NULL) mapPanel->readChanges();
 	DoomDialogMode m = (editMode)? DDMODE_EDIT: DDMODE_VIEW;
@@ -1250,7 +1397,6 @@ void GuiFrame::onMapActivated(long index, int dialogType)
 		int y = (int) configObject->Read("/ComboEntry/y", 100);
 		int w = (int) configObject->Read("/ComboEntry/w", 1400);
 		int h = (int) configObject->Read("/ComboEntry/h", 550);
-		MapEntry* me = dataBase->getMap(index);
 		WadEntry* we = me->wadPointer;
 		int mapIndex = we->getMapIndex(me);
 		ListWrapper<WadEntry*>* wrapper = new ListWrapper<WadEntry*>();
@@ -1266,9 +1412,16 @@ void GuiFrame::onMapActivated(long index, int dialogType)
 		int y = (int) configObject->Read("/MapEntry/y", 200);
 		int w = (int) configObject->Read("/MapEntry/w", 800);
 		int h = (int) configObject->Read("/MapEntry/h", 550);
-		ListWrapper<MapEntry*>* mapLst = dataBase->getMapList();
-		mapLst->setIndex(index);
-		GuiMapEntry* mapDialog = new GuiMapEntry(this, wxPoint(x,y), wxSize(w,h), mapLst, dataBase, m, true);
+		//The dialog browses a copy, as edits can move entries in the list
+		ListWrapper<MapEntry*> mapLst(*dataBase->getMapList());
+		index = mapLst.find(me);
+		if (index >= 0) {
+			mapLst.setIndex(index);
+		} else { //No longer in the list after the changes
+			vector<MapEntry*> single(1, me);
+			mapLst.fromVector(single);
+		}
+		GuiMapEntry* mapDialog = new GuiMapEntry(this, wxPoint(x,y), wxSize(w,h), &mapLst, dataBase, m, true);
 		int result = mapDialog->ShowModal();
 		mapDialog->savePlacement(configObject);
 		mapDialog->Destroy();
@@ -1288,9 +1441,14 @@ void GuiFrame::onMapFocused(long index)
 		if (index==-1) {
 			mapPanel->clearMap();
 		} else {
-			mapPanel->readChanges();
 			MapEntry* me = dataBase->getMap(index);
+			mapPanel->readChanges(); //Can move entries in the list
 			mapPanel->setMap(me);
+			//Neighbours are likely next when moving through the list
+			if (index > 0)
+				mapPanel->prefetchImages(dataBase->getMap(index-1));
+			if (index+1 < dataBase->getMapSize())
+				mapPanel->prefetchImages(dataBase->getMap(index+1));
 		}
     }
 }
@@ -1355,7 +1513,10 @@ void GuiFrame::onClose(wxCloseEvent& event)
 		configObject->Write("mapImages", aspects->mapImages);
 		configObject->Write("copyFailedFiles", aspects->copyFailedFiles);
 		configObject->SetPath("..");
-		//Do cleanup?
+		//Stop the image loader before the panels go
+		GuiImagePanel::setImageCache(NULL);
+		delete imageCache;
+		imageCache = NULL;
 		Destroy();
 	}
 }
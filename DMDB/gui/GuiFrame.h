@@ -21,6 +21,7 @@
 #include "wx/splitter.h" //To split main area in several panels
 
 #include "../data/WadReader.h"
+#include "../data/WadImportJob.h"
 #include "../data/DataManager.h"
 #include "GuiViewSelect.h"
 #include "GuiEntryList.h"
@@ -31,6 +32,8 @@
 #include "GuiMapCommon.h"
 #include "GuiWadPanel.h"
 #include "GuiMapPanel.h"
+#include "GuiImageCache.h"
+#include "GuiProgress.h"
 
 
 /*!
@@ -65,6 +68,8 @@ public GuiParent, public DataStatusListener
 	void onWadFilter(const wxString& name, unsigned int wadCount);
 	void onMapFilter(const wxString& name, unsigned int mapCount);
 	void onTotalCounts(long wads, long maps, long auths);
+	void onEntryModified(int type, uint32_t dbid);
+	void onListChanged(int type);
 
 	//************** Event handlers **************
 
@@ -73,6 +78,7 @@ public GuiParent, public DataStatusListener
 	void onFileNew(wxCommandEvent& event); //!< Create new database
 	void onFileRead(wxCommandEvent& event); //!< Read and process wad file
     void onFolderRead(wxCommandEvent& event); //!< Read and process all wads in a folder
+	void onCancelRead(wxCommandEvent& event); //!< Cancel reading folder
 	//void onFileSave(wxCommandEvent& event); //!< Save file
 	void onPeople(wxCommandEvent& event); //!< Show people dialog
 	void onTags(wxCommandEvent& event); //!< Show tag dialog
@@ -88,11 +94,14 @@ public GuiParent, public DataStatusListener
 	void onStatsPlaystyle(wxCommandEvent& event); //!< Show statistics pr playstyle
 	void onStatsPeople(wxCommandEvent& event); //!< Show statistics pr designer
 	void onStatsTags(wxCommandEvent& event); //!< Show statistics pr tag
+	void onStatsYearEngine(wxCommandEvent& event); //!< Show statistics pr year and engine
 	void onWadStatsTotal(wxCommandEvent& event); //!< Show total wad statistics
 	void onWadStatsYears(wxCommandEvent& event); //!< Show wad statistics pr year
 	void onWadStatsIwad(wxCommandEvent& event); //!< Show wad statistics pr iwad
 	void onWadStatsEngine(wxCommandEvent& event); //!< Show wad statistics pr engine
 	void onWadStatsRating(wxCommandEvent& event); //!< Show wad statistics pr rating
+	void onWadStatsYearEngine(wxCommandEvent& event); //!< Show wad statistics pr year and engine
+	void onStatsMemory(wxCommandEvent& event); //!< Show memory used by the database
 
 	void onNewThing(wxCommandEvent& event); //!< Create thingDefs from decorate files
 	void onLoadThing(wxCommandEvent& event); //!< Show/edit existing thingDef file
@@ -102,6 +111,12 @@ public GuiParent, public DataStatusListener
 	void onAppSettings(wxCommandEvent& event); //!< Dialog to set application settings
 	void onAbout(wxCommandEvent& event); //!< Show about dialog
 
+	void onTaskStatus(wxThreadEvent& event); //!< Progress from background job
+	void onTaskLog(wxThreadEvent& event); //!< Log line from background job
+	void onImportEntry(wxThreadEvent& event); //!< WadEntry from background job
+	void onImportDone(wxThreadEvent& event); //!< Background job finished
+	void onMapsLoaded(wxThreadEvent& event); //!< Maps read in background
+
 	void onSearchText(wxCommandEvent& event); //!< Search text changed
 	//void onSearch(wxCommandEvent& event); //!< Search input
 	//void onSearchCancel(wxCommandEvent& event); //!< Search input
@@ -130,6 +145,7 @@ public GuiParent, public DataStatusListener
 	void selectDatabase(); //Select database folder
 	void setDatabase(const wxString& folder); //Open database folder
 	void closeDatabase(); //Delete current database object
+	void stopImport(); //Cancel background job and wait for it to finish
 
 	void deleteRemovedMaps(WadEntry* wadEntry); //Delete maps flagged for deletion after updating wadEntry
 	void thingDialog(ThingDefList* things); //Show dialog with list of thingDefs
@@ -147,6 +163,12 @@ public GuiParent, public DataStatusListener
 
 	WadReader* wadReader; //Load and process wads
 	DataManager* dataBase; //The current database
+	ImageCache* imageCache; //Decoded images for GuiImagePanels
+	WadImportJob* importJob; //Background job reading folder, or NULL
+	GuiProgress* importDialog; //Progress dialog for importJob
+	int importAdded, importMaps, importUpdated; //Entry counts for importJob
+	bool importRefresh; //List changed by importJob since last refresh
+	bool importJoined; //importJob was joined by stopImport
 
 	wxSplitterWindow* clientArea; //Manages the main frame split with side panels
 	wxSplitterWindow* mainArea; //Main part of clientArea, with right panel and centerArea
@@ -0,0 +1,223 @@
+/*
+* ImageCache implementation
+*/
+
+#include "GuiImageCache.h"
+#include <wx/filefn.h>
+
+//*************************************************************
+//************************ ImageLoader ************************
+//*************************************************************
+
+ImageLoader::ImageLoader(wxEvtHandler* handler)
+: wxThread(wxTHREAD_JOINABLE), eventHandler(handler), queueSignal(queueLock), stopping(false)
+{
+}
+
+ImageLoader::~ImageLoader()
+{
+}
+
+void ImageLoader::request(const wxString& file, wxBitmapType format, bool prefetch)
+{
+	wxMutexLocker lock(queueLock);
+	for (deque<QueuedFile>::iterator it=queue.begin(); it!=queue.end(); ++it) {
+		if (it->file.IsSameAs(file)) {
+			if (prefetch)
+				return; //Keep position
+			queue.erase(it);
+			break;
+		}
+	}
+	QueuedFile qf;
+	qf.file = file;
+	qf.format = format;
+	if (prefetch)
+		queue.push_back(qf);
+	else
+		queue.push_front(qf);
+	while (queue.size() > IMAGE_QUEUE_SIZE)
+		queue.pop_back();
+	queueSignal.Signal();
+}
+
+void ImageLoader::stop()
+{
+	wxMutexLocker lock(queueLock);
+	stopping = true;
+	queueSignal.Signal();
+}
+
+wxThread::ExitCode ImageLoader::Entry()
+{
+	while (true) {
+		wxString file;
+		wxBitmapType format;
+		{
+			wxMutexLocker lock(queueLock);
+			while (queue.empty() && !stopping)
+				queueSignal.Wait();
+			if (stopping)
+				break;
+			file = queue.front().file.Clone(); //Not sharing data with the GUI thread
+			format = queue.front().format;
+			queue.pop_front();
+		}
+		LoadedImage* loaded = new LoadedImage();
+		loaded->file = file;
+		loaded->modTime = wxFileModificationTime(file);
+		loaded->image = new wxImage();
+		if (loaded->modTime==-1 || !loaded->image->LoadFile(file, format)) {
+			delete loaded->image;
+			loaded->image = NULL;
+		}
+		wxThreadEvent* event = new wxThreadEvent(wxEVT_THREAD, THREAD_IMAGELOADED);
+		event->SetPayload<LoadedImage*>(loaded);
+		wxQueueEvent(eventHandler, event);
+	}
+	return (wxThread::ExitCode)0;
+}
+
+//************************************************************
+//************************ ImageCache ************************
+//************************************************************
+
+ImageCache::ImageCache()
+{
+	entries = new map<wxString, CacheEntry*>();
+	used = new list<wxString>();
+	listeners = new list<ImageCacheListener*>();
+	loader = new ImageLoader(this);
+	if (loader->Run() != wxTHREAD_NO_ERROR) {
+		wxLogVerbose("Failed to start image loader thread");
+		delete loader;
+		loader = NULL;
+	}
+}
+
+ImageCache::~ImageCache()
+{
+	if (loader != NULL) {
+		loader->stop();
+		loader->Wait();
+		delete loader;
+	}
+	//Free images posted but not yet handled
+	listeners->clear();
+	ProcessPendingEvents();
+	for (map<wxString, CacheEntry*>::iterator it=entries->begin(); it!=entries->end(); ++it) {
+		if (it->second->bitmap != NULL)
+			delete it->second->bitmap;
+		delete it->second;
+	}
+	delete entries;
+	delete used;
+	delete listeners;
+}
+
+void ImageCache::addListener(ImageCacheListener* l)
+{
+	listeners->push_back(l);
+}
+
+void ImageCache::removeListener(ImageCacheListener* l)
+{
+	listeners->remove(l);
+}
+
+ImageStatus ImageCache::getImage(const wxString& file, wxBitmapType format, wxImage& image)
+{
+	time_t modTime = wxFileModificationTime(file);
+	if (modTime == -1) {
+		forget(file);
+		return IMG_MISSING;
+	}
+	map<wxString, CacheEntry*>::iterator it = entries->find(file);
+	if (it!=entries->end() && it->second->modTime==modTime) {
+		touch(file);
+		if (!it->second->image.IsOk())
+			return IMG_MISSING; //Couldn't decode
+		image = it->second->image;
+		return IMG_READY;
+	}
+	if (loader == NULL) {
+		//No thread - decode here
+		if (!image.LoadFile(file, format))
+			return IMG_MISSING;
+		return IMG_READY;
+	}
+	loader->request(file, format, false);
+	return IMG_PENDING;
+}
+
+wxBitmap* ImageCache::getBitmap(const wxString& file, const wxSize& size)
+{
+	map<wxString, CacheEntry*>::iterator it = entries->find(file);
+	if (it==entries->end() || !it->second->image.IsOk())
+		return NULL;
+	CacheEntry* entry = it->second;
+	if (entry->bitmap==NULL || entry->bitmapSize!=size) {
+		if (entry->bitmap != NULL)
+			delete entry->bitmap;
+		if (size.x==entry->image.GetWidth() && size.y==entry->image.GetHeight())
+			entry->bitmap = new wxBitmap(entry->image);
+		else
+			entry->bitmap = new wxBitmap(entry->image.Scale(size.x, size.y));
+		entry->bitmapSize = size;
+	}
+	return entry->bitmap;
+}
+
+void ImageCache::prefetch(const wxString& file, wxBitmapType format)
+{
+	if (loader==NULL || entries->find(file)!=entries->end())
+		return;
+	loader->request(file, format, true);
+}
+
+void ImageCache::forget(const wxString& file)
+{
+	map<wxString, CacheEntry*>::iterator it = entries->find(file);
+	if (it == entries->end())
+		return;
+	if (it->second->bitmap != NULL)
+		delete it->second->bitmap;
+	delete it->second;
+	entries->erase(it);
+	used->remove(file);
+}
+
+void ImageCache::touch(const wxString& file)
+{
+	used->remove(file);
+	used->push_front(file);
+}
+
+void ImageCache::onImageLoaded(wxThreadEvent& event)
+{
+	LoadedImage* loaded = event.GetPayload<LoadedImage*>();
+	if (loaded->modTime != -1) {
+		forget(loaded->file);
+		CacheEntry* entry = new CacheEntry();
+		entry->modTime = loaded->modTime;
+		if (loaded->image != NULL)
+			entry->image = *loaded->image;
+		entry->bitmap = NULL;
+		(*entries)[loaded->file] = entry;
+		touch(loaded->file);
+		while (used->size() > IMAGE_CACHE_SIZE) {
+			wxString oldest = used->back();
+			forget(oldest);
+		}
+	}
+	for (list<ImageCacheListener*>::iterator it=listeners->begin(); it!=listeners->end(); ++it)
+		(*it)->onImageLoaded(loaded->file);
+	if (loaded->image != NULL)
+		delete loaded->image;
+	delete loaded;
+}
+
+//Event table:
+BEGIN_EVENT_TABLE(ImageCache, wxEvtHandler)
+	EVT_THREAD(THREAD_IMAGELOADED, ImageCache::onImageLoaded)
+END_EVENT_TABLE()
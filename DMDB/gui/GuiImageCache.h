@@ -0,0 +1,165 @@
+/*!
+* \file GuiImageCache.h
+* \author Lars Thomas Boye 2020
+*
+* ImageCache keeps recently shown images decoded in memory, with the last
+* scaled bitmap for each, and decodes PNG files in a background thread.
+* ImageLoader is the background thread.
+*/
+
+#ifndef GUIIMAGECACHE_H
+#define GUIIMAGECACHE_H
+
+//Include wxWidgets headers:
+#include "wx/wxprec.h"
+#ifndef WX_PRECOMP
+    #include "wx/wx.h"
+#endif
+
+#include <map>
+#include <list>
+#include <deque>
+#include <wx/thread.h>
+#include "GuiBase.h"
+
+using namespace std;
+
+const int IMAGE_CACHE_SIZE = 32; //!< Max number of decoded images in ImageCache
+const int IMAGE_QUEUE_SIZE = 8; //!< Max number of files waiting to be decoded
+
+/*! Result of ImageCache::getImage. */
+enum ImageStatus
+{
+	IMG_READY, //!< Decoded image returned
+	IMG_PENDING, //!< Being decoded, ImageCacheListener is told when done
+	IMG_MISSING //!< No image file, or it can't be decoded
+};
+
+/*!
+* Receives notification from ImageCache when an image file has been
+* decoded (or failed to decode), so that getImage no longer returns
+* IMG_PENDING for it. Called in the GUI thread.
+*/
+class ImageCacheListener
+{
+	public:
+		virtual void onImageLoaded(const wxString& file) = 0;
+};
+
+/*! An image decoded by ImageLoader, posted as payload of THREAD_IMAGELOADED. */
+struct LoadedImage
+{
+	wxString file;
+	time_t modTime; //!< File modification time when loaded
+	wxImage* image; //!< NULL if it could not be loaded
+};
+
+/*!
+* Worker thread decoding image files for ImageCache. Files are taken from
+* a queue, most recent request first, and each decoded image is posted to
+* the cache as a THREAD_IMAGELOADED event with a LoadedImage payload.
+*/
+class ImageLoader : public wxThread
+{
+	public:
+		ImageLoader(wxEvtHandler* handler);
+		virtual ~ImageLoader();
+
+		/*!
+		* Add file to the queue, to be decoded as format. Files requested for
+		* display are decoded before prefetched ones. The oldest are dropped
+		* if the queue is full.
+		*/
+		void request(const wxString& file, wxBitmapType format, bool prefetch);
+
+		/*! Make the thread exit. Call Wait after this. */
+		void stop();
+
+	protected:
+		virtual ExitCode Entry();
+
+	private:
+		struct QueuedFile
+		{
+			wxString file;
+			wxBitmapType format;
+		};
+
+		wxEvtHandler* eventHandler;
+		wxMutex queueLock; //Guards queue and stopping
+		wxCondition queueSignal;
+		deque<QueuedFile> queue; //Next file first
+		bool stopping;
+};
+
+/*!
+* Cache of decoded images, shared by all GuiImagePanels. Each image is
+* kept as the decoded wxImage, and the bitmap last made from it for a given
+* size. Holding down the arrow keys in the entry lists changes the focused
+* entry many times per second, and with the cache, the images of recently
+* shown entries are drawn without reading, decoding or scaling them again.
+*
+* getImage returns a cached image if the file hasn't changed since it was
+* decoded. Otherwise the file is queued for decoding in the ImageLoader
+* thread, and the listeners are told when it is ready. prefetch queues a
+* file which is likely to be shown next, such as for neighbouring entries
+* in a list. At most IMAGE_CACHE_SIZE images are kept, dropping the least
+* recently used.
+*
+* All methods are for the GUI thread. The cache must be deleted before
+* the main window, which stops the loader thread.
+*/
+class ImageCache : public wxEvtHandler
+{
+	public:
+		ImageCache();
+		virtual ~ImageCache();
+
+		void addListener(ImageCacheListener* l);
+		void removeListener(ImageCacheListener* l);
+
+		/*!
+		* Get decoded image from file of format. Returns IMG_READY with image set if
+		* it is cached and the file hasn't changed. Returns IMG_MISSING if
+		* there is no such file or it couldn't be decoded. Otherwise the file
+		* is queued for decoding, returning IMG_PENDING.
+		*/
+		ImageStatus getImage(const wxString& file, wxBitmapType format, wxImage& image);
+
+		/*!
+		* Bitmap of the cached image from file, scaled to size. The last
+		* scaled bitmap is kept, so asking for the same size again is free.
+		* NULL if the image is not in the cache.
+		*/
+		wxBitmap* getBitmap(const wxString& file, const wxSize& size);
+
+		/*! Queue file for decoding as format if it is not cached. */
+		void prefetch(const wxString& file, wxBitmapType format);
+
+		/*! Remove file from the cache, when it has been replaced. */
+		void forget(const wxString& file);
+
+		/*! Receives decoded images from the loader thread. */
+		void onImageLoaded(wxThreadEvent& event);
+
+	private:
+		struct CacheEntry
+		{
+			time_t modTime;
+			wxImage image;
+			wxBitmap* bitmap; //Last scaled bitmap, or NULL
+			wxSize bitmapSize;
+		};
+
+		/*! Move file to the front of the LRU list. */
+		void touch(const wxString& file);
+
+		map<wxString, CacheEntry*>* entries;
+		list<wxString>* used; //Most recently used first
+		list<ImageCacheListener*>* listeners;
+		ImageLoader* loader;
+
+	DECLARE_EVENT_TABLE()
+};
+
+#endif // GUIIMAGECACHE_H
@@ -4,21 +4,35 @@
 //************************ GuiImagePanel ************************
 //***************************************************************
 
+ImageCache* GuiImagePanel::imageCache = NULL;
+
 GuiImagePanel::GuiImagePanel(wxWindow* parent, bool res, bool canSel, bool canOpen)
 : wxScrolledWindow(parent,wxID_ANY,wxDefaultPosition,wxDefaultSize,wxBORDER_SIMPLE),
 noImageStr(""), fileName(""), canSelect(canSel), showDialog(canOpen),
-hasImage(false), imgRatio(0.0), resized(NULL), resizing(res)
+hasImage(false), loading(false), cacheListener(false), imgRatio(0.0), resized(NULL), resizing(res)
 {
 	if (canSelect)
 		SetDropTarget(new GuiImageDropTarget(this));
+	if (imageCache != NULL) {
+		imageCache->addListener(this);
+		cacheListener = true;
+	}
 }
 
 GuiImagePanel::~GuiImagePanel()
 {
+	if (cacheListener && imageCache!=NULL)
+		imageCache->removeListener(this);
 	if (resized != NULL)
 		delete resized;
 }
 
+void GuiImagePanel::prefetch(const wxString& file, wxBitmapType format)
+{
+	if (imageCache != NULL)
+		imageCache->prefetch(file, format);
+}
+
 void GuiImagePanel::setNoImageText(wxString text)
 {
 	noImageStr = text;
@@ -32,16 +46,38 @@ void GuiImagePanel::loadImage(wxString file, wxBitmapType format)
 		delete resized;
 	resized = NULL;
 	hasImage = false;
+	loading = false;
 
-	hasImage = wxFile::Exists(fileName);
-	if (hasImage)
-		hasImage = image.LoadFile(file, bitmapType);
+	if (cacheListener && imageCache!=NULL) {
+		ImageStatus status = imageCache->getImage(fileName, bitmapType, image);
+		hasImage = (status == IMG_READY);
+		loading = (status == IMG_PENDING);
+	} else {
+		hasImage = wxFile::Exists(fileName);
+		if (hasImage)
+			hasImage = image.LoadFile(file, bitmapType);
+	}
+	showLoaded();
+}
+
+void GuiImagePanel::onImageLoaded(const wxString& file)
+{
+	if (!loading || !file.IsSameAs(fileName))
+		return;
+	ImageStatus status = imageCache->getImage(fileName, bitmapType, image);
+	hasImage = (status == IMG_READY);
+	loading = (status == IMG_PENDING);
+	showLoaded();
+}
+
+void GuiImagePanel::showLoaded()
+{
     w = -1;
     h = -1;
     if (hasImage) {
     	imgRatio = (double)image.GetWidth() / (double)image.GetHeight();
 		if (!resizing) {
-			resized = new wxBitmap(image);
+			resized = makeBitmap(image.GetWidth(), image.GetHeight());
 			SetVirtualSize(image.GetWidth(), image.GetHeight());
 			SetScrollRate(10, 10);
 		}
@@ -49,6 +85,18 @@ void GuiImagePanel::loadImage(wxString file, wxBitmapType format)
     paintNow();
 }
 
+wxBitmap* GuiImagePanel::makeBitmap(int width, int height)
+{
+	if (cacheListener && imageCache!=NULL) {
+		wxBitmap* cached = imageCache->getBitmap(fileName, wxSize(width, height));
+		if (cached != NULL)
+			return new wxBitmap(*cached); //Shares the bitmap data
+	}
+	if (width==image.GetWidth() && height==image.GetHeight())
+		return new wxBitmap(image);
+	return new wxBitmap(image.Scale(width, height /*,wxIMAGE_QUALITY_HIGH*/));
+}
+
 void GuiImagePanel::clearImage()
 {
 	fileName = "";
@@ -56,6 +104,7 @@ void GuiImagePanel::clearImage()
 		delete resized;
 	resized = NULL;
 	hasImage = false;
+	loading = false;
 	w = -1;
     h = -1;
     paintNow();
@@ -73,15 +122,18 @@ bool GuiImagePanel::createImage()
 	imgRatio = (double)image.GetWidth() / (double)image.GetHeight();
 	image.SaveFile(fileName, wxBITMAP_TYPE_PNG);
 	wxLogVerbose("Saved image file %s", fileName);
+	if (cacheListener && imageCache!=NULL)
+		imageCache->forget(fileName);
 
 	if (resized != NULL)
 		delete resized;
 	resized = NULL;
 	hasImage = true;
+	loading = false;
 	w = -1;
 	h = -1;
 	if (!resizing) {
-		resized = new wxBitmap(image);
+		resized = makeBitmap(image.GetWidth(), image.GetHeight());
 		SetVirtualSize(image.GetWidth(), image.GetHeight());
 		SetScrollRate(10, 10);
 	}
@@ -207,6 +259,7 @@ void GuiImagePanel::onRightClick(wxMouseEvent& event)
 				delete resized;
 			resized = NULL;
 			hasImage = false;
+			loading = false;
 			w = -1;
 			h = -1;
 			paintNow();
@@ -283,7 +336,7 @@ void GuiImagePanel::render(wxDC& dc)
 				imgh = (int)(imgw/imgRatio);
 			}
 			if (imgw>1 && imgh>1)
-				resized = new wxBitmap(image.Scale(imgw,imgh /*,wxIMAGE_QUALITY_HIGH*/));
+				resized = makeBitmap(imgw, imgh);
 			else
 				resized = NULL;
 		}
@@ -293,7 +346,7 @@ void GuiImagePanel::render(wxDC& dc)
 	if (hasImage) {
 		if (resized != NULL)
 			dc.DrawBitmap(*resized, 0, 0, false);
-    } else {
+    } else if (!loading) {
         dc.DrawText(noImageStr, 10,10);
     }
 }
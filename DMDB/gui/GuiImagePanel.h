@@ -21,6 +21,7 @@
 #include <wx/clipbrd.h>
 #include <wx/metafile.h>
 #include "GuiBase.h"
+#include "GuiImageCache.h"
 
 
 /*!
@@ -35,9 +36,13 @@
 * exists. Any imported image is saved with this file name, so it
 * replaces any existing file.
 *
+* When an ImageCache is set with setImageCache, images are taken from
+* it, and decoded in the background when not cached. The panel is then
+* blank until the image is ready.
+*
 * Based on the example: https://wiki.wxwidgets.org/An_image_panel
 */
-class GuiImagePanel : public wxScrolledWindow
+class GuiImagePanel : public wxScrolledWindow, public ImageCacheListener
 {
 	public:
 		/*!
@@ -62,6 +67,18 @@ class GuiImagePanel : public wxScrolledWindow
 		/*! Removes the file name and any image shown. */
 		void clearImage();
 
+		/*! Shows the image if it is for the current file. */
+		virtual void onImageLoaded(const wxString& file);
+
+		/*!
+		* Set the ImageCache used by all panels, or NULL to load images
+		* directly. Only panels created after this use the cache.
+		*/
+		static void setImageCache(ImageCache* cache) { imageCache = cache; }
+
+		/*! Decode file of format in the background if there is an ImageCache. */
+		static void prefetch(const wxString& file, wxBitmapType format);
+
 		/*! Receives file name from drag-and-drop. */
 		bool onFileDropped(const wxString &fileNam);
 
@@ -109,6 +126,14 @@ class GuiImagePanel : public wxScrolledWindow
 		/*! Shows file dialog for selecting image file. */
 		void selectFile();
 
+		/*! Set up for drawing the image once it has been loaded. */
+		void showLoaded();
+
+		/*! New bitmap of the image at size, from the cache if possible. */
+		wxBitmap* makeBitmap(int width, int height);
+
+		static ImageCache* imageCache;
+
 		wxString noImageStr;
 		wxString fileName;
 		wxBitmapType bitmapType;
@@ -116,6 +141,8 @@ class GuiImagePanel : public wxScrolledWindow
 		bool showDialog;
 
 		bool hasImage;
+		bool loading; //Waiting for ImageCache
+		bool cacheListener; //Registered with imageCache
 		double imgRatio; //w/h of current image
 		wxImage image; //Image loaded from file
 		wxBitmap* resized; //Bitmap to draw
@@ -374,13 +374,13 @@ void GuiMapManager::writeEntry()
 			titleSizer->Show(titleLabel, true);
 			titleSizer->Show(titleInput, true);
 			titleSizer->Layout();
-			mapStrFields[MAPSTR_TITLE] = mapEntry->title;
+			mapStrFields[MAPSTR_TITLE] = mapEntry->title.str();
 			if (singleMap)
 				titleInput->Enable(false);
 			else
 				titleInput->Enable(true);
 		}
-		mapStrFields[MAPSTR_NAME] = mapEntry->name;
+		mapStrFields[MAPSTR_NAME] = mapEntry->name.str();
 		mapFlagBoxes[6]->SetValue(mapEntry->flags&MF_NOTLEVEL);
 	}
 	if (parts&GMP_REFS) {
@@ -460,7 +460,7 @@ void GuiMapManager::writeEntry()
 		if (singleMap)
 			noteInput = wadText->getText(WADTEXT_DESC);
 		else
-			noteInput = wadText->getText(mapEntry->name);
+			noteInput = wadText->getText(mapEntry->name.str());
 	}
 }
 
@@ -472,7 +472,7 @@ void GuiMapManager::readEntry()
 	if (mode != DDMODE_VIEW) {
 		unsigned char flg = mapEntry->flags;
 		if (parts&GMP_TITLE) {
-			if (!singleMap && (mapEntry->title.compare(mapStrFields[MAPSTR_TITLE]))) {
+			if (!singleMap && (mapEntry->title.str().compare(mapStrFields[MAPSTR_TITLE]))) {
 				mapEntry->title = mapStrFields[MAPSTR_TITLE];
 				mapEntry->ownFlags |= OF_MAINMOD;
 			}
@@ -560,7 +560,7 @@ void GuiMapManager::readEntry()
 			if (singleMap) {
 				wadText->setText(WADTEXT_DESC, noteInput);
 			} else {
-				wadText->setText(mapEntry->name, noteInput);
+				wadText->setText(mapEntry->name.str(), noteInput);
 			}
 		}
 
@@ -615,6 +615,14 @@ void GuiMapManager::showImages()
 	}
 }
 
+void GuiMapManager::prefetchImages(MapEntry* me)
+{
+	if (mapPane != NULL)
+		GuiImagePanel::prefetch(dataBase->getMapImgFolder() + wxFILE_SEP_PATH + me->fileName() + ".png", wxBITMAP_TYPE_PNG);
+	if (shotPane != NULL)
+		GuiImagePanel::prefetch(dataBase->getScreenshotFolder() + wxFILE_SEP_PATH + me->fileName() + ".png", wxBITMAP_TYPE_PNG);
+}
+
 void GuiMapManager::clearEntry()
 {
 	//So far only complete for view mode (only disables input for private fields)
@@ -810,9 +818,9 @@ void GuiMapManager::removeSelectedTag()
 string GuiMapManager::basedOnString(MapEntry* me, MapEntry* base)
 {
 	if (me->wadPointer == base->wadPointer)
-		return base->name;
+		return base->name.str();
 	else if (base->wadPointer->numberOfMaps == 1)
 		return base->getTitle();
 	else
-		return base->wadPointer->getName()+":"+base->name;
+		return base->wadPointer->getName()+":"+base->name.str();
 }
@@ -223,6 +223,12 @@ class GuiMapManager
 		*/
 		void showImages();
 
+		/*!
+		* Start decoding the images which showImages would show for me,
+		* when it is likely to be shown next.
+		*/
+		void prefetchImages(MapEntry* me);
+
 		/*!
 		* Removes the current MapEntry, removing all data from the UI.
 		*/
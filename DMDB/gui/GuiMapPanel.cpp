@@ -53,6 +53,11 @@ void GuiMapPanel::clearMap()
 	TransferDataToWindow();
 }
 
+void GuiMapPanel::prefetchImages(MapEntry* mapEnt)
+{
+	mapManager->prefetchImages(mapEnt);
+}
+
 void GuiMapPanel::readChanges()
 {
 	if (mapManager->hasEntry()) {
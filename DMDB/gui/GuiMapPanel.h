@@ -49,6 +49,9 @@ class GuiMapPanel : public wxPanel
 		*/
 		void clearMap();
 
+		/*! Start loading the images of a MapEntry likely to be shown next. */
+		void prefetchImages(MapEntry* mapEnt);
+
 		/*!
 		* Before changing MapEntry or removing the panel, call this to
 		* update the currently shown MapEntry based on UI state.
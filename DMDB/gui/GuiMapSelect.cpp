@@ -51,10 +51,10 @@ void GuiWadList::jumpToWad(wxString prefix)
 	int index = -1;
 	if ((prefix.Length()>0) && (wadList->getSize()>0)) {
 		wadList->reset();
-		if ( wxString(wadList->entry()->title).CmpNoCase(prefix) >= 0)
+		if ( wxString(wadList->entry()->title.str()).CmpNoCase(prefix) >= 0)
 			index = wadList->getIndex();
 		while (wadList->next() && index==-1) {
-			if ( wxString(wadList->entry()->title).CmpNoCase(prefix) >= 0)
+			if ( wxString(wadList->entry()->title.str()).CmpNoCase(prefix) >= 0)
 				index = wadList->getIndex();
 		}
 	}
@@ -75,7 +75,7 @@ wxString GuiWadList::OnGetItemText(long item, long column) const
 {
 	if (wadList == NULL) return "";
 	wadList->setIndex(item);
-	return wadList->entry()->title;
+	return wadList->entry()->title.str();
 }
 
 //**************************************************************
@@ -182,7 +182,7 @@ void GuiMapSelect::showMaps()
 	mapListCtrl->Clear();
 	if (currentWad != NULL) {
 		for (int i=0; i<currentWad->numberOfMaps; i++)
-			mapListCtrl->Append(currentWad->mapPointers[i]->name);
+			mapListCtrl->Append(currentWad->mapPointers[i]->name.str());
 	}
 }
 
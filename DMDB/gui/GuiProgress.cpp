@@ -1,6 +1,6 @@
 #include "GuiProgress.h"
 
-GuiProgress::GuiProgress(wxWindow* parent, const wxPoint& pos, const wxSize& siz, bool log)
+GuiProgress::GuiProgress(wxWindow* parent, const wxPoint& pos, const wxSize& siz, bool log, bool cancel)
 : wxDialog(parent, -1, "Progress", pos, siz, wxCAPTION)
 {
 	wxBoxSizer* topSizer = new wxBoxSizer(wxVERTICAL);
@@ -18,11 +18,17 @@ GuiProgress::GuiProgress(wxWindow* parent, const wxPoint& pos, const wxSize& siz
 		closeButton = new wxButton(this,BUTTON_OK,"Close");
 		closeButton->Enable(false);
 		bottomSizer->Add(closeButton, 0, wxALL, 10);
-		//bottomSizer->Add(new wxButton(this,BUTTON_CANCEL,"Done"), 0, wxALL, 10);
+		if (cancel) {
+			cancelButton = new wxButton(this,BUTTON_CANCEL,"Cancel");
+			bottomSizer->Add(cancelButton, 0, wxALL, 10);
+		} else {
+			cancelButton = NULL;
+		}
 		topSizer->Add(bottomSizer, 0, wxALIGN_CENTER);
 	} else {
 		logView = NULL;
 		closeButton = NULL;
+		cancelButton = NULL;
 	}
 
 	SetSizer(topSizer);
@@ -71,12 +77,15 @@ void GuiProgress::finished()
 		Close(true);
 	} else {
 		closeButton->Enable(true);
+		if (cancelButton != NULL)
+			cancelButton->Enable(false);
 	}
 }
 
 //Event table:
 BEGIN_EVENT_TABLE(GuiProgress, wxDialog)
     EVT_BUTTON(BUTTON_OK, GuiProgress::onOk)
+    EVT_BUTTON(BUTTON_CANCEL, GuiProgress::onCancel)
     //EVT_CLOSE(GuiProgress::onClose)
 END_EVENT_TABLE()
 
@@ -86,4 +95,13 @@ void GuiProgress::onOk(wxCommandEvent& event)
 	Destroy();
 }
 
+void GuiProgress::onCancel(wxCommandEvent& event)
+{
+	//The task is owned by the parent window, which cancels it
+	cancelButton->Enable(false);
+	setLabel("Cancelling...");
+	wxCommandEvent cancelEvent(wxEVT_MENU, LFILE_CANCELREAD);
+	wxPostEvent(GetParent(), cancelEvent);
+}
+
 //void GuiProgress::onClose(wxCloseEvent& event)
@@ -16,6 +16,7 @@
 
 #include <wx/richtext/richtextctrl.h>
 #include "GuiBase.h"
+#include "../data/TaskProgress.h"
 
 /*!
 * Dialog to show during potentially long-running operations, such as
@@ -23,16 +24,20 @@
 * and a progress bar to be updated as the task progresses. It can also
 * include a text log, to show a log of tasks done. In this mode, the
 * dialog can be closed by the user, with a button enabled when ready.
+* With the log, it can also have a cancel button, for a task running in
+* the background. This sends an LFILE_CANCELREAD menu event to the parent
+* window, which must handle it by cancelling the task.
 */
-class GuiProgress : public wxDialog
+class GuiProgress : public wxDialog, public ProgressView
 {
 	public: //wxSize(320,300)
 		/*!
-		* Regular wxDialog constructor arguments, except for the log option.
-		* Enable this to include a text log in the dialog, as well as a
-		* button to close the dialog.
+		* Regular wxDialog constructor arguments, except for the log and
+		* cancel options. Enable log to include a text log in the dialog,
+		* as well as a button to close the dialog. Enable cancel (with log)
+		* to also include a button to cancel the task.
 		*/
-		GuiProgress(wxWindow* parent, const wxPoint& pos, const wxSize& siz=wxDefaultSize, bool log=false);
+		GuiProgress(wxWindow* parent, const wxPoint& pos, const wxSize& siz=wxDefaultSize, bool log=false, bool cancel=false);
 
 		virtual ~GuiProgress();
 
@@ -67,6 +72,7 @@ class GuiProgress : public wxDialog
 		void finished();
 
 		void onOk(wxCommandEvent& event); //!< Close dialog
+		void onCancel(wxCommandEvent& event); //!< Cancel task
 		//void onClose(wxCloseEvent& event); //!< Dialog closed
 
 	protected:
@@ -76,6 +82,7 @@ class GuiProgress : public wxDialog
 		wxGauge* bar;
 		wxRichTextCtrl* logView;
 		wxButton* closeButton;
+		wxButton* cancelButton;
 
 	//Macro for the event table
 	DECLARE_EVENT_TABLE()
@@ -6,6 +6,19 @@
 
 StatisticsReport::StatisticsReport(wxWindow* parent, const wxPoint& pos, DBStatistics* stats)
 : GuiReport(parent, "Statistics", pos, wxSize(560,400))
+{
+	makeLayout();
+	stats->printReport(this);
+}
+
+StatisticsReport::StatisticsReport(wxWindow* parent, const wxPoint& pos, MemoryUsage* usage)
+: GuiReport(parent, "Memory usage", pos, wxSize(560,400))
+{
+	makeLayout();
+	usage->printReport(this);
+}
+
+void StatisticsReport::makeLayout()
 {
 	//Main layout objects:
 	wxBoxSizer* topSizer = new wxBoxSizer(wxVERTICAL);
@@ -22,8 +35,6 @@ StatisticsReport::StatisticsReport(wxWindow* parent, const wxPoint& pos, DBStati
     SetSizer(topSizer);
     //topSizer->SetSizeHints(this); //Set minimal size for window based on topSizer
     //topSizer->Fit(this); //Resize window to match topSizer minimal size
-
-    stats->printReport(this);
 }
 
 //Event table:
@@ -144,16 +155,82 @@ void GuiStatsList::colClicked(wxListEvent& event)
 	updateList();
 }
 
+//**************************************************************
+//************************ GuiPivotList ************************
+//**************************************************************
+
+GuiPivotList::GuiPivotList(wxWindow* parent, GroupStatSet* stats, StatFields field)
+: wxListCtrl(parent,-1,wxDefaultPosition, wxDefaultSize,
+			wxLC_REPORT|wxLC_VIRTUAL|wxLC_HRULES|wxLC_VRULES|wxLC_SINGLE_SEL),
+statSet(stats), cellField(field)
+{
+	statSet->getKeys(0, rowKeys);
+	statSet->getKeys(1, colKeys);
+	StatGroupKey* key1 = statSet->getKey(0);
+	StatGroupKey* key2 = statSet->getKey(1);
+
+	wxListItem col;
+	col.SetText(key1->getTitle());
+	col.SetWidth(key1->getWidth());
+	col.SetAlign(wxLIST_FORMAT_LEFT);
+	InsertColumn(0, col);
+	for (size_t i=0; i<colKeys.size(); i++) {
+		wxListItem kcol;
+		kcol.SetText(key2->keyName(colKeys[i]));
+		kcol.SetWidth(80);
+		kcol.SetAlign(wxLIST_FORMAT_LEFT);
+		InsertColumn(i+1, kcol);
+	}
+	SetItemCount(rowKeys.size());
+}
+
+void GuiPivotList::setField(StatFields field)
+{
+	cellField = field;
+	if (rowKeys.size() > 0)
+		RefreshItems(0, rowKeys.size()-1);
+}
+
+wxString GuiPivotList::OnGetItemText(long item, long column) const
+{
+	if (column == 0)
+		return statSet->getKey(0)->keyName(rowKeys[item]);
+	DBStatistics* dbs = statSet->getGroup(rowKeys[item], colKeys[column-1]);
+	if (dbs == NULL)
+		return "";
+	if (cellField < STS_LINEDEFS_AVG)
+		return wxString::Format("%i", dbs->intStats[cellField]);
+	else
+		return wxString::Format("%.2f", dbs->floatStats[cellField]);
+}
+
 //***************************************************************
 //************************ GuiStatistics ************************
 //***************************************************************
 
 GuiStatistics::GuiStatistics(wxWindow* parent, const wxPoint& pos, StatisticSet* stats)
-: wxDialog(parent, -1, stats->getHeading(), pos, wxSize(800,500), wxDEFAULT_DIALOG_STYLE|wxRESIZE_BORDER)
+: wxDialog(parent, -1, stats->getHeading(), pos, wxSize(800,500), wxDEFAULT_DIALOG_STYLE|wxRESIZE_BORDER),
+statSet(stats), pivotList(NULL), fieldChoice(NULL)
 {
 	//Main layout objects:
 	wxBoxSizer* topSizer = new wxBoxSizer(wxVERTICAL);
 
+	//Pivot table, with choice of field to show
+	GroupStatSet* groupSet = dynamic_cast<GroupStatSet*>(stats);
+	if (groupSet!=NULL && groupSet->isPivot() && stats->fieldCount>1) {
+		wxArrayString fieldNames;
+		for (int i=1; i<stats->fieldCount; i++)
+			fieldNames.Add(statLabels[stats->fields[i]]);
+		wxBoxSizer* choiceSizer = new wxBoxSizer(wxHORIZONTAL);
+		choiceSizer->Add(new wxStaticText(this, -1, "Show field:"), 0, wxALIGN_CENTER_VERTICAL|wxRIGHT, 8);
+		fieldChoice = new wxChoice(this, STATS_FIELD, wxDefaultPosition, wxDefaultSize, fieldNames);
+		fieldChoice->SetSelection(0);
+		choiceSizer->Add(fieldChoice, 0);
+		topSizer->Add(choiceSizer, 0, wxLEFT|wxRIGHT|wxTOP, 8);
+		pivotList = new GuiPivotList(this, groupSet, stats->fields[1]);
+		topSizer->Add(pivotList, 1, wxEXPAND|wxALL, 8);
+	}
+
 	GuiStatsList* statList = new GuiStatsList(this,stats);
 	topSizer->Add(statList, 1, wxEXPAND|wxALL, 8);
 
@@ -178,6 +255,7 @@ GuiStatistics::~GuiStatistics()
 BEGIN_EVENT_TABLE(GuiStatistics, wxDialog)
     EVT_BUTTON(BUTTON_OK, GuiStatistics::onOk)
     EVT_CLOSE(GuiStatistics::onClose)
+    EVT_CHOICE(STATS_FIELD, GuiStatistics::onFieldChoice)
 END_EVENT_TABLE()
 
 void GuiStatistics::onOk(wxCommandEvent& event)
@@ -185,6 +263,13 @@ void GuiStatistics::onOk(wxCommandEvent& event)
 	EndModal(BUTTON_OK);
 }
 
+void GuiStatistics::onFieldChoice(wxCommandEvent& event)
+{
+	int sel = fieldChoice->GetSelection();
+	if (pivotList!=NULL && sel!=wxNOT_FOUND)
+		pivotList->setField(statSet->fields[sel+1]);
+}
+
 void GuiStatistics::onClose(wxCloseEvent& event)
 {
 	EndModal(BUTTON_OK);
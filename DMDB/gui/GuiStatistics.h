@@ -3,11 +3,12 @@
 * \author Lars Thomas Boye 2018
 *
 * Defines GUI dialogs for showing statistics. StatisticsReport
-* shows the contents of a DBStatistics object as a textual
+* shows the contents of a DBStatistics or MemoryUsage object as a textual
 * report. GuiStatsList is a list control for listing the
 * DBStatistics of a StatisticSet. The GuiStatistics dialog
 * houses such a list control. StatisticsReport dialog is shown
-* when selecting a row in the list.
+* when selecting a row in the list. GuiPivotList shows a
+* GroupStatSet with two keys as a pivot table.
 */
 
 #ifndef GUISTATISTICS_H
@@ -23,6 +24,7 @@
 #include "GuiBase.h"
 #include "GuiMapReport.h"
 #include "../data/StatisticSet.h"
+#include "../data/MemoryUsage.h"
 
 /*!
 * Dialog to show the contents of a DBStatistics object -
@@ -36,6 +38,9 @@ class StatisticsReport : public GuiReport
 	/*! Created with a MapStatistics object to show. */
 	StatisticsReport(wxWindow* parent, const wxPoint& pos, DBStatistics* stats);
 
+	/*! Created with the memory usage of the database to show. */
+	StatisticsReport(wxWindow* parent, const wxPoint& pos, MemoryUsage* usage);
+
 	virtual ~StatisticsReport() {}
 
 	//Event handlers:
@@ -43,6 +48,8 @@ class StatisticsReport : public GuiReport
 	virtual void onClose(wxCloseEvent& event); //!< Dialog closed
 
 	private:
+	/*! Adds the report view and OK button. */
+	void makeLayout();
 
 	//Macro for the event table
 	DECLARE_EVENT_TABLE()
@@ -85,9 +92,38 @@ class GuiStatsList : public wxListCtrl
 	DECLARE_EVENT_TABLE()
 };
 
+/*!
+* List control showing one field of a GroupStatSet with two keys
+* as a pivot table. There is a row for each key of the first
+* dimension, and a column for each key of the second, with the
+* field value of the group of each key pair. Empty if no group.
+*/
+class GuiPivotList : public wxListCtrl
+{
+	public:
+		/*! Created with a GroupStatSet with two keys. */
+		GuiPivotList(wxWindow* parent, GroupStatSet* stats, StatFields field);
+
+		virtual ~GuiPivotList() {}
+
+		/*! Show another field in the cells. */
+		void setField(StatFields field);
+
+	protected:
+		/*! Implementation of wxListCtrl. */
+		virtual wxString OnGetItemText(long item, long column) const;
+
+	private:
+		GroupStatSet* statSet;
+		StatFields cellField;
+		vector<int> rowKeys;
+		vector<int> colKeys;
+};
+
 /*!
 * Dialog with a GuiStatsList, to show a StatisticSet in
-* a table.
+* a table. For a GroupStatSet with two keys, it also has a
+* GuiPivotList with a choice of field.
 */
 class GuiStatistics : public wxDialog
 {
@@ -100,10 +136,14 @@ class GuiStatistics : public wxDialog
 		//Event handlers:
 		virtual void onOk(wxCommandEvent& event); //!< Ending with ok
 		virtual void onClose(wxCloseEvent& event); //!< Dialog closed
+		void onFieldChoice(wxCommandEvent& event); //!< Pivot field selected
 
 	protected:
 
 	private:
+		StatisticSet* statSet;
+		GuiPivotList* pivotList; //NULL if not pivot
+		wxChoice* fieldChoice;
 	//Macro for the event table
 	DECLARE_EVENT_TABLE()
 };
@@ -13,6 +13,7 @@ GuiViewSelect::GuiViewSelect(wxWindow* parent, GuiViewListener* l)
 {
 	listener = l;
 	dataViews = NULL;
+	newMaps = NULL;
 	SetDropTarget(new GuiViewDropTarget(this));
 	SetSizeHints(wxSize(40,40));
 }
@@ -63,7 +64,8 @@ void GuiViewSelect::populate(DataManager* dataMan, WadMapFields wadSort, WadMapF
 	dv->name = "New wads";
 	item = AppendItem(newStuff, dv->name);
 	(*dataViews)[item] = dv;
-	dv = new DataIdFilter(FILTER_MAP, DFOP_MORE, dataBase->getMapIdEnd());
+	newMaps = new DataIdFilter(FILTER_MAP, DFOP_MORE, dataBase->getMapIdEnd());
+	dv = newMaps;
 	dv->name = "New maps";
 	item = AppendItem(newStuff, dv->name);
 	(*dataViews)[item] = dv;
@@ -117,6 +119,20 @@ void GuiViewSelect::removeDataManager()
 		DeleteAllItems();
 		dataViews = NULL;
 	}
+	newMaps = NULL;
+}
+
+void GuiViewSelect::mapsLoaded()
+{
+	if (newMaps == NULL)
+		return;
+	newMaps->val = dataBase->getMapIdEnd();
+	newMaps->isChanged = true;
+	map<wxTreeItemId,DataFilter*>::iterator it = dataViews->find(GetSelection());
+	if (it!=dataViews->end() && it->second==newMaps) {
+		dataBase->changeDataFilter(newMaps);
+		listener->onViewSelected(newMaps);
+	}
 }
 
 //Event table:
@@ -201,6 +217,31 @@ void GuiViewSelect::onMenu(wxTreeEvent& event)
 		if ((dfilter->type==FILTER_WAD_LIST) || (dfilter->type==FILTER_MAP_LIST)) {
 			wxMenu menu;
 			menu.Append(10, "Delete list");
+			//Set operations with the other lists of the same type
+			list<DataListFilter*>* lists = (dfilter->type==FILTER_WAD_LIST)?
+				dataBase->getWadLists(): dataBase->getMapLists();
+			vector<DataListFilter*> others;
+			wxMenu* addMenu = new wxMenu();
+			wxMenu* keepMenu = new wxMenu();
+			wxMenu* removeMenu = new wxMenu();
+			for (list<DataListFilter*>::iterator lit=lists->begin(); lit != lists->end(); ++lit) {
+				if ((*lit) != dfilter && others.size() < 1000) {
+					addMenu->Append(1000+others.size(), (*lit)->name);
+					keepMenu->Append(2000+others.size(), (*lit)->name);
+					removeMenu->Append(3000+others.size(), (*lit)->name);
+					others.push_back(*lit);
+				}
+			}
+			if (others.empty()) {
+				delete addMenu;
+				delete keepMenu;
+				delete removeMenu;
+			} else {
+				menu.AppendSeparator();
+				menu.AppendSubMenu(addMenu, "Add entries from");
+				menu.AppendSubMenu(keepMenu, "Keep entries also in");
+				menu.AppendSubMenu(removeMenu, "Remove entries in");
+			}
 			int result = GetPopupMenuSelectionFromUser(menu, event.GetPoint());
 			if (result==10) {
 				bool wasSelected = (IsSelected(id));
@@ -210,6 +251,22 @@ void GuiViewSelect::onMenu(wxTreeEvent& event)
 					SelectItem(defaultView, true);
 				dataBase->removeDataFilter(dfilter);
 				delete dfilter;
+			} else if (result>=1000 && result<4000) {
+				DataListFilter* dlv = dynamic_cast<DataListFilter*>(dfilter);
+				DataListFilter* other = others[result%1000];
+				if (result < 2000)
+					dlv->addAll(other);
+				else if (result < 3000)
+					dlv->retainAll(other);
+				else
+					dlv->removeAll(other);
+				if (dlv->isChanged) {
+					dataBase->dataFilterModified();
+					if (IsSelected(id)) {
+						dataBase->changeDataFilter(dfilter);
+						listener->onViewSelected(dfilter);
+					}
+				}
 			}
 		}
 	}
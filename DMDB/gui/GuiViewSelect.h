@@ -71,6 +71,12 @@ class GuiViewSelect : public wxTreeCtrl
 		*/
 		void removeDataManager();
 
+		/*!
+		* Call when the DataManager has completed loading maps in the
+		* background, to update the "New maps" filter with the last map id.
+		*/
+		void mapsLoaded();
+
 		void onSelection(wxTreeEvent& event); //!< Item selection
 		void onMenu(wxTreeEvent& event); //!< Right-click for menu on item
 		void onBeginEdit(wxTreeEvent& event); //!< Start edit list name
@@ -115,6 +121,7 @@ class GuiViewSelect : public wxTreeCtrl
 		wxTreeItemId defaultView;
 		wxTreeItemId mapAuthor; //Tree item for author filter
 		wxTreeItemId mapTag; //Tree item for tag filter
+		DataIdFilter* newMaps; //"New maps" filter
 		wxTreeItemId wadLists; //Tree item holding wad lists
 		wxTreeItemId mapLists; //Tree item holding map lists
 
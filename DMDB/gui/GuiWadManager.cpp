@@ -256,7 +256,7 @@ void GuiWadManager::writeEntry()
 {
 	if (parts&GWP_MAIN) {
 		wadStrFields[WADSTR_IDGAMES] = wxIntToString(wadEntry->idGames);
-		wadStrFields[WADSTR_TITLE] = wadEntry->title;
+		wadStrFields[WADSTR_TITLE] = wadEntry->title.str();
 		wadStrFields[WADSTR_YEAR] = wxIntToString(wadEntry->year);
 		wadStrFields[WADSTR_RATING] = wxIntToString(wadEntry->rating); //Not shown
 		wadFlagBoxes[0]->SetValue(wadEntry->flags&WF_IWAD);
@@ -271,10 +271,10 @@ void GuiWadManager::writeEntry()
 		}
 	}
 	if (parts&GWP_FILE) {
-		wadStrFields[WADSTR_FILENAME] = wadEntry->fileName;
+		wadStrFields[WADSTR_FILENAME] = wadEntry->fileName.str();
 		wadStrFields[WADSTR_FILESIZE] = wxIntToString(wadEntry->fileSize);
 		wadStrFields[WADSTR_MD5] = wadEntry->getMd5String();
-		wadStrFields[WADSTR_XFILES] = wadEntry->extraFiles;
+		wadStrFields[WADSTR_XFILES] = wadEntry->extraFiles.str();
 	}
 	if (parts&GWP_OWN) {
 		if ((wadEntry->numberOfMaps==1) && hide) {
@@ -317,7 +317,7 @@ void GuiWadManager::writeEntry()
 	if (parts&GWP_MAPS) {
 		listBox->Clear();
 		for (int i=0; i<wadEntry->numberOfMaps; i++)
-			listBox->Append(wadEntry->mapPointers[i]->name);
+			listBox->Append(wadEntry->mapPointers[i]->name.str());
 		if (commonButton != NULL)
 			commonButton->Enable(wadEntry->numberOfMaps > 1);
 		if (deleteButton != NULL)
@@ -332,7 +332,7 @@ void GuiWadManager::readEntry()
 		uint16_t flg = wadEntry->flags;
 
 		if (parts&GWP_MAIN) {
-			if (wadEntry->title.compare(wadStrFields[WADSTR_TITLE])) {
+			if (wadEntry->title.str().compare(wadStrFields[WADSTR_TITLE])) {
 				wadEntry->title = wadStrFields[WADSTR_TITLE];
 				wadEntry->ownFlags |= OF_MAINMOD;
 				if (wadEntry->numberOfMaps==1) {
@@ -367,11 +367,11 @@ void GuiWadManager::readEntry()
 		}
 
 		if (parts&GWP_FILE) {
-			if (wadEntry->fileName.compare(wadStrFields[WADSTR_FILENAME])) {
+			if (wadEntry->fileName.str().compare(wadStrFields[WADSTR_FILENAME])) {
 				wadEntry->fileName = wadStrFields[WADSTR_FILENAME];
 				wadEntry->ownFlags |= OF_MAINMOD;
 			}
-			if (wadEntry->extraFiles.compare(wadStrFields[WADSTR_XFILES])) {
+			if (wadEntry->extraFiles.str().compare(wadStrFields[WADSTR_XFILES])) {
 				wadEntry->extraFiles = wadStrFields[WADSTR_XFILES];
 				wadEntry->ownFlags |= OF_MAINMOD;
 			}
@@ -438,6 +438,15 @@ void GuiWadManager::readEntry()
 		dataBase->saveWadText(wadText);
 }
 
+void GuiWadManager::prefetchImages(WadEntry* we)
+{
+	if (dataBase==NULL || we->mapPointers.empty())
+		return;
+	MapEntry* me = we->mapPointers[0];
+	GuiImagePanel::prefetch(dataBase->getMapImgFolder() + wxFILE_SEP_PATH + me->fileName() + ".png", wxBITMAP_TYPE_PNG);
+	GuiImagePanel::prefetch(dataBase->getScreenshotFolder() + wxFILE_SEP_PATH + me->fileName() + ".png", wxBITMAP_TYPE_PNG);
+}
+
 void GuiWadManager::clearEntry()
 {
 	//So far only complete for view mode (only disables input for private fields)
@@ -530,11 +539,11 @@ bool GuiWadManager::deleteSelectedMap(wxWindow* parent)
 		//Wad not yet in database
 		dataBase->deleteMapFiles(delMap);
 		if (wadText != NULL)
-			wadText->removeText(delMap->name);
+			wadText->removeText(delMap->name.str());
 		wadEntry->removeMap(i,true);
 		listBox->Clear();
 		for (int i=0; i<wadEntry->numberOfMaps; i++)
-			listBox->Append(wadEntry->mapPointers[i]->name);
+			listBox->Append(wadEntry->mapPointers[i]->name.str());
 		return true;
 	} else if (mode == DDMODE_EDIT) {
 		//Delete from database
@@ -547,7 +556,7 @@ bool GuiWadManager::deleteSelectedMap(wxWindow* parent)
 			dataBase->deleteMap(delMap);
 			listBox->Clear();
 			for (int i=0; i<wadEntry->numberOfMaps; i++)
-				listBox->Append(wadEntry->mapPointers[i]->name);
+				listBox->Append(wadEntry->mapPointers[i]->name.str());
 			return true;
 		}
 		return false;
@@ -175,6 +175,12 @@ class GuiWadManager
 		*/
 		void clearEntry();
 
+		/*!
+		* Start decoding the images of the first map of we, where the map
+		* dialog opens, when it is likely to be shown next.
+		*/
+		void prefetchImages(WadEntry* we);
+
 		/*!
 		* Shows the map dialog for the maps in the current wad. This is a modal
 		* dialog, and the user can scroll through the maps in the wad (if there are
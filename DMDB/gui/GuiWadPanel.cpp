@@ -44,6 +44,11 @@ void GuiWadPanel::clearWad()
 	TransferDataToWindow();
 }
 
+void GuiWadPanel::prefetchImages(WadEntry* wad)
+{
+	wadManager->prefetchImages(wad);
+}
+
 void GuiWadPanel::readChanges()
 {
 	if (wadManager->hasEntry()) {
@@ -50,6 +50,9 @@ class GuiWadPanel : public wxPanel
 		*/
 		void clearWad();
 
+		/*! Start loading the map images of a WadEntry likely to be shown next. */
+		void prefetchImages(WadEntry* wad);
+
 		/*!
 		* Before changing WadEntry or removing the panel, call this to
 		* update the currently shown WadEntry based on UI state.
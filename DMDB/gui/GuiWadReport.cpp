@@ -32,6 +32,7 @@ GuiWadReport::GuiWadReport(wxWindow* parent, const wxPoint& pos, WadReader* read
 	}
 	bottomSizer->Add(new wxButton(this,LTHING_OPEN,"Map Things..."), 0, wxALL, 10);
 	bottomSizer->Add(new wxButton(this,BUTTON_EDIT,"Aspects..."), 0, wxALL, 10);
+	bottomSizer->Add(new wxButton(this,BUTTON_TIMING,"Timing..."), 0, wxALL, 10);
 	bottomSizer->Add(new wxButton(this,BUTTON_OK,"Add to database"), 0, wxALL, 10);
 	bottomSizer->Add(new wxButton(this,BUTTON_CANCEL,"Discard"), 0, wxALL, 10);
 
@@ -65,6 +66,7 @@ BEGIN_EVENT_TABLE(GuiWadReport, wxDialog)
 	EVT_BUTTON(BUTTON_DELETE, GuiWadReport::onRemoveFile)
 	EVT_BUTTON(LTHING_OPEN, GuiWadReport::onThingDefs)
 	EVT_BUTTON(BUTTON_EDIT, GuiWadReport::onAspects)
+	EVT_BUTTON(BUTTON_TIMING, GuiWadReport::onTiming)
     EVT_BUTTON(BUTTON_OK, GuiWadReport::onOk)
     EVT_BUTTON(BUTTON_CANCEL, GuiWadReport::onCancel)
     EVT_CLOSE(GuiWadReport::onClose)
@@ -107,6 +109,7 @@ void GuiWadReport::onMapSelected(wxCommandEvent& event)
 		int result = mapDialog->ShowModal();
 		mapDialog->Destroy();
 	}
+	wadReader->addTiming(progress->takeTiming());
 	delete progress;
 	if (mapStats != NULL)
 		delete mapStats;
@@ -151,6 +154,7 @@ void GuiWadReport::addDeh(wxString fileName)
 		dlg->ShowModal();
 		dlg->Destroy();
 	}
+	wadReader->addTiming(progress->takeTiming());
 	delete progress;
 }
 
@@ -172,6 +176,7 @@ void GuiWadReport::addWad(wxString fileName, bool pk3)
 	} else {
 		listMaps();
 	}
+	wadReader->addTiming(progress->takeTiming());
 	delete progress;
 }
 
@@ -212,6 +217,13 @@ void GuiWadReport::onAspects(wxCommandEvent& event)
 	aspectDialog->Destroy();
 }
 
+void GuiWadReport::onTiming(wxCommandEvent& event)
+{
+	GuiTimingReport* dialog = new GuiTimingReport(this, wxDefaultPosition, wadReader->getTiming());
+	dialog->ShowModal();
+	dialog->Destroy();
+}
+
 void GuiWadReport::onOk(wxCommandEvent& event)
 {
 	EndModal(BUTTON_OK);
@@ -228,6 +240,64 @@ void GuiWadReport::onClose(wxCloseEvent& event)
 }
 
 
+//*****************************************************************
+//************************ GuiTimingReport ************************
+//*****************************************************************
+
+GuiTimingReport::GuiTimingReport(wxWindow* parent, const wxPoint& pos, TaskTrace* trc)
+: GuiReport(parent, "Timing", pos, wxSize(600,500)), trace(trc)
+{
+	//Main layout objects:
+	wxBoxSizer* topSizer = new wxBoxSizer(wxVERTICAL);
+
+	//Report view
+	topSizer->Add(reportView, 1, wxEXPAND|wxALL, 8);
+
+	//Buttons:
+	wxBoxSizer* bottomSizer = new wxBoxSizer(wxHORIZONTAL);
+	bottomSizer->Add(new wxButton(this,BUTTON_SAVE,"Save trace..."), 0, wxALL, 10);
+	bottomSizer->Add(new wxButton(this,BUTTON_OK,"OK"), 0, wxALL, 10);
+	topSizer->Add(bottomSizer, 0, wxALIGN_CENTER);
+
+	//Implementing the sizer:
+    SetSizer(topSizer);
+
+    trace->printReport(this);
+}
+
+//Event table:
+BEGIN_EVENT_TABLE(GuiTimingReport, wxDialog)
+	EVT_BUTTON(BUTTON_SAVE, GuiTimingReport::onSave)
+    EVT_BUTTON(BUTTON_OK, GuiTimingReport::onOk)
+    EVT_CLOSE(GuiTimingReport::onClose)
+END_EVENT_TABLE()
+
+void GuiTimingReport::onSave(wxCommandEvent& event)
+{
+	wxFileDialog* fdlg = new wxFileDialog(this, "Save trace", "", "trace.json",
+		"Trace files (*.json)|*.json", wxFD_SAVE|wxFD_OVERWRITE_PROMPT|wxFD_CHANGE_DIR);
+	if (fdlg->ShowModal() == wxID_OK) {
+		if (!trace->writeFile(fdlg->GetPath())) {
+			wxMessageDialog* dlg = new wxMessageDialog(this, "Could not write "+fdlg->GetPath(),
+				"File error", wxOK | wxICON_ERROR);
+			dlg->ShowModal();
+			dlg->Destroy();
+		}
+	}
+	fdlg->Destroy();
+}
+
+void GuiTimingReport::onOk(wxCommandEvent& event)
+{
+	EndModal(BUTTON_OK);
+}
+
+void GuiTimingReport::onClose(wxCloseEvent& event)
+{
+	EndModal(BUTTON_OK);
+}
+
+
 //************************************************************
 //************************ GuiWadType ************************
 //************************************************************
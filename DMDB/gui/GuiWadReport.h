@@ -5,8 +5,9 @@
 * Defines user interface components for reading and processing wad
 * files and other Doom-engine resource files. GuiWadReport is the
 * main GUI dialog of the process, acting as a user interface for a
-* WadReader object. GuiWadType is a simple dialog for specifying the
-* target iwad and engine of a wad.
+* WadReader object. GuiTimingReport shows how long the processing took.
+* GuiWadType is a simple dialog for specifying the target iwad and engine
+* of a wad.
 */
 
 #ifndef GUIWADREPORT_H
@@ -22,6 +23,7 @@
 #include "GuiMapReport.h"
 #include "GuiThingDef.h"
 #include "GuiAspectDialog.h"
+#include "GuiProgress.h"
 #include "../data/WadStats.h"
 #include "../data/WadReader.h"
 
@@ -52,6 +54,7 @@ class GuiWadReport : public GuiReport
 	void onRemoveFile(wxCommandEvent& event); //!< Remove file from WadReader
 	void onThingDefs(wxCommandEvent& event); //!< Show ThingDef dialog
 	void onAspects(wxCommandEvent& event); //!< Show Aspects dialog
+	void onTiming(wxCommandEvent& event); //!< Show GuiTimingReport
 	void onOk(wxCommandEvent& event); //!< Ending with ok
 	void onCancel(wxCommandEvent& event); //!< Ending with cancel
 	void onClose(wxCloseEvent& event); //!< Dialog closed
@@ -74,6 +77,29 @@ class GuiWadReport : public GuiReport
 	DECLARE_EVENT_TABLE()
 };
 
+/*!
+* GuiTimingReport is a report dialog with the timing of the tasks and
+* phases of a TaskTrace, as tables. The trace can be saved as a JSON
+* file for Chrome's trace viewer or Perfetto.
+*/
+class GuiTimingReport : public GuiReport
+{
+	public:
+	GuiTimingReport(wxWindow* parent, const wxPoint& pos, TaskTrace* trc);
+	virtual ~GuiTimingReport() {}
+
+	//Event handlers:
+	void onSave(wxCommandEvent& event); //!< Save trace file
+	void onOk(wxCommandEvent& event); //!< Ending with ok
+	void onClose(wxCloseEvent& event); //!< Dialog closed
+
+	private:
+	TaskTrace* trace;
+
+	//Macro for the event table
+	DECLARE_EVENT_TABLE()
+};
+
 /*!
 * Dialog for selecting an iwad and engine. These are given as
 * unsigned integers, corresponding to the IwadType and EngineType